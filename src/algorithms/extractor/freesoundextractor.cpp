@@ -17,7 +17,9 @@
  * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
  */
 
+#include <thread>
 #include "freesoundextractor.h"
+#include "vectoroutput.h"
 
 using namespace std;
 
@@ -55,6 +57,9 @@ void FreesoundExtractor::configure() {
   analysisSampleRate = parameter("analysisSampleRate").toReal();
   startTime = parameter("startTime").toReal();
   endTime = parameter("endTime").toReal();
+  cacheDirectory = parameter("cacheDirectory").toString();
+  memoryBudget = parameter("memoryBudget").toReal();
+  parallelGroups = parameter("parallelGroups").toBool();
 
   lowlevelFrameSize = parameter("lowlevelFrameSize").toInt();
   lowlevelHopSize = parameter("lowlevelHopSize").toInt();
@@ -100,6 +105,9 @@ void FreesoundExtractor::configure() {
     analysisSampleRate = options.value<Real>("analysisSampleRate");
     startTime = options.value<Real>("startTime");
     endTime = options.value<Real>("endTime");
+    cacheDirectory = options.value<string>("cacheDirectory");
+    memoryBudget = options.value<Real>("memoryBudget");
+    parallelGroups = options.value<Real>("parallelGroups");
   }
 
   if (options.value<Real>("highlevel.compute")) {
@@ -118,6 +126,9 @@ void FreesoundExtractor::setExtractorDefaultOptions() {
   options.set("startTime", startTime);
   options.set("endTime", endTime);
   options.set("analysisSampleRate", analysisSampleRate);
+  options.set("cacheDirectory", cacheDirectory);
+  options.set("memoryBudget", memoryBudget);
+  options.set("parallelGroups", parallelGroups);
 
   // lowlevel
   options.set("lowlevel.frameSize", lowlevelFrameSize);
@@ -191,64 +202,125 @@ void FreesoundExtractor::compute() {
   E_INFO("FreesoundExtractor: Read metadata");
   readMetadata(audioFilename, results);
  
-  E_INFO("FreesoundExtractor: Compute md5 audio hash, codec, length, and EBU 128 loudness");
-  computeAudioMetadata(audioFilename, results);
+  // results of each group of descriptors, which can be cached separately
+  Pool audioResults;
+  Pool lowlevelResults;
+  Pool rhythmResults;
+  Pool tonalResults;
+  Pool sfxResults;
+
+  bool useCache = !cacheDirectory.empty();
+  ExtractorCache cache(cacheDirectory, name, FREESOUND_EXTRACTOR_VERSION);
+  if (useCache) {
+    E_INFO("FreesoundExtractor: Compute md5 audio hash for the results cache");
+    cache.setAudioFile(audioFilename);
+    setCacheGroupOptions(cache);
+  }
+
+  if (useCache && cache.load("audio", audioResults)) {
+    E_INFO("FreesoundExtractor: Using cached md5 audio hash, codec, length, and EBU 128 loudness");
+  }
+  else {
+    E_INFO("FreesoundExtractor: Compute md5 audio hash, codec, length, and EBU 128 loudness");
+    computeAudioMetadata(audioFilename, audioResults);
+    if (useCache) cache.store("audio", audioResults);
+  }
   
   //TODO: add algorithm option to compute with replay gain? 
   //E_INFO("FreesoundExtractor: Replay gain");
   //computeReplayGain(audioFilename, results);
 
-  E_INFO("FreesoundExtractor: Compute audio features");
-
-  streaming::Algorithm* loader = factory.create("EasyLoader",
-                                    "filename",   audioFilename,
-                                    "sampleRate", analysisSampleRate,
-                                    "startTime",  startTime,
-                                    "endTime",    endTime,
-                                    //"replayGain", replayGain,
-                                    "downmix",    downmix);
-
-  FreesoundLowlevelDescriptors *lowlevel = new FreesoundLowlevelDescriptors(options);
-  FreesoundRhythmDescriptors *rhythm = new FreesoundRhythmDescriptors(options);
-  FreesoundTonalDescriptors *tonal = new FreesoundTonalDescriptors(options);
-  FreesoundSfxDescriptors *sfx = new FreesoundSfxDescriptors(options);
- 
-  SourceBase& source = loader->output("audio");
-  lowlevel->createNetwork(loader->output("audio"),results);
-  rhythm->createNetwork(source, results);
-  tonal->createNetwork(source, results);
-  sfx->createNetwork(loader->output("audio"),results);
-  sfx->createHarmonicityNetwork(loader->output("audio"), results);            
-
-  scheduler::Network network(loader);
-  network.run();
-  
-  // Descriptors that require values from other descriptors in the previous chain
-  
-  // requires 'loudness'
-  lowlevel->computeAverageLoudness(results);
+  bool computeLowlevel = !(useCache && cache.load("lowlevel", lowlevelResults));
+  bool computeRhythm = !(useCache && cache.load("rhythm", rhythmResults));
+  bool computeTonal = !(useCache && cache.load("tonal", tonalResults));
+  bool computeSfx = !(useCache && cache.load("sfx", sfxResults));
+
+  if (computeLowlevel || computeRhythm || computeTonal || computeSfx) {
+    if (parallelGroups) {
+      E_INFO("FreesoundExtractor: Compute audio features, one thread per group of descriptors");
+
+      vector<string> groups;
+      vector<Pool*> pools;
+      if (computeLowlevel) { groups.push_back("lowlevel"); pools.push_back(&lowlevelResults); }
+      if (computeRhythm) { groups.push_back("rhythm"); pools.push_back(&rhythmResults); }
+      if (computeTonal) { groups.push_back("tonal"); pools.push_back(&tonalResults); }
+      if (computeSfx) { groups.push_back("sfx"); pools.push_back(&sfxResults); }
+      computeFeaturesParallel(audioFilename, groups, pools);
+
+      // requires 'pitch'
+      if (computeSfx) computeSfxPitch(lowlevelResults, sfxResults);
+    }
+    else {
+      E_INFO("FreesoundExtractor: Compute audio features");
+
+      streaming::Algorithm* loader = factory.create("EasyLoader",
+                                        "filename",   audioFilename,
+                                        "sampleRate", analysisSampleRate,
+                                        "startTime",  startTime,
+                                        "endTime",    endTime,
+                                        //"replayGain", replayGain,
+                                        "downmix",    downmix);
+
+      FreesoundLowlevelDescriptors *lowlevel = new FreesoundLowlevelDescriptors(options);
+      FreesoundRhythmDescriptors *rhythm = new FreesoundRhythmDescriptors(options);
+      FreesoundTonalDescriptors *tonal = new FreesoundTonalDescriptors(options);
+      FreesoundSfxDescriptors *sfx = new FreesoundSfxDescriptors(options);
+   
+      SourceBase& source = loader->output("audio");
+      if (computeLowlevel) lowlevel->createNetwork(loader->output("audio"), lowlevelResults);
+      if (computeRhythm) rhythm->createNetwork(source, rhythmResults);
+      if (computeTonal) tonal->createNetwork(source, tonalResults);
+      if (computeSfx) {
+        sfx->createNetwork(loader->output("audio"), sfxResults);
+        sfx->createHarmonicityNetwork(loader->output("audio"), sfxResults);
+      }
 
-  streaming::Algorithm* loader_2 = factory.create("EasyLoader",
-                                       "filename",   audioFilename,
-                                       "sampleRate", analysisSampleRate,
-                                       "startTime",  startTime,
-                                       "endTime",    endTime,
-                                       //"replayGain", replayGain,
-                                       "downmix",    downmix);
+      scheduler::Network network(loader);
+      network.setMemoryBudget(memoryBudget * 1024 * 1024);
+      network.run();
+    
+      // Descriptors that require values from other descriptors in the previous chain
+    
+      // requires 'loudness'
+      if (computeLowlevel) lowlevel->computeAverageLoudness(lowlevelResults);
+
+      if (computeRhythm) {
+        streaming::Algorithm* loader_2 = factory.create("EasyLoader",
+                                             "filename",   audioFilename,
+                                             "sampleRate", analysisSampleRate,
+                                             "startTime",  startTime,
+                                             "endTime",    endTime,
+                                             //"replayGain", replayGain,
+                                             "downmix",    downmix);
+
+        // requires 'beat_positions'
+        rhythm->createNetworkBeatsLoudness(loader_2->output("audio"), rhythmResults);  
+
+        scheduler::Network network_2(loader_2);
+        network_2.setMemoryBudget(memoryBudget * 1024 * 1024);
+        network_2.run();
+      }
 
-  // requires 'beat_positions'
-  rhythm->createNetworkBeatsLoudness(loader_2->output("audio"), results);  
+      // requires 'pitch'
+      if (computeSfx) computeSfxPitch(lowlevelResults, sfxResults);
+    }
 
-  scheduler::Network network_2(loader_2);
-  network_2.run();
+    if (useCache) {
+      if (computeLowlevel) cache.store("lowlevel", lowlevelResults);
+      if (computeRhythm) cache.store("rhythm", rhythmResults);
+      if (computeTonal) cache.store("tonal", tonalResults);
+      if (computeSfx) cache.store("sfx", sfxResults);
+    }
+  }
+  else {
+    E_INFO("FreesoundExtractor: Using cached audio features");
+  }
 
-  // requires 'pitch'
-  vector<Real> pitch = results.value<vector<Real> >("lowlevel.pitch");
-  VectorInput<Real> *pitchVector = new VectorInput<Real>();
-  pitchVector->setVector(&pitch);
-  sfx->createPitchNetwork(*pitchVector, results);
-  scheduler::Network sfxPitchNetwork(pitchVector);
-  sfxPitchNetwork.run();
+  results.merge(audioResults);
+  results.merge(lowlevelResults);
+  results.merge(rhythmResults);
+  results.merge(tonalResults);
+  results.merge(sfxResults);
 
   E_INFO("FreesoundExtractor: Compute aggregation");
   stats = computeAggregation(results);
@@ -270,6 +342,117 @@ void FreesoundExtractor::compute() {
 }
 
 
+void FreesoundExtractor::computeFeaturesParallel(const string& audioFilename,
+                                                 const vector<string>& groups,
+                                                 const vector<Pool*>& pools) {
+  // decode the audio only once, it is then read by the networks of all the
+  // groups of descriptors
+  vector<Real> audio;
+  streaming::AlgorithmFactory& factory = streaming::AlgorithmFactory::instance();
+  streaming::Algorithm* loader = factory.create("EasyLoader",
+                                    "filename",   audioFilename,
+                                    "sampleRate", analysisSampleRate,
+                                    "startTime",  startTime,
+                                    "endTime",    endTime,
+                                    //"replayGain", replayGain,
+                                    "downmix",    downmix);
+  loader->output("audio") >> audio;
+
+  scheduler::Network network(loader);
+  network.setMemoryBudget(memoryBudget * 1024 * 1024);
+  network.run();
+
+  // the groups only share the (read-only) audio and write to their own pool
+  vector<string> errors(groups.size());
+  vector<thread> threads;
+  for (int i=0; i<(int)groups.size(); ++i) {
+    threads.push_back(thread(computeGroupThread, this, groups[i], &audio, pools[i], &errors[i]));
+  }
+  for (int i=0; i<(int)threads.size(); ++i) threads[i].join();
+
+  for (int i=0; i<(int)errors.size(); ++i) {
+    if (!errors[i].empty()) {
+      throw EssentiaException("FreesoundExtractor: error computing the ", groups[i], " descriptors: ", errors[i]);
+    }
+  }
+}
+
+
+void FreesoundExtractor::computeGroupThread(FreesoundExtractor* extractor, string group,
+                                            const vector<Real>* audio, Pool* pool, string* error) {
+  // exceptions cannot cross threads, they are rethrown by computeFeaturesParallel
+  try {
+    extractor->computeGroup(group, *audio, *pool);
+  }
+  catch (const std::exception& e) {
+    *error = e.what();
+  }
+}
+
+
+void FreesoundExtractor::computeGroup(const string& group, const vector<Real>& audio, Pool& pool) {
+  streaming::VectorInput<Real, 4096>* input = new streaming::VectorInput<Real, 4096>(&audio);
+  input->output("data").setBufferType(BufferUsage::forAudioStream);
+  SourceBase& source = input->output("data");
+
+  if (group == "lowlevel") {
+    FreesoundLowlevelDescriptors lowlevel(options);
+    lowlevel.createNetwork(source, pool);
+    scheduler::Network network(input);
+    network.setMemoryBudget(memoryBudget * 1024 * 1024);
+    network.run();
+
+    // requires 'loudness'
+    lowlevel.computeAverageLoudness(pool);
+  }
+  else if (group == "rhythm") {
+    FreesoundRhythmDescriptors rhythm(options);
+    rhythm.createNetwork(source, pool);
+    scheduler::Network network(input);
+    network.setMemoryBudget(memoryBudget * 1024 * 1024);
+    network.run();
+
+    // requires 'beat_positions'
+    streaming::VectorInput<Real, 4096>* input_2 = new streaming::VectorInput<Real, 4096>(&audio);
+    input_2->output("data").setBufferType(BufferUsage::forAudioStream);
+    rhythm.createNetworkBeatsLoudness(input_2->output("data"), pool);
+    scheduler::Network network_2(input_2);
+    network_2.setMemoryBudget(memoryBudget * 1024 * 1024);
+    network_2.run();
+  }
+  else if (group == "tonal") {
+    FreesoundTonalDescriptors tonal(options);
+    tonal.createNetwork(source, pool);
+    scheduler::Network network(input);
+    network.setMemoryBudget(memoryBudget * 1024 * 1024);
+    network.run();
+  }
+  else if (group == "sfx") {
+    FreesoundSfxDescriptors sfx(options);
+    sfx.createNetwork(source, pool);
+    sfx.createHarmonicityNetwork(source, pool);
+    scheduler::Network network(input);
+    network.setMemoryBudget(memoryBudget * 1024 * 1024);
+    network.run();
+  }
+  else {
+    delete input;
+    throw EssentiaException("FreesoundExtractor: unknown group of descriptors: ", group);
+  }
+}
+
+
+void FreesoundExtractor::computeSfxPitch(Pool& lowlevelResults, Pool& sfxResults) {
+  FreesoundSfxDescriptors sfx(options);
+  vector<Real> pitch = lowlevelResults.value<vector<Real> >("lowlevel.pitch");
+  VectorInput<Real> *pitchVector = new VectorInput<Real>();
+  pitchVector->setVector(&pitch);
+  sfx.createPitchNetwork(*pitchVector, sfxResults);
+  scheduler::Network sfxPitchNetwork(pitchVector);
+  sfxPitchNetwork.run();
+}
+
+
 Pool FreesoundExtractor::computeAggregation(Pool& pool){
 
   // choose which descriptors stats to output
@@ -554,6 +737,35 @@ void FreesoundExtractor::computeReplayGain(const string& audioFilename, Pool& re
 }
 
 
+void FreesoundExtractor::setCacheGroupOptions(ExtractorCache& cache) {
+  // all the descriptors are computed on the audio trimmed and resampled
+  // according to the general options. Statistics options are not included as
+  // the aggregation is never cached.
+  const char* audioOptions[] = { "analysisSampleRate", "startTime", "endTime" };
+  const char* lowlevelOptions[] = { "lowlevel.frameSize", "lowlevel.hopSize",
+                                    "lowlevel.zeroPadding", "lowlevel.windowType",
+                                    "lowlevel.silentFrames" };
+  const char* rhythmOptions[] = { "rhythm.method", "rhythm.minTempo", "rhythm.maxTempo" };
+  const char* tonalOptions[] = { "tonal.frameSize", "tonal.hopSize", "tonal.zeroPadding",
+                                 "tonal.windowType", "tonal.silentFrames" };
+
+  vector<string> audio = arrayToVector<string>(audioOptions);
+  vector<string> lowlevel = audio;
+  vector<string> rhythm = audio;
+  vector<string> tonal = audio;
+  lowlevel.insert(lowlevel.end(), lowlevelOptions, lowlevelOptions + ARRAY_SIZE(lowlevelOptions));
+  rhythm.insert(rhythm.end(), rhythmOptions, rhythmOptions + ARRAY_SIZE(rhythmOptions));
+  tonal.insert(tonal.end(), tonalOptions, tonalOptions + ARRAY_SIZE(tonalOptions));
+
+  cache.setGroupOptions("audio", options, audio);
+  cache.setGroupOptions("lowlevel", options, lowlevel);
+  cache.setGroupOptions("rhythm", options, rhythm);
+  cache.setGroupOptions("tonal", options, tonal);
+  // sfx descriptors use the low-level frames and pitch
+  cache.setGroupOptions("sfx", options, lowlevel);
+}
+
+
 void FreesoundExtractor::setExtractorOptions(const std::string& filename) {
 
   if (filename.empty()) return;
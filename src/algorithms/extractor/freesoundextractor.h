@@ -28,6 +28,7 @@
 #include "extractor_freesound/FreesoundSfxDescriptors.h"  
 #include "extractor_freesound/FreesoundTonalDescriptors.h"
 #include "extractor_freesound/extractor_version.h"
+#include "extractorcache.h"
 
 namespace essentia {
 namespace standard {
@@ -41,6 +42,9 @@ class FreesoundExtractor : public Algorithm {
   Real analysisSampleRate;
   Real startTime;
   Real endTime;
+  std::string cacheDirectory;
+  Real memoryBudget;
+  bool parallelGroups;
 
   int lowlevelFrameSize;
   int lowlevelHopSize;
@@ -83,6 +87,14 @@ class FreesoundExtractor : public Algorithm {
   void readMetadata(const std::string& audioFilename, Pool& results);
   void computeAudioMetadata(const std::string& audioFilename, Pool& results);
   void computeReplayGain(const std::string& audioFilename, Pool& results);
+  void setCacheGroupOptions(ExtractorCache& cache);
+  void computeFeaturesParallel(const std::string& audioFilename,
+                               const std::vector<std::string>& groups,
+                               const std::vector<Pool*>& pools);
+  void computeGroup(const std::string& group, const std::vector<Real>& audio, Pool& pool);
+  void computeSfxPitch(Pool& lowlevelResults, Pool& sfxResults);
+  static void computeGroupThread(FreesoundExtractor* extractor, std::string group,
+                                 const std::vector<Real>* audio, Pool* pool, std::string* error);
 
   Pool computeAggregation(Pool& pool);
 
@@ -97,6 +109,9 @@ class FreesoundExtractor : public Algorithm {
     declareParameter("analysisSampleRate", "the analysis sampling rate of the audio signal [Hz]", "(0,inf)", 44100.0);
     declareParameter("startTime", "the start time of the slice you want to extract [s]", "[0,inf)", 0.0);
     declareParameter("endTime", "the end time of the slice you want to extract [s]", "[0,inf)", 1.0e6); 
+    declareParameter("cacheDirectory", "directory where to cache the results of each group of descriptors, keyed by the MD5 of the audio stream, the extractor version and the options they depend on. Cached results are reused instead of being recomputed. Caching is disabled if empty", "", "");
+    declareParameter("memoryBudget", "the maximum memory that each processing network may use [MB], as estimated by its memory accounting. The analysis fails with an exception as soon as it is exceeded, instead of being killed when running out of memory. No limit if 0", "[0,inf)", 0.0);
+    declareParameter("parallelGroups", "decode the audio once and compute each group of descriptors (lowlevel, rhythm, tonal, sfx) in its own network and thread, instead of a single network. The decoded audio is kept in memory during the analysis", "{true,false}", false);
     declareParameter("lowlevelFrameSize", "the frame size for computing low-level features", "(0,inf)", 2048);
     declareParameter("lowlevelHopSize", "the hop size for computing low-level features", "(0,inf)", 1024);
     declareParameter("lowlevelZeroPadding", "zero padding factor for computing low-level features", "[0,inf)", 0);
@@ -19,6 +19,9 @@
 
 #include "musicextractor.h"
 #include "extractor_music/tagwhitelist.h"
+#include "chunkedpoolaggregator.h"
+#include "vectorinput.h"
+#include "vectoroutput.h"
 
 using namespace std;
 
@@ -29,6 +32,9 @@ const char* MusicExtractor::name = "MusicExtractor";
 const char* MusicExtractor::category = "Extractors";
 const char* MusicExtractor::description = DOC("This algorithm is a wrapper for Music Extractor");
 
+// the statistics computed for the descriptors without a specific configuration
+static const char* defaultStats[] = { "mean", "var", "stdev", "median", "min", "max", "dmean", "dmean2", "dvar", "dvar2" };
+
 
 MusicExtractor::MusicExtractor() {
   declareInput(_audiofile, "filename", "the input audiofile");
@@ -57,6 +63,10 @@ void MusicExtractor::configure() {
   startTime = parameter("startTime").toReal();
   endTime = parameter("endTime").toReal();
   requireMbid = parameter("requireMbid").toBool();
+  cacheDirectory = parameter("cacheDirectory").toString();
+  memoryBudget = parameter("memoryBudget").toReal();
+  chunkSize = parameter("chunkSize").toReal();
+  chunkOverlap = parameter("chunkOverlap").toReal();
 
   lowlevelFrameSize = parameter("lowlevelFrameSize").toInt();
   lowlevelHopSize = parameter("lowlevelHopSize").toInt();
@@ -101,6 +111,10 @@ void MusicExtractor::configure() {
     startTime = options.value<Real>("startTime");
     endTime = options.value<Real>("endTime");
     requireMbid = options.value<Real>("requireMbid");
+    cacheDirectory = options.value<string>("cacheDirectory");
+    memoryBudget = options.value<Real>("memoryBudget");
+    chunkSize = options.value<Real>("chunkSize");
+    chunkOverlap = options.value<Real>("chunkOverlap");
   }
 
   if (options.value<Real>("highlevel.compute")) {
@@ -120,6 +134,10 @@ void MusicExtractor::setExtractorDefaultOptions() {
   options.set("endTime", endTime);
   options.set("analysisSampleRate", analysisSampleRate);
   options.set("requireMbid", requireMbid);
+  options.set("cacheDirectory", cacheDirectory);
+  options.set("memoryBudget", memoryBudget);
+  options.set("chunkSize", chunkSize);
+  options.set("chunkOverlap", chunkOverlap);
 
   // lowlevel
   options.set("lowlevel.frameSize", lowlevelFrameSize);
@@ -174,7 +192,9 @@ void MusicExtractor::compute() {
   Pool results;
   Pool stats;
 
-  streaming::AlgorithmFactory& factory = streaming::AlgorithmFactory::instance();
+  // the downmix may be changed by computeReplayGain for (almost) silent files,
+  // start from the configured one so that the extractor can be reused
+  downmix = "mix";
 
   results.set("metadata.version.essentia", essentia::version);
   results.set("metadata.version.essentia_git_sha", essentia::version_git_sha);
@@ -199,67 +219,79 @@ void MusicExtractor::compute() {
       throw EssentiaException("MusicExtractor: Error processing ", audioFilename, " file: cannot find musicbrainz recording id");
   }
   
-  E_INFO("MusicExtractor: Compute md5 audio hash, codec, length, and EBU 128 loudness");
-  computeAudioMetadata(audioFilename, results);
-  
-  E_INFO("MusicExtractor: Replay gain");
-  computeReplayGain(audioFilename, results);
-  
-  E_INFO("MusicExtractor: Compute audio features");
-
-  // normalize the audio with replay gain and compute as many lowlevel, rhythm,
-  // and tonal descriptors as possible
-  
-  streaming::Algorithm* loader = factory.create("EasyLoader",
-                                    "filename",   audioFilename,
-                                    "sampleRate", analysisSampleRate,
-                                    "startTime",  startTime,
-                                    "endTime",    endTime,
-                                    "replayGain", replayGain,
-                                    "downmix",    downmix);
-  MusicLowlevelDescriptors *lowlevel = new MusicLowlevelDescriptors(options);
-  MusicRhythmDescriptors *rhythm = new MusicRhythmDescriptors(options);
-  MusicTonalDescriptors *tonal = new MusicTonalDescriptors(options);
-  
-  SourceBase& source = loader->output("audio");
-  lowlevel->createNetworkNeqLoud(source, results);
-  lowlevel->createNetworkEqLoud(source, results);
-  lowlevel->createNetworkLoudness(source, results);
-  rhythm->createNetwork(source, results);
-  tonal->createNetworkTuningFrequency(source, results);
+  // results of each group of descriptors, which can be cached separately
+  Pool audioResults;
+  Pool lowlevelResults;
+  Pool rhythmResults;
+  Pool tonalResults;
+
+  bool useCache = !cacheDirectory.empty();
+  ExtractorCache cache(cacheDirectory, name, MUSIC_EXTRACTOR_VERSION);
+  if (useCache) {
+    E_INFO("MusicExtractor: Compute md5 audio hash for the results cache");
+    cache.setAudioFile(audioFilename);
+    setCacheGroupOptions(cache);
+  }
 
-  scheduler::Network network(loader);
-  network.run();
-  
-  // Descriptors that require values from other descriptors in the previous chain
-  lowlevel->computeAverageLoudness(results);  // requires 'loudness'
+  if (useCache && cache.load("audio", audioResults)) {
+    E_INFO("MusicExtractor: Using cached md5 audio hash, codec, length, EBU 128 loudness, and replay gain");
+    replayGain = audioResults.value<Real>("metadata.audio_properties.replay_gain");
+    downmix = audioResults.value<string>("cache.downmix");
+  }
+  else {
+    E_INFO("MusicExtractor: Compute md5 audio hash, codec, length, and EBU 128 loudness");
+    computeAudioMetadata(audioFilename, audioResults);
 
-  streaming::Algorithm* loader_2 = factory.create("EasyLoader",
-                                       "filename",   audioFilename,
-                                       "sampleRate", analysisSampleRate,
-                                       "startTime",  startTime,
-                                       "endTime",    endTime,
-                                       "replayGain", replayGain,
-                                       "downmix",    downmix);
+    E_INFO("MusicExtractor: Replay gain");
+    computeReplayGain(audioFilename, audioResults);
 
-  SourceBase& source_2 = loader_2->output("audio");
-  rhythm->createNetworkBeatsLoudness(source_2, results);  // requires 'beat_positions'
-  tonal->createNetwork(source_2, results);                // requires 'tuning frequency'
+    // the downmix used for the analysis may have been changed while computing
+    // the replay gain
+    audioResults.set("cache.downmix", downmix);
+    if (useCache) cache.store("audio", audioResults);
+  }
+  audioResults.remove("cache.downmix");
 
-  scheduler::Network network_2(loader_2);
-  network_2.run();
+  results.merge(audioResults);
 
-  // Descriptors that require values from other descriptors in the previous chain
-  tonal->computeTuningSystemFeatures(results); // requires 'hpcp_highres'
+  if (chunkSize > 0) {
+    // the frame values of the descriptors are not kept, only the statistics
+    // of each chunk, which are not cached
+    E_INFO("MusicExtractor: Compute audio features and aggregation in chunks of " << chunkSize << "s");
+    stats = computeChunkedAggregation(audioFilename, results);
+  }
+  else {
+    bool computeLowlevel = !(useCache && cache.load("lowlevel", lowlevelResults));
+    bool computeRhythm = !(useCache && cache.load("rhythm", rhythmResults));
+    bool computeTonal = !(useCache && cache.load("tonal", tonalResults));
+
+    if (computeLowlevel || computeRhythm || computeTonal) {
+      E_INFO("MusicExtractor: Compute audio features");
+      computeFeatures(audioFilename, startTime, endTime,
+                      computeLowlevel, computeRhythm, computeTonal,
+                      lowlevelResults, rhythmResults, tonalResults);
+
+      if (useCache) {
+        if (computeLowlevel) cache.store("lowlevel", lowlevelResults);
+        if (computeRhythm) cache.store("rhythm", rhythmResults);
+        if (computeTonal) cache.store("tonal", tonalResults);
+      }
+    }
+    else {
+      E_INFO("MusicExtractor: Using cached audio features");
+    }
 
-  // TODO is this necessary? tuning_frequency should always have one value:
-  Real tuningFreq = results.value<vector<Real> >(tonal->nameSpace + "tuning_frequency").back();
-  results.remove(tonal->nameSpace + "tuning_frequency");
-  results.set(tonal->nameSpace + "tuning_frequency", tuningFreq);
-  
+    results.merge(lowlevelResults);
+    results.merge(rhythmResults);
+    results.merge(tonalResults);
 
-  E_INFO("MusicExtractor: Compute aggregation");
-  stats = computeAggregation(results);
+    E_INFO("MusicExtractor: Compute aggregation");
+    stats = computeAggregation(results);
+    addMissingStats(stats,
+                    results.contains<vector<Real> >("rhythm.beats_loudness"),
+                    results.contains<vector<vector<Real> > >("rhythm.beats_loudness_band_ratio"),
+                    results.value<vector<Real> >("rhythm.beats_position").size());
+  }
 
   // pre-trained classifiers are only available in branches devoted for that
   // (eg: 2.0.1)
@@ -280,13 +312,241 @@ void MusicExtractor::compute() {
 }
 
 
+streaming::Algorithm* MusicExtractor::createLoader(const string& audioFilename, Real start, Real end,
+                                                   const vector<Real>* audio) {
+  if (audio) {
+    streaming::VectorInput<Real>* input = new streaming::VectorInput<Real>(audio);
+    input->setAcquireSize(4096);
+    input->output("data").setBufferType(BufferUsage::forLargeAudioStream);
+    return input;
+  }
+
+  // normalize the audio with replay gain
+  return streaming::AlgorithmFactory::create("EasyLoader",
+                                             "filename",   audioFilename,
+                                             "sampleRate", analysisSampleRate,
+                                             "startTime",  start,
+                                             "endTime",    end,
+                                             "replayGain", replayGain,
+                                             "downmix",    downmix);
+}
+
+
+void MusicExtractor::computeFeatures(const string& audioFilename, Real start, Real end,
+                                     bool computeLowlevel, bool computeRhythm, bool computeTonal,
+                                     Pool& lowlevelResults, Pool& rhythmResults, Pool& tonalResults,
+                                     const vector<Real>* audio) {
+  // compute as many lowlevel, rhythm, and tonal descriptors as possible, on
+  // the given audio if it has already been loaded, or else on the audio of
+  // the file between start and end
+  const char* output = audio ? "data" : "audio";
+
+  streaming::Algorithm* loader = createLoader(audioFilename, start, end, audio);
+  MusicLowlevelDescriptors *lowlevel = new MusicLowlevelDescriptors(options);
+  MusicRhythmDescriptors *rhythm = new MusicRhythmDescriptors(options);
+  MusicTonalDescriptors *tonal = new MusicTonalDescriptors(options);
+
+  SourceBase& source = loader->output(output);
+  if (computeLowlevel) {
+    lowlevel->createNetworkNeqLoud(source, lowlevelResults);
+    lowlevel->createNetworkEqLoud(source, lowlevelResults);
+    lowlevel->createNetworkLoudness(source, lowlevelResults);
+  }
+  if (computeRhythm) rhythm->createNetwork(source, rhythmResults);
+  if (computeTonal) tonal->createNetworkTuningFrequency(source, tonalResults);
+
+  scheduler::Network network(loader);
+  network.setMemoryBudget(memoryBudget * 1024 * 1024);
+  network.run();
+
+  // Descriptors that require values from other descriptors in the previous chain
+  if (computeLowlevel) lowlevel->computeAverageLoudness(lowlevelResults);  // requires 'loudness'
+
+  if (computeRhythm || computeTonal) {
+    streaming::Algorithm* loader_2 = createLoader(audioFilename, start, end, audio);
+
+    SourceBase& source_2 = loader_2->output(output);
+    if (computeRhythm) rhythm->createNetworkBeatsLoudness(source_2, rhythmResults);  // requires 'beat_positions'
+    if (computeTonal) tonal->createNetwork(source_2, tonalResults);                // requires 'tuning frequency'
+
+    scheduler::Network network_2(loader_2);
+    network_2.setMemoryBudget(memoryBudget * 1024 * 1024);
+    network_2.run();
+  }
+
+  if (computeTonal) {
+    // Descriptors that require values from other descriptors in the previous chain
+    tonal->computeTuningSystemFeatures(tonalResults); // requires 'hpcp_highres'
+
+    // TODO is this necessary? tuning_frequency should always have one value:
+    Real tuningFreq = tonalResults.value<vector<Real> >(tonal->nameSpace + "tuning_frequency").back();
+    tonalResults.remove(tonal->nameSpace + "tuning_frequency");
+    tonalResults.set(tonal->nameSpace + "tuning_frequency", tuningFreq);
+  }
+
+  delete lowlevel;
+  delete rhythm;
+  delete tonal;
+}
+
+
 Pool MusicExtractor::computeAggregation(Pool& pool){
 
   // choose which descriptors stats to output
-  const char* defaultStats[] = { "mean", "var", "stdev", "median", "min", "max", "dmean", "dmean2", "dvar", "dvar2" };
+  map<string, vector<string> > exceptions = statsExceptions(pool.descriptorNames());
 
+  standard::Algorithm* aggregator = standard::AlgorithmFactory::create("PoolAggregator",
+                                                                       "defaultStats", arrayToVector<string>(defaultStats),
+                                                                       "exceptions", exceptions);
+  Pool poolStats;
+  aggregator->input("input").set(pool);
+  aggregator->output("output").set(poolStats);
+
+  aggregator->compute();
+
+  delete aggregator;
+
+  return poolStats;
+}
+
+
+// rounds value to the nearest multiple of step
+static long long roundToMultiple(double value, long long step) {
+  return (long long)(value / step + 0.5) * step;
+}
+
+// returns the least common multiple of a and b
+static long long lcm(long long a, long long b) {
+  long long x = a, y = b;
+  while (y != 0) {
+    long long r = x % y;
+    x = y;
+    y = r;
+  }
+  return a / x * b;
+}
+
+
+Pool MusicExtractor::computeChunkedAggregation(const string& audioFilename, Pool& results) {
+  Real sampleRate = analysisSampleRate;
+
+  // The boundaries of the chunks and of the audio analyzed before them, only
+  // to give context, are multiples of the lowlevel and tonal hop sizes, so
+  // that the lowlevel and tonal frames of a chunk are centered on the same
+  // samples as when the whole audio is analyzed at once, and the aggregator
+  // ignores exactly the ones centered in the context. Each chunk is also
+  // analyzed together with the half-frame following it, so that its last
+  // frames are not zero padded.
+  int lowlevelHop = int(options.value<Real>("lowlevel.hopSize"));
+  int tonalHop = int(options.value<Real>("tonal.hopSize"));
+  long long hop = lcm(lowlevelHop, tonalHop);
+  long long halfFrame = max(int(options.value<Real>("lowlevel.frameSize")),
+                            int(options.value<Real>("tonal.frameSize"))) / 2;
+  long long chunkSamples = max(hop, roundToMultiple(chunkSize * sampleRate, hop));
+  long long overlapSamples = roundToMultiple(chunkOverlap * sampleRate, hop);
+  long long lookaheadSamples = max(hop, (halfFrame + hop - 1) / hop * hop);
+
+  // The audio is decoded only once: the loader network is run step by step
+  // until the samples needed by the next chunk have been loaded, and the
+  // samples preceding its context are discarded.
+  streaming::Algorithm* loader = createLoader(audioFilename, startTime, endTime);
+  vector<Real> audio;
+  long long audioStart = 0; // index of the first sample of audio
+  streaming::VectorOutput<Real>* storage = new streaming::VectorOutput<Real>(&audio);
+  loader->output("audio") >> storage->input("data");
+
+  scheduler::Network loaderNetwork(loader);
+  loaderNetwork.setMemoryBudget(memoryBudget * 1024 * 1024);
+  loaderNetwork.runPrepare();
+  bool loading = true;
+
+  ChunkedPoolAggregator aggregator(arrayToVector<string>(defaultStats));
+  aggregator.setFramePeriod("lowlevel.", lowlevelHop / sampleRate);
+  aggregator.setFramePeriod("tonal.", tonalHop / sampleRate);
+  vector<Real> beats;
+  bool hasBeatsLoudness = false;
+  bool hasBeatsLoudnessBandRatio = false;
+
+  long long chunkStart = 0;
+  while (true) {
+    // a remainder shorter than half a chunk is added to the last chunk, as
+    // the rhythm descriptors are not reliable on very short segments
+    long long chunkEnd = chunkStart + chunkSamples;
+    long long needed = chunkEnd + max(lookaheadSamples, chunkSamples / 2);
+    while (loading && audioStart + (long long)audio.size() < needed) {
+      loading = loaderNetwork.runStep();
+    }
+    long long loaded = audioStart + audio.size();
+    if (loaded <= chunkStart) break;
+
+    bool last = !loading && loaded - chunkEnd < chunkSamples / 2;
+    if (last) chunkEnd = loaded;
+
+    long long analysisStart = max(0LL, chunkStart - overlapSamples);
+    long long analysisEnd = last ? chunkEnd : chunkEnd + lookaheadSamples;
+
+    E_INFO("MusicExtractor: Compute audio features from " << startTime + chunkStart / sampleRate
+           << "s to " << startTime + chunkEnd / sampleRate << "s");
+
+    vector<Real> chunkAudio(audio.begin() + (analysisStart - audioStart),
+                            audio.begin() + (analysisEnd - audioStart));
+
+    Pool chunk, lowlevelResults, rhythmResults, tonalResults;
+    computeFeatures(audioFilename, 0, 0, true, true, true,
+                    lowlevelResults, rhythmResults, tonalResults, &chunkAudio);
+    chunk.merge(lowlevelResults);
+    chunk.merge(rhythmResults);
+    chunk.merge(tonalResults);
+
+    // beat positions are relative to the start of the analyzed audio. The
+    // beats of all the chunks are gathered, except for the ones found in the
+    // context before and after the chunk
+    if (chunk.contains<vector<Real> >("rhythm.beats_position")) {
+      const vector<Real>& positions = chunk.value<vector<Real> >("rhythm.beats_position");
+      for (int i=0; i<(int)positions.size(); ++i) {
+        Real position = analysisStart / sampleRate + positions[i];
+        if (position >= chunkStart / sampleRate && position < chunkEnd / sampleRate) {
+          beats.push_back(position);
+        }
+      }
+      chunk.remove("rhythm.beats_position");
+    }
+    hasBeatsLoudness |= chunk.contains<vector<Real> >("rhythm.beats_loudness");
+    hasBeatsLoudnessBandRatio |= chunk.contains<vector<vector<Real> > >("rhythm.beats_loudness_band_ratio");
+
+    aggregator.setExceptions(statsExceptions(chunk.descriptorNames()));
+    aggregator.add(chunk, (analysisEnd - analysisStart) / sampleRate,
+                   (chunkStart - analysisStart) / sampleRate,
+                   (analysisEnd - chunkEnd) / sampleRate);
+
+    if (last) break;
+
+    // drop the samples which are not needed by the next chunk
+    chunkStart = chunkEnd;
+    long long keepFrom = max(0LL, chunkStart - overlapSamples);
+    audio.erase(audio.begin(), audio.begin() + (keepFrom - audioStart));
+    audioStart = keepFrom;
+  }
+
+  if (!beats.empty()) {
+    Pool beatsPool;
+    beatsPool.append("rhythm.beats_position", beats);
+    aggregator.setExceptions(statsExceptions(beatsPool.descriptorNames()));
+    aggregator.add(beatsPool, 0);
+  }
+
+  // the metadata and the descriptors computed on the whole audio are
+  // aggregated as usual
+  Pool poolStats = computeAggregation(results);
+  aggregator.aggregate(poolStats);
+  addMissingStats(poolStats, hasBeatsLoudness, hasBeatsLoudnessBandRatio, beats.size());
+
+  return poolStats;
+}
+
+
+map<string, vector<string> > MusicExtractor::statsExceptions(const vector<string>& descNames) {
   map<string, vector<string> > exceptions;
-  const vector<string>& descNames = pool.descriptorNames();
   for (int i=0; i<(int)descNames.size(); i++) {
     if (descNames[i].find("lowlevel.mfcc") != string::npos) {
       exceptions[descNames[i]] = options.value<vector<string> >("lowlevel.mfccStats");
@@ -309,28 +569,24 @@ Pool MusicExtractor::computeAggregation(Pool& pool){
       continue;
     }
   }
+  return exceptions;
+}
 
-  standard::Algorithm* aggregator = standard::AlgorithmFactory::create("PoolAggregator",
-                                                                       "defaultStats", arrayToVector<string>(defaultStats),
-                                                                       "exceptions", exceptions);
-  Pool poolStats;
-  aggregator->input("input").set(pool);
-  aggregator->output("output").set(poolStats);
-
-  aggregator->compute();
 
+void MusicExtractor::addMissingStats(Pool& poolStats, bool hasBeatsLoudness,
+                                     bool hasBeatsLoudnessBandRatio, int beatsCount) {
 
   // add descriptors that may be missing due to content
   const Real emptyVector[] = { 0, 0, 0, 0, 0, 0};
 
   int statsSize = int(sizeof(defaultStats)/sizeof(defaultStats[0]));
 
-  if (!pool.contains<vector<Real> >("rhythm.beats_loudness")) {
+  if (!hasBeatsLoudness) {
     for (int i=0; i<statsSize; i++)
         poolStats.set(string("rhythm.beats_loudness.")+defaultStats[i], 0);
   }
 
-  if (!pool.contains<vector<vector<Real> > >("rhythm.beats_loudness_band_ratio")) {
+  if (!hasBeatsLoudnessBandRatio) {
     for (int i=0; i<statsSize; i++)
       poolStats.set(string("rhythm.beats_loudness_band_ratio.")+defaultStats[i], arrayToVector<Real>(emptyVector));
   }
@@ -353,12 +609,9 @@ Pool MusicExtractor::computeAggregation(Pool& pool){
   // variable descriptor length counts:
 
   // poolStats.set(string("rhythm.onset_count"), pool.value<vector<Real> >("rhythm.onset_times").size());
-  poolStats.set(string("rhythm.beats_count"), pool.value<vector<Real> >("rhythm.beats_position").size());
+  poolStats.set(string("rhythm.beats_count"), beatsCount);
   //poolStats.set(string("tonal.chords_count"), pool.value<vector<string> >("tonal.chords_progression").size());
 
-  delete aggregator;
-
-  return poolStats;
 }
 
 
@@ -573,6 +826,35 @@ void MusicExtractor::computeReplayGain(const string& audioFilename, Pool& result
 }
 
 
+void MusicExtractor::setCacheGroupOptions(ExtractorCache& cache) {
+  // all the descriptors are computed on the audio trimmed, resampled, and
+  // normalized by replay gain according to the general options. Statistics
+  // options are not included as the aggregation is never cached.
+  const char* audioOptions[] = { "analysisSampleRate", "startTime", "endTime" };
+  const char* lowlevelOptions[] = { "lowlevel.frameSize", "lowlevel.hopSize",
+                                    "lowlevel.zeroPadding", "lowlevel.windowType",
+                                    "lowlevel.silentFrames",
+                                    "average_loudness.frameSize", "average_loudness.hopSize",
+                                    "average_loudness.windowType", "average_loudness.silentFrames" };
+  const char* rhythmOptions[] = { "rhythm.method", "rhythm.minTempo", "rhythm.maxTempo" };
+  const char* tonalOptions[] = { "tonal.frameSize", "tonal.hopSize", "tonal.zeroPadding",
+                                 "tonal.windowType", "tonal.silentFrames" };
+
+  vector<string> audio = arrayToVector<string>(audioOptions);
+  vector<string> lowlevel = audio;
+  vector<string> rhythm = audio;
+  vector<string> tonal = audio;
+  lowlevel.insert(lowlevel.end(), lowlevelOptions, lowlevelOptions + ARRAY_SIZE(lowlevelOptions));
+  rhythm.insert(rhythm.end(), rhythmOptions, rhythmOptions + ARRAY_SIZE(rhythmOptions));
+  tonal.insert(tonal.end(), tonalOptions, tonalOptions + ARRAY_SIZE(tonalOptions));
+
+  cache.setGroupOptions("audio", options, audio);
+  cache.setGroupOptions("lowlevel", options, lowlevel);
+  cache.setGroupOptions("rhythm", options, rhythm);
+  cache.setGroupOptions("tonal", options, tonal);
+}
+
+
 void MusicExtractor::setExtractorOptions(const std::string& filename) {
 
   if (filename.empty()) return;
@@ -27,6 +27,7 @@
 #include "extractor_music/MusicRhythmDescriptors.h"
 #include "extractor_music/MusicTonalDescriptors.h"
 #include "extractor_music/extractor_version.h"
+#include "extractorcache.h"
 
 namespace essentia {
 namespace standard {
@@ -41,6 +42,10 @@ class MusicExtractor : public Algorithm {
   Real startTime;
   Real endTime;
   bool requireMbid;
+  std::string cacheDirectory;
+  Real memoryBudget;
+  Real chunkSize;
+  Real chunkOverlap;
 
   int lowlevelFrameSize;
   int lowlevelHopSize;
@@ -83,8 +88,18 @@ class MusicExtractor : public Algorithm {
   void readMetadata(const std::string& audioFilename, Pool& results);
   void computeAudioMetadata(const std::string& audioFilename, Pool& results);
   void computeReplayGain(const std::string& audioFilename, Pool& results);
+  void setCacheGroupOptions(ExtractorCache& cache);
+  streaming::Algorithm* createLoader(const std::string& audioFilename, Real start, Real end,
+                                     const std::vector<Real>* audio=0);
+  void computeFeatures(const std::string& audioFilename, Real start, Real end,
+                       bool computeLowlevel, bool computeRhythm, bool computeTonal,
+                       Pool& lowlevelResults, Pool& rhythmResults, Pool& tonalResults,
+                       const std::vector<Real>* audio=0);
 
   Pool computeAggregation(Pool& pool);
+  Pool computeChunkedAggregation(const std::string& audioFilename, Pool& results);
+  std::map<std::string, std::vector<std::string> > statsExceptions(const std::vector<std::string>& descNames);
+  void addMissingStats(Pool& poolStats, bool hasBeatsLoudness, bool hasBeatsLoudnessBandRatio, int beatsCount);
 
  public:
 
@@ -100,6 +115,10 @@ class MusicExtractor : public Algorithm {
     declareParameter("requireMbid", "ignore audio files without musicbrainz recording id tag (throw exception)", "{true,false}", false);
     // requireMbid option is very specific for AcousticBrainz extractor
     // however, we'll keep it here for now...
+    declareParameter("cacheDirectory", "directory where to cache the results of each group of descriptors, keyed by the MD5 of the audio stream, the extractor version and the options they depend on. Cached results are reused instead of being recomputed. Caching is disabled if empty", "", "");
+    declareParameter("memoryBudget", "the maximum memory that each processing network may use [MB], as estimated by its memory accounting. The analysis fails with an exception as soon as it is exceeded, instead of being killed when running out of memory. No limit if 0", "[0,inf)", 0.0);
+    declareParameter("chunkSize", "the duration of the chunks in which to analyze the audio [s], so that the memory used does not depend on the duration of the file, rounded to a multiple of the lowlevel and tonal hop sizes. The statistics of the chunks are merged, some of them being approximated (see ChunkedPoolAggregator), and differ slightly from the ones of the whole audio. The whole audio is analyzed at once if 0", "[0,inf)", 0.0);
+    declareParameter("chunkOverlap", "the duration of audio before each chunk that is also analyzed, only to give context to the descriptors of the chunk [s], rounded to a multiple of the lowlevel and tonal hop sizes", "[0,inf)", 10.0);
   
     declareParameter("lowlevelFrameSize", "the frame size for computing low-level features", "(0,inf)", 2048);
     declareParameter("lowlevelHopSize", "the hop size for computing low-level features", "(0,inf)", 1024);
@@ -31,7 +31,7 @@ const char* IIR::description = DOC("This algorithm implements a standard IIR fil
 "The filter is a Direct Form II Transposed implementation of the standard difference equation:\n"
 "  a(0)*y(n) = b(0)*x(n) + b(1)*x(n-1) + ... + b(nb-1)*x(n-nb+1) - a(1)*y(n-1) - ... - a(nb-1)*y(n-na+1)\n"
 "\n"
-"This algorithm maintains a state which is the state of the delays. One should call the reset() method to reinitialize the state to all zeros.\n"
+"This algorithm maintains a state which is the state of the delays. One should call the reset() method to reinitialize the state to all zeros. The coefficients and the state are kept in double precision, unless Essentia was built with the float-only profile.\n"
 "\n"
 "An exception is thrown if the \"numerator\" or \"denominator\" parameters are empty. An exception is also thrown if the first coefficient of the \"denominator\" parameter is 0.\n"
 "\n"
@@ -48,8 +48,10 @@ void IIR::reset() {
 }
 
 void IIR::configure() {
-  _a = parameter("denominator").toVectorReal();
-  _b = parameter("numerator").toVectorReal();
+  vector<Real> a = parameter("denominator").toVectorReal();
+  vector<Real> b = parameter("numerator").toVectorReal();
+  _a.assign(a.begin(), a.end());
+  _b.assign(b.begin(), b.end());
 
   if (_b.empty()) {
     throw EssentiaException("IIR: the numerator vector is empty");
@@ -83,16 +85,16 @@ void IIR::configure() {
 // adding a constant epsilon to the values in the state line is a tad
 // faster (~6%), but I (nwack) like this method better as it is more
 // correct, and if fed with 0, will return 0 as well (not epsilon)
-inline void renormalize(Real& x) {
+inline void renormalize(PreciseReal& x) {
   if (isDenormal(x)) {
-    x = Real(0.0);
+    x = PreciseReal(0.0);
   }
 }
 
 
-inline void updateStateLine(vector<Real>& state, int size,
-                            const vector<Real>& a, const vector<Real>& b,
-                            const Real& x, const Real& y) {
+inline void updateStateLine(vector<PreciseReal>& state, int size,
+                            const vector<PreciseReal>& a, const vector<PreciseReal>& b,
+                            const PreciseReal& x, const PreciseReal& y) {
   for (int k=1; k<size; ++k) {
     state[k-1] = (b[k]*x - a[k]*y) + state[k];
     renormalize(state[k-1]);
@@ -100,9 +102,9 @@ inline void updateStateLine(vector<Real>& state, int size,
 }
 
 template <int n>
-void updateStateLineUnrolled(vector<Real>& state,
-                            const vector<Real>& a, const vector<Real>& b,
-                            const Real& x, Real& y) {
+void updateStateLineUnrolled(vector<PreciseReal>& state,
+                            const vector<PreciseReal>& a, const vector<PreciseReal>& b,
+                            const PreciseReal& x, const PreciseReal& y) {
   for (int k=1; k<n; ++k) {
     state[k-1] = b[k]*x - a[k]*y + state[k];
   }
@@ -116,11 +118,13 @@ void updateStateLineUnrolled(vector<Real>& state,
 
 template <int filterSize>
 void filterABEqualSize(const vector<Real>& x, vector<Real>& y,
-                       const vector<Real>& a, const vector<Real>& b,
-                       vector<Real>& state) {
+                       const vector<PreciseReal>& a, const vector<PreciseReal>& b,
+                       vector<PreciseReal>& state) {
   for (int n=0; n < int(y.size()); ++n) {
-    y[n] = b[0]*x[n] + state[0];
-    updateStateLineUnrolled<filterSize>(state, a, b, x[n], y[n]);
+    // the feedback uses the output before it is rounded to Real
+    PreciseReal yn = b[0]*x[n] + state[0];
+    y[n] = yn;
+    updateStateLineUnrolled<filterSize>(state, a, b, x[n], yn);
   }
 }
 
@@ -154,16 +158,18 @@ void IIR::compute() {
 
     default:
       for (int n=0; n < int(y.size()); ++n) {
-        y[n] = _b[0]*x[n] + _state[0];
-        updateStateLine(_state, _state.size(), _a, _b, x[n], y[n]);
+        PreciseReal yn = _b[0]*x[n] + _state[0];
+        y[n] = yn;
+        updateStateLine(_state, _state.size(), _a, _b, x[n], yn);
       }
     }
   }
 
   else if (_b.size() > _a.size()) {
     for (int n=0; n < int(y.size()); ++n) {
-      y[n] = _b[0]*x[n]  + _state[0];
-      updateStateLine(_state, _a.size(), _a, _b, x[n], y[n]);
+      PreciseReal yn = _b[0]*x[n]  + _state[0];
+      y[n] = yn;
+      updateStateLine(_state, _a.size(), _a, _b, x[n], yn);
 
       for (int k=_a.size(); k < int(_state.size()); ++k) {
         _state[k-1] = _b[k]*x[n]  + _state[k];
@@ -174,11 +180,12 @@ void IIR::compute() {
 
   else { //if (a.size() > b.size()) {
     for (int n=0; n < int(y.size()); ++n) {
-      y[n] = _b[0]*x[n]  + _state[0];
-      updateStateLine(_state, _b.size(), _a, _b, x[n], y[n]);
+      PreciseReal yn = _b[0]*x[n]  + _state[0];
+      y[n] = yn;
+      updateStateLine(_state, _b.size(), _a, _b, x[n], yn);
 
       for (int k=_b.size(); k < int(_state.size()); ++k) {
-        _state[k-1] = (-_a[k]*y[n])  + _state[k];
+        _state[k-1] = (-_a[k]*yn)  + _state[k];
         renormalize(_state[k-1]);
       }
     }
@@ -32,9 +32,11 @@ class IIR : public Algorithm {
   Input<std::vector<Real> > _x;
   Output<std::vector<Real> > _y;
 
-  std::vector<Real> _a;
-  std::vector<Real> _b;
-  std::vector<Real> _state;
+  // coefficients and state are kept in higher precision, as rounding errors
+  // in the feedback loop accumulate over time
+  std::vector<PreciseReal> _a;
+  std::vector<PreciseReal> _b;
+  std::vector<PreciseReal> _state;
 
  public:
   IIR() {
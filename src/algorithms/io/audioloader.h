@@ -22,12 +22,10 @@
 
 #include "streamingalgorithm.h"
 #include "network.h"
-#include "ffmpegapi.h"
+#include "audiodecoder.h"
 #include "poolstorage.h"
 
 
-#define MAX_AUDIO_FRAME_SIZE 192000
-
 namespace essentia {
 namespace streaming {
 
@@ -41,49 +39,19 @@ class AudioLoader : public Algorithm {
   AbsoluteSource<std::string> _codec;
 
   int _nChannels;
-
-  // MAX_AUDIO_FRAME_SIZE is in bytes, multiply it by 2 to get some margin, 
-  // because we might want to decode multiple frames in this buffer (all the 
-  // frames contained in a packet, which can be more than 1 as in flac), and 
-  // each time we decode a frame we need to have at least a full buffer of free space.
-  const static int FFMPEG_BUFFER_SIZE = MAX_AUDIO_FRAME_SIZE * 2;
-
-  float* _buffer;
-  int _dataSize;
-
-  AVFormatContext* _demuxCtx;
-  AVCodecContext* _audioCtx;
-  AVCodec* _audioCodec;
-  AVPacket _packet;
-  AVMD5 *_md5Encoded;
-  uint8_t _checksum[16];
   bool _computeMD5;
-  AVFrame* _decodedFrame;
-
-  struct AVAudioResampleContext* _convertCtxAv;
-
-  int _streamIdx; // index of the audio stream among all the streams contained in the file
-  std::vector<int> _streams;
   int _selectedStream;
-  bool _configured;
-
 
-  void openAudioFile(const std::string& filename);
-  void closeAudioFile();
+  AudioDecoder _decoder;
 
   void pushChannelsSampleRateInfo(int nChannels, Real sampleRate);
   void pushCodecInfo(std::string codec, int bit_rate);
-  int decode_audio_frame(AVCodecContext* audioCtx, float* output,
-                         int* outputSize, AVPacket* packet);
-  int decodePacket();
-  void flushPacket();
   void copyFFmpegOutput();
 
 
  public:
-  AudioLoader() : Algorithm(), _buffer(0),  _demuxCtx(0),
-	          _audioCtx(0), _audioCodec(0), _decodedFrame(0),
-            _convertCtxAv(0), _configured(false) {
+  AudioLoader() : Algorithm(), _nChannels(0), _computeMD5(false),
+                  _selectedStream(0), _decoder("AudioLoader") {
 
     declareOutput(_audio, 1, "audio", "the input audio signal");
     declareOutput(_sampleRate, 0, "sampleRate", "the sampling rate of the audio signal [Hz]");
@@ -93,21 +61,8 @@ class AudioLoader : public Algorithm {
     declareOutput(_codec, 0, "codec", "the codec that is used to decode the input audio");
 
     _audio.setBufferType(BufferUsage::forLargeAudioStream);
-
-    // Register all formats and codecs
-    av_register_all();
-
-    // use av_malloc, because we _need_ the buffer to be 16-byte aligned
-    _buffer = (float*)av_malloc(FFMPEG_BUFFER_SIZE);
-
-    _md5Encoded = av_md5_alloc();
-    if (!_md5Encoded) {
-        throw EssentiaException("Error allocating the MD5 context");
-    }
   }
 
-  ~AudioLoader();
-
   AlgorithmStatus process();
   void reset();
 
@@ -29,7 +29,10 @@ using namespace std;
   if (sameType(sourceType, typeid(type))) {                          \
     fs = new FileOutput<type>();                                     \
     fs->configure("filename", proxy.parameter("filename").toString(),\
-                  "mode", proxy.parameter("mode").toString());       \
+                  "mode", proxy.parameter("mode").toString(),        \
+                  "sampleRate", proxy.parameter("sampleRate"),       \
+                  "hopSize", proxy.parameter("hopSize"),             \
+                  "directIO", proxy.parameter("directIO"));          \
   }
 
 namespace essentia {
@@ -37,7 +40,7 @@ namespace streaming {
 
 const char* FileOutputProxy::name = "FileOutput";
 const char* FileOutputProxy::category = "Input/output";
-const char* FileOutputProxy::description = DOC("Stores alphanumeric data into text or binary files");
+const char* FileOutputProxy::description = DOC("Stores alphanumeric data into text or binary files. In frames mode, ints, Reals, complex numbers and vectors of Reals or complex numbers of constant size (e.g. the frames of a spectrogram) are written as the frames of a binary feature file, with a header giving their type, size, sample rate and hop size. The frames are written in big buffered writes, optionally with direct I/O, and the file can be read back with FeatureFileReader, which memory maps it.");
 
 void connect(SourceBase& source, FileOutputProxy& file) {
   const type_info& sourceType = source.typeInfo();
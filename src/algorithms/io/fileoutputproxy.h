@@ -41,7 +41,10 @@ class FileOutputProxy : public Algorithm {
 
   void declareParameters() {
     declareParameter("filename", "the name of the output file (use '-' for stdout)", "", "out.txt");
-    declareParameter("mode", "output mode", "{text,binary}", "text");
+    declareParameter("mode", "output mode: text, raw binary values, or binary frames with a header, to be read with FeatureFileReader", "{text,binary,frames}", "text");
+    declareParameter("sampleRate", "the sample rate of the frames, stored in the header in frames mode (0 if unknown)", "[0,inf)", 0.);
+    declareParameter("hopSize", "the hop size of the frames, stored in the header in frames mode (0 if unknown)", "[0,inf)", 0);
+    declareParameter("directIO", "in frames mode, whether to write the file with direct I/O, bypassing the system cache, if supported", "{true,false}", false);
   }
 
   AlgorithmStatus process() {
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "multichannelaudioloader.h"
+#include "algorithmfactory.h"
+
+using namespace std;
+
+namespace essentia {
+namespace streaming {
+
+const char* MultiChannelAudioLoader::name = essentia::standard::MultiChannelAudioLoader::name;
+const char* MultiChannelAudioLoader::category = essentia::standard::MultiChannelAudioLoader::category;
+const char* MultiChannelAudioLoader::description = essentia::standard::MultiChannelAudioLoader::description;
+
+
+void MultiChannelAudioLoader::configure() {
+    av_log_set_level(AV_LOG_QUIET);
+    _computeMD5 = parameter("computeMD5").toBool();
+    _selectedStream = parameter("audioStream").toInt();
+    reset();
+}
+
+
+void MultiChannelAudioLoader::pushChannelsSampleRateInfo(int nChannels, Real sampleRate) {
+    if (sampleRate <= 0) {
+        throw EssentiaException("MultiChannelAudioLoader: could not load audio. Audio sampling rate must be greater than 0.");
+    }
+
+    _nChannels = nChannels;
+
+    _channels.push(nChannels);
+    _sampleRate.push(sampleRate);
+}
+
+
+void MultiChannelAudioLoader::pushCodecInfo(std::string codec, int bit_rate) {
+    _codec.push(codec);
+    _bit_rate.push(bit_rate);
+}
+
+
+AlgorithmStatus MultiChannelAudioLoader::process() {
+    if (!parameter("filename").isConfigured()) {
+        throw EssentiaException("MultiChannelAudioLoader: Trying to call process() on a MultiChannelAudioLoader algo which hasn't been correctly configured.");
+    }
+
+    if (!_decoder.readPacket()) {
+        shouldStop(true);
+        // output the frames still buffered in the decoder
+        while (_decoder.flushFrame()) copyFFmpegOutput();
+        _md5.push(_decoder.md5());
+        _decoder.close();
+        return FINISHED;
+    }
+
+    // decode all the frames in the packet
+    while (_decoder.decodeFrame()) copyFFmpegOutput();
+
+    return OK;
+}
+
+
+/**
+ * Copies the last decoded frame into a new planar block token. Each channel
+ * is copied as a whole plane: there is no interleaving or deinterleaving of
+ * the samples, whatever the number of channels.
+ */
+void MultiChannelAudioLoader::copyFFmpegOutput() {
+    int nsamples = _decoder.samples();
+    if (nsamples == 0) return;
+
+    // the output format is always AV_SAMPLE_FMT_FLTP, which is planar
+    const float* const* planes = _decoder.data();
+
+    if (!_audio.acquire(1)) {
+        throw EssentiaException("MultiChannelAudioLoader: could not acquire output for audio");
+    }
+
+    vector<vector<Real> >& block = *((vector<vector<Real> >*)_audio.getFirstToken());
+    block.resize(_nChannels);
+    for (int c=0; c<_nChannels; ++c) {
+        block[c].assign(planes[c], planes[c] + nsamples);
+    }
+
+    _audio.release(1);
+}
+
+void MultiChannelAudioLoader::reset() {
+    Algorithm::reset();
+
+    if (!parameter("filename").isConfigured()) return;
+
+    string filename = parameter("filename").toString();
+
+    _decoder.open(filename, _selectedStream, AV_SAMPLE_FMT_FLTP, _computeMD5);
+
+    pushChannelsSampleRateInfo(_decoder.channels(), _decoder.sampleRate());
+    pushCodecInfo(_decoder.codec(), _decoder.bitRate());
+}
+
+} // namespace streaming
+} // namespace essentia
+
+
+namespace essentia {
+namespace standard {
+
+const char* MultiChannelAudioLoader::name = "MultiChannelAudioLoader";
+const char* MultiChannelAudioLoader::category = "Input/output";
+const char* MultiChannelAudioLoader::description = DOC("This algorithm loads the single audio stream contained in a given audio or video file, keeping all of its channels. Supported formats are all those supported by the FFmpeg library including wav, aiff, flac, ogg and mp3.\n"
+"\n"
+"Contrary to AudioLoader, which is limited to mono and stereo files, any number of channels is supported (e.g. 5.1 and 7.1 files). The audio is output in planar form (channels x samples), with the channel order of the file. In streaming mode, each output token is a planar block holding one decoded frame; this can be fed directly to MultiChannelMixer or MultiChannelDemuxer.\n"
+"\n"
+"This algorithm will throw an exception if it was not properly configured which is normally due to not specifying a valid filename. If using this algorithm on Windows, you must ensure that the filename is encoded as UTF-8\n");
+
+
+void MultiChannelAudioLoader::createInnerNetwork() {
+    _loader = streaming::AlgorithmFactory::create("MultiChannelAudioLoader");
+    _audioStorage = new streaming::VectorOutput<vector<vector<Real> > >();
+
+    _loader->output("audio")           >>  _audioStorage->input("data");
+    _loader->output("sampleRate")      >>  PC(_pool, "internal.sampleRate");
+    _loader->output("numberChannels")  >>  PC(_pool, "internal.numberChannels");
+    _loader->output("md5")             >>  PC(_pool, "internal.md5");
+    _loader->output("codec")           >>  PC(_pool, "internal.codec");
+    _loader->output("bit_rate")        >>  PC(_pool, "internal.bit_rate");
+    _network = new scheduler::Network(_loader);
+}
+
+void MultiChannelAudioLoader::configure() {
+    _loader->configure(INHERIT("filename"),
+                       INHERIT("computeMD5"),
+                       INHERIT("audioStream"));
+}
+
+void MultiChannelAudioLoader::compute() {
+    if (!parameter("filename").isConfigured()) {
+        throw EssentiaException("MultiChannelAudioLoader: Trying to call compute() on a "
+                                "MultiChannelAudioLoader algo which hasn't been correctly configured.");
+    }
+
+    Real& sampleRate = _sampleRate.get();
+    int& numberChannels = _channels.get();
+    string& md5 = _md5.get();
+    int& bit_rate = _bit_rate.get();
+    string& codec = _codec.get();
+    vector<vector<Real> >& audio = _audio.get();
+
+    _blocks.clear();
+    _audioStorage->setVector(&_blocks);
+
+    _network->run();
+
+    sampleRate = _pool.value<Real>("internal.sampleRate");
+    numberChannels = (int) _pool.value<Real>("internal.numberChannels");
+    md5 = _pool.value<std::string>("internal.md5");
+    bit_rate = (int) _pool.value<Real>("internal.bit_rate");
+    codec = _pool.value<std::string>("internal.codec");
+
+    // concatenate the decoded blocks, channel by channel
+    size_t nsamples = 0;
+    for (size_t i=0; i<_blocks.size(); ++i) {
+        if (!_blocks[i].empty()) nsamples += _blocks[i][0].size();
+    }
+
+    audio.resize(numberChannels);
+    for (int c=0; c<numberChannels; ++c) {
+        audio[c].clear();
+        audio[c].reserve(nsamples);
+        for (size_t i=0; i<_blocks.size(); ++i) {
+            audio[c].insert(audio[c].end(), _blocks[i][c].begin(), _blocks[i][c].end());
+        }
+    }
+    _blocks.clear();
+
+    // reset, so it is ready to load audio again
+    reset();
+}
+
+void MultiChannelAudioLoader::reset() {
+    _network->reset();
+    _pool.remove("internal.md5");
+    _pool.remove("internal.sampleRate");
+    _pool.remove("internal.numberChannels");
+    _pool.remove("internal.codec");
+    _pool.remove("internal.bit_rate");
+}
+
+} // namespace standard
+} // namespace essentia
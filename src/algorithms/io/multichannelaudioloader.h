@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_STREAMING_MULTICHANNELAUDIOLOADER_H
+#define ESSENTIA_STREAMING_MULTICHANNELAUDIOLOADER_H
+
+#include "streamingalgorithm.h"
+#include "network.h"
+#include "audiodecoder.h"
+#include "poolstorage.h"
+
+
+namespace essentia {
+namespace streaming {
+
+class MultiChannelAudioLoader : public Algorithm {
+ protected:
+  // each token is a planar block of audio (channels x samples) holding one
+  // decoded frame
+  Source<std::vector<std::vector<Real> > > _audio;
+  AbsoluteSource<Real> _sampleRate;
+  AbsoluteSource<int> _channels;
+  AbsoluteSource<std::string> _md5;
+  AbsoluteSource<int> _bit_rate;
+  AbsoluteSource<std::string> _codec;
+
+  int _nChannels;
+  bool _computeMD5;
+  int _selectedStream;
+
+  AudioDecoder _decoder;
+
+  void pushChannelsSampleRateInfo(int nChannels, Real sampleRate);
+  void pushCodecInfo(std::string codec, int bit_rate);
+  void copyFFmpegOutput();
+
+
+ public:
+  MultiChannelAudioLoader() : Algorithm(), _nChannels(0), _computeMD5(false),
+                              _selectedStream(0), _decoder("MultiChannelAudioLoader") {
+
+    declareOutput(_audio, 1, "audio", "the input audio signal, as planar blocks of samples (channels x samples)");
+    declareOutput(_sampleRate, 0, "sampleRate", "the sampling rate of the audio signal [Hz]");
+    declareOutput(_channels, 0, "numberChannels", "the number of channels");
+    declareOutput(_md5, 0, "md5", "the MD5 checksum of raw undecoded audio payload");
+    declareOutput(_bit_rate, 0, "bit_rate", "the bit rate of the input audio, as reported by the decoder codec");
+    declareOutput(_codec, 0, "codec", "the codec that is used to decode the input audio");
+
+    _audio.setBufferType(BufferUsage::forMultipleFrames);
+  }
+
+  AlgorithmStatus process();
+  void reset();
+
+  void declareParameters() {
+    declareParameter("filename", "the name of the file from which to read", "", Parameter::STRING);
+    declareParameter("computeMD5", "compute the MD5 checksum", "{true,false}", false);
+    declareParameter("audioStream", "audio stream index to be loaded. Other streams are not taken into account (e.g. if stream 0 is video and 1 is audio use index 0 to access it.)", "[0,inf)", 0);
+  }
+
+  void configure();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace streaming
+} // namespace essentia
+
+
+#include "vectoroutput.h"
+#include "algorithm.h"
+
+namespace essentia {
+namespace standard {
+
+// Standard non-streaming algorithm comes after the streaming one as it
+// depends on it
+class MultiChannelAudioLoader : public Algorithm {
+
+ protected:
+  Output<std::vector<std::vector<Real> > > _audio;
+  Output<Real> _sampleRate;
+  Output<int> _channels;
+  Output<std::string> _md5;
+  Output<int> _bit_rate;
+  Output<std::string> _codec;
+
+  streaming::Algorithm* _loader;
+  streaming::VectorOutput<std::vector<std::vector<Real> > >* _audioStorage;
+  std::vector<std::vector<std::vector<Real> > > _blocks;
+
+  scheduler::Network* _network;
+  Pool _pool;
+
+  void createInnerNetwork();
+
+ public:
+  MultiChannelAudioLoader() {
+    declareOutput(_audio, "audio", "the input audio signal (channels x samples)");
+    declareOutput(_sampleRate, "sampleRate", "the sampling rate of the audio signal [Hz]");
+    declareOutput(_channels, "numberChannels", "the number of channels");
+    declareOutput(_md5, "md5", "the MD5 checksum of raw undecoded audio payload");
+    declareOutput(_bit_rate, "bit_rate", "the bit rate of the input audio, as reported by the decoder codec");
+    declareOutput(_codec, "codec", "the codec that is used to decode the input audio");
+
+    createInnerNetwork();
+  }
+
+  ~MultiChannelAudioLoader() {
+    // NB: this will also delete all the algorithms as the Network took ownership of them
+    delete _network;
+  }
+
+  void declareParameters() {
+    declareParameter("filename", "the name of the file from which to read", "", Parameter::STRING);
+    declareParameter("computeMD5", "compute the MD5 checksum", "{true,false}", false);
+    declareParameter("audioStream", "audio stream index to be loaded. Other streams are not taken into account (e.g. if stream 0 is video and 1 is audio use index 0 to access it.)", "[0,inf)", 0);
+  }
+
+  void configure();
+
+  void compute();
+  void reset();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+} // namespace standard
+} // namespace essentia
+
+#endif // ESSENTIA_STREAMING_MULTICHANNELAUDIOLOADER_H
@@ -20,6 +20,7 @@
 #include "yamlinput.h"
 #include "yamlast.h"
 #include "jsonconvert.h"
+#include "pooljson.h"
 #include <fstream>
 
 using namespace std;
@@ -30,7 +31,9 @@ const char* YamlInput::name = "YamlInput";
 const char* YamlInput::category = "Input/output";
 const char* YamlInput::description = DOC("This algorithm deserializes a file formatted in YAML to a Pool. This file can be serialized back into a YAML file using the YamlOutput algorithm. See the documentation for YamlOutput for more information on the specification of the YAML file.\n"
 "\n"
-"Note: If an empty sequence is encountered (i.e. \"[]\"), this algorithm will assume it was intended to be a sequence of Reals and will add it to the output pool accordingly. This only applies to sequences which contain empty sequences. Empty sequences (which are not subsequences) are not possible in a Pool and therefore will be ignored if encountered (i.e. foo: [] (ignored), but foo: [[]] (added as a vector of one empty vector of reals).");
+"Note: If an empty sequence is encountered (i.e. \"[]\"), this algorithm will assume it was intended to be a sequence of Reals and will add it to the output pool accordingly. This only applies to sequences which contain empty sequences. Empty sequences (which are not subsequences) are not possible in a Pool and therefore will be ignored if encountered (i.e. foo: [] (ignored), but foo: [[]] (added as a vector of one empty vector of reals).\n"
+"\n"
+"With format=json, the file is parsed directly into the pool in a single pass. Files that cannot be read this way are converted to YAML and parsed as such.");
 
 // takes an AST that's created by src/utils/essentiayaml and dumps it into a pool
 void updatePool (const YamlNode* n, Pool* p, const string& keyPrefix);
@@ -107,6 +110,21 @@ void YamlInput::compute() {
         throw EssentiaException("YamlInput: error reading the json file");
       }
       
+      // JSON written by YamlOutput is read directly into the pool, the
+      // conversion to YAML only being needed for documents the direct reader
+      // does not support
+      try {
+        readPoolJson(jsonChar, filesize, p);
+        delete[] jsonChar;
+        if (fclose(file) != 0) {
+          E_WARNING("YamlInput: an error occured while closing the json file");
+        }
+        return;
+      }
+      catch (JsonParseException& e) {
+        E_DEBUG(EAlgorithm, "YamlInput: " << e.what() << ", reading the file as YAML");
+      }
+
       string yamlString = JsonConvert(string(jsonChar, filesize)).parseDict();
       yamlString = unescapeJsonString(yamlString);
       delete[] jsonChar;
@@ -18,6 +18,7 @@
  */
 
 #include "beattrackermultifeature.h"
+#include "onsetdetectionglobal.h"
 #include "poolstorage.h"
 #include "algorithmfactory.h"
 
@@ -34,8 +35,8 @@ const char* BeatTrackerMultiFeature::description = essentia::standard::BeatTrack
 BeatTrackerMultiFeature::BeatTrackerMultiFeature() : AlgorithmComposite(),
     _frameCutter1(0), _windowing1(0), _fft1(0), _cart2polar1(0), _onsetRms1(0),
     _onsetComplex1(0), _ticksRms1(0), _ticksComplex1(0), _onsetMelFlux1(0),
-    _ticksMelFlux1(0), _onsetBeatEmphasis3(0), _ticksBeatEmphasis3(0),
-    _onsetInfogain4(0), _ticksInfogain4(0), _scale(0), _configured(false) {
+    _ticksMelFlux1(0), _signalStorage3(0), _onsetGlobal3(0),
+    _ticksBeatEmphasis3(0), _ticksInfogain3(0), _scale(0), _configured(false) {
 
   declareInput(_signal, 1024, "signal", "input signal");
   declareOutput(_ticks, 0, "ticks", "the estimated tick locations [s]");
@@ -61,11 +62,10 @@ void BeatTrackerMultiFeature::createInnerNetwork() {
   _ticksComplex1        = factory.create("TempoTapDegara");
   _ticksMelFlux1        = factory.create("TempoTapDegara");
 
-  _onsetBeatEmphasis3   = factory.create("OnsetDetectionGlobal");
-  _ticksBeatEmphasis3   = factory.create("TempoTapDegara");
-
-  _onsetInfogain4       = factory.create("OnsetDetectionGlobal");
-  _ticksInfogain4       = factory.create("TempoTapDegara");
+  _signalStorage3       = new PoolStorage<Real>(&_pool, "internal.signal");
+  _onsetGlobal3         = standard::AlgorithmFactory::create("OnsetDetectionGlobal");
+  _ticksBeatEmphasis3   = standard::AlgorithmFactory::create("TempoTapDegara");
+  _ticksInfogain3       = standard::AlgorithmFactory::create("TempoTapDegara");
 
   _tempoTapMaxAgreement = standard::AlgorithmFactory::create("TempoTapMaxAgreement");
 
@@ -95,15 +95,8 @@ void BeatTrackerMultiFeature::createInnerNetwork() {
   _onsetMelFlux1->output("onsetDetection")   >>   _ticksMelFlux1->input("onsetDetections");
   _ticksMelFlux1->output("ticks")            >>   PC(_pool, "internal.ticksMelFlux");
 
-  //_signal                                           >>   _onsetBeatEmphasis3->input("signal");
-  _scale->output("signal")                         >>  _onsetBeatEmphasis3->input("signal");
-  _onsetBeatEmphasis3->output("onsetDetections")   >>  _ticksBeatEmphasis3->input("onsetDetections");
-  _ticksBeatEmphasis3->output("ticks")             >>  PC(_pool, "internal.ticksBeatEmphasis");
-
-  //_signal                                           >> _onsetInfogain4->input("signal");
-  _scale->output("signal")  >> _onsetInfogain4->input("signal");
-  _onsetInfogain4->output("onsetDetections")        >> _ticksInfogain4->input("onsetDetections");
-  _ticksInfogain4->output("ticks")                  >> PC(_pool, "internal.ticksInfogain");
+  // beat emphasis and infogain detection functions are computed in process()
+  _scale->output("signal")                   >>   _signalStorage3->input("data");
 
   _network = new scheduler::Network(_scale);
 }
@@ -112,6 +105,9 @@ void BeatTrackerMultiFeature::clearAlgos() {
   if (!_configured) return;
 
   delete _network;
+  delete _onsetGlobal3;
+  delete _ticksBeatEmphasis3;
+  delete _ticksInfogain3;
   delete _tempoTapMaxAgreement;
 }
 
@@ -177,23 +173,18 @@ void BeatTrackerMultiFeature::configure() {
   // NB: better than 2048/1024 plus x2 resampling according to evaluation (JZapata)
   // 2048/512 works better than 1024/512 for 'beat_emphasis' OSD according to
   // evaluation results (DBogdanov)
-  _onsetBeatEmphasis3->configure("method", "beat_emphasis",
-                                  "sampleRate", _sampleRate,
-                                  "frameSize", frameSize3,
-                                  "hopSize", hopSize3);
-  _ticksBeatEmphasis3->configure("sampleRateODF", _sampleRate/hopSize3,
-                                  "resample", "none",
-                                  "minTempo", minTempo,
-                                  "maxTempo", maxTempo);
-
-  int frameSize4 = 2048;
-  int hopSize4 = 512;
   // NB: 2048/512 performs better than 1024/512 accoding to evaluation (JZapata)
-  _onsetInfogain4->configure("method", "infogain",
-                             "sampleRate", _sampleRate,
-                             "frameSize", frameSize4,
-                             "hopSize", hopSize4);
-  _ticksInfogain4->configure("sampleRateODF", _sampleRate/hopSize4,
+  // The 'infogain' OSD uses the same frame and hop sizes, so both detection
+  // functions share the same frames.
+  _onsetGlobal3->configure("method", "beat_emphasis",
+                           "sampleRate", _sampleRate,
+                           "frameSize", frameSize3,
+                           "hopSize", hopSize3);
+  _ticksBeatEmphasis3->configure("sampleRateODF", _sampleRate/hopSize3,
+                                 "resample", "none",
+                                 "minTempo", minTempo,
+                                 "maxTempo", maxTempo);
+  _ticksInfogain3->configure("sampleRateODF", _sampleRate/hopSize3,
                              "resample", "none",
                              "minTempo", minTempo,
                              "maxTempo", maxTempo);
@@ -210,6 +201,21 @@ AlgorithmStatus BeatTrackerMultiFeature::process() {
 
   tickCandidates.resize(5);
 
+  if (_pool.contains<vector<Real> >("internal.signal")) {
+    vector<Real> beatEmphasis;
+    vector<Real> infoGain;
+    static_cast<standard::OnsetDetectionGlobal*>(_onsetGlobal3)->computeDetections(
+        _pool.value<vector<Real> >("internal.signal"), &infoGain, &beatEmphasis);
+
+    _ticksBeatEmphasis3->input("onsetDetections").set(beatEmphasis);
+    _ticksBeatEmphasis3->output("ticks").set(tickCandidates[3]);
+    _ticksBeatEmphasis3->compute();
+
+    _ticksInfogain3->input("onsetDetections").set(infoGain);
+    _ticksInfogain3->output("ticks").set(tickCandidates[4]);
+    _ticksInfogain3->compute();
+  }
+
   // ticks candidates might be empty for very short signals, but
   // it is ok to feed empty tick vetors to TempoTapMaxAgreement
   if (_pool.contains<vector<Real> >("internal.ticksComplex")) {
@@ -221,12 +227,6 @@ AlgorithmStatus BeatTrackerMultiFeature::process() {
   if (_pool.contains<vector<Real> >("internal.ticksMelFlux")) {
     tickCandidates[2] = _pool.value<vector<Real> >("internal.ticksMelFlux");
   }
-  if (_pool.contains<vector<Real> >("internal.ticksBeatEmphasis")) {
-    tickCandidates[3] = _pool.value<vector<Real> >("internal.ticksBeatEmphasis");
-  }
-  if (_pool.contains<vector<Real> >("internal.ticksInfogain")) {
-    tickCandidates[4] = _pool.value<vector<Real> >("internal.ticksInfogain");
-  }
 
   _tempoTapMaxAgreement->input("tickCandidates").set(tickCandidates);
   _tempoTapMaxAgreement->output("ticks").set(ticks);
@@ -243,6 +243,9 @@ AlgorithmStatus BeatTrackerMultiFeature::process() {
 
 void BeatTrackerMultiFeature::reset() {
   AlgorithmComposite::reset();
+  _onsetGlobal3->reset();
+  _ticksBeatEmphasis3->reset();
+  _ticksInfogain3->reset();
   _tempoTapMaxAgreement->reset();
 }
 
@@ -49,11 +49,12 @@ class BeatTrackerMultiFeature : public AlgorithmComposite {
   Algorithm* _onsetMelFlux1;
   Algorithm* _ticksMelFlux1;
 
-  Algorithm* _onsetBeatEmphasis3;
-  Algorithm* _ticksBeatEmphasis3;
-
-  Algorithm* _onsetInfogain4;
-  Algorithm* _ticksInfogain4;
+  // beat emphasis and infogain detection functions share the same framing,
+  // and are computed together over a single STFT of the stored signal
+  Algorithm* _signalStorage3;
+  standard::Algorithm* _onsetGlobal3;
+  standard::Algorithm* _ticksBeatEmphasis3;
+  standard::Algorithm* _ticksInfogain3;
 
   standard::Algorithm* _tempoTapMaxAgreement;
 
@@ -65,99 +65,112 @@ void OnsetDetectionGlobal::configure() {
                         "zeroPadding", 0,
                         "type", "hann");
 
-  if (_method=="infogain") {
-    _spectrum->configure("size", frameSize);
-
-    _histogramSize = 5; // use +/- 5 frames around a target frame for histogramming
-    _bufferSize = _histogramSize * 2 + 1;
+  // Both methods are configured regardless of the selected one, so that they
+  // can be computed together by computeDetections()
+  _spectrum->configure("size", frameSize);
+  _fft->configure("size", frameSize);
+
+  // information gain
+  _histogramSize = 5; // use +/- 5 frames around a target frame for histogramming
+  _bufferSize = _histogramSize * 2 + 1;
+
+  // reversed triangle weighting
+  _weights.clear();
+  _rweights.clear();
+  for (int i=0; i < _histogramSize; i++) {
+    Real weight = 1 - i * 0.9/_histogramSize;
+    _weights.push_back(weight);                   // 1, 0.82, 0.64, 0.46, 0.28
+    _rweights.insert(_rweights.begin(), weight);  // 0.28, 0.46, 0.64, 0.82, 1
+  }
 
-    // reversed triangle weighting
-    _weights.clear();
-    for (int i=0; i < _histogramSize; i++) {
-      Real weight = 1 - i * 0.9/_histogramSize;
-      _weights.push_back(weight);                   // 1, 0.82, 0.64, 0.46, 0.28
-      _rweights.insert(_rweights.begin(), weight);  // 0.28, 0.46, 0.64, 0.82, 1
-    }
+  // frequency interval to consider
+  Real minFrequency = 40.;
+  Real maxFrequency = 5000.;
+
+  // associated FFT bins
+  _minFrequencyBin = round(minFrequency * frameSize / sampleRate);
+  _maxFrequencyBin = round(maxFrequency * frameSize / sampleRate) + 1;
+  _numberInfoGainBins = _maxFrequencyBin - _minFrequencyBin;
+
+  // beat emphasis function
+  _numberERBBands = 40;
+  _numberFFTBins = int(frameSize)/2 + 1;
+  _phase_1.resize(_numberFFTBins);
+  _phase_2.resize(_numberFFTBins);
+  _spectrum_1.resize(_numberFFTBins);
+
+  _erbbands->configure("inputSize", frameSize/2 + 1,
+                       "numberBands", _numberERBBands,
+                       "lowFrequencyBound", 80.,
+                       "highFrequencyBound", sampleRate/2,
+                       "type", "magnitude");
+  // TODO Smoothing window size is set to 8+8 ODF samples as in the paper and
+  // matlab code. However, this will result in different time durations for
+  // different ODF frame rates. Is a constant time duration required instead?
+  // Constant time for default ODF resolution of 11.6ms:
+  // Real smoothingTime = 0.18575963718820862;
+  // ~0.09s advance + ~0.09s delay;  use a simpler value of 0.2?
+  //_smoothingWindowHalfSize = floor(smoothingTime/2 * sampleRate);
+  _movingAverage->configure("size", _smoothingWindowHalfSize * 2 + 1);
+  _autocorrelation->configure("normalization", "unbiased");
+
+  // Tempo preference weights (Rayleigh distribution, code from TempoTapDegara)
+  // Maximum period of ODF to consider (period of 512 ODF samples with the
+  // default settings correspond to 512 * 512. / 44100. = ~6 secs
+  _maxPeriodODF = int(round(5.944308390022676 * sampleRate / hopSize));
+  _tempoWeights.resize(_maxPeriodODF);
+  Real rayparam2 = pow(round(43 * 512.0/_maxPeriodODF), 2);
+  // Rayleigh distribution parameter which sets the strongest point of the weighting
+  for (int i=0; i<_maxPeriodODF; ++i) {
+    int tau = i+1;
+    _tempoWeights[i] = tau / rayparam2 * exp(-0.5 * tau*tau / rayparam2);
+  }
+}
 
-    // frequency interval to consider
-    Real minFrequency = 40.;
-    Real maxFrequency = 5000.;
+void OnsetDetectionGlobal::compute() {
+  const vector<Real>& signal = _signal.get();
+  vector<Real>& onsetDetections = _onsetDetections.get();
 
-    // associated FFT bins
-    _minFrequencyBin = round(minFrequency * frameSize / sampleRate);
-    _maxFrequencyBin = round(maxFrequency * frameSize / sampleRate) + 1;
-    _numberFFTBins = _maxFrequencyBin - _minFrequencyBin;
+  if (_method=="infogain") {
+    computeDetections(signal, &onsetDetections, NULL);
   }
-
   else if (_method=="beat_emphasis") {
-    _numberERBBands = 40;
-    _numberFFTBins = int(frameSize)/2 + 1;
-    _phase_1.resize(_numberFFTBins);
-    _phase_2.resize(_numberFFTBins);
-    _spectrum_1.resize(_numberFFTBins);
-
-    _fft->configure("size", frameSize);
-    _erbbands->configure("inputSize", frameSize/2 + 1,
-                         "numberBands", _numberERBBands,
-                         "lowFrequencyBound", 80.,
-                         "highFrequencyBound", sampleRate/2,
-                         "type", "magnitude");
-    // TODO Smoothing window size is set to 8+8 ODF samples as in the paper and
-    // matlab code. However, this will result in different time durations for
-    // different ODF frame rates. Is a constant time duration required instead?
-    // Constant time for default ODF resolution of 11.6ms:
-    // Real smoothingTime = 0.18575963718820862;
-    // ~0.09s advance + ~0.09s delay;  use a simpler value of 0.2?
-    //_smoothingWindowHalfSize = floor(smoothingTime/2 * sampleRate);
-    _movingAverage->configure("size", _smoothingWindowHalfSize * 2 + 1);
-    _autocorrelation->configure("normalization", "unbiased");
-
-    // Tempo preference weights (Rayleigh distribution, code from TempoTapDegara)
-    // Maximum period of ODF to consider (period of 512 ODF samples with the
-    // default settings correspond to 512 * 512. / 44100. = ~6 secs
-    _maxPeriodODF = int(round(5.944308390022676 * sampleRate / hopSize));
-    _weights.resize(_maxPeriodODF);
-    Real rayparam2 = pow(round(43 * 512.0/_maxPeriodODF), 2);
-    // Rayleigh distribution parameter which sets the strongest point of the weighting
-    for (int i=0; i<_maxPeriodODF; ++i) {
-      int tau = i+1;
-      _weights[i] = tau / rayparam2 * exp(-0.5 * tau*tau / rayparam2);
-    }
+    computeDetections(signal, NULL, &onsetDetections);
   }
 }
 
-void OnsetDetectionGlobal::compute() {
-  const vector<Real>& signal = _signal.get();
+void OnsetDetectionGlobal::computeDetections(const vector<Real>& signal,
+                                             vector<Real>* infoGain,
+                                             vector<Real>* beatEmphasis) {
+  if (infoGain) infoGain->clear();
+  if (beatEmphasis) beatEmphasis->clear();
+
   if (signal.empty()) {
-    vector<Real>& onsetDetections = _onsetDetections.get();
-    onsetDetections.clear();
     return;
   }
 
+  _frameCutter->reset();
   _frameCutter->input("signal").set(signal);
   _frameCutter->output("frame").set(_frame);
 
   _windowing->input("frame").set(_frame);
   _windowing->output("frame").set(_frameWindowed);
 
-  if (_method=="infogain") {
-    computeInfoGain();
-  }
-  else if (_method=="beat_emphasis") {
-    computeBeatEmphasis();
-  }
-}
+  // The magnitude spectrum is computed with the Spectrum algorithm when only
+  // the information gain is required, otherwise it is taken from the polar
+  // representation of the FFT, which yields the same values
+  _spectrum->input("frame").set(_frameWindowed);
+  _spectrum->output("spectrum").set(_frameSpectrum);
 
-void OnsetDetectionGlobal::computeInfoGain() {
-  vector<Real>& onsetDetections = _onsetDetections.get();
+  _fft->input("frame").set(_frameWindowed);
+  _fft->output("fft").set(_frameFFT);
 
-  vector<vector<Real> > buffer(_bufferSize, vector<Real> (_numberFFTBins, 0));
-  vector<Real> histogramOld(_numberFFTBins, 0);
-  vector<Real> histogramNew(_numberFFTBins, 0);
+  _cartesian2polar->input("complex").set(_frameFFT);
+  _cartesian2polar->output("magnitude").set(_frameSpectrum);
+  _cartesian2polar->output("phase").set(_framePhase);
 
-  vector<Real> spectrum;
-  _spectrum->input("frame").set(_frameWindowed);
-  _spectrum->output("spectrum").set(spectrum);
+  if (infoGain) startInfoGain();
+  if (beatEmphasis) startBeatEmphasis();
 
   while (true) {
     // get a frame
@@ -167,123 +180,127 @@ void OnsetDetectionGlobal::computeInfoGain() {
       break;
     }
     _windowing->compute();
-    _spectrum->compute();
-
-    // update buffer; take only bins we are interested in
-    buffer.erase(buffer.begin());
-    buffer.push_back(vector<Real>(spectrum.begin() + _minFrequencyBin,
-                        spectrum.begin() + _maxFrequencyBin));
-
-    // compute weighted sum of magnitudes for each bin
-    for (int b=0; b<_numberFFTBins; b++) {
-      // initialize bin
-      histogramOld[b] = 0;
-      histogramNew[b] = 0;
-      for (int i=0; i<_histogramSize; i++) {
-        // previous frames
-        histogramOld[b] += buffer[i][b] * _rweights[i];
-        // posterior frames
-        histogramNew[b] += buffer[_histogramSize + 1 + i][b] * _weights[i];
-      }
+
+    if (beatEmphasis) {
+      _fft->compute();
+      _cartesian2polar->compute();
+      computeBeatEmphasisFrame(_frameSpectrum, _framePhase);
+    }
+    else {
+      _spectrum->compute();
     }
 
-    // Reassign bins with zero magnitude in histogramOld to 1 to avoid division
-    // by zero (TODO why to 1?). Reassign bins with zero magnitude in
-    // histogramNew to a very little value to avoid log(0)
-    /*
-      original code by Matthew Davies:
-      ind = find(hist1 == 0);
-      hist1(ind) = 1;
-      if hist1 == 0,  hist1 = 1; end
-      if hist2 == 0,  hist2 = eps; end
-    */
-
-    Real detection = 0.;
-    for (int b=0; b<_numberFFTBins; b++)  {
-      if (histogramOld[b] == 0) {
-        histogramOld[b] = 1;
-      }
-      if (histogramNew[b] == 0) {
-        histogramNew[b] = numeric_limits<Real>::epsilon();
-      }
-      // Use information gain as a distance between histogrammed bins in
-      // previous and posterior frames. Consider only positive changes.
-      detection += max(log2(histogramNew[b] / histogramOld[b]), Real(0));
+    if (infoGain) {
+      computeInfoGainFrame(_frameSpectrum, *infoGain);
     }
-    onsetDetections.push_back(detection);
   }
 
-  // original algorithm includes smoothing Hanning filter (length = 20 frames)
+  // original infogain algorithm includes smoothing Hanning filter (length = 20 frames)
   // df2 = filtfilt(hanning(20)/sum(hanning(20)),1,df)
   // we omit smoothing, as it should be done on the post-processing stage
-}
 
+  if (beatEmphasis) {
+    computeBeatEmphasisWeighting(*beatEmphasis);
+  }
+}
 
-void OnsetDetectionGlobal::computeBeatEmphasis() {
-  vector<Real>& onsetDetections = _onsetDetections.get();
-  onsetDetections.clear();
+void OnsetDetectionGlobal::startInfoGain() {
+  _buffer.assign(_bufferSize, vector<Real>(_numberInfoGainBins, 0));
+  _histogramOld.assign(_numberInfoGainBins, 0);
+  _histogramNew.assign(_numberInfoGainBins, 0);
+}
 
-  vector<complex<Real> > frameFFT;
-  _fft->input("frame").set(_frameWindowed);
-  _fft->output("fft").set(frameFFT);
+void OnsetDetectionGlobal::computeInfoGainFrame(const vector<Real>& spectrum,
+                                                vector<Real>& onsetDetections) {
+  // update buffer; take only bins we are interested in. The oldest frame is
+  // rotated to the end and overwritten to avoid reallocating it
+  rotate(_buffer.begin(), _buffer.begin() + 1, _buffer.end());
+  copy(spectrum.begin() + _minFrequencyBin,
+       spectrum.begin() + _maxFrequencyBin, _buffer.back().begin());
+
+  // compute weighted sum of magnitudes for each bin
+  for (int b=0; b<_numberInfoGainBins; b++) {
+    // initialize bin
+    _histogramOld[b] = 0;
+    _histogramNew[b] = 0;
+    for (int i=0; i<_histogramSize; i++) {
+      // previous frames
+      _histogramOld[b] += _buffer[i][b] * _rweights[i];
+      // posterior frames
+      _histogramNew[b] += _buffer[_histogramSize + 1 + i][b] * _weights[i];
+    }
+  }
 
-  vector<Real> spectrum;
-  vector<Real> phase;
-  _cartesian2polar->input("complex").set(frameFFT);
-  _cartesian2polar->output("magnitude").set(spectrum);
-  _cartesian2polar->output("phase").set(phase);
+  // Reassign bins with zero magnitude in histogramOld to 1 to avoid division
+  // by zero (TODO why to 1?). Reassign bins with zero magnitude in
+  // histogramNew to a very little value to avoid log(0)
+  /*
+    original code by Matthew Davies:
+    ind = find(hist1 == 0);
+    hist1(ind) = 1;
+    if hist1 == 0,  hist1 = 1; end
+    if hist2 == 0,  hist2 = eps; end
+  */
+
+  Real detection = 0.;
+  for (int b=0; b<_numberInfoGainBins; b++)  {
+    if (_histogramOld[b] == 0) {
+      _histogramOld[b] = 1;
+    }
+    if (_histogramNew[b] == 0) {
+      _histogramNew[b] = numeric_limits<Real>::epsilon();
+    }
+    // Use information gain as a distance between histogrammed bins in
+    // previous and posterior frames. Consider only positive changes.
+    detection += max(log2(_histogramNew[b] / _histogramOld[b]), Real(0));
+  }
+  onsetDetections.push_back(detection);
+}
 
 
+void OnsetDetectionGlobal::startBeatEmphasis() {
   fill(_phase_1.begin(), _phase_1.end(), Real(0.0));
   fill(_phase_2.begin(), _phase_2.end(), Real(0.0));
   fill(_spectrum_1.begin(), _spectrum_1.end(), Real(0.0));
 
-  vector<vector<Real> > onsetERB(_numberERBBands);
-  vector<Real> tempFFT (_numberFFTBins, 0.);  // detection function in FFT bins
-  vector<Real> tempERB (_numberERBBands, 0.); // detection function in ERP bands
+  _onsetERB.assign(_numberERBBands, vector<Real>());
+  _tempFFT.assign(_numberFFTBins, 0.);  // detection function in FFT bins
+  _tempERB.assign(_numberERBBands, 0.); // detection function in ERP bands
 
   // NB: a hack to make use of ERBBands algorithm and not reimplement the
   // computation of gammatone filterbank weights again. As long as ERBBands
   // computes weighted magnitudes in each ERB band instead of energy, we can
   // feed it onset detection values instead of spectrum.
-  _erbbands->input("spectrum").set(tempFFT);
-  _erbbands->output("bands").set(tempERB);
-
-  size_t numberFrames=0;
-
-  while (true) {
-    // get a frame
-    _frameCutter->compute();
+  _erbbands->input("spectrum").set(_tempFFT);
+  _erbbands->output("bands").set(_tempERB);
+}
 
-    if (!_frame.size()) {
-      break;
-    }
+void OnsetDetectionGlobal::computeBeatEmphasisFrame(const vector<Real>& spectrum,
+                                                    const vector<Real>& phase) {
+  // Compute complex spectral difference. Optimized, see details in the
+  // OnsetDetection algo
+  for (int i=0; i<_numberFFTBins; ++i) {
+    Real targetPhase = 2*_phase_1[i] + _phase_2[i];
+    targetPhase = fmod(targetPhase + M_PI, -2 * M_PI) + M_PI;
+    _tempFFT[i] = norm(_spectrum_1[i] - polar(spectrum[i], phase[i]-targetPhase));
+  }
 
-    _windowing->compute();
-    _fft->compute();
-    _cartesian2polar->compute();
-
-    // Compute complex spectral difference. Optimized, see details in the
-    // OnsetDetection algo
-    for (int i=0; i<_numberFFTBins; ++i) {
-      Real targetPhase = 2*_phase_1[i] + _phase_2[i];
-      targetPhase = fmod(targetPhase + M_PI, -2 * M_PI) + M_PI;
-      tempFFT[i] = norm(_spectrum_1[i] - polar(spectrum[i], phase[i]-targetPhase));
-    }
+  // Group detection functions for spectral bins into larger ERB sub-bands using
+  // a Gammatone filterbank to improve the likelihood of finding meaningful
+  // periodicity in spectral bands.
+  _erbbands->compute();
+  for (int b=0; b<_numberERBBands; ++b) {
+    _onsetERB[b].push_back(_tempERB[b]);
+  }
 
-    // Group detection functions for spectral bins into larger ERB sub-bands using
-    // a Gammatone filterbank to improve the likelihood of finding meaningful
-    // periodicity in spectral bands.
-    _erbbands->compute();
-    for (int b=0; b<_numberERBBands; ++b) {
-      onsetERB[b].push_back(tempERB[b]);
-    }
+  _phase_2 = _phase_1;
+  _phase_1 = phase;
+  _spectrum_1 = spectrum;
+}
 
-    _phase_2 = _phase_1;
-    _phase_1 = phase;
-    _spectrum_1 = spectrum;
-    numberFrames += 1;
-  }
+void OnsetDetectionGlobal::computeBeatEmphasisWeighting(vector<Real>& onsetDetections) {
+  vector<vector<Real> >& onsetERB = _onsetERB;
+  size_t numberFrames = onsetERB.empty() ? 0 : onsetERB[0].size();
 
   // Post-processing found in M.Davies' matlab code, but not mentioned in the
   // paper, and skipped in this implementation:
@@ -396,7 +413,7 @@ void OnsetDetectionGlobal::computeBeatEmphasis() {
       for (int region=1-comb; region<=comb-1; ++region) {
         for (int period=periodMin; period<periodMax; ++period) {
           tempACFWeighted[period] +=
-              _weights[period] * tempACF[period*comb + region] / width;
+              _tempoWeights[period] * tempACF[period*comb + region] / width;
         }
       }
     }
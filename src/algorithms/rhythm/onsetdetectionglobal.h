@@ -20,6 +20,7 @@
 #ifndef ESSENTIA_ONSETDETECTIONGLOBAL_H
 #define ESSENTIA_ONSETDETECTIONGLOBAL_H
 
+#include <complex>
 #include "algorithmfactory.h"
 
 namespace essentia {
@@ -44,24 +45,42 @@ class OnsetDetectionGlobal : public Algorithm {
 
   std::vector<Real> _frame;
   std::vector<Real> _frameWindowed;
+  std::vector<std::complex<Real> > _frameFFT;
+  std::vector<Real> _frameSpectrum;
+  std::vector<Real> _framePhase;
 
+  // information gain
   int _minFrequencyBin;
   int _maxFrequencyBin;
-  int _numberFFTBins;
+  int _numberInfoGainBins;
   int _bufferSize;
   int _histogramSize;
   std::vector<Real> _weights;
   std::vector<Real> _rweights;
+  std::vector<std::vector<Real> > _buffer;
+  std::vector<Real> _histogramOld;
+  std::vector<Real> _histogramNew;
 
   // beat emphasis function
+  int _numberFFTBins;
   int _numberERBBands;
   static const int _smoothingWindowHalfSize=8;
   int _maxPeriodODF;
+  std::vector<Real> _tempoWeights;
 
   std::vector<Real> _phase_1;
   std::vector<Real> _phase_2;
   std::vector<Real> _spectrum_1;
+  std::vector<std::vector<Real> > _onsetERB;
+  std::vector<Real> _tempFFT;
+  std::vector<Real> _tempERB;
+
+  void startInfoGain();
+  void computeInfoGainFrame(const std::vector<Real>& spectrum, std::vector<Real>& onsetDetections);
 
+  void startBeatEmphasis();
+  void computeBeatEmphasisFrame(const std::vector<Real>& spectrum, const std::vector<Real>& phase);
+  void computeBeatEmphasisWeighting(std::vector<Real>& onsetDetections);
 
  public:
   OnsetDetectionGlobal() {
@@ -100,8 +119,13 @@ class OnsetDetectionGlobal : public Algorithm {
   void configure();
   void compute();
 
-  void computeInfoGain();
-  void computeBeatEmphasis();
+  // Computes the requested detection functions (infogain and/or beat emphasis,
+  // null pointers are skipped) in a single pass over the frames of the signal,
+  // so that both of them share the same framing, windowing and FFT. This is
+  // independent of the configured method.
+  void computeDetections(const std::vector<Real>& signal,
+                         std::vector<Real>* infoGain,
+                         std::vector<Real>* beatEmphasis);
 
   static const char* name;
   static const char* category;
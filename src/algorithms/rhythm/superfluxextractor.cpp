@@ -35,7 +35,7 @@ const char* SuperFluxExtractor::description = standard::SuperFluxExtractor::desc
 SuperFluxExtractor::SuperFluxExtractor() : _configured(false) {
 
   declareInput(_signal, "signal", "the input audio signal");
-  declareOutput(_onsets, "onsets","lists of onsets");
+  declareOutput(_onsets, "onsets", "lists of onsets");
 
   // create network (instantiate algorithms)
   createInnerNetwork();
@@ -47,7 +47,8 @@ SuperFluxExtractor::SuperFluxExtractor() : _configured(false) {
   _spectrum->output("spectrum")      >> _triF->input("spectrum");
   _triF->output("bands")             >> _superFluxF->input("bands");
   _superFluxF->output("differences") >> _superFluxP->input("novelty");
-  _superFluxP->output("peaks")       >> _onsets;
+  _superFluxP->output("peaks")       >> _accumulator->input("data");
+  _accumulator->output("array")      >> _onsets;
 
   _network = new scheduler::Network(_frameCutter);
 }
@@ -64,7 +65,10 @@ void SuperFluxExtractor::createInnerNetwork() {
   _spectrum = factory.create("Spectrum");
   _triF = factory.create("TriangularBands", "log", false, 
                          "frequencyBands", arrayToVector<Real>(freqBands));
-  _superFluxP = factory.create("SuperFluxPeaks");
+  // the peaks are detected frame by frame, and gathered into the vector of
+  // onsets output at the end of the stream
+  _superFluxP = factory.create("SuperFluxPeaksStream");
+  _accumulator = factory.create("RealAccumulator");
   _superFluxF = factory.create("SuperFluxNovelty", "binWidth", 8, "frameWidth", 2);
     
   _vout = new essentia::streaming::VectorOutput<Real>();
@@ -107,6 +111,8 @@ const char* SuperFluxExtractor::name = "SuperFluxExtractor";
 const char* SuperFluxExtractor::category = "Rhythm";
 const char* SuperFluxExtractor::description = DOC("This algorithm detects onsets given an audio signal using SuperFlux algorithm. This implementation is based on the available reference implementation in python [2]. The algorithm computes spectrum of the input signal, summarizes it into triangular band energies, and computes a onset detection function based on spectral flux tracking spectral trajectories with a maximum filter (SuperFluxNovelty). The peaks of the function are then detected (SuperFluxPeaks).\n"
 "\n"
+"In streaming mode, the novelty function and its peaks are computed frame by frame, and the onsets are output as a single vector at the end of the stream. The onsets are the same as in standard mode. For online onset detection, SuperFluxPeaksStream outputs each onset time as soon as it is detected.\n"
+"\n"
 "References:\n"
 "  [1] Böck, S. and Widmer, G., Maximum Filter Vibrato Suppression for Onset\n"
 "  Detection, Proceedings of the 16th International Conference on Digital\n"
@@ -150,14 +156,17 @@ void SuperFluxExtractor::createInnerNetwork() {
   vector<vector<Real> > ll;
   _vectorInput->setVector(&signal);
   _vectorOut->setVector(&ll);
-  _network->run(); 
+  _network->run();
 
   if (ll.size()) {
-    onsets = ll[0]; // FIXME will this ever fail?
-  } 
+    onsets = ll[0];
+  }
   else {
     onsets.clear();
   }
+
+  // the onset detection keeps its state from one frame to the next
+  reset();
 }
 
 } // namespace standard
@@ -42,6 +42,7 @@ class SuperFluxExtractor : public AlgorithmComposite {
   Algorithm* _triF;
   Algorithm* _superFluxF;
   Algorithm* _superFluxP;
+  Algorithm* _accumulator;
   Algorithm* _frameCutter;
   Algorithm* _mfccF;
   VectorOutput<Real>* _vout;
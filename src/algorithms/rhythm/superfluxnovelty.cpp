@@ -21,6 +21,29 @@
 #include "essentiamath.h"
 
 namespace essentia {
+
+// maximum over the last binWidth bands of each band, computed in linear time
+// with a queue of decreasing candidates
+static void maxFilterBands(const vector<Real>& bands, int binWidth,
+                           vector<Real>& maxs, vector<int>& queue) {
+  int nBands = bands.size();
+  maxs.resize(nBands);
+  queue.resize(nBands);
+
+  int head = 0;
+  int tail = 0;
+  for (int j=0; j<nBands; j++) {
+    while (tail > head && bands[queue[tail-1]] <= bands[j]) {
+      tail--;
+    }
+    queue[tail++] = j;
+    if (queue[head] <= j - binWidth) {
+      head++;
+    }
+    maxs[j] = bands[queue[head]];
+  }
+}
+
 namespace standard {
         
 const char* SuperFluxNovelty::name = "SuperFluxNovelty";
@@ -29,7 +52,6 @@ const char* SuperFluxNovelty::description = DOC("Onset detection function for Su
         
 void SuperFluxNovelty::configure() {
   _binWidth = parameter("binWidth").toInt();
-  _maxFilter->configure("width", _binWidth, "causal", false);
   _frameWidth = parameter("frameWidth").toInt();
 }
 
@@ -52,20 +74,20 @@ const vector< vector<Real> >& bands = _bands.get();
     throw EssentiaException("SuperFluxNovelty: not enough frames for the specified frameWidth");
   }
 
-  vector<Real> maxsBuffer(nBands, 0);
+  _maxs.resize(nBands);
+  _maxQueue.resize(nBands);
             
   // buffer for differences
   Real cur_diff;
   diffs = 0;
   for (int i=_frameWidth; i<nFrames; i++) {
-    _maxFilter->input("signal").set(bands[i-_frameWidth]);
-    _maxFilter->output("signal").set(maxsBuffer);
-    _maxFilter->compute();
+    // each frame is filtered independently from the previously processed ones
+    maxFilterBands(bands[i-_frameWidth], _binWidth, _maxs, _maxQueue);
                 
     cur_diff = 0;
                 
     for (int j = 0;j<nBands;j++) {
-      cur_diff= bands[i][j]-maxsBuffer[j];
+      cur_diff= bands[i][j]-_maxs[j];
       if (cur_diff > 0.0) {
         diffs +=cur_diff ;
       }
@@ -89,16 +111,51 @@ const char* SuperFluxNovelty::name = standard::SuperFluxNovelty::name;
 const char* SuperFluxNovelty::category = standard::SuperFluxNovelty::category;
 const char* SuperFluxNovelty::description = standard::SuperFluxNovelty::description;
 
+void SuperFluxNovelty::configure() {
+  _binWidth = parameter("binWidth").toInt();
+  _frameWidth = parameter("frameWidth").toInt();
+  reset();
+}
+
+void SuperFluxNovelty::reset() {
+  Algorithm::reset();
+  _filtered.assign(_frameWidth, vector<Real>());
+  _frames = 0;
+}
+
 AlgorithmStatus SuperFluxNovelty::process() {
   AlgorithmStatus status = acquireData();
   if (status != OK) {
     return status;
   }
-  _algo->input("bands").set(_bands.tokens());
-  _algo->output("differences").set(_diffs.firstToken());
-  _algo->compute();
-  
-  // give back the tokens that were reserved
+
+  // Each frame is maximum filtered once, when it arrives, and kept until the
+  // frame frameWidth frames later is differentiated with it. The differences
+  // are the same as the ones of the standard algorithm given the frameWidth+1
+  // last frames.
+  const vector<Real>& bands = _bands.firstToken();
+  if (bands.empty()) {
+    throw EssentiaException("SuperFluxNovelty: empty bands");
+  }
+
+  vector<Real>& filtered = _filtered[_frames % _frameWidth];
+  if (_frames >= _frameWidth) {
+    if (filtered.size() != bands.size()) {
+      throw EssentiaException("SuperFluxNovelty: the number of bands of the frames changed");
+    }
+    Real diffs = 0;
+    for (int j=0; j<(int)bands.size(); j++) {
+      Real diff = bands[j] - filtered[j];
+      if (diff > 0.0) {
+        diffs += diff;
+      }
+    }
+    _diffs.push(diffs);
+  }
+
+  maxFilterBands(bands, _binWidth, filtered, _maxQueue);
+  _frames++;
+
   releaseData();
   return OK;
 }
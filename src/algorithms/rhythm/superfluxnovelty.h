@@ -35,18 +35,17 @@ class SuperFluxNovelty : public Algorithm {
  	int _binWidth;
   int _frameWidth;
 
-  Algorithm* _maxFilter;
+  // workspace for the maximum filter along the frequency axis
+  std::vector<Real> _maxs;
+  std::vector<int> _maxQueue;
 
  public:
   SuperFluxNovelty() {
     declareInput(_bands, "bands", "the input bands spectrogram");
     declareOutput(_diffs, "differences", "SuperFlux novelty curve");
-	 _maxFilter = AlgorithmFactory::create("MaxFilter"); 
   }
 
-  ~SuperFluxNovelty() {
-    delete _maxFilter;
-  }
+  ~SuperFluxNovelty() {}
 
   void declareParameters() {
     declareParameter("binWidth", "filter width (number of frequency bins)", "[3,inf)", 3);
@@ -77,32 +76,29 @@ class SuperFluxNovelty : public Algorithm {
   Sink< vector<Real> > _bands;
   Source<Real  > _diffs;
 
-  essentia::standard::Algorithm* _algo;
+  int _binWidth;
+  int _frameWidth;
+
+  // the maximum filtered bands of the last frameWidth frames, the one of
+  // frame i being in slot i % frameWidth
+  std::vector<std::vector<Real> > _filtered;
+  std::vector<int> _maxQueue;
+  long long _frames;
 
  public:
   SuperFluxNovelty() {
-    declareInput(_bands, "bands", "the input bands spectrogram");
-    declareOutput(_diffs,1,1, "differences", "SuperFlux novelty curve");
-    _algo = essentia::standard::AlgorithmFactory::create("SuperFluxNovelty");
-  }
-  
-  ~SuperFluxNovelty() {
-    delete _algo;
+    declareInput(_bands, 1, "bands", "the input bands spectrogram");
+    declareOutput(_diffs, 0, "differences", "SuperFlux novelty curve");
   }
 
   void declareParameters() {
     declareParameter("binWidth", "filter width (number of frequency bins)", "[3,inf)", 3);
     declareParameter("frameWidth", "differentiation offset (compute the difference with the N-th previous frame)", "(0,inf)", 2);
   }
-   
-  void configure() {
-    _algo->configure(_params);
-    _bands.setAcquireSize(_algo->parameter("frameWidth").toInt() + 1);
-    _bands.setReleaseSize(1);
-  }
 
+  void configure();
   AlgorithmStatus process();
-  void reset() {};
+  void reset();
 
   static const char* name;
   static const char* category;
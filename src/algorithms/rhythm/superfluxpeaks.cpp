@@ -49,14 +49,22 @@ void SuperFluxPeaks::configure() {
   // convert to seconds
   _combine = parameter("combine").toReal()/1000.;
   
-  _movAvg->configure("size",_pre_avg);
-  _maxf->configure("width",_pre_max,"causal",true);
-  
   _threshold = parameter("threshold").toReal();
   _ratioThreshold = parameter("ratioThreshold").toReal();
   
-  _startPeakTime = 0;
-  nDetec=0;
+  reset();
+}
+
+
+void SuperFluxPeaks::reset() {
+  Algorithm::reset();
+  _avgBuffer.assign(_pre_avg, 0.);
+  _avgIndex = 0;
+  _avgSum = 0.;
+  _maxCandidates.clear();
+  _nFrames = 0;
+  _hasPeak = false;
+  _lastPeakTime = 0.;
 }
 
 
@@ -64,44 +72,49 @@ void SuperFluxPeaks::compute() {
   
   const vector<Real>& signal = _signal.get();
   vector<Real>& peaks = _peaks.get();
-  if (signal.empty()) {
-    peaks.resize(0);
-    return;
-  }
-  
-  int size = signal.size();
-  
-  vector<Real> avg(size);
-  _movAvg->input("signal").set(signal);
-  _movAvg->output("signal").set(avg);
-  _movAvg->compute();
-  
-  vector<Real> maxs(size);
-  _maxf->input("signal").set(signal);
-  _maxf->output("signal").set(maxs);
-  _maxf->compute();
+  peaks.clear();
+
+  // The novelty curve is processed value by value, with the filters and the
+  // last detected peak kept between calls, so that feeding it in several
+  // chunks gives the same peaks as feeding it at once.
+  for (int i=0; i<(int)signal.size(); i++) {
+    Real value = signal[i];
+
+    // moving average over the last _pre_avg values (zero initial state, as
+    // MovingAverage), updated as a running sum
+    _avgSum += value - _avgBuffer[_avgIndex];
+    _avgBuffer[_avgIndex] = value;
+    _avgIndex = (_avgIndex + 1) % _pre_avg;
+    Real avg = _avgSum / _pre_avg;
+
+    // causal maximum over the last _pre_max values, using a queue of
+    // decreasing candidates
+    while (!_maxCandidates.empty() && _maxCandidates.back().second <= value) {
+      _maxCandidates.pop_back();
+    }
+    _maxCandidates.push_back(make_pair(_nFrames, value));
+    if (_maxCandidates.front().first <= _nFrames - _pre_max) {
+      _maxCandidates.pop_front();
+    }
+    Real maxValue = _maxCandidates.front().second;
 
-  int localnDetec = 0;
-  for( int i=0; i<=size; i++) {
     // we want to avoid ratioThreshold noisy activation in really low flux parts so we set noise floor
     // to 10-7 by default (REALLY LOW for a flux)
-    if(signal[i]==maxs[i] && signal[i]>1e-8) {
-      bool isOverLinearThreshold = _threshold > 0 && signal[i] > avg[i]+_threshold;
-      bool isOverratioThreshold = _ratioThreshold > 0 && avg[i] > 0 && signal[i]/avg[i] > _ratioThreshold;
+    if(value==maxValue && value>1e-8) {
+      bool isOverLinearThreshold = _threshold > 0 && value > avg+_threshold;
+      bool isOverratioThreshold = _ratioThreshold > 0 && avg > 0 && value/avg > _ratioThreshold;
     
       if(isOverLinearThreshold || isOverratioThreshold) {
-        Real peakTime = _startPeakTime + i*1.0/frameRate;
-        if((localnDetec > 0 && peakTime-peaks[localnDetec-1] > _combine) || localnDetec == 0) {
-          peaks[localnDetec] = peakTime;
-          nDetec++;
-		  localnDetec++;
+        Real peakTime = _nFrames*1.0/frameRate;
+        if(!_hasPeak || peakTime-_lastPeakTime > _combine) {
+          peaks.push_back(peakTime);
+          _lastPeakTime = peakTime;
+          _hasPeak = true;
         }
       }
-    } 
+    }
+    _nFrames++;
   }
-  _startPeakTime += size*1.0/frameRate;
-
-  peaks.resize(localnDetec);
 }
 
 
@@ -119,39 +132,25 @@ const char* SuperFluxPeaks::category = standard::SuperFluxPeaks::category;
 const char* SuperFluxPeaks::description = standard::SuperFluxPeaks::description;
 
 void SuperFluxPeaks::consume() {
+  std::vector<Real> out;
 
-  int _aquireSize = _signal.acquireSize();
-  std::vector<Real> out = std::vector<Real>(_aquireSize);
-
+  // peaks are combined across consecutive chunks by the standard algorithm,
+  // which keeps its state between calls
   _algo->input("novelty").set(_signal.tokens());
   _algo->output("peaks").set(out);
   _algo->compute();
 
-  if (out.size() > 0) {
-    // trim firstpart if needed
-    bool trimBeg = false;
-    if(onsetTimes.size() > 0 && (current_t + out[0] - onsetTimes.back() < _combine)) {
-      trimBeg = true;
-    }
-    
-    // copy if there is something to copy
-    if (!trimBeg || onsetTimes.size()>1) {
-      onsetTimes.insert(onsetTimes.end(), out.begin(), out.end()-(trimBeg ? 1 : 0));
-    }
-  }
-  current_t += _aquireSize / framerate;
+  onsetTimes.insert(onsetTimes.end(), out.begin(), out.end());
 }
 
 
 void SuperFluxPeaks::finalProduce() {
   _peaks.push((std::vector<Real>) onsetTimes);
-  current_t = 0;
   reset();
 }
 
 
 void SuperFluxPeaks::reset(){
-  current_t = 0;
   onsetTimes.clear();
   _algo->reset();
 }
@@ -20,6 +20,7 @@
 #ifndef ESSENTIA_SUPERFLUXPEAKS_H
 #define ESSENTIA_SUPERFLUXPEAKS_H
 
+#include <deque>
 #include "algorithmfactory.h"
 
 using namespace std;
@@ -32,34 +33,29 @@ class SuperFluxPeaks : public Algorithm {
   Input<std::vector<Real> > _signal;
   Output<std::vector<Real> > _peaks;
     
-  Algorithm* _movAvg;
-  Algorithm* _maxf;
-    
   int _pre_avg;
   int _pre_max;
   Real _combine;
   Real _threshold;
   Real _ratioThreshold;
     
-  Real _startPeakTime;
-  int nDetec;
-    
-  int hopSize;
   Real frameRate;
 
-    
+  // state of the moving average and moving maximum filters, kept between
+  // calls to compute() so that the novelty curve can be fed incrementally
+  std::vector<Real> _avgBuffer;
+  int _avgIndex;
+  double _avgSum;
+  std::deque<std::pair<long, Real> > _maxCandidates;
+  long _nFrames;
+
+  bool _hasPeak;
+  Real _lastPeakTime;
+
 public:
   SuperFluxPeaks() {
     declareInput(_signal, "novelty", "the input onset detection function");
     declareOutput(_peaks, "peaks", "detected peaks' instants [s]");
-    
-    _movAvg = AlgorithmFactory::create("MovingAverage");
-    _maxf = AlgorithmFactory::create("MaxFilter");
-  }
-    
-  ~SuperFluxPeaks() {
-    delete _movAvg;
-    delete _maxf;
   }
     
   void declareParameters() {
@@ -71,13 +67,7 @@ public:
     declareParameter("pre_max", "look back duration for moving maximum filter [ms]", "(0,inf)", 30.);
   }
     
-  void reset() {
-    Algorithm::reset();
-    _maxf->reset();
-    _movAvg->reset();
-    _startPeakTime = 0;
-  };
-  
+  void reset();
   void configure();
   void compute();
     
@@ -103,9 +93,6 @@ class SuperFluxPeaks : public AccumulatorAlgorithm {
   
   standard::Algorithm * _algo; 
 
-  float current_t;
-  float framerate,_combine;
-  
   std::vector<Real> onsetTimes;
     
  public:
@@ -131,15 +118,16 @@ class SuperFluxPeaks : public AccumulatorAlgorithm {
   // link algo parameter with streaming buffer options
   void configure(){
     _algo->configure(this->_params);
-    framerate = _algo->parameter("frameRate").toReal();
-    _combine = parameter("combine").toReal()/1000.;
-    current_t = 0;
   };
     
   void consume();
   void finalProduce();
   void reset();
 
+  size_t memoryUsage() const {
+    return essentia::memoryUsage(onsetTimes) + _algo->memoryUsage();
+  }
+
   static const char* name;
   static const char* category;
   static const char* description;  
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "superfluxpeaksstream.h"
+
+using namespace std;
+
+namespace essentia {
+namespace streaming {
+
+const char* SuperFluxPeaksStream::name = "SuperFluxPeaksStream";
+const char* SuperFluxPeaksStream::category = "Rhythm";
+const char* SuperFluxPeaksStream::description = DOC("This algorithm detects peaks of an onset detection function computed by the SuperFluxNovelty algorithm, in the same way as SuperFluxPeaks, but outputs each peak as soon as it is detected instead of a single vector of peaks at the end of the stream. "
+"It processes the novelty curve value by value with constant memory, and its latency is of one novelty value, which makes it suitable for online onset detection on live input. See SuperFluxExtractor for more details.");
+
+
+AlgorithmStatus SuperFluxPeaksStream::process() {
+  AlgorithmStatus status = acquireData();
+  if (status != OK) {
+    return status;
+  }
+
+  _algo->input("novelty").set(_novelty.tokens());
+  _algo->output("peaks").set(_detected);
+  _algo->compute();
+
+  releaseData();
+
+  for (int i=0; i<(int)_detected.size(); i++) {
+    _peaks.push(_detected[i]);
+  }
+
+  return OK;
+}
+
+
+void SuperFluxPeaksStream::reset() {
+  Algorithm::reset();
+  _algo->reset();
+}
+
+} // namespace streaming
+} // namespace essentia
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_SUPERFLUXPEAKSSTREAM_H
+#define ESSENTIA_SUPERFLUXPEAKSSTREAM_H
+
+#include "streamingalgorithm.h"
+#include "algorithmfactory.h"
+
+namespace essentia {
+namespace streaming {
+
+class SuperFluxPeaksStream : public Algorithm {
+
+ protected:
+  Sink<Real> _novelty;
+  Source<Real> _peaks;
+
+  standard::Algorithm* _algo;
+  std::vector<Real> _detected;
+
+ public:
+  SuperFluxPeaksStream() {
+    declareInput(_novelty, 1, "novelty", "the input onset detection function");
+    declareOutput(_peaks, 0, "peaks", "detected peaks' instants [s], output as soon as they are detected");
+    _algo = standard::AlgorithmFactory::create("SuperFluxPeaks");
+  }
+
+  ~SuperFluxPeaksStream() {
+    delete _algo;
+  }
+
+  void declareParameters() {
+    declareParameter("frameRate", "frameRate", "(0,inf)", 172.);
+    declareParameter("threshold", "threshold for peak peaking with respect to the difference between novelty_signal and average_signal (for onsets in ambient noise)", "[0,inf)", .05);
+    declareParameter("ratioThreshold", "ratio threshold for peak picking with respect to novelty_signal/novelty_average rate, use 0 to disable it (for low-energy onsets)", "[0,inf)", 16.);
+    declareParameter("combine", "time threshold for double onsets detections (ms)", "(0,inf)", 30.);
+    declareParameter("pre_avg", "look back duration for moving average filter [ms]", "(0,inf)", 100.);
+    declareParameter("pre_max", "look back duration for moving maximum filter [ms]", "(0,inf)", 30.);
+  }
+
+  void configure() {
+    _algo->configure(_params);
+  }
+
+  AlgorithmStatus process();
+  void reset();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_SUPERFLUXPEAKSSTREAM_H
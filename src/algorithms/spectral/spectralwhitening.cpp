@@ -127,7 +127,17 @@ void SpectralWhitening::compute() {
 
   _noiseBPF.init(xPointsNoiseBPF, yPointsNoiseBPF);
 
+  // evaluate the envelope at the frequencies of all the peaks at once, which
+  // only needs a single walk over the envelope when the peaks are sorted by
+  // frequency
+  _envelopeFrequencies.clear();
+  for (int i=0; i<nPeaks; ++i) {
+    if (!(frequencies[i] > _maxFreq - incr)) _envelopeFrequencies.push_back(frequencies[i]);
+  }
+  _noiseBPF(_envelopeFrequencies, _envelope);
+
   // compute envelope and peak difference to it
+  int envelopeIndex = 0;
   for (int i=0; i<nPeaks; ++i) { //# lots of magic values below
     Real freq = frequencies[i];
     Real amp = magnitudesdB[i];
@@ -141,7 +151,7 @@ void SpectralWhitening::compute() {
                 // vectors were ordered by frequency
     }
 
-    Real ampEnv = _noiseBPF(freq);
+    Real ampEnv = _envelope[envelopeIndex++];
     if (amp < maxAmp - 40.0)
       magnitudesWhite[i] = (maxAmp - 40.0 - amp) / 2.0;
     if (amp > ampEnv)
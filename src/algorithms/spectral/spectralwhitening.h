@@ -38,6 +38,8 @@ class SpectralWhitening : public Algorithm {
   Real _spectralRange;
 
   essentia::util::BPF _noiseBPF;
+  std::vector<Real> _envelopeFrequencies;
+  std::vector<Real> _envelope;
 
  public:
   SpectralWhitening() {
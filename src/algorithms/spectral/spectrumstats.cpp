@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+#include "spectrumstats.h"
+#include "essentiamath.h"
+
+using namespace std;
+using namespace essentia;
+using namespace standard;
+
+const char* SpectrumStats::name = "SpectrumStats";
+const char* SpectrumStats::category = "Spectral";
+const char* SpectrumStats::description = DOC("This algorithm computes a set of frame-wise descriptors of a magnitude spectrum: its energy, root mean square, roll-off frequency, decrease (of the power spectrum), high-frequency coefficient (Masri), strong peak ratio, and energy in 4 contiguous frequency bands. The results are the same as those of the Energy, RMS, RollOff, Decrease (with a range equal to the Nyquist frequency, on the squared spectrum), HFC, StrongPeak and EnergyBand algorithms, but the squared spectrum is computed only once and shared by the descriptors that need it, instead of each algorithm squaring the spectrum again.\n"
+"\n"
+"The 'energyBandFrequencies' parameter gives the 5 limits of the energy bands, which by default are those used by the music and Freesound extractors. As in EnergyBand, the energy of a band includes the bins at both of its limits. Limits above the Nyquist frequency are clipped to it.\n"
+"\n"
+"An exception is thrown if the input spectrum has less than 2 elements or contains negative values, or if the band limits are negative or not in ascending order.");
+
+
+void SpectrumStats::configure() {
+  _sampleRate = parameter("sampleRate").toReal();
+  _rollOffCutoff = parameter("rollOffCutoff").toReal();
+
+  vector<Real> bandFrequencies = parameter("energyBandFrequencies").toVectorReal();
+  if (bandFrequencies.size() != 5) {
+    throw EssentiaException("SpectrumStats: 'energyBandFrequencies' must contain exactly 5 frequencies");
+  }
+
+  Real nyquist = _sampleRate / 2.0;
+  _normBandFrequencies.resize(bandFrequencies.size());
+  for (int i=0; i<(int)bandFrequencies.size(); ++i) {
+    if (bandFrequencies[i] < 0) {
+      throw EssentiaException("SpectrumStats: the energy band frequencies must be non-negative");
+    }
+    if (i > 0 && bandFrequencies[i] <= bandFrequencies[i-1]) {
+      throw EssentiaException("SpectrumStats: the energy band frequencies must be in ascending order");
+    }
+    // limits above the Nyquist frequency (e.g. the default ones at low sample
+    // rates) are clipped to it
+    _normBandFrequencies[i] = min(bandFrequencies[i], nyquist) / nyquist;
+  }
+}
+
+// same as StrongPeak::compute
+Real SpectrumStats::strongPeak(const vector<Real>& spectrum) {
+  int maxIndex = argmax(spectrum);
+  int minIndex = argmin(spectrum);
+
+  Real maxMag = spectrum[maxIndex];
+  if (maxMag == spectrum[minIndex]) return 0; // flat spectrum
+
+  Real threshold = maxMag / 2.0;
+
+  int bandwidthLeft = maxIndex;
+  while (bandwidthLeft >= 0 && spectrum[bandwidthLeft] >= threshold) {
+    bandwidthLeft--;
+  }
+  if (bandwidthLeft != 0) bandwidthLeft++;
+  else if (spectrum[0] < threshold) {
+    bandwidthLeft++;
+  }
+
+  int bandwidthRight = maxIndex;
+  do {
+    bandwidthRight++;
+  } while (bandwidthRight < int(spectrum.size()) && spectrum[bandwidthRight] >= threshold);
+
+  return maxMag / log10(bandwidthRight / Real(bandwidthLeft));
+}
+
+void SpectrumStats::compute() {
+
+  const vector<Real>& spectrum = _spectrum.get();
+
+  int size = spectrum.size();
+  if (size < 2) {
+    throw EssentiaException("SpectrumStats: the input spectrum must contain at least 2 elements");
+  }
+
+  // the accumulations below are done with the same types and in the same
+  // order as in the individual algorithms, so that the results are identical
+
+  Real bin2hz = (_sampleRate/2.0) / (Real)(size - 1);
+
+  // squared spectrum, energy, hfc
+  _power.resize(size);
+  Real energy = 0.0;
+  Real hfc = 0.0;
+  for (int i=0; i<size; ++i) {
+    Real x = spectrum[i];
+    if (x < 0) {
+      throw EssentiaException("SpectrumStats: the input spectrum contains negative values");
+    }
+    _power[i] = x*x;
+    energy += _power[i];
+    hfc += (Real)i*bin2hz * x * x;
+  }
+
+  _energy.get() = energy;
+  _rms.get() = sqrt(energy / size);
+  _hfc.get() = hfc;
+
+  // roll-off frequency and decrease of the power spectrum, which both need
+  // the total energy
+  Real cutoff = _rollOffCutoff * energy;
+  Real cumEnergy = 0.0;
+  Real rollOff = 0.0;
+  bool rollOffFound = false;
+
+  Real range = _sampleRate * 0.5;
+  Real scaler = range / (size - 1.0);
+  Real meanX = range / 2.0;
+  Real meanY = energy / size;
+  Real ssXX = 0.0;
+  Real ssXY = 0.0;
+
+  for (int i=0; i<size; ++i) {
+    Real x2 = _power[i];
+    if (!rollOffFound) {
+      cumEnergy += x2;
+      if (cumEnergy >= cutoff) {
+        rollOff = Real(i);
+        rollOffFound = true;
+      }
+    }
+    Real tmp = Real(i) * scaler - meanX;
+    ssXX += tmp * tmp;
+    ssXY += tmp * (x2 - meanY);
+  }
+
+  _rollOff.get() = rollOff * ((_sampleRate/2.0) / (size-1));
+  _decrease.get() = ssXY / ssXX;
+
+  // energy bands
+  Real* bands[] = { &_energyBandLow.get(), &_energyBandMiddleLow.get(),
+                    &_energyBandMiddleHigh.get(), &_energyBandHigh.get() };
+  for (int b=0; b<4; ++b) {
+    int start = int(round(_normBandFrequencies[b] * (size - 1)));
+    int stop = int(round(_normBandFrequencies[b+1] * (size - 1)));
+    Real energyBand = 0.0;
+    for (int i=start; i<=stop; ++i) {
+      energyBand += _power[i];
+    }
+    *bands[b] = energyBand;
+  }
+
+  _strongPeak.get() = strongPeak(spectrum);
+}
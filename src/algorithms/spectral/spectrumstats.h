@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+#ifndef ESSENTIA_SPECTRUMSTATS_H
+#define ESSENTIA_SPECTRUMSTATS_H
+
+#include "algorithm.h"
+#include "essentiautil.h"
+
+namespace essentia {
+namespace standard {
+
+class SpectrumStats : public Algorithm {
+
+ protected:
+  Input<std::vector<Real> > _spectrum;
+  Output<Real> _energy;
+  Output<Real> _rms;
+  Output<Real> _rollOff;
+  Output<Real> _decrease;
+  Output<Real> _hfc;
+  Output<Real> _strongPeak;
+  Output<Real> _energyBandLow;
+  Output<Real> _energyBandMiddleLow;
+  Output<Real> _energyBandMiddleHigh;
+  Output<Real> _energyBandHigh;
+
+  Real _sampleRate;
+  Real _rollOffCutoff;
+  std::vector<Real> _normBandFrequencies; // band limits, normalized by the Nyquist frequency
+  std::vector<Real> _power; // the squared spectrum, shared by the descriptors
+
+  Real strongPeak(const std::vector<Real>& spectrum);
+
+ public:
+  SpectrumStats() {
+    declareInput(_spectrum, "spectrum", "the input magnitude spectrum");
+    declareOutput(_energy, "energy", "the energy of the spectrum, as in Energy");
+    declareOutput(_rms, "rms", "the root mean square of the spectrum, as in RMS");
+    declareOutput(_rollOff, "rollOff", "the roll-off frequency of the spectrum [Hz], as in RollOff");
+    declareOutput(_decrease, "decrease", "the decrease of the power spectrum, as in Decrease");
+    declareOutput(_hfc, "hfc", "the high-frequency coefficient (Masri) of the spectrum, as in HFC");
+    declareOutput(_strongPeak, "strongPeak", "the strong peak ratio of the spectrum, as in StrongPeak");
+    declareOutput(_energyBandLow, "energyBandLow", "the energy of the spectrum in the first band, as in EnergyBand");
+    declareOutput(_energyBandMiddleLow, "energyBandMiddleLow", "the energy of the spectrum in the second band, as in EnergyBand");
+    declareOutput(_energyBandMiddleHigh, "energyBandMiddleHigh", "the energy of the spectrum in the third band, as in EnergyBand");
+    declareOutput(_energyBandHigh, "energyBandHigh", "the energy of the spectrum in the fourth band, as in EnergyBand");
+  }
+
+  void declareParameters() {
+    Real bandFrequencies[] = {20.0, 150.0, 800.0, 4000.0, 20000.0};
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("rollOffCutoff", "the ratio of total energy to attain before yielding the roll-off frequency", "(0,1)", 0.85);
+    declareParameter("energyBandFrequencies", "the limits of the 4 contiguous energy bands [Hz]", "", arrayToVector<Real>(bandFrequencies));
+  }
+
+  void configure();
+  void compute();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace standard
+} // namespace essentia
+
+#include "streamingalgorithmwrapper.h"
+
+namespace essentia {
+namespace streaming {
+
+class SpectrumStats : public StreamingAlgorithmWrapper {
+
+ protected:
+  Sink<std::vector<Real> > _spectrum;
+  Source<Real> _energy;
+  Source<Real> _rms;
+  Source<Real> _rollOff;
+  Source<Real> _decrease;
+  Source<Real> _hfc;
+  Source<Real> _strongPeak;
+  Source<Real> _energyBandLow;
+  Source<Real> _energyBandMiddleLow;
+  Source<Real> _energyBandMiddleHigh;
+  Source<Real> _energyBandHigh;
+
+ public:
+  SpectrumStats() {
+    declareAlgorithm("SpectrumStats");
+    declareInput(_spectrum, TOKEN, "spectrum");
+    declareOutput(_energy, TOKEN, "energy");
+    declareOutput(_rms, TOKEN, "rms");
+    declareOutput(_rollOff, TOKEN, "rollOff");
+    declareOutput(_decrease, TOKEN, "decrease");
+    declareOutput(_hfc, TOKEN, "hfc");
+    declareOutput(_strongPeak, TOKEN, "strongPeak");
+    declareOutput(_energyBandLow, TOKEN, "energyBandLow");
+    declareOutput(_energyBandMiddleLow, TOKEN, "energyBandMiddleLow");
+    declareOutput(_energyBandMiddleHigh, TOKEN, "energyBandMiddleHigh");
+    declareOutput(_energyBandHigh, TOKEN, "energyBandHigh");
+  }
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_SPECTRUMSTATS_H
@@ -65,19 +65,19 @@ void ConstantQ::compute() {
 
   const int *fftbin = &(sk->_sparseKernelIs[0]);
   const int *cqbin  = &(sk->_sparseKernelJs[0]);
-  const double   *real   = &(sk->_sparseKernelReal[0]);
-  const double   *imag   = &(sk->_sparseKernelImag[0]);
+  const PreciseReal *real = &(sk->_sparseKernelReal[0]);
+  const PreciseReal *imag = &(sk->_sparseKernelImag[0]);
   const int sparseCells = sk->_sparseKernelReal.size();
 
   for (int i = 0; i<sparseCells; i++) {
     const int row = cqbin[i];
     const int col = fftbin[i];
-    const double & r1  = real[i];
-    const double & i1  = imag[i];
-    const double & r2  = (double) signal.at( _FFTLength - col - 1 ).real();
-    const double & i2  = (double) signal.at( _FFTLength - col - 1 ).imag();
+    const PreciseReal r1 = real[i];
+    const PreciseReal i1 = imag[i];
+    const PreciseReal r2 = (PreciseReal) signal[_FFTLength - col - 1].real();
+    const PreciseReal i2 = (PreciseReal) signal[_FFTLength - col - 1].imag();
     // add the multiplication
-    constantQ.at(row) += complex <Real>((r1*r2 - i1*i2), (r1*i2 + i1*r2));
+    constantQ[row] += complex <Real>((r1*r2 - i1*i2), (r1*i2 + i1*r2));
   }    
 }
 
@@ -50,9 +50,11 @@ class ConstantQ : public Algorithm {
   int _FFTLength;
   int _uK; // Number of constant Q bins
 
+  // the kernel is computed in double precision, but stored and applied in
+  // PreciseReal, which is float in the float-only profile
   struct SparseKernel {
-    std::vector<double> _sparseKernelReal;
-    std::vector<double> _sparseKernelImag;
+    std::vector<PreciseReal> _sparseKernelReal;
+    std::vector<PreciseReal> _sparseKernelImag;
     std::vector<int> _sparseKernelIs; 
     std::vector<int> _sparseKernelJs;
   };
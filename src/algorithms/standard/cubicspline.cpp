@@ -44,8 +44,7 @@ void CubicSpline::compute() {
 
   double dy = 0.0, ddy = 0.0;
 
-  yOutput = (Real)spline_cubic_val((int)_xPoints.size(), &_xPoints[0], xInput, &_yPoints[0],
-                                   _splineSecondDerivatives, &dy, &ddy);
+  yOutput = (Real)_spline(xInput, dy, ddy);
   dyOutput = dy;
   ddyOutput = ddy;
 }
@@ -63,18 +62,8 @@ void CubicSpline::configure() {
       throw EssentiaException("CubicSpline: parameter 'xPoints' must be in ascendant order and cannot contain duplicates)");
     }
   }
-  _xPoints.resize(size);
-  _yPoints.resize(size);
-  for (int i=0; i<size; ++i) {
-    _xPoints[i] = double(x[i]);
-    _yPoints[i] = double(y[i]);
-  }
 
-  _leftBoundaryFlag = parameter("leftBoundaryFlag").toInt();
-  _leftBoundaryValue = parameter("leftBoundaryValue").toReal();
-  _rightBoundaryFlag = parameter("rightBoundaryFlag").toInt();
-  _rightBoundaryValue = parameter("rightBoundaryValue").toReal();
-  _splineSecondDerivatives = spline_cubic_set(int(_xPoints.size()), &_xPoints[0], &_yPoints[0],
-                                              _leftBoundaryFlag,  _leftBoundaryValue,
-                                              _rightBoundaryFlag, _rightBoundaryValue);
+  _spline.init(vector<double>(x.begin(), x.end()), vector<double>(y.begin(), y.end()),
+               parameter("leftBoundaryFlag").toInt(), parameter("leftBoundaryValue").toReal(),
+               parameter("rightBoundaryFlag").toInt(), parameter("rightBoundaryValue").toReal());
 }
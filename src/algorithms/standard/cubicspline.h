@@ -21,7 +21,7 @@
 #define ESSENTIA_CUBIC_SPLINE_H
 
 #include "algorithm.h"
-#include "splineutil.h"
+#include "cubicsplineutil.h"
 
 namespace essentia {
 namespace standard {
@@ -34,13 +34,7 @@ class CubicSpline : public Algorithm {
   Output<Real> _dyOutput;
   Output<Real> _ddyOutput;
 
-  std::vector<double> _xPoints;
-  std::vector<double> _yPoints;
-  int _leftBoundaryFlag;
-  int _rightBoundaryFlag;
-  double _leftBoundaryValue;
-  double _rightBoundaryValue;
-  double * _splineSecondDerivatives;
+  essentia::util::CubicSpline _spline;
 
  public:
   CubicSpline() {
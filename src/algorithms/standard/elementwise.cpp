@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "elementwise.h"
+#include "essentiamath.h"
+#include <sstream>
+
+using namespace essentia;
+using namespace standard;
+
+// the operations are computed exactly as in UnaryOperator and BinaryOperator,
+// so that a chain of these algorithms can be replaced by a single Elementwise
+// without changing the results
+
+void ElementwiseOperations::configure(const std::vector<std::string>& operations,
+                                      const std::vector<Real>& values,
+                                      const std::string& algorithmName) {
+  _algorithmName = algorithmName;
+  _types.clear();
+  _values.assign(operations.size(), 0);
+
+  for (int i=0; i<(int)operations.size(); ++i) {
+    const std::string& op = operations[i];
+    OpType type;
+    if      (op == "identity") type = IDENTITY;
+    else if (op == "abs")      type = ABS;
+    else if (op == "log10")    type = LOG10;
+    else if (op == "log")      type = LN;
+    else if (op == "ln")       type = LN;
+    else if (op == "lin2db")   type = LIN2DB;
+    else if (op == "db2lin")   type = DB2LIN;
+    else if (op == "sin")      type = SIN;
+    else if (op == "cos")      type = COS;
+    else if (op == "sqrt")     type = SQRT;
+    else if (op == "square")   type = SQUARE;
+    else if (op == "add")      type = ADD;
+    else if (op == "subtract") type = SUBTRACT;
+    else if (op == "multiply") type = MULTIPLY;
+    else if (op == "divide")   type = DIVIDE;
+    else throw EssentiaException(algorithmName, ": Unknown operation type: ", op);
+
+    if (type >= ADD) {
+      if (i >= (int)values.size()) {
+        throw EssentiaException(algorithmName, ": no value given for the binary operation #", i);
+      }
+      if (type == DIVIDE && values[i] == 0) {
+        throw EssentiaException(algorithmName, ": cannot divide by zero");
+      }
+      _values[i] = values[i];
+    }
+    _types.push_back(type);
+  }
+}
+
+inline Real square_func(Real x) {
+  return x*x;
+}
+
+#define APPLY_FUNCTION(f) {             \
+  for (int i=0; i<size; ++i) {          \
+    x[i] = f(x[i]);                     \
+  }                                     \
+  break;                                \
+}
+
+void ElementwiseOperations::applyOperation(int op, Real* x, int size, int offset) const {
+  Real value = _values[op];
+
+  switch (_types[op]) {
+
+  case IDENTITY: break;
+
+  case ABS: APPLY_FUNCTION(fabs);
+
+  case LOG10:
+    {
+      Real cutoff = 1e-30;
+      for (int i=0; i<size; ++i) {
+        if (x[i] < cutoff) x[i] = log10(cutoff);
+        else               x[i] = log10(x[i]);
+      }
+      break;
+    }
+
+  case LN:
+    {
+      Real cutoff = 1e-30;
+      for (int i=0; i<size; ++i) {
+        if (x[i] < cutoff) x[i] = log(cutoff);
+        else               x[i] = log(x[i]);
+      }
+      break;
+    }
+
+  case LIN2DB: APPLY_FUNCTION(lin2db);
+  case DB2LIN: APPLY_FUNCTION(db2lin);
+  case SIN:    APPLY_FUNCTION(sin);
+  case COS:    APPLY_FUNCTION(cos);
+
+  case SQRT:
+    {
+      for (int i=0; i<size; i++) {
+        if (x[i] < 0) {
+          std::ostringstream e;
+          e << _algorithmName << ": Cannot compute sqrt(" << x[i]
+            << "). Found in array position " << offset + i;
+          throw EssentiaException(e);
+        }
+        x[i] = sqrt(x[i]);
+      }
+      break;
+    }
+
+  case SQUARE: APPLY_FUNCTION(square_func);
+
+  case ADD:      for (int i=0; i<size; ++i) x[i] += value; break;
+  case SUBTRACT: for (int i=0; i<size; ++i) x[i] -= value; break;
+  case MULTIPLY: for (int i=0; i<size; ++i) x[i] *= value; break;
+  case DIVIDE:   for (int i=0; i<size; ++i) x[i] /= value; break;
+  }
+}
+
+void ElementwiseOperations::apply(const Real* input, Real* output, int size) const {
+  // small enough for a block to stay in L1 cache through all the operations
+  const int blockSize = 256;
+
+  for (int start=0; start<size; start+=blockSize) {
+    int n = std::min(blockSize, size - start);
+    Real* x = output + start;
+    if (x != input + start) std::copy(input + start, input + start + n, x);
+    for (int op=0; op<(int)_types.size(); ++op) applyOperation(op, x, n, start);
+  }
+}
+
+
+const char* Elementwise::name = "Elementwise";
+const char* Elementwise::category = "Standard";
+const char* Elementwise::description = DOC("This algorithm applies a sequence of operations element by element to an array, in a single pass over the array. The operations are those of UnaryOperator (identity, abs, log10, log, ln, lin2db, db2lin, sin, cos, sqrt, square), and those of BinaryOperator (add, subtract, multiply, divide) with the constant given by the corresponding element of the 'values' parameter as second operand. For instance, operations [\"multiply\", \"add\", \"log\"] and values [1000, 1, 0] compute log(1000*x + 1).\n"
+"\n"
+"A chain of UnaryOperator algorithms in a streaming network is automatically replaced by an Elementwise algorithm when the network is run, as each of them needs its own output array.\n"
+"\n"
+"Note:\n"
+"  - for log, ln, log10 and lin2db, x is clipped to 1e-30 for x<1e-30\n"
+"  - for x<0, sqrt(x) is invalid\n"
+"  - dividing by a zero constant is invalid");
+
+void Elementwise::configure() {
+  _operations.configure(parameter("operations").toVectorString(),
+                        parameter("values").toVectorReal(), "Elementwise");
+}
+
+void Elementwise::compute() {
+  const std::vector<Real>& input = _input.get();
+  std::vector<Real>& output = _output.get();
+
+  output.resize(input.size());
+  if (input.empty()) return;
+
+  _operations.apply(&input[0], &output[0], input.size());
+}
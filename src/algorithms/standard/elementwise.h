@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_ELEMENTWISE_H
+#define ESSENTIA_ELEMENTWISE_H
+
+#include "algorithm.h"
+
+namespace essentia {
+
+/**
+ * A sequence of elementwise operations, applied one after the other to each
+ * element of an array: the unary operations of UnaryOperator, and the binary
+ * operations of BinaryOperator with a constant as second operand. The array
+ * is processed in small blocks, each block going through all the operations
+ * while it is in cache.
+ */
+class ElementwiseOperations {
+ public:
+  void configure(const std::vector<std::string>& operations,
+                 const std::vector<Real>& values, const std::string& algorithmName);
+
+  void apply(const Real* input, Real* output, int size) const;
+
+ protected:
+  enum OpType {
+    IDENTITY, ABS, LOG10, LN, LIN2DB, DB2LIN, SIN, COS, SQRT, SQUARE,
+    ADD, SUBTRACT, MULTIPLY, DIVIDE
+  };
+
+  std::vector<OpType> _types;
+  std::vector<Real> _values;
+  std::string _algorithmName;
+
+  void applyOperation(int op, Real* x, int size, int offset) const;
+};
+
+namespace standard {
+
+class Elementwise : public Algorithm {
+
+ protected:
+  Input<std::vector<Real> > _input;
+  Output<std::vector<Real> > _output;
+
+  ElementwiseOperations _operations;
+
+ public:
+  Elementwise() {
+    declareInput(_input, "array", "the input array");
+    declareOutput(_output, "array", "the input array transformed by the operations");
+  }
+
+  void declareParameters() {
+    declareParameter("operations", "the operations to apply in sequence to each element, among identity, abs, log10, log, ln, lin2db, db2lin, sin, cos, sqrt, square (unary), and add, subtract, multiply, divide (with a constant)", "", std::vector<std::string>());
+    declareParameter("values", "the constant second operand of each binary operation (ignored for unary operations)", "", std::vector<Real>());
+  }
+
+  void configure();
+  void compute();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace standard
+} // namespace essentia
+
+#include "streamingalgorithmwrapper.h"
+
+namespace essentia {
+namespace streaming {
+
+class Elementwise : public StreamingAlgorithmWrapper {
+
+ protected:
+  Sink<std::vector<Real> > _input;
+  Source<std::vector<Real> > _output;
+
+ public:
+  Elementwise() {
+    declareAlgorithm("Elementwise");
+    declareInput(_input, TOKEN, "array");
+    declareOutput(_output, TOKEN, "array");
+  }
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_ELEMENTWISE_H
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "elementwisestream.h"
+
+using namespace essentia;
+using namespace standard;
+
+const char* ElementwiseStream::name = "ElementwiseStream";
+const char* ElementwiseStream::category = "Standard";
+const char* ElementwiseStream::description = DOC("This algorithm applies a sequence of operations element by element to an array, as Elementwise does. In streaming mode, it processes a stream of Reals instead of a stream of arrays, and replaces chains of UnaryOperatorStream algorithms.");
+
+void ElementwiseStream::configure() {
+  _operations.configure(parameter("operations").toVectorString(),
+                        parameter("values").toVectorReal(), "ElementwiseStream");
+}
+
+void ElementwiseStream::compute() {
+  const std::vector<Real>& input = _input.get();
+  std::vector<Real>& output = _output.get();
+
+  output.resize(input.size());
+  if (input.empty()) return;
+
+  _operations.apply(&input[0], &output[0], input.size());
+}
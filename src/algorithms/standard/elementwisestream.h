@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_ELEMENTWISESTREAM_H
+#define ESSENTIA_ELEMENTWISESTREAM_H
+
+#include "elementwise.h"
+
+namespace essentia {
+namespace standard {
+
+// Same as Elementwise, but the streaming mode processes a stream of Reals
+// instead of a stream of arrays, as UnaryOperatorStream does.
+
+class ElementwiseStream : public Algorithm {
+
+ protected:
+  Input<std::vector<Real> > _input;
+  Output<std::vector<Real> > _output;
+
+  ElementwiseOperations _operations;
+
+ public:
+  ElementwiseStream() {
+    declareInput(_input, "array", "the input array");
+    declareOutput(_output, "array", "the input array transformed by the operations");
+  }
+
+  void declareParameters() {
+    declareParameter("operations", "the operations to apply in sequence to each element, among identity, abs, log10, log, ln, lin2db, db2lin, sin, cos, sqrt, square (unary), and add, subtract, multiply, divide (with a constant)", "", std::vector<std::string>());
+    declareParameter("values", "the constant second operand of each binary operation (ignored for unary operations)", "", std::vector<Real>());
+  }
+
+  void configure();
+  void compute();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace standard
+} // namespace essentia
+
+#include "streamingalgorithmwrapper.h"
+
+namespace essentia {
+namespace streaming {
+
+class ElementwiseStream : public StreamingAlgorithmWrapper {
+
+ protected:
+  Sink<Real> _input;
+  Source<Real> _output;
+
+  static const int preferredSize = 4096;
+
+ public:
+  ElementwiseStream() {
+    declareAlgorithm("ElementwiseStream");
+    declareInput(_input, STREAM, preferredSize, "array");
+    declareOutput(_output, STREAM, preferredSize, "array");
+
+    _output.setBufferType(BufferUsage::forAudioStream);
+  }
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_ELEMENTWISESTREAM_H
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "multichanneldemuxer.h"
+#include "essentiautil.h"
+
+using namespace std;
+
+namespace essentia {
+
+// copies size samples of the given channel, starting at sample begin, into
+// output. A monophonic signal has a zero right channel, as in StereoDemuxer.
+static void demux(const vector<vector<Real> >& audio, int channel, bool isRight,
+                  int begin, int size, AudioSample* output) {
+  int nChannels = audio.size();
+
+  if (nChannels == 1 && isRight) {
+    fill(output, output + size, (AudioSample)0.0);
+    return;
+  }
+  if (channel >= nChannels) {
+    throw EssentiaException("MultiChannelDemuxer: cannot output channel ", channel,
+                            ", the input signal does not have that many channels");
+  }
+
+  const Real* in = &audio[channel][0] + begin;
+  copy(in, in + size, output);
+}
+
+namespace standard {
+
+const char* MultiChannelDemuxer::name = "MultiChannelDemuxer";
+const char* MultiChannelDemuxer::category = "Standard";
+const char* MultiChannelDemuxer::description = DOC("This algorithm outputs two channels of a multichannel signal separately, as left and right channels, which can then be used for stereo analysis. The input signal is planar (channels x samples), as output by MultiChannelAudioLoader, and may have any number of channels. The output channels are selected by the 'leftChannel' and 'rightChannel' parameters. It is the planar counterpart of StereoDemuxer; for instance, its outputs can be framed and fed to Spectrum to compute the Panning of a pair of channels.\n"
+"\n"
+"If the signal is monophonic, it outputs a zero signal on the right channel. An exception is thrown if the channels of the input signal have different lengths, or if a selected channel does not exist.");
+
+void MultiChannelDemuxer::configure() {
+  _leftChannel = parameter("leftChannel").toInt();
+  _rightChannel = parameter("rightChannel").toInt();
+}
+
+void MultiChannelDemuxer::compute() {
+  const vector<vector<Real> >& audio = _audio.get();
+  vector<AudioSample>& left = _left.get();
+  vector<AudioSample>& right = _right.get();
+
+  int size = planarSize(audio, "MultiChannelDemuxer");
+  left.resize(size);
+  right.resize(size);
+  if (size == 0) return;
+
+  demux(audio, _leftChannel, false, 0, size, &left[0]);
+  demux(audio, _rightChannel, true, 0, size, &right[0]);
+}
+
+} // namespace standard
+} // namespace essentia
+
+namespace essentia {
+namespace streaming {
+
+const char* MultiChannelDemuxer::name = standard::MultiChannelDemuxer::name;
+const char* MultiChannelDemuxer::category = standard::MultiChannelDemuxer::category;
+const char* MultiChannelDemuxer::description = standard::MultiChannelDemuxer::description;
+
+void MultiChannelDemuxer::configure() {
+  _leftChannel = parameter("leftChannel").toInt();
+  _rightChannel = parameter("rightChannel").toInt();
+}
+
+void MultiChannelDemuxer::reset() {
+  Algorithm::reset();
+  _offset = 0;
+}
+
+AlgorithmStatus MultiChannelDemuxer::process() {
+  if (!_audio.acquire(1)) return NO_INPUT;
+
+  const vector<vector<Real> >& block = _audio.firstToken();
+  int size = planarSize(block, "MultiChannelDemuxer");
+
+  // large blocks are output in several pieces, so that we never need to
+  // acquire more than _preferredBufferSize tokens at once
+  int n = min(size - _offset, _preferredBufferSize);
+  if (n > 0) {
+    if (!_left.acquire(n) || !_right.acquire(n)) return NO_OUTPUT;
+
+    demux(block, _leftChannel, false, _offset, n, &_left.firstToken());
+    demux(block, _rightChannel, true, _offset, n, &_right.firstToken());
+
+    _left.release(n);
+    _right.release(n);
+    _offset += n;
+  }
+
+  if (_offset >= size) {
+    _audio.release(1);
+    _offset = 0;
+  }
+
+  return OK;
+}
+
+} // namespace streaming
+} // namespace essentia
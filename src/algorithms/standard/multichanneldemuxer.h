@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_STREAMING_MULTICHANNELDEMUXER_H
+#define ESSENTIA_STREAMING_MULTICHANNELDEMUXER_H
+
+#include "algorithm.h"
+
+namespace essentia {
+namespace standard {
+
+class MultiChannelDemuxer : public Algorithm {
+
+ protected:
+  Input<std::vector<std::vector<Real> > > _audio;
+  Output<std::vector<AudioSample> > _left;
+  Output<std::vector<AudioSample> > _right;
+
+  int _leftChannel;
+  int _rightChannel;
+
+ public:
+  MultiChannelDemuxer() {
+    declareInput(_audio, "audio", "the input multichannel signal (channels x samples)");
+    declareOutput(_left, "left", "the channel of the audio signal selected by 'leftChannel'");
+    declareOutput(_right, "right", "the channel of the audio signal selected by 'rightChannel'");
+  }
+
+  void declareParameters() {
+    declareParameter("leftChannel", "the index of the channel to output as left channel", "[0,inf)", 0);
+    declareParameter("rightChannel", "the index of the channel to output as right channel", "[0,inf)", 1);
+  }
+
+  ~MultiChannelDemuxer() {}
+
+  void configure();
+  void compute();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace standard
+} // namespace essentia
+
+
+#include "streamingalgorithm.h"
+
+namespace essentia {
+namespace streaming {
+
+class MultiChannelDemuxer : public Algorithm {
+ protected:
+  Sink<std::vector<std::vector<Real> > > _audio;
+  Source<AudioSample> _left;
+  Source<AudioSample> _right;
+
+  int _leftChannel;
+  int _rightChannel;
+  int _preferredBufferSize;
+  int _offset; // position in the current input block
+
+ public:
+  MultiChannelDemuxer() : Algorithm(), _offset(0) {
+    _preferredBufferSize = 4096; // arbitrary
+    declareInput(_audio, 1, "audio", "the input multichannel signal, as planar blocks (channels x samples)");
+    declareOutput(_left, 0, "left", "the channel of the audio signal selected by 'leftChannel'");
+    declareOutput(_right, 0, "right", "the channel of the audio signal selected by 'rightChannel'");
+
+    _left.setBufferType(BufferUsage::forAudioStream);
+    _right.setBufferType(BufferUsage::forAudioStream);
+  }
+
+  ~MultiChannelDemuxer() {}
+
+  AlgorithmStatus process();
+  void reset();
+
+  void declareParameters() {
+    declareParameter("leftChannel", "the index of the channel to output as left channel", "[0,inf)", 0);
+    declareParameter("rightChannel", "the index of the channel to output as right channel", "[0,inf)", 1);
+  }
+
+  void configure();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_STREAMING_MULTICHANNELDEMUXER_H
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "multichannelmixer.h"
+#include "essentiamath.h"
+#include "essentiautil.h"
+
+using namespace std;
+
+namespace essentia {
+
+// writes size downmixed samples, starting at sample begin, into output
+static void downmix(const vector<vector<Real> >& audio, bool mix, int channel,
+                    int begin, int size, Real* output) {
+  int nChannels = audio.size();
+
+  if (!mix) {
+    if (channel >= nChannels) {
+      throw EssentiaException("MultiChannelMixer: cannot output channel ", channel,
+                              ", the input signal does not have that many channels");
+    }
+    const Real* in = &audio[channel][0] + begin;
+    copy(in, in + size, output);
+    return;
+  }
+
+  // accumulate one whole plane at a time, so that each pass is a contiguous
+  // loop over the samples of a single channel
+  const Real* in = &audio[0][0] + begin;
+  copy(in, in + size, output);
+  for (int c=1; c<nChannels; ++c) {
+    in = &audio[c][0] + begin;
+    for (int i=0; i<size; ++i) output[i] += in[i];
+  }
+  if (nChannels > 1) {
+    Real norm = 1.0 / nChannels;
+    for (int i=0; i<size; ++i) output[i] *= norm;
+  }
+}
+
+namespace standard {
+
+const char* MultiChannelMixer::name = "MultiChannelMixer";
+const char* MultiChannelMixer::category = "Standard";
+const char* MultiChannelMixer::description = DOC("This algorithm downmixes a multichannel signal into a single channel. The input signal is planar (channels x samples), as output by MultiChannelAudioLoader, and may have any number of channels. With type 'mix', the output is the average of all the channels; with type 'channel', the output is the channel given by the 'channel' parameter. It is the planar counterpart of MonoMixer, which only accepts mono and stereo signals.\n"
+"\n"
+"An exception is thrown if the channels of the input signal have different lengths, or if the selected channel does not exist.\n"
+"\n"
+"References:\n"
+"  [1] downmixing - Wikipedia, the free encyclopedia,\n"
+"  http://en.wikipedia.org/wiki/Downmixing\n");
+
+void MultiChannelMixer::configure() {
+  _type = parameter("type").toLower();
+  _channel = parameter("channel").toInt();
+}
+
+void MultiChannelMixer::compute() {
+  const vector<vector<Real> >& input = _inputAudio.get();
+  vector<Real>& output = _outputAudio.get();
+
+  int size = planarSize(input, "MultiChannelMixer");
+  output.resize(size);
+  if (size == 0) return;
+
+  downmix(input, _type == "mix", _channel, 0, size, &output[0]);
+}
+
+} // namespace standard
+} // namespace essentia
+
+namespace essentia {
+namespace streaming {
+
+const char* MultiChannelMixer::name = standard::MultiChannelMixer::name;
+const char* MultiChannelMixer::category = standard::MultiChannelMixer::category;
+const char* MultiChannelMixer::description = standard::MultiChannelMixer::description;
+
+void MultiChannelMixer::configure() {
+  _type = parameter("type").toLower();
+  _channel = parameter("channel").toInt();
+}
+
+void MultiChannelMixer::reset() {
+  Algorithm::reset();
+  _offset = 0;
+}
+
+AlgorithmStatus MultiChannelMixer::process() {
+  if (!_inputAudio.acquire(1)) return NO_INPUT;
+
+  const vector<vector<Real> >& block = _inputAudio.firstToken();
+  int size = planarSize(block, "MultiChannelMixer");
+
+  // large blocks are output in several pieces, so that we never need to
+  // acquire more than _preferredBufferSize tokens at once
+  int n = min(size - _offset, _preferredBufferSize);
+  if (n > 0) {
+    if (!_outputAudio.acquire(n)) return NO_OUTPUT;
+
+    downmix(block, _type == "mix", _channel, _offset, n, &_outputAudio.firstToken());
+
+    _outputAudio.release(n);
+    _offset += n;
+  }
+
+  if (_offset >= size) {
+    _inputAudio.release(1);
+    _offset = 0;
+  }
+
+  return OK;
+}
+
+} // namespace streaming
+} // namespace essentia
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_STREAMING_MULTICHANNELMIXER_H
+#define ESSENTIA_STREAMING_MULTICHANNELMIXER_H
+
+#include "algorithm.h"
+
+namespace essentia {
+namespace standard {
+
+class MultiChannelMixer : public Algorithm {
+
+ protected:
+  Input<std::vector<std::vector<Real> > > _inputAudio;
+  Output<std::vector<Real> > _outputAudio;
+
+  std::string _type;
+  int _channel;
+
+ public:
+  MultiChannelMixer() {
+    declareInput(_inputAudio, "audio", "the input multichannel signal (channels x samples)");
+    declareOutput(_outputAudio, "audio", "the downmixed signal");
+  }
+
+  void declareParameters() {
+    declareParameter("type", "the type of downmixing performed: average of all channels or selection of a single channel", "{mix,channel}", "mix");
+    declareParameter("channel", "the index of the channel to output when type is 'channel'", "[0,inf)", 0);
+  }
+
+  ~MultiChannelMixer() {}
+
+  void configure();
+  void compute();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace standard
+} // namespace essentia
+
+
+#include "streamingalgorithm.h"
+
+namespace essentia {
+namespace streaming {
+
+class MultiChannelMixer : public Algorithm {
+ protected:
+  Sink<std::vector<std::vector<Real> > > _inputAudio;
+  Source<Real> _outputAudio;
+
+  std::string _type;
+  int _channel;
+  int _preferredBufferSize;
+  int _offset; // position in the current input block
+
+ public:
+  MultiChannelMixer() : Algorithm(), _offset(0) {
+    _preferredBufferSize = 4096; // arbitrary
+    declareInput(_inputAudio, 1, "audio", "the input multichannel signal, as planar blocks (channels x samples)");
+    declareOutput(_outputAudio, 0, "audio", "the downmixed signal");
+
+    _outputAudio.setBufferType(BufferUsage::forAudioStream);
+  }
+
+  ~MultiChannelMixer() {}
+
+  AlgorithmStatus process();
+  void reset();
+
+  void declareParameters() {
+    declareParameter("type", "the type of downmixing performed: average of all channels or selection of a single channel", "{mix,channel}", "mix");
+    declareParameter("channel", "the index of the channel to output when type is 'channel'", "[0,inf)", 0);
+  }
+
+  void configure();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace streaming
+} // namespace essentia
+
+
+#endif // ESSENTIA_STREAMING_MULTICHANNELMIXER_H
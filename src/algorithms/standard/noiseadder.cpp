@@ -25,22 +25,20 @@ using namespace standard;
 
 const char* NoiseAdder::name = "NoiseAdder";
 const char* NoiseAdder::category = "Standard";
-const char* NoiseAdder::description = DOC("This algorithm adds noise to an input signal. The average energy of the noise in dB is defined by the level parameter, and is generated using the Mersenne Twister random number generator.\n"
+const char* NoiseAdder::description = DOC("This algorithm adds noise to an input signal. The average energy of the noise in dB is defined by the level parameter, and the noise is uniformly distributed. It is generated in blocks with the Philox counter-based random number generator, so that the same seed always gives the same noise, whatever the size of the input signals.\n"
 "\n"
 "References:\n"
-"  [1] Mersenne Twister: A random number generator (since 1997/10),\n"
-"  http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/emt.html\n\n"
-"  [2] Mersenne twister - Wikipedia, the free encyclopedia,\n"
-"  http://en.wikipedia.org/wiki/Mersenne_twister");
+"  [1] J. K. Salmon, M. A. Moraes, R. O. Dror, and D. E. Shaw, \"Parallel\n"
+"  random numbers: as easy as 1, 2, 3,\" in Proceedings of the International\n"
+"  Conference for High Performance Computing, Networking, Storage and\n"
+"  Analysis (SC'11), 2011.");
 
 
 void NoiseAdder::configure() {
   _level = db2pow(parameter("level").toReal());
   if (parameter("fixSeed").toBool()) {
-    unsigned long seed = 0;
-    _mtrand.seed(seed);
+    _random.seed(parameter("seed").toInt());
   }
-
 }
 
 void NoiseAdder::compute() {
@@ -49,12 +47,10 @@ void NoiseAdder::compute() {
 
   std::vector<Real>::size_type size = signal.size();
   noise.resize(size);
+  if (size == 0) return;
+
+  _random.uniform(noise, -_level, _level);
   for (std::vector<Real>::size_type i=0; i<size; i++) {
-#ifdef CPP_11
-    noise[i] = signal[i] + _level * (Real(_mtrand())/std::mt19937::max()*2.0f - 1.0f);
-#else
-    noise[i] = signal[i] + _level * (Real(_mtrand())*2.0f - 1.0f);
-#endif
+    noise[i] += signal[i];
   }
-
 }
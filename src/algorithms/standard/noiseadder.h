@@ -21,15 +21,7 @@
 #define ESSENTIA_NOISEADDER_H
 
 #include "algorithm.h"
-
-#ifdef CPP_11
-#  include <random>
-#else
-// The implementation for non C++11 compilers uses the MersenneTwister.h file
-// downloaded from:
-// http://www-personal.engin.umich.edu/~wagnerr/MersenneTwister.html
-#  include "MersenneTwister.h"
-#endif
+#include "randomgenerator.h"
 
 namespace essentia {
 namespace standard {
@@ -40,27 +32,20 @@ class NoiseAdder : public Algorithm {
   Input<std::vector<Real> > _signal;
   Output<std::vector<Real> > _noise;
 
-#ifdef CPP_11
-  std::mt19937 _mtrand;
-#else
-  MTRand _mtrand;
-#endif
+  RandomGenerator _random;
 
   Real _level;
 
  public:
-  NoiseAdder()
-#ifdef CPP_11
-      : _mtrand(time(NULL) ^ clock())
-#endif
-  {
+  NoiseAdder() : _random(RandomGenerator::randomSeed()) {
     declareInput(_signal, "signal", "the input signal");
     declareOutput(_noise, "signal", "the output signal with the added noise");
   }
 
   void declareParameters() {
     declareParameter("level", "power level of the noise generator [dB]", "(-inf,0]", -100);
-    declareParameter("fixSeed", "if true, 0 is used as the seed for generating random values", "{true,false}", false);
+    declareParameter("fixSeed", "if true, the 'seed' parameter is used as the seed for generating random values", "{true,false}", false);
+    declareParameter("seed", "the seed used if fixSeed is true, e.g. a different one for each of the files processed in parallel in a reproducible way", "[0,inf)", 0);
   }
 
   void configure();
@@ -49,12 +49,36 @@ void PeakDetection::configure() {
     throw EssentiaException("PeakDetection: The minimum position has to be less than the maximum position");
   }
 
+  if (_orderBy != "position" && _orderBy != "amplitude") {
+    throw EssentiaException("PeakDetection: Unsupported ordering type: '" + _orderBy + "'");
+  }
+
   // blunt test to make sure some compiler which we won't name isn't going berserk...
   std::vector<Peak> v;
   v.resize(1);
   assert(v.size() == 1);
 }
 
+// Returns the index of the first element in [begin, end) which is above the
+// threshold, or end if there is none. Values are tested in blocks without
+// early exit so that the compiler can vectorize the comparisons.
+static inline int firstAboveThreshold(const std::vector<Real>& array,
+                                      int begin, int end, Real threshold) {
+  const int blockSize = 8;
+  int k = begin;
+  for (; k+blockSize <= end; k+=blockSize) {
+    int above = 0;
+    for (int b=0; b<blockSize; b++) {
+      above |= (array[k+b] > threshold);
+    }
+    if (above) break;
+  }
+  while (k < end && !(array[k] > threshold)) {
+    k++;
+  }
+  return k;
+}
+
 void PeakDetection::compute() {
 
   const std::vector<Real>& array = _array.get();
@@ -72,8 +96,8 @@ void PeakDetection::compute() {
   // which makes more sense in general?
   const Real scale = _range / (Real)(size - 1);
 
-  std::vector<Peak> peaks;
-  peaks.reserve(size);
+  std::vector<Peak>& peaks = _peaks;
+  peaks.clear();
 
   // we want to round up to the next integer instead of simple truncation,
   // otherwise the peak frequency at i can be lower than _minPos
@@ -87,6 +111,15 @@ void PeakDetection::compute() {
   }
 
   while(true) {
+    // skip the regions below threshold, they cannot contain any peak. We
+    // resume on the element just before the first one above threshold, where
+    // the array is necessarily climbing
+    if (i+1 < size-1 && !(array[i] > _threshold)) {
+      int k = firstAboveThreshold(array, i+1, size-1, _threshold);
+      if (k >= size-1) break;
+      i = k-1;
+    }
+
     // going down
     while (i+1 < size-1 && array[i] >= array[i+1]) {
       i++;
@@ -170,16 +203,12 @@ void PeakDetection::compute() {
 
   if (_orderBy == "amplitude") {
     // sort peaks by magnitude, in case of equality,
-    // return the one having smaller position
-    std::sort(peaks.begin(), peaks.end(),
-              ComparePeakMagnitude<std::greater<Real>, std::less<Real> >());
-  }
-  else if (_orderBy == "position") {
-    // they're already sorted by position
-  }
-  else {
-    throw EssentiaException("PeakDetection: Unsupported ordering type: '" + _orderBy + "'");
+    // return the one having smaller position. Positions are unique, so the
+    // ordering is total and only the wanted peaks need to be sorted
+    std::partial_sort(peaks.begin(), peaks.begin() + nWantedPeaks, peaks.end(),
+                      ComparePeakMagnitude<std::greater<Real>, std::less<Real> >());
   }
+  // otherwise, they're already sorted by position
 
   peakPosition.resize(nWantedPeaks);
   peakValue.resize(nWantedPeaks);
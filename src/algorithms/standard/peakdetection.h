@@ -21,6 +21,7 @@
 #define ESSENTIA_PEAKDETECTION_H
 
 #include "algorithm.h"
+#include "peak.h"
 
 namespace essentia {
 namespace standard {
@@ -40,6 +41,10 @@ class PeakDetection : public Algorithm {
   bool _interpolate;
   std::string _orderBy;
 
+  // buffer of detected peaks, kept between calls to avoid reallocating it on
+  // every frame
+  std::vector<util::Peak> _peaks;
+
  public:
   PeakDetection() {
     declareInput(_array, "array", "the input array");
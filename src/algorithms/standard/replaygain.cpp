@@ -19,7 +19,7 @@
 
 #include "replaygain.h"
 #include "essentiamath.h"
-#include <algorithm> // sort
+#include <algorithm> // nth_element
 
 using namespace std;
 
@@ -85,8 +85,9 @@ void ReplayGain::compute() {
 
   // 3. Statistical processing, as described in the algorithm, the 5% point is taken to
   // represent the overall loudness of the input audio signal
-  sort(rms.begin(), rms.end());
-  Real loudness = rms[(int)(0.95*rms.size())];
+  vector<Real>::iterator percentile = rms.begin() + (int)(0.95*rms.size());
+  nth_element(rms.begin(), percentile, rms.end());
+  Real loudness = *percentile;
 
   // 4. Calibration with reference level
   // file is ref_pink.wav, downloaded on reference site (www.replaygain.org)
@@ -175,9 +176,10 @@ AlgorithmStatus ReplayGain::process() {
   vector<Real>& powerValues = const_cast<vector<Real>&>(_pool.value<vector<Real> >("internal.power"));
 
   // 3. Statistical processing
-  sort(powerValues.begin(), powerValues.end());
   int size = powerValues.size();
-  Real loudness = pow2db(powerValues[(int)(0.95*size)]);
+  vector<Real>::iterator percentile = powerValues.begin() + (int)(0.95*size);
+  nth_element(powerValues.begin(), percentile, powerValues.end());
+  Real loudness = pow2db(*percentile);
 
   // 4. Calibration with reference level
   // file is ref_pink.wav, downloaded on reference site (www.replaygain.org)
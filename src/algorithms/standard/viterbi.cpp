@@ -28,7 +28,7 @@ const char* Viterbi::name = "Viterbi";
 const char* Viterbi::category = "Statistics";
 const char* Viterbi::description = DOC("This algorithm estimates the most-likely path by Viterbi algorithm. It is used in PitchYinProbabilistiesHMM algorithm.\n"
 "\n"
-"This Viterbi algorithm returns the most likely path. The internal variable calculation uses double for a better precision.\n"
+"This Viterbi algorithm returns the most likely path. The internal variable calculation uses double for a better precision, unless Essentia was built with the float-only profile.\n"
 "\n"
 "References:\n"
 "  [1] M. Mauch and S. Dixon, \"pYIN: A Fundamental Frequency Estimator\n"
@@ -56,14 +56,20 @@ void Viterbi::compute() {
   // check for consistency    
   size_t nTrans = transProb.size();
   
-  // declaring variables, use double for a better precision
-  vector<double> delta = vector<double>(nState);
-  vector<double> oldDelta = vector<double>(nState);
-  vector<vector<int> > psi; //  "matrix" of remembered indices of the best transitions
-  
+  // declaring variables, use higher precision for the deltas
+  vector<PreciseReal>& delta = _delta;
+  vector<PreciseReal>& oldDelta = _oldDelta;
+  delta.assign(nState, 0.0);
+  oldDelta.assign(nState, 0.0);
+
+  // "matrix" of remembered indices of the best transitions, stored as one
+  // contiguous nFrame x nState buffer reused between calls
+  _psi.assign(nFrame*nState, 0);
+  int* psi = &_psi[0];
+
   _tempPath.resize(nFrame);
 
-  double deltasum = 0;
+  PreciseReal deltasum = 0;
 
   // initialise first frame
   for (size_t iState = 0; iState < nState; ++iState)
@@ -77,19 +83,17 @@ void Viterbi::compute() {
       oldDelta[iState] /= deltasum; // normalise (scale)
   }
 
-  psi.push_back(vector<int>(nState,0));
-
   // rest of forward step
   for (size_t iFrame = 1; iFrame < nFrame; ++iFrame)
   {
       deltasum = 0;
-      psi.push_back(vector<int>(nState,0));
+      int* framePsi = psi + iFrame*nState;
 
       // calculate best previous state for every current state
       size_t fromState;
       size_t toState;
-      double currentTransProb;
-      double currentValue;
+      PreciseReal currentTransProb;
+      PreciseReal currentValue;
       
       // this is the "sparse" loop
       for (size_t iTrans = 0; iTrans < nTrans; ++iTrans)
@@ -102,7 +106,7 @@ void Viterbi::compute() {
           if (currentValue > delta[toState])
           {
               delta[toState] = currentValue; // will be multiplied by the right obs later!
-              psi[iFrame][toState] = fromState;
+              framePsi[toState] = fromState;
           }            
       }
       
@@ -130,11 +134,11 @@ void Viterbi::compute() {
       }
   }
 
-  // initialise backward step, use double for a better precision
-  double bestValue = 0;
+  // initialise backward step
+  PreciseReal bestValue = 0;
   for (size_t iState = 0; iState < nState; ++iState)
   {
-      double currentValue = oldDelta[iState];
+      PreciseReal currentValue = oldDelta[iState];
       if (currentValue > bestValue)
       {
           bestValue = currentValue;            
@@ -145,7 +149,7 @@ void Viterbi::compute() {
   // rest of backward step
   for (int iFrame = nFrame-2; iFrame != -1; --iFrame)
   {
-      _tempPath[iFrame] = psi[iFrame+1][_tempPath[iFrame+1]];
+      _tempPath[iFrame] = psi[(iFrame+1)*nState + _tempPath[iFrame+1]];
   }
 
   path = _tempPath;
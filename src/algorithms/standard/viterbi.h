@@ -36,6 +36,9 @@ class Viterbi : public Algorithm {
   Output<std::vector<int> > _path;
 
   std::vector<int> _tempPath; 
+  std::vector<int> _psi;
+  std::vector<PreciseReal> _delta;
+  std::vector<PreciseReal> _oldDelta;
 
  public:
   Viterbi() {
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+#include "bandstats.h"
+#include "essentiamath.h"
+
+using namespace std;
+using namespace essentia;
+using namespace standard;
+
+const char* BandStats::name = "BandStats";
+const char* BandStats::category = "Statistics";
+const char* BandStats::description = DOC("This algorithm computes the statistics that describe the shape of an array of band energies (e.g. the output of MelBands, ERBBands or BarkBands): the spread, skewness and kurtosis of the bands seen as a distribution, their flatness in dB and their crest. The results are the same as those of CentralMoments (in 'pdf' mode) followed by DistributionShape, FlatnessDB and Crest, but they are computed together in a single algorithm, with two passes over the input array.\n"
+"\n"
+"An exception is thrown if the input array has less than 2 elements or contains negative values.\n"
+"\n"
+"References:\n"
+"  [1] G. Peeters, \"A large set of audio features for sound description\n"
+"  (similarity and classification) in the CUIDADO project,\" CUIDADO I.S.T.\n"
+"  Project Report, 2004.");
+
+
+void BandStats::configure() {
+  _range = parameter("range").toReal();
+}
+
+void BandStats::compute() {
+
+  const vector<Real>& bands = _bands.get();
+  Real& spread = _spread.get();
+  Real& skewness = _skewness.get();
+  Real& kurtosis = _kurtosis.get();
+  Real& flatnessDB = _flatnessDB.get();
+  Real& crest = _crest.get();
+
+  int size = bands.size();
+  if (size < 2) {
+    throw EssentiaException("BandStats: the input array must contain at least 2 elements");
+  }
+
+  // first pass: everything that does not depend on the centroid. The sums use
+  // the same types and order as Flatness, Crest and CentralMoments, so that
+  // the results are identical to theirs.
+  Real sum = 0.0;
+  Real logSum = 0.0;
+  bool hasZero = false;
+  Real maximum = bands[0];
+  double norm = 0.0;
+  double centroid = 0.0;
+  double scale = 1.0 / (size - 1);
+
+  for (int i=0; i<size; ++i) {
+    Real x = bands[i];
+    if (x < 0) {
+      throw EssentiaException("BandStats: the input array contains negative values");
+    }
+    sum += x;
+    if (x == 0.0) hasZero = true;
+    else logSum += log(x);
+    if (x > maximum) maximum = x;
+    norm += x;
+    centroid += (i*scale) * x;
+  }
+
+  Real arithmeticMean = sum / size;
+
+  // flatness in dB (see Flatness, FlatnessDB)
+  if (hasZero) {
+    flatnessDB = 1.0; // default value chosen for silent signals
+  }
+  else {
+    Real geometricMean = exp(logSum / (Real)size);
+    Real flatness = geometricMean / arithmeticMean;
+    flatnessDB = flatness <= 0.0 ? 1.0 : min(Real(lin2db(flatness)/-60.0), Real(1.0));
+  }
+
+  // crest (see Crest)
+  crest = maximum == 0.0 ? 0.0 : maximum / arithmeticMean;
+
+  // second pass: central moments of the bands seen as a distribution over the
+  // normalized range [0,1] (see CentralMoments), and shape of this
+  // distribution (see DistributionShape)
+  if (norm == 0.0) {
+    spread = 0.0;
+    skewness = 0.0;
+    kurtosis = -3.0;
+    return;
+  }
+  centroid /= norm;
+
+  double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+  for (int i=0; i<size; ++i) {
+    double v = (i*scale) - centroid;
+    double v2 = v*v;
+    double v2f = v2 * bands[i];
+    m2 += v2f;
+    m3 += v2f * v;
+    m4 += v2f * v2;
+  }
+
+  double r = _range;
+  Real moment2 = (m2 / norm) * r*r;
+  Real moment3 = (m3 / norm) * r*r*r;
+  Real moment4 = (m4 / norm) * r*r*r*r;
+
+  spread = moment2;
+  if (spread == 0.0) {
+    skewness = 0.0;
+    kurtosis = -3.0;
+  }
+  else {
+    skewness = (Real)(moment3 / pow(spread, (Real)1.5));
+    kurtosis = (moment4 / (spread * spread)) - 3.0;
+  }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+#ifndef ESSENTIA_BANDSTATS_H
+#define ESSENTIA_BANDSTATS_H
+
+#include "algorithm.h"
+
+namespace essentia {
+namespace standard {
+
+class BandStats : public Algorithm {
+
+ protected:
+  Input<std::vector<Real> > _bands;
+  Output<Real> _spread;
+  Output<Real> _skewness;
+  Output<Real> _kurtosis;
+  Output<Real> _flatnessDB;
+  Output<Real> _crest;
+
+  double _range;
+
+ public:
+  BandStats() {
+    declareInput(_bands, "bands", "the input band energies (must be non-negative)");
+    declareOutput(_spread, "spread", "the spread (variance) of the bands, as in DistributionShape");
+    declareOutput(_skewness, "skewness", "the skewness of the bands, as in DistributionShape");
+    declareOutput(_kurtosis, "kurtosis", "the kurtosis of the bands, as in DistributionShape");
+    declareOutput(_flatnessDB, "flatnessDB", "the flatness of the bands in dB, as in FlatnessDB");
+    declareOutput(_crest, "crest", "the crest of the bands, as in Crest");
+  }
+
+  void declareParameters() {
+    declareParameter("range", "the range of the input array, used for normalizing the central moments (see CentralMoments in 'pdf' mode)", "(0,inf)", 1.0);
+  }
+
+  void configure();
+  void compute();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace standard
+} // namespace essentia
+
+#include "streamingalgorithmwrapper.h"
+
+namespace essentia {
+namespace streaming {
+
+class BandStats : public StreamingAlgorithmWrapper {
+
+ protected:
+  Sink<std::vector<Real> > _bands;
+  Source<Real> _spread;
+  Source<Real> _skewness;
+  Source<Real> _kurtosis;
+  Source<Real> _flatnessDB;
+  Source<Real> _crest;
+
+ public:
+  BandStats() {
+    declareAlgorithm("BandStats");
+    declareInput(_bands, TOKEN, "bands");
+    declareOutput(_spread, TOKEN, "spread");
+    declareOutput(_skewness, TOKEN, "skewness");
+    declareOutput(_kurtosis, TOKEN, "kurtosis");
+    declareOutput(_flatnessDB, TOKEN, "flatnessDB");
+    declareOutput(_crest, TOKEN, "crest");
+  }
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_BANDSTATS_H
@@ -26,7 +26,7 @@ using namespace standard;
 
 const char* StochasticModelSynth::name = "StochasticModelSynth";
 const char* StochasticModelSynth::category = "Synthesis";
-const char* StochasticModelSynth::description = DOC("This algorithm computes the stochastic model synthesis. It generates the noisy spectrum from a resampled spectral envelope of the stochastic component.\n"
+const char* StochasticModelSynth::description = DOC("This algorithm computes the stochastic model synthesis. It generates the noisy spectrum from a resampled spectral envelope of the stochastic component, with random phases that only depend on the 'seed' parameter.\n"
 "\n"
 "References:\n"
 "  https://github.com/MTG/sms-tools\n"
@@ -40,6 +40,7 @@ void StochasticModelSynth::configure() {
   _stocf = parameter("stocf").toReal();
   _fftSize = parameter("fftSize").toInt();
   _hopSize = parameter("hopSize").toInt();
+  _random.seed(parameter("seed").toInt());
 
   _window->configure("type", "hann", "size", _fftSize);
   _ifft->configure("size", _fftSize );
@@ -121,9 +122,12 @@ void StochasticModelSynth::getFFTFromEnvelope(const std::vector<Real> magResDB,
   initializeFFT(fftStoc,N);
   Real scale = Real(_fftSize)/2.f; // normalization to match stochastic analysis input energy.
 
+  _phases.resize(N);
+  _random.uniform(_phases, 0, 2 * M_PI);
+
   for (int i = 0; i < N; ++i)
   {
-    phase =  2 * M_PI *  Real(rand()/Real(RAND_MAX));
+    phase = _phases[i];
     magdB = magResDB[i];
 
     // positive spectrums
@@ -22,6 +22,7 @@
 
 #include "algorithm.h"
 #include "algorithmfactory.h"
+#include "randomgenerator.h"
 #include <fstream>
 
 
@@ -46,6 +47,8 @@ class StochasticModelSynth : public Algorithm {
   Algorithm* _resample;
   Algorithm* _overlapadd;
 
+  RandomGenerator _random;
+  std::vector<Real> _phases;
 
  public:
   StochasticModelSynth() {
@@ -73,6 +76,7 @@ class StochasticModelSynth : public Algorithm {
     declareParameter("hopSize", "the hop size between frames", "[1,inf)", 512);
     declareParameter("fftSize", "the size of the internal FFT size (full spectrum size)", "[1,inf)", 2048);
     declareParameter("stocf", "decimation factor used for the stochastic approximation", "(0,1]", 0.2);
+    declareParameter("seed", "the seed of the random phases, e.g. a different one for each of the files processed in parallel in a reproducible way", "[0,inf)", 0);
 
   }
 
@@ -183,8 +183,9 @@ AlgorithmStatus LoudnessEBUR128::process() {
   const vector<Real>& powerI = _pool.value<vector<Real> >("integrated_power");
   
   // compute gated loudness with absolute threshold: 
-  // ignore values below -70 LKFS and computed mean of the rest
-  Real sum = 0.;
+  // ignore values below -70 LKFS and computed mean of the rest. The sums run
+  // over the whole signal, so they are accumulated in higher precision
+  PreciseReal sum = 0.;
   size_t n=0;
   for (size_t i=0; i<powerI.size(); ++i) {
     if (powerI[i] >= _absoluteThreshold) {
@@ -194,7 +195,7 @@ AlgorithmStatus LoudnessEBUR128::process() {
   }
   // relative threshold = gated loudness in LKFS - 10 LKFS 
   // 10 dB difference means 10 times less power 
-  Real threshold = n ? max(sum / n / 10, _absoluteThreshold) : _absoluteThreshold;
+  Real threshold = n ? max(Real(sum / n / 10), _absoluteThreshold) : _absoluteThreshold;
 
   // compute gated loudness with relative threshold
   sum = 0.;
@@ -205,7 +206,7 @@ AlgorithmStatus LoudnessEBUR128::process() {
       n++;
     }
   }
-  _integratedLoudness.push(power2loudness(n ? sum / n : _absoluteThreshold));
+  _integratedLoudness.push(power2loudness(n ? Real(sum / n) : _absoluteThreshold));
   
   // Compute loudness range based on short-term loudness
   const vector<Real>& powerST = _pool.value<vector<Real> >("shortterm_power");
@@ -222,7 +223,7 @@ AlgorithmStatus LoudnessEBUR128::process() {
   }
   // relative threshold = gated loudness - 20 LKFS
   // 20 dB difference means 100 times less power
-  threshold = n ? max(sum / n / 100, _absoluteThreshold) : _absoluteThreshold;
+  threshold = n ? max(Real(sum / n / 100), _absoluteThreshold) : _absoluteThreshold;
   
   // remove values lower than the relative threshold
   vector<Real> powerSTGated;
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "loudnessmeters.h"
+#include "essentiamath.h"
+
+using namespace std;
+
+namespace essentia {
+
+// the range and resolution of the histogram of the ReplayGain frame powers.
+// Powers below the lower bound are those of silence for pow2db
+static const Real histogramMinDb = dbSilenceCutoff;
+static const Real histogramMaxDb = 50;
+static const Real histogramResolution = 0.01;
+
+// file is ref_pink.wav, downloaded on reference site (www.replaygain.org)
+static const Real replayGainReference = -31.492595672607422;
+
+
+LoudnessMetersAccumulator::LoudnessMetersAccumulator() {
+  standard::AlgorithmFactory& factory = standard::AlgorithmFactory::instance();
+  _eqloud = factory.create("EqualLoudness");
+  _vickersFilter = factory.create("IIR");
+
+  _histogram.resize(int((histogramMaxDb - histogramMinDb) / histogramResolution) + 1);
+  configure(44100., 10., 1500., 1.5);
+}
+
+LoudnessMetersAccumulator::~LoudnessMetersAccumulator() {
+  delete _eqloud;
+  delete _vickersFilter;
+}
+
+void LoudnessMetersAccumulator::configure(Real sampleRate, Real attackTime,
+                                          Real releaseTime, Real power) {
+  // same as ReplayGain
+  _frameSize = int(int(sampleRate) * 0.05);
+  _eqloud->configure("sampleRate", sampleRate);
+
+  // same as Envelope
+  attackTime /= 1000.f;
+  releaseTime /= 1000.f;
+  _ga = attackTime > 0 ? exp(- 1.0 / (sampleRate * attackTime)) : 0.0;
+  _gr = releaseTime > 0 ? exp(- 1.0 / (sampleRate * releaseTime)) : 0.0;
+  _power = power;
+
+  // same as LoudnessVickers: cheap B-curve loudness compensation, and the
+  // time constant given in the paper
+  vector<Real> b(2, 0.0);
+  b[0] = 0.98595;
+  b[1] = -0.98595;
+  vector<Real> a(2, 0.0);
+  a[0] = 1.0;
+  a[1] = -0.9719;
+  _vickersFilter->configure("numerator", b, "denominator", a);
+  _c = exp(-1.0 / (0.035 * sampleRate));
+
+  reset();
+}
+
+void LoudnessMetersAccumulator::reset() {
+  _eqloud->reset();
+  _vickersFilter->reset();
+
+  _size = 0;
+  _frameFill = 0;
+  _framePower = 0;
+  fill(_histogram.begin(), _histogram.end(), 0);
+  _frames = 0;
+  _energy = 0;
+  _envelope = 0;
+  _powerSum = 0;
+  _envelopeZero = false;
+  _vms = 0;
+}
+
+void LoudnessMetersAccumulator::process(const vector<Real>& block) {
+  if (block.empty()) return;
+  const int size = int(block.size());
+  _size += size;
+
+  // Leq and LARM, on the signal itself
+  Real energy = 0;
+  Real powerSum = 0;
+  for (int i=0; i<size; ++i) {
+    Real sample = block[i];
+    energy += sample * sample;
+
+    sample = fabs(sample);
+    if (_envelope < sample) _envelope = (1.0 - _ga) * sample + _ga * _envelope;
+    else                    _envelope = (1.0 - _gr) * sample + _gr * _envelope;
+
+    if (_power == 0) {
+      // geometric mean
+      if (_envelope > 0) powerSum += log(_envelope);
+      else _envelopeZero = true;
+    }
+    else {
+      powerSum += powf(_envelope, _power);
+    }
+
+    if (isDenormal(_envelope)) _envelope = 0;
+  }
+  _energy += energy;
+  _powerSum += powerSum;
+
+  // ReplayGain, on the equal-loudness filtered signal: the frames may span
+  // several blocks
+  _eqloud->input("signal").set(block);
+  _eqloud->output("signal").set(_filtered);
+  _eqloud->compute();
+
+  for (int i=0; i<size; ++i) {
+    _framePower += _filtered[i] * _filtered[i];
+    if (++_frameFill == _frameSize) {
+      Real db = pow2db(_framePower / _frameSize);
+      int bin = int((db - histogramMinDb) / histogramResolution + 0.5);
+      _histogram[max(0, min(bin, int(_histogram.size()) - 1))] += 1;
+      _frames += 1;
+      _framePower = 0;
+      _frameFill = 0;
+    }
+  }
+
+  // Vickers, on the B-curve filtered signal
+  _vickersFilter->input("signal").set(block);
+  _vickersFilter->output("signal").set(_filtered);
+  _vickersFilter->compute();
+
+  double vms = _vms;
+  for (int i=0; i<size; ++i) {
+    vms = _c * vms + double(_filtered[i]) * _filtered[i];
+  }
+  _vms = vms;
+}
+
+Real LoudnessMetersAccumulator::replayGain() const {
+  if (_frames == 0) {
+    throw EssentiaException("LoudnessMeters: The input size must not be less than 0.05ms");
+  }
+
+  // the value at 95% of the sorted frame powers, as in ReplayGain
+  long long index = (long long)(0.95 * _frames);
+  long long count = 0;
+  int bin = 0;
+  for (; bin<int(_histogram.size()) - 1; ++bin) {
+    count += _histogram[bin];
+    if (count > index) break;
+  }
+  Real loudness = histogramMinDb + bin * histogramResolution;
+
+  return replayGainReference - loudness;
+}
+
+Real LoudnessMetersAccumulator::leq() const {
+  if (_size == 0) throw EssentiaException("LoudnessMeters: signal is empty");
+  return pow2db(_energy / _size);
+}
+
+Real LoudnessMetersAccumulator::larm() const {
+  if (_size == 0) throw EssentiaException("LoudnessMeters: signal is empty");
+
+  Real powerMean;
+  if (_power == 0) powerMean = _envelopeZero ? 0 : exp(_powerSum / _size);
+  else powerMean = powf(_powerSum / _size, 1.0 / _power);
+
+  return powerMean < 1e-5 ? -100.0 : 20.0 * log10(powerMean);
+}
+
+Real LoudnessMetersAccumulator::vickers() const {
+  if (_size == 0) throw EssentiaException("LoudnessMeters: signal is empty");
+  return pow2db((1 - _c) * _vms);
+}
+
+
+namespace standard {
+
+const char* LoudnessMeters::name = "LoudnessMeters";
+const char* LoudnessMeters::category = "Loudness/dynamics";
+const char* LoudnessMeters::description = DOC("This algorithm computes several loudness measures of an audio signal at once: the ReplayGain gain value, the equivalent sound level (Leq), the LARM loudness and the Vickers loudness. The results are those of the ReplayGain, Leq, Larm and LoudnessVickers algorithms (the Vickers loudness being the one of the whole signal given as a single frame), but the signal is processed in a single pass, block by block, and in constant memory, which makes it suitable for long signals. In streaming mode, the results are computed as the signal is received and output at the end of the stream.\n"
+"\n"
+"The ReplayGain loudness, which is the 95th percentile of the powers of 50ms frames of the equal-loudness filtered signal, is computed from a histogram of the frame powers with a resolution of 0.01dB, instead of sorting them. It may therefore differ from the value given by the ReplayGain algorithm by up to 0.005dB.\n"
+"\n"
+"An exception is thrown if the signal is shorter than 50ms.\n"
+"\n"
+"References:\n"
+"  [1] ReplayGain 1.0 specification, https://wiki.hydrogenaud.io/index.php?title=ReplayGain_1.0_specification\n"
+"  [2] G. A. Soulodre, \"Evaluation of Objective Loudness Meters,\" in\n"
+"  The 116th AES Convention, 2004.\n"
+"  [3] E. Skovenborg and S. H. Nielsen, \"Evaluation of different loudness\n"
+"  models with music and speech material,\" in The 117th AES Convention, 2004.\n"
+"  [4] E. Vickers, \"Automatic Long-term Loudness and Dynamics Matching,\" in\n"
+"  The 111th AES Convention, 2001.");
+
+
+void LoudnessMeters::configure() {
+  _meters.configure(parameter("sampleRate").toReal(),
+                    parameter("attackTime").toReal(),
+                    parameter("releaseTime").toReal(),
+                    parameter("power").toReal());
+}
+
+void LoudnessMeters::compute() {
+  const vector<Real>& signal = _signal.get();
+
+  _meters.reset();
+
+  // blocks of the size of the ones of the streaming mode, so that the
+  // filtered signal is never entirely in memory
+  const int blockSize = 4096;
+  vector<Real> block;
+  for (int start=0; start<int(signal.size()); start+=blockSize) {
+    int end = min(start + blockSize, int(signal.size()));
+    block.assign(signal.begin() + start, signal.begin() + end);
+    _meters.process(block);
+  }
+
+  _replayGain.get() = _meters.replayGain();
+  _leq.get() = _meters.leq();
+  _larm.get() = _meters.larm();
+  _vickers.get() = _meters.vickers();
+}
+
+} // namespace standard
+
+
+namespace streaming {
+
+const char* LoudnessMeters::name = standard::LoudnessMeters::name;
+const char* LoudnessMeters::category = standard::LoudnessMeters::category;
+const char* LoudnessMeters::description = standard::LoudnessMeters::description;
+
+void LoudnessMeters::configure() {
+  _meters.configure(parameter("sampleRate").toReal(),
+                    parameter("attackTime").toReal(),
+                    parameter("releaseTime").toReal(),
+                    parameter("power").toReal());
+}
+
+void LoudnessMeters::reset() {
+  AccumulatorAlgorithm::reset();
+  _meters.reset();
+}
+
+void LoudnessMeters::consume() {
+  const vector<Real>& signal = *((const vector<Real>*)_signal.getTokens());
+  _meters.process(signal);
+}
+
+void LoudnessMeters::finalProduce() {
+  _replayGain.push(_meters.replayGain());
+  _leq.push(_meters.leq());
+  _larm.push(_meters.larm());
+  _vickers.push(_meters.vickers());
+}
+
+} // namespace streaming
+} // namespace essentia
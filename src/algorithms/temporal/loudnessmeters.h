@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_LOUDNESSMETERS_H
+#define ESSENTIA_LOUDNESSMETERS_H
+
+#include "algorithmfactory.h"
+
+namespace essentia {
+
+/**
+ * Computes the ReplayGain, Leq, LARM and Vickers loudness of a signal given
+ * block by block, in a single pass over the samples and in constant memory.
+ * The filters of each measure (equal-loudness filter, envelope, B-curve
+ * filter) keep their state from one block to the next, so that the results
+ * do not depend on the sizes of the blocks.
+ *
+ * The 95th percentile of the ReplayGain frame powers is computed from a
+ * histogram of the powers in dB instead of sorting them, with a resolution
+ * of 0.01dB.
+ */
+class LoudnessMetersAccumulator {
+ public:
+  LoudnessMetersAccumulator();
+  ~LoudnessMetersAccumulator();
+
+  void configure(Real sampleRate, Real attackTime, Real releaseTime, Real power);
+  void reset();
+
+  void process(const std::vector<Real>& block);
+
+  // throw an exception if no (or not enough) samples have been processed
+  Real replayGain() const;
+  Real leq() const;
+  Real larm() const;
+  Real vickers() const;
+
+ protected:
+  standard::Algorithm* _eqloud;
+  standard::Algorithm* _vickersFilter;
+  std::vector<Real> _filtered;
+
+  long long _size;
+
+  // ReplayGain: the power of the current 50ms frame, and the histogram of
+  // the powers of the previous ones
+  int _frameSize;
+  int _frameFill;
+  Real _framePower;
+  std::vector<long long> _histogram;
+  long long _frames;
+
+  // Leq
+  Real _energy;
+
+  // LARM: the envelope follower and the sum of the powers of its values
+  Real _ga, _gr, _envelope;
+  Real _power;
+  Real _powerSum;
+  bool _envelopeZero; // for the geometric mean (power 0)
+
+  // Vickers: the exponentially weighted energy of the filtered signal
+  Real _c;
+  double _vms;
+};
+
+namespace standard {
+
+class LoudnessMeters : public Algorithm {
+
+ protected:
+  Input<std::vector<Real> > _signal;
+  Output<Real> _replayGain;
+  Output<Real> _leq;
+  Output<Real> _larm;
+  Output<Real> _vickers;
+
+  LoudnessMetersAccumulator _meters;
+
+ public:
+  LoudnessMeters() {
+    declareInput(_signal, "signal", "the input audio signal (must be longer than 50ms)");
+    declareOutput(_replayGain, "replayGain", "the ReplayGain gain value [dB]");
+    declareOutput(_leq, "leq", "the equivalent sound level estimate [dB]");
+    declareOutput(_larm, "larm", "the LARM loudness estimate [dB]");
+    declareOutput(_vickers, "vickers", "the Vickers loudness of the whole signal [dB]");
+  }
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "{8000,32000,44100,48000}", 44100.);
+    declareParameter("attackTime", "the attack time of the LARM envelope [ms]", "[0,inf)", 10.0);
+    declareParameter("releaseTime", "the release time of the LARM envelope [ms]", "[0,inf)", 1500.0);
+    declareParameter("power", "the power used for averaging the LARM envelope", "(-inf,inf)", 1.5);
+  }
+
+  void configure();
+  void compute();
+  void reset() { _meters.reset(); }
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+} // namespace standard
+} // namespace essentia
+
+#include "accumulatoralgorithm.h"
+
+namespace essentia {
+namespace streaming {
+
+class LoudnessMeters : public AccumulatorAlgorithm {
+
+ protected:
+  Sink<Real> _signal;
+  Source<Real> _replayGain;
+  Source<Real> _leq;
+  Source<Real> _larm;
+  Source<Real> _vickers;
+
+  LoudnessMetersAccumulator _meters;
+  std::vector<Real> _block;
+
+ public:
+  LoudnessMeters() {
+    declareInputStream(_signal, "signal", "the input audio signal (must be longer than 50ms)");
+    declareOutputResult(_replayGain, "replayGain", "the ReplayGain gain value [dB]");
+    declareOutputResult(_leq, "leq", "the equivalent sound level estimate [dB]");
+    declareOutputResult(_larm, "larm", "the LARM loudness estimate [dB]");
+    declareOutputResult(_vickers, "vickers", "the Vickers loudness of the whole signal [dB]");
+  }
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "{8000,32000,44100,48000}", 44100.);
+    declareParameter("attackTime", "the attack time of the LARM envelope [ms]", "[0,inf)", 10.0);
+    declareParameter("releaseTime", "the release time of the LARM envelope [ms]", "[0,inf)", 1500.0);
+    declareParameter("power", "the power used for averaging the LARM envelope", "(-inf,inf)", 1.5);
+  }
+
+  void configure();
+  void reset();
+  void consume();
+  void finalProduce();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_LOUDNESSMETERS_H
@@ -77,32 +77,37 @@ void LPC::compute() {
   _correlation->compute();
 
   // Levinson-Durbin algorithm
-  vector<Real> temp(_p);
+  _a.assign(_p+1, 0.0);
+  _temp.resize(_p);
 
-  Real k;
-  Real E = _r[0];
-  lpc[0] = 1;
+  PreciseReal k;
+  PreciseReal E = _r[0];
+  _a[0] = 1;
 
   for (int i=1; i<(_p+1); i++) {
     k = _r[i];
 
     for (int j=1; j<i; j++) {
-      k += _r[i-j] * lpc[j];
+      k += _r[i-j] * _a[j];
     }
 
     k /= E;
 
     reflection[i-1] = k;
-    lpc[i] = -k;
+    _a[i] = -k;
 
     for (int j=1; j<i; j++) {
-      temp[j] = lpc[j] - k*lpc[i-j];
+      _temp[j] = _a[j] - k*_a[i-j];
     }
 
     for (int j=1; j<i; j++) {
-      lpc[j] = temp[j];
+      _a[j] = _temp[j];
     }
 
     E *= (1-k*k);
   }
+
+  for (int i=0; i<_p+1; i++) {
+    lpc[i] = _a[i];
+  }
 }
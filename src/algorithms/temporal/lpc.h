@@ -33,6 +33,9 @@ class LPC : public Algorithm {
   Output<std::vector<Real> > _reflection;
   Algorithm* _correlation;
   std::vector<Real> _r;
+  // the Levinson-Durbin recursion is computed in higher precision
+  std::vector<PreciseReal> _a;
+  std::vector<PreciseReal> _temp;
   int _p;
 
  public:
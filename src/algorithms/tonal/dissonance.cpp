@@ -19,6 +19,7 @@
 
 #include "dissonance.h"
 #include "essentiamath.h"
+#include <algorithm>
 
 using namespace std;
 using namespace essentia;
@@ -76,22 +77,28 @@ Real plompLevelt(Real df) {
   return res;
 }
 
-Real consonance(Real f1, Real f2) {
-  // critical bandwidth between f1, f2:
-  // see  http://www.sfu.ca/sonic-studio/handbook/Critical_Band.html for a
-  // definition of critical bandwidth between two partials of a complex tone:
-  Real cbwf1 = barkCriticalBandwidth(hz2bark(f1));
-  Real cbwf2 = barkCriticalBandwidth(hz2bark(f2));
-  Real cbw = std::min(cbwf1, cbwf2 );
+// the critical bandwidth of each peak is computed once, and the dissonance of
+// a pair of peaks with the smallest of their critical bandwidths, see
+// http://www.sfu.ca/sonic-studio/handbook/Critical_Band.html for a
+// definition of critical bandwidth between two partials of a complex tone
+Real consonance(Real f1, Real f2, Real cbwf1, Real cbwf2) {
+  Real cbw = std::min(cbwf1, cbwf2);
   return plompLevelt(fabs(f2-f1)/cbw);
 }
 
+// two peaks more than this many times the critical bandwidth of one of them
+// apart are more than 1.18 critical bandwidths apart, and thus not dissonant.
+// The margin makes sure no rounding error can make plompLevelt disagree
+static const double maxDissonantDistance = 1.18 * 1.001;
 
 
+namespace essentia {
+
 Real calcDissonance(const vector<Real>& frequencies, const vector<Real>& magnitudes) {
   vector<Real> loudness = magnitudes;
   Real totalLoudness = 0;
   int size = frequencies.size();
+  vector<Real> barkFreqs(size), cbws(size);
 
   // calculate dissonance
   for (int i = 0; i < size; i++) {
@@ -102,6 +109,9 @@ Real calcDissonance(const vector<Real>& frequencies, const vector<Real>& magnitu
     Real aWeightingFactor = aWeighting(frequencies[i]);
     loudness[i] *= aWeightingFactor * aWeightingFactor;
     totalLoudness += loudness[i];
+
+    barkFreqs[i] = hz2bark(frequencies[i]);
+    cbws[i] = barkCriticalBandwidth(barkFreqs[i]);
   }
 
 
@@ -109,25 +119,41 @@ Real calcDissonance(const vector<Real>& frequencies, const vector<Real>& magnitu
     return 0.0;
   }
 
-  //vector<Real> loudness(size);
-  //for (int i=0; i<size; i++) partialLoudness = loudness[i]/totalLoudness;
+  // the peaks are scanned with a window sliding along the frequencies: the
+  // peaks below 'lowest' are too far below the current peak (and thus below
+  // all the following ones) to be dissonant with it, and the scan stops at
+  // the first peak too far above it. The pairs of peaks outside the window
+  // would only add zeros to the dissonance
+  int lowest = 0;
 
   Real totalDissonance = 0;
   for (int p1 = 0; p1 < size; p1++) {
     if (frequencies[p1] > 50) { // ignore frequencies below 50 Hz
-      Real barkFreq = hz2bark(frequencies[p1]);
+      Real barkFreq = barkFreqs[p1];
       Real startF = bark2hz(barkFreq - 1.18);
       Real endF = bark2hz(barkFreq + 1.18);
-      int p2 = 0;
+
+      // the first peak at or above min(startF, 50 Hz), and the first peak at
+      // or above min(endF, 10 kHz)
+      int first = lower_bound(frequencies.begin(), frequencies.end(), min(startF, Real(50))) - frequencies.begin();
+      int last = lower_bound(frequencies.begin(), frequencies.end(), min(endF, Real(10000))) - frequencies.begin();
+
+      while (lowest < p1 &&
+             double(frequencies[p1]) - frequencies[lowest] > maxDissonantDistance * cbws[lowest]) {
+        lowest++;
+      }
+
       Real peakDissonance = 0;
-      while (p2 < size && frequencies[p2] < startF && frequencies[p2] < 50) p2++;
-      while (p2 < size && frequencies[p2] < endF && frequencies[p2] < 10000) {
-        Real d = 1.0 - consonance(frequencies[p1], frequencies[p2]);
+      for (int p2 = max(first, lowest); p2 < last; p2++) {
+        if (p2 > p1 &&
+            double(frequencies[p2]) - frequencies[p1] > maxDissonantDistance * cbws[p1]) {
+          break;
+        }
+        Real d = 1.0 - consonance(frequencies[p1], frequencies[p2], cbws[p1], cbws[p2]);
         // Dissonance from p1 to p2, should be the same as dissonance from p2
         // to p1, this is the reason for using both peaks' loudness as
         // weight
         if (d > 0) peakDissonance += d*(loudness[p2] + loudness[p1])/totalLoudness;
-        p2++;
       }
       Real partialLoudness = loudness[p1]/totalLoudness;
       if (peakDissonance > partialLoudness) peakDissonance = partialLoudness;
@@ -139,6 +165,8 @@ Real calcDissonance(const vector<Real>& frequencies, const vector<Real>& magnitu
   return totalDissonance/2;
 }
 
+} // namespace essentia
+
 
 void Dissonance::compute() {
 
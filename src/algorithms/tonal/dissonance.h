@@ -23,6 +23,13 @@
 #include "algorithm.h"
 
 namespace essentia {
+
+/**
+ * The sensory dissonance of spectral peaks sorted by frequency, as computed
+ * by the Dissonance algorithm.
+ */
+Real calcDissonance(const std::vector<Real>& frequencies, const std::vector<Real>& magnitudes);
+
 namespace standard {
 
 class Dissonance : public Algorithm {
@@ -19,6 +19,7 @@
 
 #include "nnlschroma.h"
 #include "essentiamath.h"
+#include <thread>
 
 using namespace std;
 using namespace essentia;
@@ -33,6 +34,8 @@ const char* NNLSChroma::description = DOC("This algorithm extracts treble and ba
 "This code is ported from NNLS Chroma [1, 2]. To achieve similar results follow this processing chain:\n"
 "frame slicing with sample rate = 44100, frame size = 16384, hop size = 2048 -> Windowing with Hann and no normalization -> Spectrum -> LogSpectrum.\n"
 "\n"
+"The non-negative least squares problem of each frame is solved from the Gram matrix of the note dictionary, computed once at configuration, starting from the notes found in the previous frame. The frames can be split among several threads with the 'threads' parameter.\n"
+"\n"
 "References:\n"
 "  [1] Mauch, M., & Dixon, S. (2010, August). Approximate Note Transcription\n"
 "  for the Improved Identification of Difficult Chords. In ISMIR (pp. 135-140).\n"
@@ -70,6 +73,223 @@ static const Real treblewindow[] = {
     0.233984, 0.203090, 0.173856, 0.146447, 0.121014, 0.097701, 0.076638,
     0.057942, 0.041719, 0.028058, 0.017037, 0.008717, 0.003144, 0.000350};
 
+/**
+ * Solves the non-negative least squares problem min |A x - b| with x >= 0
+ * from its normal equations, ie: given the Gram matrix G = A'A and c = A'b,
+ * with the active set method of Lawson and Hanson as reformulated by Bro and
+ * De Jong [1]. As consecutive frames have mostly the same notes, the passive
+ * set (the non-zero values of x) can be started from the solution of the
+ * previous frame instead of being built one value at a time.
+ * The workspace is allocated once for the largest problem.
+ *
+ * [1] Bro, R., & De Jong, S. (1997). A fast non-negativity-constrained least
+ *     squares algorithm. Journal of Chemometrics, 11(5), 393-401.
+ */
+namespace {
+
+class GramNNLS {
+ public:
+  GramNNLS(int maxSize) : _n(0) {
+    _passive.resize(maxSize);
+    _blocked.resize(maxSize);
+    _x.resize(maxSize);
+    _s.resize(maxSize);
+    _y.resize(maxSize);
+    _index.resize(maxSize);
+    _chol.resize(maxSize * maxSize);
+  }
+
+  /**
+   * @param gram the Gram matrix of all the columns, of size dim x dim
+   * @param columns the columns of the problem (indices in gram)
+   * @param c A'b for these columns
+   * @param warm whether each column is in the passive set to start with
+   * @param x the solution for these columns
+   */
+  void solve(const std::vector<double>& gram, int dim, const std::vector<int>& columns,
+             const std::vector<double>& c, const std::vector<bool>& warm, std::vector<Real>& x);
+
+ protected:
+  int _n;
+  const double* _gram;
+  int _dim;
+  const int* _columns;
+  const double* _c;
+
+  std::vector<char> _passive, _blocked;
+  std::vector<double> _x, _s, _y;
+  std::vector<int> _index;
+  std::vector<double> _chol;
+
+  double G(int i, int j) const { return _gram[_columns[i]*_dim + _columns[j]]; }
+  bool solvePassive();
+};
+
+// solves G_PP s_P = c_P by Cholesky decomposition, returns false if G_PP is
+// (numerically) singular
+bool GramNNLS::solvePassive() {
+  int k = 0;
+  for (int i=0; i<_n; ++i) {
+    if (_passive[i]) _index[k++] = i;
+  }
+
+  double* L = &_chol[0];
+  for (int i=0; i<k; ++i) {
+    for (int j=0; j<=i; ++j) {
+      double sum = G(_index[i], _index[j]);
+      for (int l=0; l<j; ++l) sum -= L[i*k + l] * L[j*k + l];
+      if (i == j) {
+        if (sum <= 1e-12 * G(_index[i], _index[i])) return false;
+        L[i*k + i] = sqrt(sum);
+      }
+      else {
+        L[i*k + j] = sum / L[j*k + j];
+      }
+    }
+  }
+
+  // forward then backward substitution
+  double* y = &_y[0];
+  for (int i=0; i<k; ++i) {
+    double sum = _c[_index[i]];
+    for (int l=0; l<i; ++l) sum -= L[i*k + l] * y[l];
+    y[i] = sum / L[i*k + i];
+  }
+  for (int i=k-1; i>=0; --i) {
+    double sum = y[i];
+    for (int l=i+1; l<k; ++l) sum -= L[l*k + i] * y[l];
+    y[i] = sum / L[i*k + i];
+  }
+
+  for (int i=0; i<_n; ++i) _s[i] = 0;
+  for (int i=0; i<k; ++i) _s[_index[i]] = y[i];
+  return true;
+}
+
+void GramNNLS::solve(const std::vector<double>& gram, int dim, const std::vector<int>& columns,
+                     const std::vector<double>& c, const std::vector<bool>& warm, std::vector<Real>& x) {
+  _n = columns.size();
+  _gram = &gram[0];
+  _dim = dim;
+  _columns = &columns[0];
+  _c = &c[0];
+
+  x.assign(_n, 0);
+  if (_n == 0) return;
+
+  double maxC = 0;
+  for (int i=0; i<_n; ++i) maxC = std::max(maxC, std::fabs(c[i]));
+  if (maxC == 0) return;
+  const double tolerance = 1e-10 * maxC;
+
+  bool warmStart = false;
+  for (int i=0; i<_n; ++i) {
+    _x[i] = 0;
+    _blocked[i] = false;
+    _passive[i] = warm[i];
+    if (warm[i]) warmStart = true;
+  }
+
+  // the warm start is projected onto x >= 0: the values of its least squares
+  // solution that are not positive are removed until the others all are
+  while (warmStart) {
+    if (!solvePassive()) {
+      // the warm start is degenerate, start from scratch
+      for (int i=0; i<_n; ++i) _passive[i] = false;
+      break;
+    }
+    bool feasible = true;
+    for (int i=0; i<_n; ++i) {
+      if (_passive[i] && _s[i] <= 0) {
+        _passive[i] = false;
+        feasible = false;
+      }
+    }
+    if (feasible) {
+      for (int i=0; i<_n; ++i) _x[i] = _s[i];
+      break;
+    }
+  }
+
+  // each iteration adds a value to the passive set, and the inner loop can
+  // only remove values that were added before
+  const int maxIterations = 3 * _n;
+  for (int iter=0; iter<maxIterations; ++iter) {
+    // the gradient w = c - G x, for the values in the active set
+    int added = -1;
+    double maxW = tolerance;
+    for (int i=0; i<_n; ++i) {
+      if (_passive[i] || _blocked[i]) continue;
+      double w = _c[i];
+      for (int j=0; j<_n; ++j) {
+        if (_passive[j]) w -= G(i, j) * _x[j];
+      }
+      if (w > maxW) {
+        maxW = w;
+        added = i;
+      }
+    }
+    if (added < 0) break; // optimal
+
+    _passive[added] = true;
+
+    // inner loop: move towards the unconstrained solution of the passive set
+    // as far as it stays feasible, removing the values reaching zero
+    while (true) {
+      if (!solvePassive()) {
+        // this column is (numerically) a combination of the passive ones
+        _passive[added] = false;
+        _blocked[added] = true;
+        added = -1;
+        continue;
+      }
+
+      double alpha = 2;
+      int limiting = -1;
+      for (int i=0; i<_n; ++i) {
+        if (_passive[i] && _s[i] <= 0) {
+          double a = _x[i] > 0 ? _x[i] / (_x[i] - _s[i]) : 0;
+          if (a < alpha) {
+            alpha = a;
+            limiting = i;
+          }
+        }
+      }
+
+      if (limiting < 0) {
+        for (int i=0; i<_n; ++i) _x[i] = _s[i];
+        break;
+      }
+
+      for (int i=0; i<_n; ++i) {
+        if (!_passive[i]) continue;
+        _x[i] += alpha * (_s[i] - _x[i]);
+        if (i == limiting || _x[i] <= 0) {
+          _passive[i] = false;
+          _x[i] = 0;
+          // the value that has just been added cannot be part of the solution
+          if (i == added) {
+            _blocked[i] = true;
+            added = -1;
+          }
+        }
+      }
+    }
+
+    // the value added is in the new solution, which has a lower residual: the
+    // values blocked at the previous one may be needed again, so that the
+    // optimality conditions are checked for all of them
+    if (added >= 0) {
+      for (int i=0; i<_n; ++i) _blocked[i] = false;
+    }
+  }
+
+  for (int i=0; i<_n; ++i) x[i] = _x[i];
+}
+
+} // namespace
+
+
 void NNLSChroma::configure() {
   _frameSize = parameter("frameSize").toInt();
   _sampleRate = parameter("sampleRate").toReal();
@@ -140,6 +360,22 @@ void NNLSChroma::configure() {
   for (int i = 0; i < nNote * 84; ++i) _dict[i] = 0.0;
 
   dictionaryMatrix(_dict, _spectralShape);
+
+  // the NNLS problem of each frame only needs the products of the
+  // dictionary columns, computed once here
+  _gram.assign(84 * 84, 0.0);
+  for (int i = 0; i < 84; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      double sum = 0;
+      for (int iBin = 0; iBin < nNote; ++iBin) {
+        sum += (double)_dict[i * nNote + iBin] * _dict[j * nNote + iBin];
+      }
+      _gram[i * 84 + j] = _gram[j * 84 + i] = sum;
+    }
+  }
+
+  _threads = parameter("threads").toInt();
+  if (_threads == 0) _threads = max(1, (int)std::thread::hardware_concurrency());
 }
 
 void NNLSChroma::reset() {
@@ -239,15 +475,45 @@ void NNLSChroma::compute() {
   chromagram.assign(logSpectrum.size(), vector<Real>());
   bassChromagram.assign(logSpectrum.size(), vector<Real>());
 
-  for (int i = 0; i < (int)logSpectrum.size(); i++) {
+  // the frames are independent, except for the warm start of the NNLS
+  // solver, which starts again at the first frame of each thread
+  int nFrames = logSpectrum.size();
+  int nThreads = min(_threads, nFrames);
+  if (nThreads <= 1) {
+    computeChromagrams(0, nFrames);
+    return;
+  }
+
+  vector<std::thread> threads;
+  for (int t = 0; t < nThreads; ++t) {
+    threads.push_back(std::thread(&NNLSChroma::computeChromagrams, this,
+                                  t * nFrames / nThreads, (t + 1) * nFrames / nThreads));
+  }
+  for (int t = 0; t < nThreads; ++t) threads[t].join();
+}
+
+
+void NNLSChroma::computeChromagrams(int begin, int end) {
+  const vector<vector<Real> >& tunedLogfreqSpectrum = _tunedLogfreqSpectrum.get();
+  vector<vector<Real> >& semitoneSpectrum = _semitoneSpectrum.get();
+  vector<vector<Real> >& bassChromagram = _bassChromagram.get();
+  vector<vector<Real> >& chromagram = _chromagram.get();
+
+  // workspace of the NNLS solver, and note activations of the previous frame
+  GramNNLS solver(84);
+  vector<int> signifIndex;
+  vector<double> dictTimesB;
+  vector<bool> warm;
+  vector<Real> x;
+  vector<Real> previousX(84, 0);
+
+  for (int i = begin; i < end; i++) {
     Real b[nNote];
 
     bool some_b_greater_zero = false;
-    Real sumb = 0;
 
     for (int j = 0; j < nNote; j++) {
       b[j] = tunedLogfreqSpectrum[i][j];
-      sumb += b[j];
       if (b[j] > 0) {
         some_b_greater_zero = true;
       }
@@ -277,14 +543,8 @@ void NNLSChroma::compute() {
       }
 
       else {
-        Real x[84 + 1000];
-        for (int j = 1; j < 1084; ++j){
-          x[j] = 1.0;
-        } 
-
-        vector<int> signifIndex;
+        signifIndex.clear();
         int index = 0;
-        sumb /= 84.0;
 
         for (int iNote = nBPS / 2 + 2; iNote < nNote - nBPS / 2;
              iNote += nBPS) {
@@ -296,26 +556,25 @@ void NNLSChroma::compute() {
           semitoneSpectrum[i].push_back(0.f);  // fill the values, change later
           index++;
         }
-        Real rnorm;
-        Real w[84 + 1000];
-        Real zz[84 + 1000];
-        int indx[84 + 1000];
-        int mode;
-        int dictsize = nNote * signifIndex.size();
-        Real* curr_dict = new Real[dictsize];
+
+        // c = A'b for the significant notes, and warm start from the notes
+        // found in the previous frame
+        dictTimesB.resize(signifIndex.size());
+        warm.resize(signifIndex.size());
         for (int iNote = 0; iNote < (int)signifIndex.size(); ++iNote) {
-          for (int iBin = 0; iBin < nNote; iBin++) {
-            curr_dict[iNote * nNote + iBin] =
-                1.0 * _dict[signifIndex[iNote] * nNote + iBin];
-          }
+          const Real* column = &_dict[signifIndex[iNote] * nNote];
+          double sum = 0;
+          for (int iBin = 0; iBin < nNote; iBin++) sum += (double)column[iBin] * b[iBin];
+          dictTimesB[iNote] = sum;
+          warm[iNote] = previousX[signifIndex[iNote]] > 0;
         }
 
-        nnls(curr_dict, nNote, nNote, signifIndex.size(), b, x, &rnorm, w, zz,
-             indx, &mode);
-        delete[] curr_dict;
+        solver.solve(_gram, 84, signifIndex, dictTimesB, warm, x);
 
+        previousX.assign(84, 0);
         for (int iNote = 0; iNote < (int)signifIndex.size(); ++iNote) {
           semitoneSpectrum[i][signifIndex[iNote]] = x[iNote];
+          previousX[signifIndex[iNote]] = x[iNote];
           chroma[signifIndex[iNote] % 12] +=
               x[iNote] * treblewindow[signifIndex[iNote]];
           basschroma[signifIndex[iNote] % 12] +=
@@ -521,7 +780,7 @@ Real NNLSChroma::pitchCospuls(Real x, Real centre, int binsperoctave) {
   return out;
 }
 
-void NNLSChroma::dictionaryMatrix(vector<Real> dm, Real s_param) {
+void NNLSChroma::dictionaryMatrix(vector<Real>& dm, Real s_param) {
   // TODO: make this more general, such that it works with all minoctave,
   // maxoctave and even more than one note per semitone
   int binspersemitone = nBPS;
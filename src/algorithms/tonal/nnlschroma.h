@@ -21,7 +21,6 @@
 #define ESSENTIA_NNLSCHROMA_H
 
 #include "algorithm.h"
-#include "nnls.h"
 
 namespace essentia {
 namespace standard {
@@ -57,6 +56,7 @@ class NNLSChroma : public Algorithm {
     declareParameter("spectralWhitening", "determines how much the log-frequency spectrum is whitened", "[0,1.0]", 1.0);
     declareParameter("spectralShape", " the shape of the notes in the NNLS dictionary", "(0.5,0.9)", 0.7);
     declareParameter("chromaNormalization", "determines whether or how the chromagrams are normalised", "{none,maximum,L1,L2}", "none");
+    declareParameter("threads", "the number of threads computing the chromagrams of the frames, 0 to use one per CPU core", "[0,inf)", 1);
   }
 
   void configure();
@@ -83,12 +83,15 @@ class NNLSChroma : public Algorithm {
   std::vector<Real> _sinvalues;
   std::vector<Real> _cosvalues;
   std::vector<Real> _dict;
+  std::vector<double> _gram; // _dict' * _dict, for the NNLS solver
+  int _threads;
 
   bool logFreqMatrix(Real fs, int frameSize, std::vector<Real> outmatrix);
   Real cospuls(Real x, Real centre, Real width);
   Real pitchCospuls(Real x, Real centre, int binsperoctave);
   std::vector<Real> SpecialConvolution(std::vector<Real> convolvee, std::vector<Real> kernel);
-  void dictionaryMatrix(std::vector<Real> dm, Real s_param);
+  void dictionaryMatrix(std::vector<Real>& dm, Real s_param);
+  void computeChromagrams(int begin, int end);
 
 };
 
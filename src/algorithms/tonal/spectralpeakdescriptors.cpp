@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "spectralpeakdescriptors.h"
+#include "dissonance.h"
+#include "essentiamath.h"
+
+using namespace std;
+using namespace essentia;
+using namespace standard;
+
+const char* SpectralPeakDescriptors::name = "SpectralPeakDescriptors";
+const char* SpectralPeakDescriptors::category = "Tonal";
+const char* SpectralPeakDescriptors::description = DOC("This algorithm computes the descriptors of a set of spectral peaks and of their harmonic peaks, given the spectral peaks and the fundamental frequency of a signal. It outputs the same values as the Dissonance algorithm on the spectral peaks, and as the Inharmonicity, Tristimulus and OddToEvenHarmonicEnergyRatio algorithms on the harmonic peaks found by the HarmonicPeaks algorithm, but it computes the harmonic descriptors in a single pass over the harmonic peaks, without passing these peaks from one algorithm to the next.\n"
+"\n"
+"This algorithm is intended to receive its \"frequencies\" and \"magnitudes\" inputs from the SpectralPeaks algorithm, and its \"pitch\" input from a pitch detection algorithm such as PitchYinFFT. If \"pitch\" is zero, there are no harmonic peaks, and the inharmonicity is 0, the tristimulus [0, 0, 0] and the odd to even harmonic energy ratio 1.\n"
+"\n"
+"An exception is thrown if the input vectors differ in size or are not sorted by ascending frequency, and if the pitch is negative.");
+
+
+void SpectralPeakDescriptors::configure() {
+  _harmonicPeaks->configure("maxHarmonics", parameter("maxHarmonics"),
+                            "tolerance", parameter("tolerance"));
+}
+
+void SpectralPeakDescriptors::compute() {
+
+  const vector<Real>& frequencies = _frequencies.get();
+  const vector<Real>& magnitudes = _magnitudes.get();
+  const Real& pitch = _pitch.get();
+  Real& dissonance = _dissonance.get();
+  Real& inharmonicity = _inharmonicity.get();
+  vector<Real>& tristimulus = _tristimulus.get();
+  Real& oddToEvenHarmonicEnergyRatio = _oddToEvenHarmonicEnergyRatio.get();
+
+  if (magnitudes.size() != frequencies.size()) {
+    throw EssentiaException("SpectralPeakDescriptors: frequency and magnitude input vectors are not the same size");
+  }
+
+  for (int i=1; i<int(frequencies.size()); i++) {
+    if (frequencies[i] < frequencies[i-1]) {
+      throw EssentiaException("SpectralPeakDescriptors: spectral peaks must be sorted by frequency");
+    }
+  }
+
+  dissonance = calcDissonance(frequencies, magnitudes);
+
+  _harmonicPeaks->input("frequencies").set(frequencies);
+  _harmonicPeaks->input("magnitudes").set(magnitudes);
+  _harmonicPeaks->input("pitch").set(pitch);
+  _harmonicPeaks->output("harmonicFrequencies").set(_harmonicFrequencies);
+  _harmonicPeaks->output("harmonicMagnitudes").set(_harmonicMagnitudes);
+  _harmonicPeaks->compute();
+
+  // the harmonic peaks are sorted by strictly ascending frequencies, as each
+  // of them is within less than half the pitch of its ideal frequency. The
+  // sums below are computed in the same order as in the Inharmonicity,
+  // Tristimulus and OddToEvenHarmonicEnergyRatio algorithms, so that the
+  // results are exactly the same
+  const vector<Real>& hfreqs = _harmonicFrequencies;
+  const vector<Real>& hmags = _harmonicMagnitudes;
+  int size = hfreqs.size();
+
+  tristimulus.assign(3, 0.0);
+
+  if (size == 0) {
+    inharmonicity = 0.0;
+    oddToEvenHarmonicEnergyRatio = 1.0;
+    return;
+  }
+
+  Real f0 = hfreqs[0];
+  Real num = 0.0;
+  Real den = hmags[0] * hmags[0];
+  Real sum = 0.0;
+  Real sum_4 = 0.0;
+  Real even_energy = 0.0;
+  Real odd_energy = 0.0;
+
+  for (int i=0; i<size; ++i) {
+    Real energy = hmags[i] * hmags[i];
+
+    if (i > 0) {
+      Real ratio = round(hfreqs[i]/f0);
+      num += abs(hfreqs[i] - ratio * f0) * hmags[i] * hmags[i];
+      den += energy;
+    }
+
+    sum += hmags[i];
+    if (i >= 4) sum_4 += hmags[i];
+
+    if (i%2 == 0) even_energy += energy;
+    else           odd_energy += energy;
+  }
+
+  // inharmonicity
+  inharmonicity = den == 0.0 ? 1.0 : num/(den*f0);
+
+  // tristimulus
+  if (sum != 0.0) {
+    tristimulus[0] = hmags[0] / sum;
+    if (size >= 4) tristimulus[1] = (hmags[1] + hmags[2] + hmags[3]) / sum;
+    if (size >= 5) tristimulus[2] = sum_4 / sum;
+  }
+
+  // odd to even harmonic energy ratio
+  const Real maxRatio = 1000.;
+  if (even_energy == 0.0 && odd_energy > 0.01) {
+    oddToEvenHarmonicEnergyRatio = maxRatio;
+  }
+  else if (even_energy == 0.0 && odd_energy < 0.01) {
+    oddToEvenHarmonicEnergyRatio = 1;
+  }
+  else {
+    oddToEvenHarmonicEnergyRatio = odd_energy / even_energy;
+  }
+  if (oddToEvenHarmonicEnergyRatio >= maxRatio) {
+    E_WARNING("clipping oddtoevenharmonicenergyratio to maximum allowed value");
+    oddToEvenHarmonicEnergyRatio = maxRatio;
+  }
+}
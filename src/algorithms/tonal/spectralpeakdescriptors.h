@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_SPECTRALPEAKDESCRIPTORS_H
+#define ESSENTIA_SPECTRALPEAKDESCRIPTORS_H
+
+#include "algorithmfactory.h"
+
+namespace essentia {
+namespace standard {
+
+class SpectralPeakDescriptors : public Algorithm {
+
+ protected:
+  Input<std::vector<Real> > _frequencies;
+  Input<std::vector<Real> > _magnitudes;
+  Input<Real> _pitch;
+  Output<Real> _dissonance;
+  Output<Real> _inharmonicity;
+  Output<std::vector<Real> > _tristimulus;
+  Output<Real> _oddToEvenHarmonicEnergyRatio;
+
+  Algorithm* _harmonicPeaks;
+  std::vector<Real> _harmonicFrequencies;
+  std::vector<Real> _harmonicMagnitudes;
+
+ public:
+  SpectralPeakDescriptors() {
+    declareInput(_frequencies, "frequencies", "the frequencies of the spectral peaks [Hz] (ascending order)");
+    declareInput(_magnitudes, "magnitudes", "the magnitudes of the spectral peaks (ascending frequency order)");
+    declareInput(_pitch, "pitch", "an estimate of the fundamental frequency of the signal [Hz]");
+    declareOutput(_dissonance, "dissonance", "the dissonance of the spectral peaks (see Dissonance)");
+    declareOutput(_inharmonicity, "inharmonicity", "the inharmonicity of the harmonic peaks (see Inharmonicity)");
+    declareOutput(_tristimulus, "tristimulus", "the tristimulus of the harmonic peaks (see Tristimulus)");
+    declareOutput(_oddToEvenHarmonicEnergyRatio, "oddToEvenHarmonicEnergyRatio", "the ratio between the odd and even harmonic energies of the harmonic peaks (see OddToEvenHarmonicEnergyRatio)");
+
+    _harmonicPeaks = AlgorithmFactory::create("HarmonicPeaks");
+  }
+
+  ~SpectralPeakDescriptors() {
+    delete _harmonicPeaks;
+  }
+
+  void declareParameters() {
+    declareParameter("maxHarmonics", "the number of harmonic peaks including F0 (see HarmonicPeaks)", "[1,inf)", 20);
+    declareParameter("tolerance", "the allowed ratio deviation from ideal harmonics (see HarmonicPeaks)", "(0,0.5)", 0.2);
+  }
+
+  void configure();
+  void compute();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace standard
+} // namespace essentia
+
+#include "streamingalgorithmwrapper.h"
+
+namespace essentia {
+namespace streaming {
+
+class SpectralPeakDescriptors : public StreamingAlgorithmWrapper {
+
+ protected:
+  Sink<std::vector<Real> > _frequencies;
+  Sink<std::vector<Real> > _magnitudes;
+  Sink<Real> _pitch;
+  Source<Real> _dissonance;
+  Source<Real> _inharmonicity;
+  Source<std::vector<Real> > _tristimulus;
+  Source<Real> _oddToEvenHarmonicEnergyRatio;
+
+ public:
+  SpectralPeakDescriptors() {
+    declareAlgorithm("SpectralPeakDescriptors");
+    declareInput(_frequencies, TOKEN, "frequencies");
+    declareInput(_magnitudes, TOKEN, "magnitudes");
+    declareInput(_pitch, TOKEN, "pitch");
+    declareOutput(_dissonance, TOKEN, "dissonance");
+    declareOutput(_inharmonicity, TOKEN, "inharmonicity");
+    declareOutput(_tristimulus, TOKEN, "tristimulus");
+    declareOutput(_oddToEvenHarmonicEnergyRatio, TOKEN, "oddToEvenHarmonicEnergyRatio");
+  }
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_SPECTRALPEAKDESCRIPTORS_H
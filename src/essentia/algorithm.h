@@ -87,6 +87,14 @@ class ESSENTIA_API Algorithm : public Configurable {
    */
   virtual void reset() {}
 
+  /**
+   * Returns an estimate of the memory kept by this algorithm from one call of
+   * compute() to the next, in bytes. Algorithms whose state grows with the
+   * input should reimplement it, so that the streaming networks in which
+   * they are wrapped can account for that memory.
+   */
+  virtual size_t memoryUsage() const { return 0; }
+
 
   // methods for having access to the types of the inputs/outputs
   std::vector<const std::type_info*> inputTypes() const;
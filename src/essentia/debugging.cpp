@@ -18,6 +18,8 @@
  */
 
 #include "debugging.h"
+#include "types.h"
+#include "threading.h"
 #include <iostream>
 
 using namespace std;
@@ -33,6 +35,10 @@ int debugIndentLevel = 0;
 
 Logger loggerInstance;
 
+// algorithms may be run concurrently from different threads (e.g. one
+// extractor per thread), so the message queue always needs to be protected
+static ForcedMutex loggerMutex;
+
 const char* debugModuleDescription(DebuggingModule module) {
   switch (module) {
   case EAlgorithm:  return "[Algorithm ] ";
@@ -102,9 +108,9 @@ void setDebugLevelForTimeIndex(int index) {
 }
 
 
-// NOTE: in a thread-safe implementation, the msg queue would be thread-safe and
-//       the flushing would need to happen in a separate thread
-//       This can be achieved using tbb::concurrent_queue
+// NOTE: the msg queue is protected by a mutex, so that messages from different
+//       threads are not interleaved. The flushing could also happen in a
+//       separate thread, using tbb::concurrent_queue
 
 void Logger::flush() {
   while (!_msgQueue.empty()) {
@@ -116,6 +122,7 @@ void Logger::flush() {
 
 void Logger::debug(DebuggingModule module, const string& msg, bool resetHeader) {
   if (module & activatedDebugLevels) {
+    ForcedMutexLocker lock(loggerMutex);
     if (_addHeader) {
       _msgQueue.push_back(E_STRINGIFY(debugModuleDescription(module)      // module name
                                       + string(debugIndentLevel * 8, ' ') // indentation
@@ -132,18 +139,21 @@ void Logger::debug(DebuggingModule module, const string& msg, bool resetHeader)
 
 void Logger::info(const string& msg) {
   if (!infoLevelActive) return;
+  ForcedMutexLocker lock(loggerMutex);
   _msgQueue.push_back(E_STRINGIFY(GREEN_FONT << "[   INFO   ] " << RESET_FONT << msg << '\n'));
   flush();
 }
 
 void Logger::warning(const string& msg) {
   if (!warningLevelActive) return;
+  ForcedMutexLocker lock(loggerMutex);
   _msgQueue.push_back(E_STRINGIFY(YELLOW_FONT << "[ WARNING  ] " << RESET_FONT << msg << '\n'));
   flush();
 }
 
 void Logger::error(const string& msg) {
   if (!errorLevelActive) return;
+  ForcedMutexLocker lock(loggerMutex);
   _msgQueue.push_back(E_STRINGIFY(RED_FONT << "[  ERROR   ] " << RESET_FONT << msg << '\n'));
   flush();
 }
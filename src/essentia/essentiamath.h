@@ -814,6 +814,10 @@ inline bool isDenormal(const float& x) {
   //return (biasedExponent == 0 && absMantissa != 0);
 }
 
+inline bool isDenormal(const double& x) {
+  return std::fpclassify(x) == FP_SUBNORMAL;
+}
+
 // should always return a positive value, even when a/b is negative
 template <typename T> T fmod(T a, T b) {
   T q = floor(a/b);
@@ -22,6 +22,8 @@
 #ifdef OS_WIN32
 #include <fcntl.h>
 #include <io.h> // _mktemp
+#else // OS_WIN32
+#include <sys/resource.h> // getrusage
 #endif // OS_WIN32
 
 using namespace std;
@@ -40,4 +42,29 @@ int mkstemp(char *tmpl) {
 }
 #endif // OS_WIN32
 
+int planarSize(const vector<vector<Real> >& audio, const string& name) {
+  if (audio.empty()) return 0;
+  int size = audio[0].size();
+  for (int c=1; c<(int)audio.size(); ++c) {
+    if ((int)audio[c].size() != size) {
+      throw EssentiaException(name, ": all channels of the input signal must have the same length");
+    }
+  }
+  return size;
+}
+
+size_t peakResidentMemory() {
+#ifdef OS_WIN32
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#  ifdef OS_MAC
+  return usage.ru_maxrss;        // in bytes
+#  else
+  return usage.ru_maxrss * 1024; // in kilobytes
+#  endif
+#endif
+}
+
 } //namespace essentia
@@ -204,6 +204,55 @@ inline void fastcopy(std::vector<StereoSample>::iterator dest, std::vector<Stere
   }
 }
 
+
+/**
+ * Returns an estimate of the heap memory, in bytes, owned by the given value,
+ * not counting the value itself nor the overhead of the allocator. Overload
+ * it for the types that own memory.
+ */
+template <typename T>
+inline size_t heapMemoryUsage(const T&) {
+  return 0;
+}
+
+inline size_t heapMemoryUsage(const std::string& s) {
+  return s.capacity();
+}
+
+template <typename T>
+inline size_t heapMemoryUsage(const TNT::Array2D<T>& array) {
+  return array.dim1() * (sizeof(T*) + array.dim2() * sizeof(T));
+}
+
+template <typename T>
+inline size_t heapMemoryUsage(const std::vector<T>& v) {
+  size_t total = v.capacity() * sizeof(T);
+  for (int i=0; i<(int)v.size(); i++) total += heapMemoryUsage(v[i]);
+  return total;
+}
+
+/**
+ * Returns an estimate of the memory, in bytes, used by the given value,
+ * including the heap memory it owns.
+ */
+template <typename T>
+inline size_t memoryUsage(const T& value) {
+  return sizeof(T) + heapMemoryUsage(value);
+}
+
+/**
+ * Returns the number of samples per channel of a planar multichannel signal
+ * (channels x samples). Throws an exception, prefixed with the name of the
+ * calling algorithm, if the channels do not all have the same length.
+ */
+int planarSize(const std::vector<std::vector<Real> >& audio, const std::string& name);
+
+/**
+ * Returns the peak resident set size of the current process, in bytes, or 0
+ * if it cannot be determined on this platform.
+ */
+size_t peakResidentMemory();
+
 } // namespace essentia
 
 #endif // ESSENTIA_UTILS_H
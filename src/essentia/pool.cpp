@@ -132,6 +132,49 @@ void Pool::removeNamespace(const string& ns) {
 }
 
 
+size_t Pool::memoryUsage() const {
+  map<string, size_t> usage = memoryUsagePerType();
+  size_t total = sizeof(*this);
+  for (map<string, size_t>::const_iterator it = usage.begin(); it != usage.end(); ++it) {
+    total += it->second;
+  }
+  return total;
+}
+
+
+map<string, size_t> Pool::memoryUsagePerType() const {
+  map<string, size_t> usage;
+
+  #define ADD_MEMORY_USAGE(type, tname, typeName)                              \
+  {                                                                            \
+    MutexLocker lock(mutex##tname);                                            \
+    size_t total = 0;                                                          \
+    for (map<string, type >::const_iterator it = _pool##tname.begin();         \
+         it != _pool##tname.end();                                             \
+         ++it) {                                                               \
+      total += essentia::memoryUsage(it->first);                               \
+      total += essentia::memoryUsage(it->second);                              \
+    }                                                                          \
+    usage[typeName] = total;                                                   \
+  }
+
+  ADD_MEMORY_USAGE(vector<Real>, Real, "Real");
+  ADD_MEMORY_USAGE(vector<vector<Real> >, VectorReal, "vector<Real>");
+  ADD_MEMORY_USAGE(vector<string>, String, "string");
+  ADD_MEMORY_USAGE(vector<vector<string> >, VectorString, "vector<string>");
+  ADD_MEMORY_USAGE(vector<TNT::Array2D<Real> >, Array2DReal, "Array2D<Real>");
+  ADD_MEMORY_USAGE(vector<StereoSample>, StereoSample, "StereoSample");
+  ADD_MEMORY_USAGE(Real, SingleReal, "single Real");
+  ADD_MEMORY_USAGE(string, SingleString, "single string");
+  ADD_MEMORY_USAGE(vector<Real>, SingleVectorReal, "single vector<Real>");
+  ADD_MEMORY_USAGE(vector<string>, SingleVectorString, "single vector<string>");
+
+  #undef ADD_MEMORY_USAGE
+
+  return usage;
+}
+
+
 vector<string> Pool::descriptorNames() const {
   vector<string> descNames;
   int i=0;
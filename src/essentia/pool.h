@@ -359,6 +359,19 @@ class Pool {
    */
   const std::map<std::string, std::vector<std::string> >& getSingleVectorStringPool() const { return _poolSingleVectorString; }
 
+  /**
+   * @returns an estimate of the memory used by the pool, in bytes
+   */
+  size_t memoryUsage() const;
+
+  /**
+   * @returns an estimate of the memory used by each of the inner pools, in
+   *          bytes, indexed by the type of data they hold (e.g. "vector<Real>"
+   *          for descriptors added as vectors of Reals, "single Real" for
+   *          descriptors set as a single Real)
+   */
+  std::map<std::string, size_t> memoryUsagePerType() const;
+
   /**
    * Checks that no descriptor name is in two different inner pool types at
    * the same time, and throws an EssentiaException if there is
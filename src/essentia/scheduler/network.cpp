@@ -18,10 +18,19 @@
  */
 
 #include <stack>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include <algorithm>
 #include "network.h"
 #include "graphutils.h"
 #include "../streaming/streamingalgorithm.h"
 #include "../streaming/streamingalgorithmcomposite.h"
+#include "../streaming/algorithms/poolstorage.h"
+#include "../algorithmfactory.h"
+#include "../threading.h"
 using namespace std;
 using namespace essentia;
 using namespace essentia::streaming;
@@ -166,11 +175,112 @@ vector<NetworkNode*> NetworkNode::addVisibleDependencies(map<Algorithm*, Network
 
 Network* Network::lastCreated = 0;
 
+// networks may be created and destroyed concurrently (e.g. one per group of
+// descriptors in a multithreaded extractor)
+static ForcedMutex lastCreatedMutex;
+
+// profiling totals, shared by all the networks (which may run in different threads)
+static std::atomic<bool> profilingEnabled(false);
+static ProfileMap profileTotals;
+static ForcedMutex profileMutex;
+
+void Network::setProfiling(bool enabled) {
+  profilingEnabled = enabled;
+}
+
+bool Network::profiling() {
+  return profilingEnabled;
+}
+
+ProfileMap Network::profile() {
+  ForcedMutexLocker lock(profileMutex);
+  return profileTotals;
+}
+
+void Network::resetProfile() {
+  ForcedMutexLocker lock(profileMutex);
+  profileTotals.clear();
+}
+
+static std::atomic<bool> elementwiseFusionEnabled(false);
+
+void Network::setElementwiseFusion(bool enabled) {
+  elementwiseFusionEnabled = enabled;
+}
+
+bool Network::elementwiseFusion() {
+  return elementwiseFusionEnabled;
+}
+
+static inline double profilingTime() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// trace of the networks run while tracing is enabled. The names of the
+// events are only ever added, as the networks refer to them by index
+static std::atomic<bool> tracingEnabled(false);
+static TraceBuffer traceEvents;
+static vector<string> traceNames;
+static map<string, int> traceNameIndices;
+static map<std::thread::id, int> traceThreads;
+static double traceStart = 0;
+static ForcedMutex traceMutex;
+
+// the number of events recorded by a network before they are added to the
+// global trace, which needs locking
+static const int traceFlushSize = 4096;
+
+void Network::setTracing(bool enabled, int capacity) {
+  ForcedMutexLocker lock(traceMutex);
+  tracingEnabled = enabled;
+  if (enabled) {
+    traceEvents.setCapacity(capacity);
+    traceStart = profilingTime();
+  }
+}
+
+bool Network::tracing() {
+  return tracingEnabled;
+}
+
+void Network::resetTrace() {
+  ForcedMutexLocker lock(traceMutex);
+  traceEvents.clear();
+  traceStart = profilingTime();
+}
+
+void Network::writeTrace(ostream& out) {
+  ForcedMutexLocker lock(traceMutex);
+  writeChromeTrace(out, traceEvents, traceNames, traceStart);
+}
+
+void Network::writeTrace(const string& filename) {
+  ofstream out(filename.c_str());
+  if (!out) throw EssentiaException("Network: could not open file for writing the trace: ", filename);
+  writeTrace(out);
+}
+
+// to be called with traceMutex locked
+static int traceNameIndex(const string& name) {
+  map<string, int>::const_iterator it = traceNameIndices.find(name);
+  if (it != traceNameIndices.end()) return it->second;
+  traceNames.push_back(name);
+  return traceNameIndices[name] = (int)traceNames.size() - 1;
+}
+
 Network::Network(Algorithm* generator, bool takeOwnership) : _takeOwnership(takeOwnership),
                                                              _generator(generator),
                                                              _visibleNetworkRoot(0),
-                                                             _executionNetworkRoot(0) {
-  lastCreated = this;
+                                                             _executionNetworkRoot(0),
+                                                             _profiling(false),
+                                                             _tracing(false),
+                                                             _traceThread(0),
+                                                             _memoryBudget(0),
+                                                             _stepsSinceMemoryCheck(0) {
+  {
+    ForcedMutexLocker lock(lastCreatedMutex);
+    lastCreated = this;
+  }
 
   // 1- find the simple list of algorithms connected in this network
   buildVisibleNetwork();
@@ -182,11 +292,20 @@ Network::Network(Algorithm* generator, bool takeOwnership) : _takeOwnership(take
 }
 
 Network::~Network() {
-  if (lastCreated == this) lastCreated = 0;
+  {
+    ForcedMutexLocker lock(lastCreatedMutex);
+    if (lastCreated == this) lastCreated = 0;
+  }
   clear();
 }
 
 void Network::clear() {
+  // the events of a run interrupted by an exception
+  flushTrace();
+
+  // the algorithms owned by the user are those of the original network
+  unfuseElementwiseChains();
+
   if (_takeOwnership) {
     deleteAlgorithms();
   }
@@ -236,34 +355,343 @@ void Network::run() {
   runPrepare();
   while (runStep());
 
+  if (_profiling) mergeProfile();
+  flushTrace();
+
   string dash(24, '-');
   E_DEBUG(ENetwork, dash << " Final buffer states " << dash);
   printBufferFillState();
+  printMemoryUsage();
+
+  // leave the network as it was connected by the user
+  if (unfuseElementwiseChains()) {
+    buildExecutionNetwork();
+    topologicalSortExecutionNetwork();
+  }
 }
 
 void Network::runPrepare() {
   // 1- build the execution network here as internal configuration of some
-  //    algorithms might have changed since we constructed the Network
+  //    algorithms might have changed since we constructed the Network. The
+  //    chains fused by a previous run are rebuilt from their original
+  //    algorithms, which might have been reconfigured as well
+  unfuseElementwiseChains();
   buildExecutionNetwork();
 
-  // 2- get a linear ordering on the newly constructed execution network
-  topologicalSortExecutionNetwork();
-
-  // 3- make sure all inputs/outputs are correctly connected
+  // 2- make sure all inputs/outputs are correctly connected
   checkConnections();
 
-  // 4- resize the buffers depending on the requirements of the connected sinks
+  // 3- replace the chains of elementwise operators, now that we know they
+  //    are correctly connected
+  if (elementwiseFusionEnabled && fuseElementwiseChains()) buildExecutionNetwork();
+
+  // 4- get a linear ordering on the newly constructed execution network
+  topologicalSortExecutionNetwork();
+
+  // 5- resize the buffers depending on the requirements of the connected sinks
   checkBufferSizes();
 
 #if DEBUGGING_ENABLED
   for (int i=0; i<(int)_toposortedNetwork.size(); i++) _toposortedNetwork[i]->nProcess = 0;
 #endif
   saveDebugLevels();
+
+  _profiling = profilingEnabled;
+  _profile.assign(_profiling ? _toposortedNetwork.size() : 0, AlgorithmProfile());
+
+  _tracing = tracingEnabled;
+  if (_tracing) prepareTrace();
+
+  _stepsSinceMemoryCheck = 0;
+  if (_memoryBudget) checkMemoryBudget();
+}
+
+AlgorithmStatus Network::processAlgorithm(int i) {
+  if (!_profiling && !_tracing) return _toposortedNetwork[i]->process();
+
+  double start = profilingTime();
+  AlgorithmStatus status = _toposortedNetwork[i]->process();
+  double end = profilingTime();
+
+  if (_profiling) {
+    AlgorithmProfile& profile = _profile[i];
+    profile.time += end - start;
+    profile.nProcess++;
+    if (status == NO_OUTPUT) profile.nNoOutput++;
+  }
+
+  if (_tracing) traceProcess(i, start, end, status);
+
+  return status;
+}
+
+void Network::mergeProfile() {
+  ForcedMutexLocker lock(profileMutex);
+  for (int i=0; i<(int)_profile.size(); i++) {
+    AlgorithmProfile& total = profileTotals[_toposortedNetwork[i]->name()];
+    total.nProcess += _profile[i].nProcess;
+    total.nNoOutput += _profile[i].nNoOutput;
+    total.time += _profile[i].time;
+  }
+  _profile.assign(_profile.size(), AlgorithmProfile());
+}
+
+void Network::prepareTrace() {
+  ForcedMutexLocker lock(traceMutex);
+
+  std::thread::id thread = std::this_thread::get_id();
+  if (traceThreads.find(thread) == traceThreads.end()) {
+    int index = (int)traceThreads.size() + 1;
+    traceThreads[thread] = index;
+  }
+  _traceThread = traceThreads[thread];
+
+  // the fill levels are shown by port name, which are made unique for the
+  // algorithms that appear more than once in the network
+  map<string, int> occurrences;
+  int n = (int)_toposortedNetwork.size();
+  _traceAlgorithmNames.resize(n);
+  _traceInputNames.assign(n, vector<int>());
+  _traceOutputNames.assign(n, vector<int>());
+
+  for (int i=0; i<n; i++) {
+    Algorithm* algo = _toposortedNetwork[i];
+    _traceAlgorithmNames[i] = traceNameIndex(algo->name());
+
+    ostringstream suffix;
+    int occurrence = ++occurrences[algo->name()];
+    if (occurrence > 1) suffix << "#" << occurrence;
+
+    for (int j=0; j<(int)algo->inputs().size(); j++) {
+      _traceInputNames[i].push_back(traceNameIndex(algo->input(j).fullName() + suffix.str()));
+    }
+    for (int j=0; j<(int)algo->outputs().size(); j++) {
+      _traceOutputNames[i].push_back(traceNameIndex(algo->output(j).fullName() + suffix.str()));
+    }
+  }
+
+  _traceEvents.reserve(traceFlushSize);
+}
+
+void Network::traceProcess(int i, double start, double end, AlgorithmStatus status) {
+  TraceEvent event;
+  event.time = start;
+  event.duration = float(end - start);
+  event.name = _traceAlgorithmNames[i];
+  event.thread = _traceThread;
+  event.type = TraceEvent::Process;
+  event.status = short(status);
+  event.tokens = 0;
+  event.size = 0;
+  _traceEvents.push_back(event);
+
+  // the ports which made acquireData() fail
+  Algorithm* algo = _toposortedNetwork[i];
+  event.time = end;
+  event.duration = 0;
+  event.type = TraceEvent::AcquireFailure;
+
+  if (status == NO_INPUT) {
+    for (int j=0; j<(int)algo->inputs().size(); j++) {
+      SinkBase& input = algo->input(j);
+      if (input.available() >= input.acquireSize()) continue;
+      event.name = _traceInputNames[i][j];
+      event.tokens = input.available();
+      event.size = input.acquireSize();
+      _traceEvents.push_back(event);
+    }
+  }
+  else if (status == NO_OUTPUT) {
+    for (int j=0; j<(int)algo->outputs().size(); j++) {
+      SourceBase& output = algo->output(j);
+      if (output.available() >= output.acquireSize()) continue;
+      event.name = _traceOutputNames[i][j];
+      event.tokens = output.available();
+      event.size = output.acquireSize();
+      _traceEvents.push_back(event);
+    }
+  }
+
+  if ((int)_traceEvents.size() >= traceFlushSize) flushTrace();
 }
 
+void Network::traceBufferFill() {
+  TraceEvent event;
+  event.time = profilingTime();
+  event.duration = 0;
+  event.thread = _traceThread;
+  event.type = TraceEvent::BufferFill;
+  event.status = 0;
+
+  for (int i=0; i<(int)_toposortedNetwork.size(); i++) {
+    Algorithm* algo = _toposortedNetwork[i];
+    for (int j=0; j<(int)algo->outputs().size(); j++) {
+      SourceBase& output = algo->output(j);
+      event.name = _traceOutputNames[i][j];
+      event.size = output.bufferInfo().size;
+      event.tokens = event.size - output.available();
+      _traceEvents.push_back(event);
+    }
+  }
+
+  if ((int)_traceEvents.size() >= traceFlushSize) flushTrace();
+}
+
+void Network::flushTrace() {
+  if (_traceEvents.empty()) return;
+  ForcedMutexLocker lock(traceMutex);
+  for (int i=0; i<(int)_traceEvents.size(); i++) traceEvents.add(_traceEvents[i]);
+  _traceEvents.clear();
+}
+
+// name of the algorithm replacing a chain of the given elementwise operators,
+// empty if it is not one
+static string fusedAlgorithmName(const string& name) {
+  if (name == "UnaryOperator") return "Elementwise";
+  if (name == "UnaryOperatorStream") return "ElementwiseStream";
+  return "";
+}
+
+// the operator following algo in its chain, or 0 if its output is not only
+// connected to an operator of the same kind
+static Algorithm* nextInChain(Algorithm* algo) {
+  if (fusedAlgorithmName(algo->name()).empty()) return 0;
+
+  SourceBase& output = algo->output("array");
+  if (output.isProxied() || output.sinks().size() != 1) return 0;
+
+  Algorithm* next = output.sinks()[0]->parent();
+  if (!next || next->name() != algo->name()) return 0;
+  return next;
+}
+
+// whether the fused algorithm can be connected to the sinks of this output
+static bool canBeReplaced(SourceBase& output) {
+  if (output.isProxied() || output.sinks().empty()) return false;
+  for (int i=0; i<(int)output.sinks().size(); i++) {
+    if (dynamic_cast<SinkProxyBase*>(output.sinks()[i])) return false;
+  }
+  return true;
+}
+
+// appends the operations computed by an elementwise operator, with its
+// scale and shift applied in the same cases as the operator itself does
+static void addOperations(Algorithm* algo, vector<string>& operations, vector<Real>& values) {
+  string type = algo->parameter("type").toString();
+  Real scale = algo->parameter("scale").toReal();
+  Real shift = algo->parameter("shift").toReal();
+
+  if (type != "identity") {
+    operations.push_back(type);
+    values.push_back(0);
+  }
+
+  bool transform;
+  if (algo->name() == "UnaryOperator") {
+    // these functions return before applying the scale and shift
+    bool direct = type == "abs" || type == "lin2db" || type == "db2lin" ||
+                  type == "sin" || type == "cos" || type == "square";
+    transform = !direct && (scale != 1 || shift != 0);
+  }
+  else {
+    transform = scale != 1 && shift != 0;
+  }
+
+  if (transform) {
+    operations.push_back("multiply");
+    values.push_back(scale);
+    operations.push_back("add");
+    values.push_back(shift);
+  }
+}
+
+bool Network::fuseElementwiseChains() {
+  vector<string> available = AlgorithmFactory::keys();
+  vector<Algorithm*> algos = depthFirstMap(_executionNetworkRoot, returnAlgorithm);
+
+  int nFused = (int)_fusedChains.size();
+
+  for (int i=0; i<(int)algos.size(); i++) {
+    Algorithm* algo = algos[i];
+    string fusedName = fusedAlgorithmName(algo->name());
+    if (fusedName.empty() || !contains(available, fusedName)) continue;
+
+    // only start from the first operator of a chain, connected directly (ie:
+    // not through the proxy of a composite) to its source
+    SinkBase& input = algo->input("array");
+    SourceBase* source = input.source();
+    if (!source || !contains(source->sinks(), &input)) continue;
+    if (source->parent() && nextInChain(source->parent()) == algo) continue;
+
+    vector<Algorithm*> chain(1, algo);
+    while (Algorithm* next = nextInChain(chain.back())) chain.push_back(next);
+    while (chain.size() > 1 && !canBeReplaced(chain.back()->output("array"))) chain.pop_back();
+    if (chain.size() < 2) continue;
+
+    vector<string> operations;
+    vector<Real> values;
+    for (int j=0; j<(int)chain.size(); j++) addOperations(chain[j], operations, values);
+
+    FusedChain fused;
+    fused.fused = AlgorithmFactory::create(fusedName,
+                                           "operations", operations,
+                                           "values", values);
+    fused.chain = chain;
+    fused.source = source;
+
+    SourceBase& output = chain.back()->output("array");
+    fused.sinks = output.sinks();
+    fused.fused->output("array").setBufferInfo(output.bufferInfo());
+
+    E_DEBUG(ENetwork, "fusing " << chain.size() << " " << algo->name() << " starting at "
+            << algo->input("array").fullName() << " into " << fusedName);
+
+    disconnect(*source, input);
+    for (int j=0; j<(int)fused.sinks.size(); j++) {
+      disconnect(output, *fused.sinks[j]);
+      connect(fused.fused->output("array"), *fused.sinks[j]);
+    }
+    connect(*source, fused.fused->input("array"));
+
+    _fusedChains.push_back(fused);
+  }
+
+  return (int)_fusedChains.size() > nFused;
+}
+
+bool Network::unfuseElementwiseChains() {
+  if (_fusedChains.empty()) return false;
+
+  // the visible network only contains fused algorithms if it was rebuilt
+  // while they were connected
+  vector<Algorithm*> visible = depthFirstMap(_visibleNetworkRoot, returnAlgorithm);
+  bool rebuildVisible = false;
+
+  for (int i=(int)_fusedChains.size()-1; i>=0; i--) {
+    FusedChain& fused = _fusedChains[i];
+    SourceBase& output = fused.chain.back()->output("array");
+
+    disconnect(*fused.source, fused.fused->input("array"));
+    for (int j=0; j<(int)fused.sinks.size(); j++) {
+      disconnect(fused.fused->output("array"), *fused.sinks[j]);
+      connect(output, *fused.sinks[j]);
+    }
+    connect(*fused.source, fused.chain[0]->input("array"));
+
+    if (contains(visible, fused.fused)) rebuildVisible = true;
+    delete fused.fused;
+  }
+  _fusedChains.clear();
+
+  if (rebuildVisible) buildVisibleNetwork();
+
+  return true;
+}
+
+
 // returns False when there are no more steps to run
 bool Network::runStep() {
-  // 5- actually run the network
+  // 6- actually run the network
   if (_toposortedNetwork.empty()) return false;
 
   streaming::Algorithm* gen = _toposortedNetwork[0];
@@ -282,7 +710,7 @@ bool Network::runStep() {
 #endif
 
   // first run the generator once
-  gen->process();
+  processAlgorithm(0);
 
   bool endOfStream = gen->shouldStop();
 
@@ -310,7 +738,7 @@ bool Network::runStep() {
       _toposortedNetwork[i]->shouldStop(endOfStream && runStack.empty());
       AlgorithmStatus status;
       do {
-        status = _toposortedNetwork[i]->process();
+        status = processAlgorithm(i);
 
 #if DEBUGGING_ENABLED
         if (status == OK || status == FINISHED) _toposortedNetwork[i]->nProcess++;
@@ -341,6 +769,17 @@ bool Network::runStep() {
   }
   E_DEBUG(EScheduler, dash << " Buffer states after running the generator and all the nodes " << dash);
   printBufferFillState();
+
+  if (_tracing) traceBufferFill();
+
+  // the memory usage only changes slowly, and estimating it requires going
+  // through all the buffers, so it is not checked after every step
+  const int memoryCheckInterval = 16;
+  if (_memoryBudget && ++_stepsSinceMemoryCheck >= memoryCheckInterval) {
+    _stepsSinceMemoryCheck = 0;
+    checkMemoryBudget();
+  }
+
   return true;
 }
 
@@ -966,6 +1405,93 @@ void Network::printBufferFillState() {
   }
 }
 
+// name under which the memory of an algorithm is reported
+static string memoryUsageName(const Algorithm* algo) {
+  const PoolStorageBase* storage = dynamic_cast<const PoolStorageBase*>(algo);
+  if (storage) return algo->name() + "[" + storage->descriptorName() + "]";
+  return algo->name();
+}
+
+static string megabytes(size_t bytes) {
+  ostringstream s;
+  s << fixed << setprecision(1) << bytes / (1024.*1024.) << " MB";
+  return s.str();
+}
+
+MemoryMap Network::memoryUsage() {
+  MemoryMap usage;
+  vector<Algorithm*> algos = depthFirstMap(executionNetworkRoot(), returnAlgorithm);
+
+  for (int i=0; i<(int)algos.size(); i++) {
+    Algorithm* algo = algos[i];
+    AlgorithmMemory& memory = usage[memoryUsageName(algo)];
+    for (Algorithm::OutputMap::const_iterator output = algo->outputs().begin();
+         output != algo->outputs().end();
+         ++output) {
+      memory.buffers += output->second->memoryUsage();
+    }
+    memory.algorithm += algo->memoryUsage();
+  }
+
+  return usage;
+}
+
+size_t Network::totalMemoryUsage() {
+  MemoryMap usage = memoryUsage();
+  size_t total = 0;
+  for (MemoryMap::const_iterator it = usage.begin(); it != usage.end(); ++it) {
+    total += it->second.total();
+  }
+  return total;
+}
+
+void Network::printMemoryUsage() {
+  if (!E_ACTIVE(EMemory)) return;
+
+  MemoryMap usage = memoryUsage();
+  size_t buffers = 0, algorithms = 0;
+
+  E_DEBUG(EMemory, pad("Algorithm", 40) << pad("buffers", 12, ' ', true)
+          << pad("algorithm", 12, ' ', true));
+  for (MemoryMap::const_iterator it = usage.begin(); it != usage.end(); ++it) {
+    E_DEBUG(EMemory, pad(it->first, 40)
+            << pad(megabytes(it->second.buffers), 12, ' ', true)
+            << pad(megabytes(it->second.algorithm), 12, ' ', true));
+    buffers += it->second.buffers;
+    algorithms += it->second.algorithm;
+  }
+  E_DEBUG(EMemory, pad("Total", 40) << pad(megabytes(buffers), 12, ' ', true)
+          << pad(megabytes(algorithms), 12, ' ', true));
+  E_DEBUG(EMemory, "Peak resident memory of the process: " << megabytes(peakResidentMemory()));
+
+  // if we compile without debugging
+  NOWARN_UNUSED(buffers);
+  NOWARN_UNUSED(algorithms);
+}
+
+void Network::checkMemoryBudget() {
+  MemoryMap usage = memoryUsage();
+
+  vector<pair<size_t, string> > consumers;
+  size_t total = 0;
+  for (MemoryMap::const_iterator it = usage.begin(); it != usage.end(); ++it) {
+    consumers.push_back(make_pair(it->second.total(), it->first));
+    total += it->second.total();
+  }
+  if (total <= _memoryBudget) return;
+
+  sort(consumers.rbegin(), consumers.rend());
+
+  ostringstream msg;
+  msg << "Network: memory budget of " << megabytes(_memoryBudget) << " exceeded ("
+      << megabytes(total) << " used). Largest consumers: ";
+  for (int i=0; i<min((int)consumers.size(), 5); i++) {
+    if (i > 0) msg << ", ";
+    msg << consumers[i].second << " (" << megabytes(consumers[i].first) << ")";
+  }
+  throw EssentiaException(msg);
+}
+
 void printNetworkBufferFillState() {
   if (!Network::lastCreated) {
     E_WARNING("No network created, or last created network has been deleted...");
@@ -22,15 +22,19 @@
 
 #include <vector>
 #include <set>
+#include <map>
+#include <string>
 #include <stack>
 #include "../streaming/streamingalgorithm.h"
 #include "../essentiautil.h"
+#include "networktrace.h"
 
 namespace essentia {
 namespace streaming {
 
 class AlgorithmComposite;
 class SourceBase;
+class SinkBase;
 
 } // namespace streaming
 } // namespace essentia
@@ -74,6 +78,34 @@ class NetworkNode {
   std::vector<NetworkNode*> _children;
 };
 
+/**
+ * Processing statistics of the algorithms with a given name, accumulated by
+ * Network::run() over all the networks run while profiling is enabled.
+ */
+struct AlgorithmProfile {
+  long long nProcess;   // number of calls to process()
+  long long nNoOutput;  // number of calls that returned NO_OUTPUT
+  double time;          // total time spent in process(), in seconds
+
+  AlgorithmProfile() : nProcess(0), nNoOutput(0), time(0) {}
+};
+
+typedef std::map<std::string, AlgorithmProfile> ProfileMap;
+
+/**
+ * Estimate of the memory used by an algorithm of a network, in bytes, as
+ * returned by Network::memoryUsage().
+ */
+struct AlgorithmMemory {
+  size_t buffers;    // the buffers of its outputs
+  size_t algorithm;  // the memory held by the algorithm itself (accumulated data)
+
+  AlgorithmMemory() : buffers(0), algorithm(0) {}
+  size_t total() const { return buffers + algorithm; }
+};
+
+typedef std::map<std::string, AlgorithmMemory> MemoryMap;
+
 typedef std::vector<NetworkNode*> NodeVector;
 typedef std::set<NetworkNode*> NodeSet;
 typedef std::stack<NetworkNode*> NodeStack;
@@ -196,12 +228,93 @@ class Network {
    */
   void printBufferFillState();
 
+  /**
+   * Returns an estimate of the memory used by each algorithm of the network,
+   * by algorithm name. PoolStorage algorithms are listed by the descriptor
+   * they store, as "PoolStorage[descriptor.name]".
+   */
+  MemoryMap memoryUsage();
+
+  /**
+   * Returns an estimate of the total memory used by the network, in bytes.
+   */
+  size_t totalMemoryUsage();
+
+  /**
+   * Prints the memory used by the buffers and the algorithms of the network,
+   * when the EMemory debugging module is active.
+   */
+  void printMemoryUsage();
+
+  /**
+   * Sets the maximum memory, in bytes, that the network may use as estimated
+   * by totalMemoryUsage(), 0 meaning no limit (default). The memory usage is
+   * checked before running the network and every few generator steps; when
+   * it exceeds the budget, an exception listing the largest consumers is
+   * thrown, so that the analysis fails early instead of being killed when
+   * the process runs out of memory.
+   */
+  void setMemoryBudget(size_t bytes) { _memoryBudget = bytes; }
+  size_t memoryBudget() const { return _memoryBudget; }
+
   /**
    * Last instance of Network created, 0 if it has been deleted or if
    * no network has been created yet.
    */
   static Network* lastCreated;
 
+  /**
+   * Enables or disables the profiling of all the networks run from now on.
+   * When enabled, the time spent in each call to process() is measured and
+   * added, at the end of run(), to the totals returned by profile(). This is
+   * meant for benchmarking whole extractors, and costs two clock reads per
+   * call to process().
+   */
+  static void setProfiling(bool enabled);
+  static bool profiling();
+
+  /**
+   * Returns the profiling totals, by algorithm name, of all the networks run
+   * while profiling was enabled since the last call to resetProfile().
+   */
+  static ProfileMap profile();
+  static void resetProfile();
+
+  /**
+   * Enables or disables the fusion of elementwise operators in all the
+   * networks run from now on (disabled by default). When enabled, each chain
+   * of UnaryOperator (resp. UnaryOperatorStream) algorithms connected one
+   * after the other is replaced, while the network runs, by a single
+   * Elementwise (resp. ElementwiseStream) algorithm computing the same
+   * values in one pass, without the intermediate buffers. The original
+   * algorithms are connected back at the end of run().
+   */
+  static void setElementwiseFusion(bool enabled);
+  static bool elementwiseFusion();
+
+  /**
+   * Enables or disables the tracing of all the networks run from now on.
+   * When enabled, each network records a timeline of its activity: the start
+   * and duration of each call to process(), the ports that did not have
+   * enough tokens (inputs) or space (outputs) when process() returned
+   * NO_INPUT or NO_OUTPUT, and the fill level of the output buffers after
+   * each step of the generator. The events are kept in memory in a ring of
+   * the given capacity, the oldest ones being dropped once it is full.
+   * Enabling tracing clears the events recorded so far. Like profiling, this
+   * costs two clock reads per call to process().
+   */
+  static void setTracing(bool enabled, int capacity=1<<20);
+  static bool tracing();
+  static void resetTrace();
+
+  /**
+   * Writes the events recorded while tracing was enabled in the Chrome
+   * trace-event JSON format (see writeChromeTrace()), to be loaded in a trace
+   * viewer. The events of a network are all written once its run() is over.
+   */
+  static void writeTrace(std::ostream& out);
+  static void writeTrace(const std::string& filename);
+
  protected:
   bool _takeOwnership;
   streaming::Algorithm* _generator;
@@ -209,6 +322,86 @@ class Network {
   NetworkNode* _executionNetworkRoot;
   std::vector<streaming::Algorithm*> _toposortedNetwork;
 
+  // profiling of the algorithms in _toposortedNetwork, in the same order
+  bool _profiling;
+  std::vector<AlgorithmProfile> _profile;
+
+  // tracing: the events not yet added to the global trace, and the indices
+  // of the names of the algorithms in _toposortedNetwork and of their ports,
+  // in the same order
+  bool _tracing;
+  int _traceThread;
+  std::vector<TraceEvent> _traceEvents;
+  std::vector<int> _traceAlgorithmNames;
+  std::vector<std::vector<int> > _traceInputNames;
+  std::vector<std::vector<int> > _traceOutputNames;
+
+  size_t _memoryBudget;
+  int _stepsSinceMemoryCheck;
+
+  /**
+   * A chain of elementwise operators replaced by a single algorithm.
+   */
+  struct FusedChain {
+    streaming::Algorithm* fused;
+    std::vector<streaming::Algorithm*> chain;
+    streaming::SourceBase* source;         // connected to the first of the chain
+    std::vector<streaming::SinkBase*> sinks; // connected to the last of the chain
+  };
+
+  std::vector<FusedChain> _fusedChains;
+
+  /**
+   * Replaces the chains of elementwise operators in the execution network by
+   * fused algorithms. Returns whether any chain has been replaced.
+   */
+  bool fuseElementwiseChains();
+
+  /**
+   * Connects back the chains replaced by fuseElementwiseChains() and deletes
+   * the fused algorithms. Returns whether any chain had been replaced.
+   */
+  bool unfuseElementwiseChains();
+
+  /**
+   * Throws an EssentiaException if the memory used by the network exceeds
+   * its budget.
+   */
+  void checkMemoryBudget();
+
+  /**
+   * Calls process() on the i-th algorithm of the execution order, measuring
+   * it if profiling is enabled.
+   */
+  streaming::AlgorithmStatus processAlgorithm(int i);
+
+  /**
+   * Adds the profile of the last run to the global totals.
+   */
+  void mergeProfile();
+
+  /**
+   * Gets the names of the algorithms and ports of the execution network in
+   * the global trace.
+   */
+  void prepareTrace();
+
+  /**
+   * Records a call to process() of the i-th algorithm of the execution order,
+   * and the ports which made it fail if it did.
+   */
+  void traceProcess(int i, double start, double end, streaming::AlgorithmStatus status);
+
+  /**
+   * Records the fill level of all the output buffers.
+   */
+  void traceBufferFill();
+
+  /**
+   * Adds the recorded events to the global trace.
+   */
+  void flushTrace();
+
   /**
    * Build the network of visibly connected algorithms (ie: do not enter composite
    * algorithms) and stores its root in @c _visibleNetworkRoot.
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <cstdio>
+#include <set>
+#include "networktrace.h"
+#include "../streaming/streamingalgorithm.h"
+
+using namespace std;
+
+namespace essentia {
+namespace scheduler {
+
+static string jsonString(const string& s) {
+  string result = "\"";
+  for (int i=0; i<(int)s.size(); i++) {
+    char c = s[i];
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    }
+    else if ((unsigned char)c < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      result += escaped;
+    }
+    else result += c;
+  }
+  return result + "\"";
+}
+
+static const char* statusName(int status) {
+  switch (status) {
+  case streaming::OK:        return "OK";
+  case streaming::PASS:      return "PASS";
+  case streaming::FINISHED:  return "FINISHED";
+  case streaming::NO_INPUT:  return "NO_INPUT";
+  case streaming::NO_OUTPUT: return "NO_OUTPUT";
+  }
+  return "UNKNOWN";
+}
+
+void writeChromeTrace(ostream& out, const TraceBuffer& events,
+                      const vector<string>& names, double startTime) {
+  // the times are given in microseconds
+  const double us = 1e6;
+  char number[32];
+
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+  // name the tracks of the threads
+  set<int> threads;
+  for (int i=0; i<events.size(); i++) threads.insert(events[i].thread);
+  const char* separator = "\n";
+  for (set<int>::const_iterator t = threads.begin(); t != threads.end(); ++t) {
+    out << separator << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << *t
+        << ", \"args\": {\"name\": \"Network thread " << *t << "\"}}";
+    separator = ",\n";
+  }
+
+  for (int i=0; i<events.size(); i++) {
+    const TraceEvent& event = events[i];
+    const string& name = names[event.name];
+
+    snprintf(number, sizeof(number), "%.3f", (event.time - startTime) * us);
+    out << separator << "{\"name\": " << jsonString(name) << ", \"ts\": " << number
+        << ", \"pid\": 1, \"tid\": " << event.thread << ", ";
+    separator = ",\n";
+
+    switch (event.type) {
+    case TraceEvent::Process:
+      snprintf(number, sizeof(number), "%.3f", event.duration * us);
+      out << "\"cat\": \"process\", \"ph\": \"X\", \"dur\": " << number
+          << ", \"args\": {\"status\": \"" << statusName(event.status) << "\"}}";
+      break;
+
+    case TraceEvent::AcquireFailure:
+      out << "\"cat\": \"acquire\", \"ph\": \"i\", \"s\": \"t\""
+          << ", \"args\": {\"status\": \"" << statusName(event.status) << "\""
+          << ", \"available\": " << event.tokens
+          << ", \"required\": " << event.size << "}}";
+      break;
+
+    case TraceEvent::BufferFill:
+      // the counters of the same port in different threads are kept apart
+      out << "\"cat\": \"buffer\", \"ph\": \"C\", \"id\": " << event.thread
+          << ", \"args\": {\"fill\": " << event.tokens << "}}";
+      break;
+    }
+  }
+
+  out << "\n], \"otherData\": {\"droppedEvents\": " << events.dropped() << "}}\n";
+}
+
+} // namespace scheduler
+} // namespace essentia
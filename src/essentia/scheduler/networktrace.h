@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_SCHEDULER_NETWORKTRACE_H
+#define ESSENTIA_SCHEDULER_NETWORKTRACE_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace essentia {
+namespace scheduler {
+
+/**
+ * An event of the timeline recorded by the networks while tracing is enabled
+ * (see Network::setTracing()).
+ */
+struct TraceEvent {
+  enum Type {
+    Process,         // a call to process() of an algorithm
+    AcquireFailure,  // a port that did not have enough tokens for process()
+    BufferFill       // the number of tokens in the buffer of an output
+  };
+
+  double time;      // in seconds, from the steady clock
+  float duration;   // in seconds, for Process events
+  int name;         // index of the name of the algorithm or port in the trace names
+  int thread;       // index of the thread which ran the network
+  short type;
+  short status;     // the AlgorithmStatus returned by process()
+  int tokens;       // AcquireFailure: tokens available, BufferFill: tokens in the buffer
+  int size;         // AcquireFailure: tokens required, BufferFill: size of the buffer
+};
+
+/**
+ * A ring of trace events of fixed capacity, in which the oldest events are
+ * overwritten by the new ones once it is full.
+ */
+class TraceBuffer {
+ public:
+  TraceBuffer(int capacity=0) : _next(0), _size(0), _dropped(0) { setCapacity(capacity); }
+
+  // clears the buffer
+  void setCapacity(int capacity) {
+    _events.assign(capacity, TraceEvent());
+    clear();
+  }
+
+  int capacity() const { return (int)_events.size(); }
+  int size() const { return _size; }
+
+  /**
+   * Returns the number of events overwritten since the last clear().
+   */
+  long long dropped() const { return _dropped; }
+
+  void clear() {
+    _next = 0;
+    _size = 0;
+    _dropped = 0;
+  }
+
+  void add(const TraceEvent& event) {
+    if (_events.empty()) return;
+    _events[_next] = event;
+    if (++_next == capacity()) _next = 0;
+    if (_size < capacity()) _size++;
+    else _dropped++;
+  }
+
+  /**
+   * Returns the i-th event, from the oldest one.
+   */
+  const TraceEvent& operator[](int i) const {
+    int index = _next - _size + i;
+    return _events[index < 0 ? index + capacity() : index];
+  }
+
+ protected:
+  std::vector<TraceEvent> _events;
+  int _next;
+  int _size;
+  long long _dropped;
+};
+
+/**
+ * Writes the events in the Chrome trace-event JSON format, which can be
+ * loaded in chrome://tracing or https://ui.perfetto.dev. The times are given
+ * from startTime, and names are the names the events refer to. Each thread of
+ * the trace is shown on its own track, where the calls to process() are shown
+ * as slices, the acquire failures as instant events and the buffer fill levels
+ * as counters. The number of events dropped by the ring is given as
+ * otherData.droppedEvents.
+ */
+void writeChromeTrace(std::ostream& out, const TraceBuffer& events,
+                      const std::vector<std::string>& names, double startTime);
+
+} // namespace scheduler
+} // namespace essentia
+
+#endif // ESSENTIA_SCHEDULER_NETWORKTRACE_H
@@ -57,6 +57,10 @@ namespace streaming {
  *
  * WARNING: if you overload the reset() method, do not forget to call the base class
  *          implementation in it.
+ *
+ * If consume() keeps the values it receives (or anything growing with the
+ * length of the stream) until finalProduce(), reimplement memoryUsage() so that
+ * networks can account for that memory.
  */
 class AccumulatorAlgorithm : public Algorithm {
  public:
@@ -35,7 +35,7 @@ class DiskWriter : public Algorithm {
   std::ostream *_out;
 
  public:
-  DiskWriter(const std::string& filename) : Algorithm() {
+  DiskWriter(const std::string& filename) : Algorithm(), _filename(filename) {
 
     declareInput(_data, 1, "data", "the data to write to disk");
     _name = "DiskWriter";
@@ -23,6 +23,7 @@
 #include <fstream>
 #include "../streamingalgorithm.h"
 #include "../../streamutil.h"
+#include "../../utils/featurefile.h"
 
 namespace essentia {
 namespace streaming {
@@ -39,6 +40,54 @@ template <> void inline write_binary<std::vector<Real> >(std::ostream* _stream,
 }
 
 
+// the token types that can be written as the frames of a feature file
+template <typename TokenType> inline bool featureFileType(FeatureFileType& type) {
+  return false;
+}
+
+#define FEATURE_FILE_TYPE(TokenType, featureType)                           \
+template <> inline bool featureFileType<TokenType>(FeatureFileType& type) { \
+  type = featureType;                                                       \
+  return true;                                                              \
+}
+
+FEATURE_FILE_TYPE(int, IntFeature)
+FEATURE_FILE_TYPE(Real, RealFeature)
+FEATURE_FILE_TYPE(std::complex<Real>, ComplexFeature)
+FEATURE_FILE_TYPE(std::vector<Real>, RealFeature)
+FEATURE_FILE_TYPE(std::vector<std::complex<Real> >, ComplexFeature)
+
+#undef FEATURE_FILE_TYPE
+
+template <typename TokenType> inline void write_frame(FeatureFileWriter* file,
+                                                      const TokenType& value) {
+  throw EssentiaException("FileOutput: this type of data cannot be written in frames mode");
+}
+
+template <> inline void write_frame<int>(FeatureFileWriter* file, const int& value) {
+  file->write(&value, 1);
+}
+
+template <> inline void write_frame<Real>(FeatureFileWriter* file, const Real& value) {
+  file->write(&value, 1);
+}
+
+template <> inline void write_frame<std::complex<Real> >(FeatureFileWriter* file,
+                                                         const std::complex<Real>& value) {
+  file->write(&value, 1);
+}
+
+template <> inline void write_frame<std::vector<Real> >(FeatureFileWriter* file,
+                                                        const std::vector<Real>& value) {
+  file->write(value);
+}
+
+template <> inline void write_frame<std::vector<std::complex<Real> > >(FeatureFileWriter* file,
+                                                                       const std::vector<std::complex<Real> >& value) {
+  file->write(value);
+}
+
+
 template <typename TokenType, typename StorageType = TokenType>
 class FileOutput : public Algorithm {
  protected:
@@ -46,9 +95,11 @@ class FileOutput : public Algorithm {
   std::ostream* _stream;
   std::string _filename;
   bool _binary;
+  bool _frames;
+  FeatureFileWriter* _featureFile;
 
  public:
-  FileOutput() : Algorithm(), _stream(NULL) {
+  FileOutput() : Algorithm(), _stream(NULL), _featureFile(NULL) {
     setName("FileOutput");
     declareInput(_data, 1, "data", "the incoming data to be stored in the output file");
 
@@ -57,11 +108,15 @@ class FileOutput : public Algorithm {
 
   ~FileOutput() {
     if (_stream != &std::cout) delete _stream;
+    delete _featureFile;
   }
 
   void declareParameters() {
     declareParameter("filename", "the name of the output file (use '-' for stdout)", "", "out.txt");
-    declareParameter("mode", "output mode", "{text,binary}", "text");
+    declareParameter("mode", "output mode: text, raw binary values, or binary frames with a header, to be read with FeatureFileReader", "{text,binary,frames}", "text");
+    declareParameter("sampleRate", "the sample rate of the frames, stored in the header in frames mode (0 if unknown)", "[0,inf)", 0.);
+    declareParameter("hopSize", "the hop size of the frames, stored in the header in frames mode (0 if unknown)", "[0,inf)", 0);
+    declareParameter("directIO", "in frames mode, whether to write the file with direct I/O, bypassing the system cache, if supported", "{true,false}", false);
   }
 
   void configure() {
@@ -76,9 +131,27 @@ class FileOutput : public Algorithm {
     }
 
     _binary = (parameter("mode").toString() == "binary");
+    _frames = (parameter("mode").toString() == "frames");
+
+    FeatureFileType type;
+    if (_frames && !featureFileType<TokenType>(type)) {
+      throw EssentiaException("FileOutput: only int, Real, complex and vectors of Real or complex can be written in frames mode");
+    }
+    if (_frames && _filename == "-") {
+      throw EssentiaException("FileOutput: cannot write to stdout in frames mode");
+    }
   }
 
   void createOutputStream() {
+    if (_frames) {
+      FeatureFileType type = RealFeature;
+      featureFileType<TokenType>(type);
+      FeatureFileHeader header(type, parameter("sampleRate").toReal(),
+                               parameter("hopSize").toInt());
+      _featureFile = new FeatureFileWriter(_filename, header, parameter("directIO").toBool());
+      return;
+    }
+
     if (_filename == "-") {
       _stream = &std::cout;
     }
@@ -93,13 +166,17 @@ class FileOutput : public Algorithm {
   }
 
   AlgorithmStatus process() {
-    if (!_stream) {
+    if (!_stream && !_featureFile) {
       createOutputStream();
     }
 
     EXEC_DEBUG("process()");
 
-    if (!_data.acquire(1)) return NO_INPUT;
+    if (!_data.acquire(1)) {
+      // the header of a feature file is complete once it is closed
+      if (shouldStop() && _featureFile) _featureFile->close();
+      return NO_INPUT;
+    }
 
     write(_data.firstToken());
 
@@ -108,7 +185,18 @@ class FileOutput : public Algorithm {
     return OK;
   }
 
+  void reset() {
+    Algorithm::reset();
+    // a new run writes the feature file again
+    delete _featureFile;
+    _featureFile = NULL;
+  }
+
   void write(const TokenType& value) {
+    if (_frames && _featureFile) {
+      write_frame(_featureFile, value);
+      return;
+    }
     if (!_stream) throw EssentiaException("FileOutput: not configured properly");
     if (_binary) {
       write_binary(_stream, value);
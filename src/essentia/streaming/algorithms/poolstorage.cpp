@@ -70,13 +70,37 @@ void connectSingleValue(SourceBase& source, Pool& pool, const string& descriptor
   connect(source, pool, descriptorName, true);
 }
 
+void connect(SourceBase& source, Pool& pool, const string& descriptorName,
+             const FrameEncoding& encoding) {
 
-#define GET_POOLSTORAGE_PROPERTIES(type) \
-  if (sameType(sourceType, typeid(type))) { \
-    p = ((PoolStorage<type>*)sinkAlg)->pool(); \
-    dname = ((PoolStorage<type>*)sinkAlg)->descriptorName(); \
+  const type_info& sourceType = source.typeInfo();
+
+  Algorithm* ps = 0;
+  if (sameType(sourceType, typeid(Real))) {
+    ps = new EncodedPoolStorage<Real>(&pool, descriptorName, encoding);
+  }
+  else if (sameType(sourceType, typeid(int))) {
+    ps = new EncodedPoolStorage<int>(&pool, descriptorName, encoding);
+  }
+  else if (sameType(sourceType, typeid(vector<Real>))) {
+    ps = new EncodedPoolStorage<vector<Real> >(&pool, descriptorName, encoding);
   }
 
+  if (!ps) throw EssentiaException("Pool Storage can't encode frames of type: ", nameOfType(sourceType));
+
+  try {
+    connect(source, ps->input("data"));
+  }
+  catch (EssentiaException& e) {
+    delete ps;
+    std::ostringstream msg;
+    msg << "While connecting " << source.fullName()
+        << " to Pool[" << descriptorName << "]:\n"
+        << e.what();
+    throw EssentiaException(msg);
+  }
+}
+
 
 void disconnect(SourceBase& source, Pool& pool, const string& descriptorName) {
   // find pool storage that this source is connected to (one that matches the
@@ -85,30 +109,10 @@ void disconnect(SourceBase& source, Pool& pool, const string& descriptorName) {
     SinkBase& sink = *(source.sinks()[i]);
     Algorithm* sinkAlg = sink.parent();
 
-    if (sinkAlg->name() == "PoolStorage") {
-      const type_info& sourceType = source.typeInfo();
-      Pool* p;
-      string dname;
-
-      GET_POOLSTORAGE_PROPERTIES(Real)
-      else GET_POOLSTORAGE_PROPERTIES(string)
-      else GET_POOLSTORAGE_PROPERTIES(vector<string>)
-      else GET_POOLSTORAGE_PROPERTIES(vector<Real>)
-      else GET_POOLSTORAGE_PROPERTIES(TNT::Array2D<Real>)
-      else GET_POOLSTORAGE_PROPERTIES(StereoSample)
-      else if (sameType(sourceType, typeid(int))) {
-        p = ((PoolStorage<Real>*)sinkAlg)->pool();
-        dname = ((PoolStorage<Real>*)sinkAlg)->descriptorName();
-      }
-      else {
-        ostringstream msg;
-        msg << "internal error: it seems that a source (";
-        msg << source.parent()->name() << "::" << source.name();
-        msg << ") with an invalid type has been connected to a Pool, this shouldn't happen";
-        throw EssentiaException(msg);
-      }
-
-      if (p == &pool && dname == descriptorName) {
+    // plain and encoded PoolStorages all derive from PoolStorageBase
+    PoolStorageBase* storage = dynamic_cast<PoolStorageBase*>(sinkAlg);
+    if (storage) {
+      if (storage->pool() == &pool && storage->descriptorName() == descriptorName) {
         disconnect(source, sink);
 
         // since the PoolStorage is no longer connected to a network, it must be
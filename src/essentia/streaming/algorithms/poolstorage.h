@@ -22,6 +22,7 @@
 
 #include "../streamingalgorithm.h"
 #include "../../pool.h"
+#include "../../utils/frameencoding.h"
 
 namespace essentia {
 namespace streaming {
@@ -31,10 +32,11 @@ class PoolStorageBase : public Algorithm {
   Pool* _pool;
   std::string _descriptorName;
   bool _setSingle;
+  size_t _memoryUsage; // memory used by the values added since the last reset
 
  public:
   PoolStorageBase(Pool* pool, const std::string& descriptorName, bool setSingle = false) :
-    _pool(pool), _descriptorName(descriptorName), _setSingle(setSingle) {}
+    _pool(pool), _descriptorName(descriptorName), _setSingle(setSingle), _memoryUsage(0) {}
 
   ~PoolStorageBase() {}
 
@@ -46,6 +48,15 @@ class PoolStorageBase : public Algorithm {
     return _pool;
   }
 
+  void reset() {
+    Algorithm::reset();
+    _memoryUsage = 0;
+  }
+
+  size_t memoryUsage() const {
+    return _memoryUsage;
+  }
+
 };
 
 template <typename TokenType, typename StorageType = TokenType>
@@ -80,6 +91,9 @@ class PoolStorage : public PoolStorageBase {
     }
 
     EXEC_DEBUG("appending tokens to pool");
+    const std::vector<TokenType>& tokens = _descriptor.tokens();
+    for (int i=0; i<ntokens; i++) _memoryUsage += essentia::memoryUsage(tokens[i]);
+
     if (ntokens > 1) {
       _pool->append(_descriptorName, _descriptor.tokens());
     }
@@ -138,6 +152,75 @@ class PoolStorage : public PoolStorageBase {
 };
 
 
+/**
+ * Stores the frames of a descriptor of Reals or vectors of Reals encoded with a
+ * FrameEncoding, so that decimated frames never enter the Pool. The metadata
+ * needed to decode the frames is set in the Pool with the first frame.
+ */
+template <typename TokenType>
+class EncodedPoolStorage : public PoolStorageBase {
+ protected:
+  Sink<TokenType> _descriptor;
+  FrameEncoder _encoder;
+  bool _metadataSet;
+  std::vector<Real> _codes;
+
+ public:
+  EncodedPoolStorage(Pool* pool, const std::string& descriptorName,
+                     const FrameEncoding& encoding) :
+    PoolStorageBase(pool, descriptorName), _encoder(encoding), _metadataSet(false) {
+
+    setName("PoolStorage");
+    declareInput(_descriptor, 1, "data", "the input data");
+  }
+
+  ~EncodedPoolStorage() {}
+
+  void declareParameters() {}
+
+  void reset() {
+    PoolStorageBase::reset();
+    _encoder.reset();
+    _metadataSet = false;
+  }
+
+  AlgorithmStatus process() {
+    int ntokens = std::min(_descriptor.available(),
+                           _descriptor.buffer().bufferInfo().maxContiguousElements);
+    ntokens = std::max(ntokens, 1);
+
+    if (!_descriptor.acquire(ntokens)) {
+      return NO_INPUT;
+    }
+
+    if (!_metadataSet) {
+      _encoder.setMetadata(*_pool, _descriptorName);
+      _metadataSet = true;
+    }
+
+    const std::vector<TokenType>& tokens = _descriptor.tokens();
+    for (int i=0; i<ntokens; i++) addToPool(tokens[i]);
+
+    _descriptor.release(ntokens);
+
+    return OK;
+  }
+
+  void addToPool(Real value) {
+    Real code;
+    if (!_encoder.encode(value, code)) return;
+    _memoryUsage += essentia::memoryUsage(code);
+    _pool->add(_descriptorName, code);
+  }
+
+  void addToPool(const std::vector<Real>& frame) {
+    if (!_encoder.encode(frame, _codes)) return;
+    _memoryUsage += essentia::memoryUsage(_codes);
+    _pool->add(_descriptorName, _codes);
+  }
+};
+
+
 /**
  * Connect a source (eg: the output of an algorithm) to a Pool, and use the given
  * name as an identifier in the Pool.
@@ -145,13 +228,23 @@ class PoolStorage : public PoolStorageBase {
 void connect(SourceBase& source, Pool& pool,
              const std::string& descriptorName);
 
+/**
+ * Connect a source of Reals or vectors of Reals to a Pool, and store its frames
+ * encoded with the given encoding (see FrameEncoding).
+ */
+void connect(SourceBase& source, Pool& pool,
+             const std::string& descriptorName, const FrameEncoding& encoding);
+
 class PoolConnector {
  protected:
   Pool& pool;
   std::string name;
+  FrameEncoding encoding;
 
  public:
   PoolConnector(Pool& p, const std::string& descName) : pool(p), name(descName) {}
+  PoolConnector(Pool& p, const std::string& descName, const FrameEncoding& enc) :
+    pool(p), name(descName), encoding(enc) {}
 
   friend void operator>>(SourceBase& source, const PoolConnector& pc);
 };
@@ -161,7 +254,8 @@ class PoolConnector {
 // The reason why this function is defined with a const PC& as argument is described here:
 // http://herbsutter.com/2008/01/01/gotw-88-a-candidate-for-the-most-important-const/
 inline void operator>>(SourceBase& source, const PoolConnector& pc) {
-  connect(source, pc.pool, pc.name);
+  if (pc.encoding.isIdentity()) connect(source, pc.pool, pc.name);
+  else                          connect(source, pc.pool, pc.name, pc.encoding);
 }
 
 /**
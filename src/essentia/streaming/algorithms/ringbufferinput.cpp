@@ -50,18 +50,34 @@ void RingBufferInput::configure()
 	_impl = new RingBufferImpl(RingBufferImpl::kAvailable,parameter("bufferSize").toInt());
 }
 
-void RingBufferInput::add(Real* inputData, int size)
+void RingBufferInput::add(const Real* inputData, int size)
 {
 	//std::cerr << "adding " << size << " to ringbuffer with space " << _impl->_space << std::endl;
 	int added = _impl->add(inputData,size);
 	if (added < size) throw EssentiaException("Not enough space in ringbuffer at input");
 }
 
+int RingBufferInput::available() const
+{
+	return _impl->_available;
+}
+
+void RingBufferInput::endOfStream()
+{
+	_impl->endOfStream();
+}
+
 AlgorithmStatus RingBufferInput::process() {
   //std::cerr << "ringbufferinput waiting" << std::endl;
   _impl->waitAvailable();
   //std::cerr << "ringbufferinput waiting done" << std::endl;
 
+  // the end of the stream has been reached
+  if (_impl->_available == 0) {
+    Algorithm::shouldStop(true);
+    return PASS;
+  }
+
   AlgorithmStatus status = acquireData();
 
   if (status != OK) {
@@ -83,11 +99,16 @@ AlgorithmStatus RingBufferInput::process() {
 
   assert(size);
 
+  if (_impl->_endOfStream && _impl->_available == 0) Algorithm::shouldStop(true);
+
   return OK;
 }
 
 void RingBufferInput::reset() {
   Algorithm::reset();
+  // shouldStop(bool) does nothing for this algorithm, which only stops at the
+  // end of the stream
+  Algorithm::shouldStop(false);
   _impl->reset();
 }
 
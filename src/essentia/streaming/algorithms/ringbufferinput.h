@@ -34,7 +34,19 @@ class RingBufferInput : public Algorithm {
   RingBufferInput();
   ~RingBufferInput();
 
-  void add(Real* inputData, int size);
+  void add(const Real* inputData, int size);
+
+  /**
+   * Returns the number of samples added and not yet output.
+   */
+  int available() const;
+
+  /**
+   * Marks the end of the stream: once the samples already added have been
+   * output, the algorithm stops, so that the algorithms connected to it
+   * produce their final results. Until then, it waits for data to be added.
+   */
+  void endOfStream();
 
   AlgorithmStatus process();
 
@@ -36,9 +36,10 @@ class VectorOutput : public Algorithm {
  protected:
   Sink<TokenType> _data;
   std::vector<TokenType>* _v;
+  size_t _memoryUsage; // memory used by the tokens added since the last reset
 
  public:
-  VectorOutput(std::vector<TokenType>* v = 0) : Algorithm(), _v(v) {
+  VectorOutput(std::vector<TokenType>* v = 0) : Algorithm(), _v(v), _memoryUsage(0) {
     setName("VectorOutput");
     declareInput(_data, 1, "data", "the input data");
   }
@@ -50,6 +51,7 @@ class VectorOutput : public Algorithm {
 
   void setVector(std::vector<TokenType>* v) {
     _v = v;
+    _memoryUsage = 0;
   }
 
   AlgorithmStatus process() {
@@ -75,6 +77,7 @@ class VectorOutput : public Algorithm {
     const TokenType* src = &_data.firstToken();
 
     fastcopy(dest, src, ntokens);
+    for (int i=0; i<ntokens; i++) _memoryUsage += essentia::memoryUsage(dest[i]);
     _data.release(ntokens);
 
     return OK;
@@ -82,6 +85,14 @@ class VectorOutput : public Algorithm {
 
   void reset() {
     //_acquireSize = acquireSize;
+    _memoryUsage = 0;
+  }
+
+  // only the memory of the tokens added since the last reset is accounted for,
+  // the vector itself (and what it already contained) belongs to the caller.
+  // It is updated in process(), as it is queried often while the network runs
+  size_t memoryUsage() const {
+    return _memoryUsage;
   }
 };
 
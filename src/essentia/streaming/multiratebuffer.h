@@ -36,6 +36,9 @@ class MultiRateBuffer {
   virtual BufferInfo bufferInfo() const = 0;
   virtual void setBufferInfo(const BufferInfo& info) = 0;
 
+  // estimate of the memory used by the buffer and the tokens it holds, in bytes
+  virtual size_t memoryUsage() const = 0;
+
   // add/remove readers to/from the buffer
   // returns the id of the newly attached reader
   virtual ReaderID addReader(bool startFromZero = false) = 0;
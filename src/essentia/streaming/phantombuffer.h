@@ -109,6 +109,10 @@ class PhantomBuffer : public MultiRateBuffer<T> {
     _buffer.resize(_bufferSize + _phantomSize);
   }
 
+  size_t memoryUsage() const {
+    return sizeof(*this) + heapMemoryUsage(_buffer);
+  }
+
   PhantomBuffer(SourceBase* parent, int size, int phantomSize) :
     _parent(parent),
     _bufferSize(size),
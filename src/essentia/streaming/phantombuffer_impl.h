@@ -50,8 +50,13 @@ ReaderID PhantomBuffer<T>::addReader(bool startFromZero) {
 
 template <typename T>
 void PhantomBuffer<T>::removeReader(ReaderID id) {
-  _readView.erase(_readView.begin() + id);
   _readWindow.erase(_readWindow.begin() + id);
+
+  // erasing a view would assign the following ones to it, ie: copy their
+  // contents into the buffer, so drop the last view instead and point the
+  // following ones to their shifted windows
+  _readView.pop_back();
+  for (int i=id; i<(int)_readWindow.size(); i++) updateReadView(i);
 }
 
 
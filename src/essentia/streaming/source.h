@@ -62,6 +62,10 @@ class Source : public SourceBase {
     _buffer->setBufferInfo(info);
   }
 
+  virtual size_t memoryUsage() const {
+    return _buffer->memoryUsage();
+  }
+
   int totalProduced() const { return _buffer->totalTokensWritten(); }
 
   ReaderID addReader() {
@@ -113,6 +113,12 @@ class SourceBase : public Connector {
   virtual BufferInfo bufferInfo() const = 0;
   virtual void setBufferInfo(const BufferInfo& info) = 0;
 
+  /**
+   * Returns an estimate of the memory used by the buffer of this source, in
+   * bytes, including the memory owned by the tokens it holds.
+   */
+  virtual size_t memoryUsage() const = 0;
+
  protected:
   // made those protected so that only our friend streaming::{dis}connect() functions can access these
   // @todo this function should probably be protected by a mutex (?)
@@ -80,6 +80,11 @@ class SourceProxyBase : public SourceBase {
     _proxiedSource->setBufferInfo(info);
   }
 
+  // the buffer belongs to the proxied source, and is accounted for there
+  virtual size_t memoryUsage() const {
+    return 0;
+  }
+
 
   //---- StreamConnector interface hijacking for proxies ----------------------------------------//
 
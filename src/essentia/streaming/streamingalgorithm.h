@@ -222,6 +222,21 @@ class ESSENTIA_API Algorithm : public Configurable {
    */
   virtual void reset();
 
+  /**
+   * Returns an estimate of the memory held by this algorithm, in bytes, not
+   * counting the buffers of its outputs. Algorithms which accumulate data
+   * during the processing of a stream (e.g. into a vector or a Pool) should
+   * reimplement it, so that networks can account for that memory and enforce
+   * their memory budget. Its cost should be small compared to process().
+   *
+   * Wrappers of standard algorithms return the memoryUsage() of the wrapped
+   * algorithm. Composites are expanded by the networks, so the memory of the
+   * PoolStorage and VectorOutput algorithms inside them is accounted for;
+   * a composite only needs to reimplement it for the data it accumulates
+   * itself, outside of its inner algorithms.
+   */
+  virtual size_t memoryUsage() const { return 0; }
+
  protected:
   /** Declare a Sink for this algorithm. The sink uses its default acquire/release size. */
   void declareInput(SinkBase& sink, const std::string& name, const std::string& desc);
@@ -78,6 +78,10 @@ class StreamingAlgorithmWrapper : public Algorithm {
     E_DEBUG(EAlgorithm, "Standard : " << name() << "::reset() ok!");
   }
 
+  size_t memoryUsage() const {
+    return _algorithm->memoryUsage();
+  }
+
   void setParameters(const ParameterMap& params) {
     Configurable::setParameters(params);
     _algorithm->setParameters(params);
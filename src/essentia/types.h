@@ -67,6 +67,19 @@ namespace essentia {
  */
 typedef float Real;
 
+/**
+ * The typedef for real numbers used internally by numerically sensitive
+ * computations (recursive filter states, Levinson-Durbin recursion, Viterbi
+ * decoding, loudness integration), where the rounding errors of Real would
+ * accumulate. It is double by default, and the same as Real when building
+ * the float-only profile (see the --float-only configure option).
+ */
+#ifdef ESSENTIA_FLOAT_ONLY
+typedef Real PreciseReal;
+#else
+typedef double PreciseReal;
+#endif
+
 
 /**
  * Exception class for Essentia. It has a whole slew of different constructors
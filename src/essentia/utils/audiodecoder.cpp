@@ -0,0 +1,381 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "audiodecoder.h"
+#include <iomanip>  //  setw()
+
+using namespace std;
+
+namespace essentia {
+
+AudioDecoder::AudioDecoder(const string& name)
+  : _name(name), _buffer(0), _planeSize(0), _demuxCtx(0), _audioCtx(0),
+    _audioCodec(0), _decodedFrame(0), _outputFormat(AV_SAMPLE_FMT_FLT),
+    _md5Encoded(0), _computeMD5(false), _convertCtxAv(0), _streamIdx(-1),
+    _samples(0) {
+
+  // Register all formats and codecs
+  av_register_all();
+
+  // use av_malloc, because we _need_ the buffer to be 16-byte aligned
+  _buffer = (float*)av_malloc(FFMPEG_BUFFER_SIZE);
+
+  _md5Encoded = av_md5_alloc();
+  if (!_md5Encoded) {
+    throw EssentiaException("Error allocating the MD5 context");
+  }
+
+  _decodedFrame = av_frame_alloc();
+  if (!_decodedFrame) {
+    throw EssentiaException(_name, ": Could not allocate audio frame");
+  }
+
+  av_init_packet(&_packet);
+  _packet.data = NULL;
+  _packet.size = 0;
+  _remaining = _packet;
+}
+
+
+AudioDecoder::~AudioDecoder() {
+  close();
+
+  av_freep(&_buffer);
+  av_freep(&_md5Encoded);
+  av_frame_free(&_decodedFrame);
+}
+
+
+void AudioDecoder::open(const string& filename, int audioStream,
+                        AVSampleFormat outputFormat, bool computeMD5) {
+  close();
+
+  E_DEBUG(EAlgorithm, _name << ": opening file: " << filename);
+
+  // Open file
+  int errnum;
+  if ((errnum = avformat_open_input(&_demuxCtx, filename.c_str(), NULL, NULL)) != 0) {
+    char errorstr[128];
+    string error = "Unknown error";
+    if (av_strerror(errnum, errorstr, 128) == 0) error = errorstr;
+    throw EssentiaException(_name, ": Could not open file \"", filename, "\", error = " + error);
+  }
+
+  // Retrieve stream information
+  if ((errnum = avformat_find_stream_info(_demuxCtx, NULL)) < 0) {
+    char errorstr[128];
+    string error = "Unknown error";
+    if (av_strerror(errnum, errorstr, 128) == 0) error = errorstr;
+    avformat_close_input(&_demuxCtx);
+    _demuxCtx = 0;
+    throw EssentiaException(_name, ": Could not find stream information, error = ", error);
+  }
+
+  // Look for the audio streams of the file
+  vector<int> streams;
+  for (int i=0; i<(int)_demuxCtx->nb_streams; i++) {
+    if (_demuxCtx->streams[i]->codec->codec_type == AVMEDIA_TYPE_AUDIO) {
+      streams.push_back(i);
+    }
+  }
+  int nAudioStreams = streams.size();
+
+  if (nAudioStreams == 0) {
+    avformat_close_input(&_demuxCtx);
+    _demuxCtx = 0;
+    throw EssentiaException(_name, " ERROR: found 0 streams in the file, expecting one or more audio streams");
+  }
+
+  if (audioStream >= nAudioStreams) {
+    avformat_close_input(&_demuxCtx);
+    _demuxCtx = 0;
+    ostringstream msg;
+    msg << _name << " ERROR: 'audioStream' parameter set to " << audioStream
+        << ". It should be smaller than the audio streams count, " << nAudioStreams;
+    throw EssentiaException(msg);
+  }
+
+  _streamIdx = streams[audioStream];
+
+  // Load corresponding audio codec
+  _audioCtx = _demuxCtx->streams[_streamIdx]->codec;
+  _audioCodec = avcodec_find_decoder(_audioCtx->codec_id);
+
+  if (!_audioCodec) {
+    throw EssentiaException(_name, ": Unsupported codec!");
+  }
+
+  if (avcodec_open2(_audioCtx, _audioCodec, NULL) < 0) {
+    throw EssentiaException(_name, ": Unable to instantiate codec...");
+  }
+
+  int nChannels = _audioCtx->channels;
+  if (nChannels <= 0) {
+    throw EssentiaException(_name, ": could not load audio. Audio file has no channels.");
+  }
+
+  // Configure format conversion, keeping the channel layout of the file (no
+  // downmixing, no samplerate conversion). Decoders that already output the
+  // requested format do not need any conversion at all.
+  _outputFormat = outputFormat;
+  if (_audioCtx->sample_fmt != _outputFormat) {
+    int64_t layout = _audioCtx->channel_layout;
+    if (!layout || av_get_channel_layout_nb_channels(layout) != nChannels) {
+      layout = av_get_default_channel_layout(nChannels);
+    }
+
+    E_DEBUG(EAlgorithm, _name << ": using sample format conversion from libavresample");
+    _convertCtxAv = avresample_alloc_context();
+
+    av_opt_set_int(_convertCtxAv, "in_channel_layout", layout, 0);
+    av_opt_set_int(_convertCtxAv, "out_channel_layout", layout, 0);
+    av_opt_set_int(_convertCtxAv, "in_sample_rate", _audioCtx->sample_rate, 0);
+    av_opt_set_int(_convertCtxAv, "out_sample_rate", _audioCtx->sample_rate, 0);
+    av_opt_set_int(_convertCtxAv, "in_sample_fmt", _audioCtx->sample_fmt, 0);
+    av_opt_set_int(_convertCtxAv, "out_sample_fmt", _outputFormat, 0);
+
+    if (avresample_open(_convertCtxAv) < 0) {
+      throw EssentiaException(_name, ": Could not initialize avresample context");
+    }
+  }
+
+  // one plane per channel for planar output, one plane for all of them otherwise
+  int nPlanes = av_sample_fmt_is_planar(_outputFormat) ? nChannels : 1;
+  _planeSize = FFMPEG_BUFFER_SIZE / nPlanes;
+  _planeSize -= _planeSize % 16; // keep all planes aligned
+  _planes.resize(nPlanes);
+  for (int i=0; i<nPlanes; ++i) {
+    _planes[i] = (uint8_t*)_buffer + i*_planeSize;
+  }
+  _data.assign(nPlanes, (const float*)0);
+  _samples = 0;
+
+  _computeMD5 = computeMD5;
+  av_md5_init(_md5Encoded);
+}
+
+
+void AudioDecoder::close() {
+  if (!_demuxCtx) {
+    return;
+  }
+
+  if (_convertCtxAv) {
+    avresample_close(_convertCtxAv);
+    avresample_free(&_convertCtxAv);
+  }
+
+  // Close the codec
+  if (_audioCtx) avcodec_close(_audioCtx);
+  // Close the audio file
+  avformat_close_input(&_demuxCtx);
+
+  av_free_packet(&_packet);
+  _remaining = _packet;
+
+  _demuxCtx = 0;
+  _audioCtx = 0;
+  _audioCodec = 0;
+  _samples = 0;
+}
+
+
+bool AudioDecoder::readPacket() {
+  av_free_packet(&_packet);
+  _remaining = _packet;
+
+  // read packets until we get one of our stream
+  while (true) {
+    int result = av_read_frame(_demuxCtx, &_packet);
+    if (result != 0) {
+      // 0 = OK, < 0 = error or EOF
+      if (result != AVERROR_EOF) {
+        char errstring[1204];
+        av_strerror(result, errstring, sizeof(errstring));
+        E_WARNING(_name << ": Error reading frame: " << errstring);
+      }
+      // TODO: should try reading again on EAGAIN error?
+      //       https://github.com/FFmpeg/FFmpeg/blob/master/ffmpeg.c
+      return false;
+    }
+    if (_packet.stream_index == _streamIdx) break;
+    av_free_packet(&_packet);
+  }
+
+  // Note: md5 should be computed before decoding frame, as the decoding may
+  // change the content of a packet. Still, not sure if it is correct to
+  // compute md5 over packet which contains incorrect frames, potentially
+  // belonging to id3 metadata (TODO: or is it just a missing header issue?),
+  // but computing md5 hash using ffmpeg will also treat it as audio:
+  //      ffmpeg -i file.mp3 -acodec copy -f md5 -
+  if (_computeMD5) {
+    av_md5_update(_md5Encoded, _packet.data, _packet.size);
+  }
+
+  _remaining = _packet;
+  return true;
+}
+
+
+int AudioDecoder::decodePacket(AVPacket* packet, int* gotFrame) {
+  *gotFrame = 0;
+  av_frame_unref(_decodedFrame);
+  return avcodec_decode_audio4(_audioCtx, _decodedFrame, gotFrame, packet);
+}
+
+
+bool AudioDecoder::decodeFrame() {
+  _samples = 0;
+  if (_remaining.size <= 0) return false;
+
+  int gotFrame;
+  int len = decodePacket(&_remaining, &gotFrame);
+
+  if (len < 0) {
+    char errstring[1204];
+    av_strerror(len, errstring, sizeof(errstring));
+
+    if (_audioCtx->codec_id == AV_CODEC_ID_MP3) {
+      // mp3 streams can have tag frames (id3v2?) which libavcodec tries to
+      // read as audio anyway
+      // TODO: Are these frames really id3 tags?
+      E_WARNING(_name << ": invalid frame, skipping it: " << errstring);
+    }
+    else {
+      E_WARNING(_name << ": error while decoding, skipping frame: " << errstring);
+    }
+    _remaining.size = 0;
+    return false;
+  }
+
+  // Some decoders may support multiple frames in a single AVPacket. Such
+  // decoders would then just decode the first frame and the return value
+  // would be less than the packet size. In this case, avcodec_decode_audio4
+  // has to be called again with an AVPacket containing the remaining data
+  // in order to decode the second frame, etc... Even if no frames are
+  // returned, the packet needs to be fed to the decoder with remaining
+  // data until it is completely consumed or an error occurs.
+  // https://www.ffmpeg.org/doxygen/trunk/group__lavc__decoding.html#ga834bb1b062fbcc2de4cf7fb93f154a3e
+  if (len == 0 && !gotFrame) {
+    // the decoder did not make any progress, give up on this packet
+    _remaining.size = 0;
+    return false;
+  }
+  _remaining.size -= len;
+  _remaining.data += len;
+
+  if (gotFrame) convertFrame();
+  else E_DEBUG(EAlgorithm, _name << ": tried to decode packet but didn't get any frame...");
+
+  return true;
+}
+
+
+bool AudioDecoder::flushFrame() {
+  _samples = 0;
+
+  AVPacket empty;
+  av_init_packet(&empty);
+  empty.data = NULL;
+  empty.size = 0;
+
+  int gotFrame;
+  int len = decodePacket(&empty, &gotFrame);
+  if (len < 0) {
+    char errstring[1204];
+    av_strerror(len, errstring, sizeof(errstring));
+    E_WARNING(_name << ": decoding error while flushing a packet:" << errstring);
+    return false;
+  }
+  if (!gotFrame) return false;
+
+  convertFrame();
+  return true;
+}
+
+
+/**
+ * Converts the frame stored in _decodedFrame to the output format, and makes
+ * _data point to its samples.
+ */
+void AudioDecoder::convertFrame() {
+  int nsamples = _decodedFrame->nb_samples;
+  int nPlanes = (int)_planes.size();
+
+  if (!_convertCtxAv) {
+    // the decoder already outputs the requested format
+    for (int i=0; i<nPlanes; ++i) {
+      _data[i] = (const float*)_decodedFrame->extended_data[i];
+    }
+    _samples = nsamples;
+    return;
+  }
+
+  int nChannels = _audioCtx->channels;
+  // the size of a plane, in samples per channel
+  int planeSamples = _planeSize / (sizeof(float) * (nPlanes == 1 ? nChannels : 1));
+
+  if (planeSamples < nsamples) {
+    // this should never happen, throw exception here
+    throw EssentiaException(_name, ": Insufficient buffer size for format conversion");
+  }
+
+  int inputPlaneSize = av_samples_get_buffer_size(NULL, nChannels, nsamples,
+                                                  _audioCtx->sample_fmt, 1);
+
+  int samplesWritten = avresample_convert(_convertCtxAv,
+                                          &_planes[0],
+                                          _planeSize,
+                                          planeSamples,
+                                          _decodedFrame->extended_data,
+                                          inputPlaneSize,
+                                          nsamples);
+
+  if (samplesWritten < nsamples) {
+    // TODO: there may be data remaining in the internal FIFO buffer
+    // to get this data: call avresample_convert() with NULL input
+    // Test if this happens in practice
+    ostringstream msg;
+    msg << _name << ": Incomplete format conversion (some samples missing)"
+        << " from " << av_get_sample_fmt_name(_audioCtx->sample_fmt)
+        << " to "   << av_get_sample_fmt_name(_outputFormat);
+    throw EssentiaException(msg);
+  }
+
+  for (int i=0; i<nPlanes; ++i) {
+    _data[i] = (const float*)_planes[i];
+  }
+  _samples = nsamples;
+}
+
+
+string AudioDecoder::md5() {
+  if (!_computeMD5) return "";
+
+  uint8_t checksum[16];
+  av_md5_final(_md5Encoded, checksum);
+
+  ostringstream result;
+  for (int i=0; i<16; ++i) {
+    result << setw(2) << setfill('0') << hex << (int)checksum[i];
+  }
+  return result.str();
+}
+
+} // namespace essentia
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_AUDIODECODER_H
+#define ESSENTIA_AUDIODECODER_H
+
+#include <string>
+#include <vector>
+#include "types.h"
+#include "ffmpegapi.h"
+
+#define MAX_AUDIO_FRAME_SIZE 192000
+
+namespace essentia {
+
+/**
+ * Object-oriented wrapper around FFMPEG for reading the audio stream of a
+ * file, shared by the audio loaders. It demuxes the packets of the selected
+ * stream, computes their MD5 checksum, decodes them and converts the decoded
+ * frames to float samples, either interleaved (AV_SAMPLE_FMT_FLT) or planar
+ * (AV_SAMPLE_FMT_FLTP), without changing the channels or the sampling rate.
+ *
+ * The name given to the constructor is the one of the algorithm using the
+ * decoder, which is used in error and warning messages.
+ */
+class AudioDecoder {
+ protected:
+  std::string _name;
+
+  // MAX_AUDIO_FRAME_SIZE is in bytes, multiply it by 2 to get some margin,
+  // because a frame may be decoded in several chunks and each time we decode
+  // we need to have at least a full buffer of free space.
+  const static int FFMPEG_BUFFER_SIZE = MAX_AUDIO_FRAME_SIZE * 2;
+
+  // the conversion buffer, which holds the planes of all channels one after
+  // the other (or a single plane for interleaved samples)
+  float* _buffer;
+  std::vector<uint8_t*> _planes;
+  int _planeSize; // in bytes
+
+  AVFormatContext* _demuxCtx;
+  AVCodecContext* _audioCtx;
+  AVCodec* _audioCodec;
+  AVPacket _packet;
+  AVPacket _remaining;  // the part of _packet which has not been decoded yet
+  AVFrame* _decodedFrame;
+  AVSampleFormat _outputFormat;
+
+  AVMD5* _md5Encoded;
+  bool _computeMD5;
+
+  struct AVAudioResampleContext* _convertCtxAv;
+
+  int _streamIdx; // index of the audio stream among all the streams contained in the file
+
+  // the last decoded frame
+  std::vector<const float*> _data;
+  int _samples;
+
+  int decodePacket(AVPacket* packet, int* gotFrame);
+  void convertFrame();
+
+ public:
+  AudioDecoder(const std::string& name);
+  ~AudioDecoder();
+
+  /**
+   * Opens the audioStream-th audio stream of the file, to be decoded to the
+   * given sample format, which must be AV_SAMPLE_FMT_FLT or AV_SAMPLE_FMT_FLTP.
+   */
+  void open(const std::string& filename, int audioStream,
+            AVSampleFormat outputFormat, bool computeMD5);
+  void close();
+  bool isOpen() const { return _demuxCtx != 0; }
+
+  int channels() const { return _audioCtx->channels; }
+  Real sampleRate() const { return _audioCtx->sample_rate; }
+  std::string codec() const { return _audioCodec->name; }
+  int bitRate() const { return _audioCtx->bit_rate; }
+
+  /**
+   * Reads the next packet of the audio stream, and updates the MD5 checksum
+   * with its undecoded payload. Returns false at the end of the file.
+   */
+  bool readPacket();
+
+  /**
+   * Decodes the next frame of the packet given by readPacket(). Returns false
+   * once the whole packet has been decoded. The frame is empty when the
+   * decoder did not output any samples for this part of the packet.
+   */
+  bool decodeFrame();
+
+  /**
+   * Decodes the next of the frames delayed by the decoder, once all the
+   * packets have been read. Returns false when there are no more of them.
+   */
+  bool flushFrame();
+
+  /**
+   * Returns the number of samples per channel of the last decoded frame.
+   */
+  int samples() const { return _samples; }
+
+  /**
+   * Returns the samples of the last decoded frame: one plane per channel in
+   * planar format, or a single plane of interleaved samples.
+   */
+  const float* const* data() const { return &_data[0]; }
+
+  /**
+   * Returns the MD5 checksum of the packets read since the file was opened,
+   * in hexadecimal, or an empty string if it is not computed.
+   */
+  std::string md5();
+};
+
+} // namespace essentia
+
+#endif // ESSENTIA_AUDIODECODER_H
@@ -20,6 +20,7 @@
 #ifndef BPFUTIL_H
 #define BPFUTIL_H
 
+#include <algorithm>
 #include "types.h"
 
 namespace essentia {
@@ -61,7 +62,37 @@ namespace essentia {
           }
         }
 
-        inline float operator()(float x) {
+        inline float operator()(float x) const {
+          checkRange(x);
+          return value(x, segment(x));
+        }
+
+        /**
+         * Evaluates the function at each of the given x-values. Increasing
+         * x-values are located with a single walk over the points, and the
+         * other ones with a binary search, so that evaluating n values takes
+         * O(n + points) time if they are sorted, and O(n log(points))
+         * otherwise.
+         */
+        void operator()(const std::vector<Real>& x, std::vector<Real>& y) const {
+          y.resize(x.size());
+          std::vector<Real>::size_type j = 0;
+          for (int i=0; i<int(x.size()); ++i) {
+            checkRange(x[i]);
+            if (i > 0 && x[i] >= x[i-1]) {
+              while (x[i] > _xPoints[j+1]) {
+                j += 1;
+              }
+            }
+            else {
+              j = segment(x[i]);
+            }
+            y[i] = value(x[i], j);
+          }
+        }
+
+      protected:
+        inline void checkRange(float x) const {
           if (x < _xPoints[0]) {
             throw EssentiaException("BPF: Input x-value is before the first point");
           }
@@ -69,12 +100,14 @@ namespace essentia {
           if (x > _xPoints.back()) {
             throw EssentiaException("BPF: Input x-value is past the last point");
           }
+        }
 
-          std::vector<Real>::size_type j = 0;
-          while (x > _xPoints[j+1]) {
-            j += 1;
-          }
+        // the first segment whose end is not before x
+        inline std::vector<Real>::size_type segment(float x) const {
+          return std::lower_bound(_xPoints.begin() + 1, _xPoints.end() - 1, Real(x)) - _xPoints.begin() - 1;
+        }
 
+        inline float value(float x, std::vector<Real>::size_type j) const {
           return (x - _xPoints[j]) * _slopes[j] + _yPoints[j];
         }
     };
@@ -0,0 +1,467 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <cmath>
+#include "chunkedpoolaggregator.h"
+#include "essentiamath.h"
+#include "essentiautil.h"
+#include "tnt/tnt.h"
+#include "tnt/jama_lu.h"
+
+using namespace std;
+
+namespace essentia {
+
+ChunkedPoolAggregator::ChunkedPoolAggregator(const vector<string>& defaultStats) :
+  _defaultStats(defaultStats), _chunks(0) {}
+
+
+void ChunkedPoolAggregator::setExceptions(const map<string, vector<string> >& exceptions) {
+  for (map<string, vector<string> >::const_iterator it = exceptions.begin();
+       it != exceptions.end(); ++it) {
+    _exceptions[it->first] = it->second;
+  }
+}
+
+
+void ChunkedPoolAggregator::setFramePeriod(const string& prefix, Real period) {
+  if (period <= 0) {
+    throw EssentiaException("ChunkedPoolAggregator: the frame period of \"", prefix, "\" must be positive");
+  }
+  _framePeriods[prefix] = period;
+}
+
+
+const vector<string>& ChunkedPoolAggregator::getStats(const string& key) const {
+  map<string, vector<string> >::const_iterator it = _exceptions.find(key);
+  if (it != _exceptions.end()) return it->second;
+  return _defaultStats;
+}
+
+
+bool ChunkedPoolAggregator::needs(const string& key, const char* stat) const {
+  return contains(getStats(key), string(stat));
+}
+
+
+ChunkedPoolAggregator::FrameStats& ChunkedPoolAggregator::frameStats(const string& key,
+                                                                     bool scalar, int dim) {
+  map<string, FrameStats>::iterator it = _frames.find(key);
+  if (it != _frames.end()) {
+    FrameStats& stats = it->second;
+    if (!stats.skip && stats.dim != dim) {
+      E_WARNING("ChunkedPoolAggregator: not aggregating \"" << key << "\" because it has frames of different sizes");
+      stats.skip = true;
+    }
+    return stats;
+  }
+
+  FrameStats& stats = _frames[key];
+  stats.scalar = scalar;
+  stats.skip = false;
+  stats.dim = dim;
+  stats.n = stats.nd = stats.nd2 = 0;
+  stats.mean.assign(dim, 0.);
+  stats.m2.assign(dim, 0.);
+  stats.dmean.assign(dim, 0.);
+  stats.dm2.assign(dim, 0.);
+  stats.d2mean.assign(dim, 0.);
+  stats.d2m2.assign(dim, 0.);
+  if (!scalar && (needs(key, "cov") || needs(key, "icov"))) stats.scatter.assign(dim*dim, 0.);
+  stats.median.assign(dim, 0.);
+  stats.skew.assign(dim, 0.);
+  stats.kurt.assign(dim, 0.);
+  return stats;
+}
+
+
+// updates the running mean and sum of squared differences of a value (Welford)
+static inline void accumulate(double n, double& mean, double& m2, double x) {
+  double delta = x - mean;
+  mean += delta / n;
+  m2 += delta * (x - mean);
+}
+
+
+void ChunkedPoolAggregator::addFrame(FrameStats& stats, const Real* frame, bool covariance) {
+  int dim = stats.dim;
+
+  if (stats.n == 0) {
+    stats.min.assign(frame, frame + dim);
+    stats.max.assign(frame, frame + dim);
+  }
+  stats.n += 1;
+
+  // the co-moments need the means before and after the update
+  if (covariance) {
+    vector<double> delta(dim);
+    for (int j=0; j<dim; ++j) delta[j] = frame[j] - stats.mean[j];
+    for (int j=0; j<dim; ++j) {
+      double after = frame[j] - (stats.mean[j] + delta[j] / stats.n);
+      for (int k=0; k<dim; ++k) stats.scatter[k*dim + j] += delta[k] * after;
+    }
+  }
+
+  for (int j=0; j<dim; ++j) {
+    accumulate(stats.n, stats.mean[j], stats.m2[j], frame[j]);
+    stats.min[j] = min(stats.min[j], frame[j]);
+    stats.max[j] = max(stats.max[j], frame[j]);
+  }
+
+  // as in PoolAggregator, only the absolute values of the derivatives are
+  // considered. The previous frames are kept so that the derivatives are
+  // also computed across the chunk boundaries
+  if (!stats.previous.empty()) {
+    vector<Real> derivative(dim);
+    for (int j=0; j<dim; ++j) derivative[j] = frame[j] - stats.previous[j];
+
+    stats.nd += 1;
+    for (int j=0; j<dim; ++j) {
+      accumulate(stats.nd, stats.dmean[j], stats.dm2[j], abs(derivative[j]));
+    }
+
+    if (!stats.previousDerivative.empty()) {
+      stats.nd2 += 1;
+      for (int j=0; j<dim; ++j) {
+        accumulate(stats.nd2, stats.d2mean[j], stats.d2m2[j],
+                   abs(derivative[j] - stats.previousDerivative[j]));
+      }
+    }
+    stats.previousDerivative.swap(derivative);
+  }
+  stats.previous.assign(frame, frame + dim);
+}
+
+
+void ChunkedPoolAggregator::addColumnStats(FrameStats& stats, const string& key, int j,
+                                           const vector<Real>& column) {
+  double weight = column.size();
+  if (needs(key, "median")) stats.median[j] += weight * median(column);
+
+  if (needs(key, "skew") || needs(key, "kurt")) {
+    Real m = mean(column);
+    stats.skew[j] += weight * skewness(column, m);
+    stats.kurt[j] += weight * kurtosis(column, m);
+  }
+}
+
+
+// range [begin, end) of the frames of a chunk that do not only overlap with
+// the previous or the next chunk: the frames centered before overlap or after
+// duration - lookahead when the frame period of the descriptor is known, or
+// the corresponding proportions of the frames otherwise. At least one frame is
+// always kept, so that descriptors with a single value per chunk are never
+// ignored
+void ChunkedPoolAggregator::chunkFrames(const string& key, int size, Real duration,
+                                        Real overlap, Real lookahead,
+                                        int& begin, int& end) const {
+  begin = 0;
+  end = size;
+  if (duration <= 0) return;
+
+  // the longest prefix of the key which has a frame period
+  Real period = 0;
+  size_t prefixSize = 0;
+  for (map<string, Real>::const_iterator it = _framePeriods.begin();
+       it != _framePeriods.end(); ++it) {
+    const string& prefix = it->first;
+    if (prefix.size() >= prefixSize && key.compare(0, prefix.size(), prefix) == 0) {
+      period = it->second;
+      prefixSize = prefix.size();
+    }
+  }
+
+  // the tolerance absorbs the rounding of boundaries which fall on a frame
+  const double tolerance = 1e-3;
+  if (period > 0) {
+    if (overlap > 0) begin = int(ceil(overlap / period - tolerance));
+    if (lookahead > 0) end = int(ceil((duration - lookahead) / period - tolerance));
+  }
+  else {
+    if (overlap > 0) begin = int(size * (overlap / duration) + 0.5);
+    if (lookahead > 0) end = size - int(size * (lookahead / duration) + 0.5);
+  }
+  begin = max(min(begin, size - 1), 0);
+  end = min(max(end, begin + 1), size);
+}
+
+
+void ChunkedPoolAggregator::add(const Pool& chunk, Real duration, Real overlap, Real lookahead) {
+  double weight = max(duration - overlap - lookahead, (Real)0.);
+
+  // frame-wise descriptors
+  const PoolOf(Real)& realPool = chunk.getRealPool();
+  for (PoolOf(Real)::const_iterator it = realPool.begin(); it != realPool.end(); ++it) {
+    const string& key = it->first;
+    const vector<Real>& data = it->second;
+    if (data.empty()) continue;
+
+    FrameStats& stats = frameStats(key, true, 1);
+    if (stats.skip) continue;
+
+    int begin, end;
+    chunkFrames(key, data.size(), duration, overlap, lookahead, begin, end);
+    for (int i=begin; i<end; ++i) addFrame(stats, &data[i], false);
+
+    vector<Real> column(data.begin() + begin, data.begin() + end);
+    addColumnStats(stats, key, 0, column);
+    if (needs(key, "copy") || needs(key, "value")) {
+      stats.values.push_back(column);
+    }
+  }
+
+  const PoolOf(vector<Real>)& vectorRealPool = chunk.getVectorRealPool();
+  for (PoolOf(vector<Real>)::const_iterator it = vectorRealPool.begin();
+       it != vectorRealPool.end(); ++it) {
+    const string& key = it->first;
+    const vector<vector<Real> >& data = it->second;
+    if (data.empty()) continue;
+
+    int dim = data[0].size();
+    bool sameSize = true;
+    for (int i=1; i<(int)data.size(); ++i) {
+      if ((int)data[i].size() != dim) sameSize = false;
+    }
+    FrameStats& stats = frameStats(key, false, dim);
+    if (!sameSize && !stats.skip) {
+      E_WARNING("ChunkedPoolAggregator: not aggregating \"" << key << "\" because it has frames of different sizes");
+      stats.skip = true;
+    }
+    if (stats.skip || dim == 0) continue;
+
+    bool covariance = !stats.scatter.empty();
+    int begin, end;
+    chunkFrames(key, data.size(), duration, overlap, lookahead, begin, end);
+    for (int i=begin; i<end; ++i) addFrame(stats, &data[i][0], covariance);
+
+    vector<Real> column(end - begin);
+    for (int j=0; j<dim; ++j) {
+      for (int i=begin; i<end; ++i) column[i-begin] = data[i][j];
+      addColumnStats(stats, key, j, column);
+    }
+    if (needs(key, "copy") || needs(key, "value")) {
+      stats.values.insert(stats.values.end(), data.begin() + begin, data.begin() + end);
+    }
+  }
+
+  // descriptors computed once per chunk
+  const map<string, Real>& singleRealPool = chunk.getSingleRealPool();
+  for (map<string, Real>::const_iterator it = singleRealPool.begin();
+       it != singleRealPool.end(); ++it) {
+    pair<double, double>& sum = _singleReals[it->first];
+    sum.first += weight * it->second;
+    sum.second += weight;
+  }
+
+  const map<string, vector<Real> >& singleVectorRealPool = chunk.getSingleVectorRealPool();
+  for (map<string, vector<Real> >::const_iterator it = singleVectorRealPool.begin();
+       it != singleVectorRealPool.end(); ++it) {
+    const vector<Real>& value = it->second;
+    pair<vector<double>, double>& sum = _singleVectors[it->first];
+    if (sum.second == 0 && sum.first.empty()) sum.first.assign(value.size(), 0.);
+    if (sum.first.size() != value.size()) {
+      E_WARNING("ChunkedPoolAggregator: ignoring a value of \"" << it->first << "\" of a different size than in the previous chunks");
+      continue;
+    }
+    for (int j=0; j<(int)value.size(); ++j) sum.first[j] += weight * value[j];
+    sum.second += weight;
+  }
+
+  const map<string, string>& singleStringPool = chunk.getSingleStringPool();
+  for (map<string, string>::const_iterator it = singleStringPool.begin();
+       it != singleStringPool.end(); ++it) {
+    _votes[it->first][it->second] += weight;
+    _singleStrings.insert(it->first);
+  }
+
+  const PoolOf(string)& stringPool = chunk.getStringPool();
+  for (PoolOf(string)::const_iterator it = stringPool.begin(); it != stringPool.end(); ++it) {
+    const vector<string>& values = it->second;
+    for (int i=0; i<(int)values.size(); ++i) {
+      _votes[it->first][values[i]] += weight / values.size();
+    }
+  }
+
+  const PoolOf(vector<string>)& vectorStringPool = chunk.getVectorStringPool();
+  for (PoolOf(vector<string>)::const_iterator it = vectorStringPool.begin();
+       it != vectorStringPool.end(); ++it) {
+    vector<vector<string> >& values = _vectorStrings[it->first];
+    values.insert(values.end(), it->second.begin(), it->second.end());
+  }
+
+  if (!chunk.getArray2DRealPool().empty() || !chunk.getStereoSamplePool().empty()) {
+    E_WARNING("ChunkedPoolAggregator: Array2D and stereo descriptors are not aggregated");
+  }
+
+  ++_chunks;
+}
+
+
+// returns the inverse of a covariance matrix, computed in double precision
+// as in SingleGaussian
+static TNT::Array2D<double> inverseCovariance(const TNT::Array2D<double>& cov) {
+  JAMA::LU<double> solver(cov);
+  if (!solver.isNonsingular()) {
+    throw EssentiaException("ChunkedPoolAggregator: Cannot compute the inverse covariance because the covariance matrix is singular");
+  }
+  int dim = cov.dim1();
+  TNT::Array2D<double> identity(dim, dim, 0.0);
+  for (int i=0; i<dim; ++i) identity[i][i] = 1.0;
+  return solver.solve(identity);
+}
+
+
+void ChunkedPoolAggregator::addStats(const string& key, const FrameStats& stats,
+                                     Pool& output) const {
+  if (stats.skip || stats.n == 0) return;
+
+  int dim = stats.dim;
+  vector<Real> meanVals(dim), varVals(dim), stdevVals(dim), medianVals(dim);
+  vector<Real> skewVals(dim), kurtVals(dim);
+  vector<Real> dmeanVals(dim), dvarVals(dim), d2meanVals(dim), d2varVals(dim);
+
+  // derivatives of descriptors with fewer than 2 (or 3) frames are 0, as in
+  // PoolAggregator
+  for (int j=0; j<dim; ++j) {
+    meanVals[j] = stats.mean[j];
+    varVals[j] = stats.m2[j] / stats.n;
+    stdevVals[j] = sqrt(varVals[j]);
+    medianVals[j] = stats.median[j] / stats.n;
+    skewVals[j] = stats.skew[j] / stats.n;
+    kurtVals[j] = stats.kurt[j] / stats.n;
+    dmeanVals[j] = stats.dmean[j];
+    dvarVals[j] = stats.nd > 0 ? stats.dm2[j] / stats.nd : 0;
+    d2meanVals[j] = stats.d2mean[j];
+    d2varVals[j] = stats.nd2 > 0 ? stats.d2m2[j] / stats.nd2 : 0;
+  }
+
+  const vector<string>& statNames = getStats(key);
+
+  vector<vector<Real> > cov, icov;
+  if (!stats.scatter.empty()) {
+    if (stats.n < 2) {
+      throw EssentiaException("ChunkedPoolAggregator: Cannot compute the covariance of \"", key, "\" from a single frame");
+    }
+    TNT::Array2D<double> covDouble(dim, dim);
+    for (int j=0; j<dim; ++j) {
+      for (int k=0; k<dim; ++k) {
+        covDouble[j][k] = stats.scatter[j*dim + k] / (stats.n - 1); // unbiased estimator
+      }
+    }
+    TNT::Array2D<double> icovDouble;
+    if (contains(statNames, string("icov"))) icovDouble = inverseCovariance(covDouble);
+
+    cov.assign(dim, vector<Real>(dim));
+    icov.assign(dim, vector<Real>(dim));
+    for (int j=0; j<dim; ++j) {
+      for (int k=0; k<dim; ++k) {
+        cov[j][k] = covDouble[j][k];
+        if (icovDouble.dim1() == dim) icov[j][k] = icovDouble[j][k];
+      }
+    }
+  }
+
+  for (int i=0; i<(int)statNames.size(); ++i) {
+    const string& stat = statNames[i];
+    string subkey = key + "." + stat;
+    const vector<Real>* values = 0;
+
+    if      (stat == "mean")   values = &meanVals;
+    else if (stat == "median") values = &medianVals;
+    else if (stat == "min")    values = &stats.min;
+    else if (stat == "max")    values = &stats.max;
+    else if (stat == "var")    values = &varVals;
+    else if (stat == "stdev")  values = &stdevVals;
+    else if (stat == "skew")   values = &skewVals;
+    else if (stat == "kurt")   values = &kurtVals;
+    else if (stat == "dmean")  values = &dmeanVals;
+    else if (stat == "dvar")   values = &dvarVals;
+    else if (stat == "dmean2") values = &d2meanVals;
+    else if (stat == "dvar2")  values = &d2varVals;
+
+    if (values) {
+      if (stats.scalar) output.set(subkey, (*values)[0]);
+      else for (int j=0; j<dim; ++j) output.add(subkey, (*values)[j]);
+    }
+    else if (stat == "cov" && !stats.scalar) {
+      for (int j=0; j<dim; ++j) output.add(subkey, cov[j]);
+    }
+    else if (stat == "icov" && !stats.scalar) {
+      for (int j=0; j<dim; ++j) output.add(subkey, icov[j]);
+    }
+    else if (stat == "copy" || stat == "value") {
+      // don't use the subkey for 'copy', just key
+      const string& name = stat == "copy" ? key : subkey;
+      for (int c=0; c<(int)stats.values.size(); ++c) {
+        if (stats.scalar) {
+          for (int j=0; j<(int)stats.values[c].size(); ++j) output.add(name, stats.values[c][j]);
+        }
+        else output.add(name, stats.values[c]);
+      }
+    }
+    else if (stat == "last") {
+      if (stats.scalar) output.set(key, stats.previous[0]);
+      else output.set(key, stats.previous);
+    }
+  }
+}
+
+
+void ChunkedPoolAggregator::aggregate(Pool& output) const {
+  for (map<string, pair<double, double> >::const_iterator it = _singleReals.begin();
+       it != _singleReals.end(); ++it) {
+    const pair<double, double>& sum = it->second;
+    output.set(it->first, Real(sum.second > 0 ? sum.first / sum.second : 0));
+  }
+
+  for (map<string, FrameStats>::const_iterator it = _frames.begin();
+       it != _frames.end(); ++it) {
+    addStats(it->first, it->second, output);
+  }
+
+  for (map<string, pair<vector<double>, double> >::const_iterator it = _singleVectors.begin();
+       it != _singleVectors.end(); ++it) {
+    const pair<vector<double>, double>& sum = it->second;
+    vector<Real> value(sum.first.size(), 0.);
+    if (sum.second > 0) {
+      for (int j=0; j<(int)value.size(); ++j) value[j] = sum.first[j] / sum.second;
+    }
+    output.set(it->first, value);
+  }
+
+  // single strings remain single strings, while strings added to the pool
+  // are still added (as a single value)
+  for (map<string, map<string, double> >::const_iterator it = _votes.begin();
+       it != _votes.end(); ++it) {
+    const map<string, double>& votes = it->second;
+    map<string, double>::const_iterator winner = votes.begin();
+    for (map<string, double>::const_iterator v = votes.begin(); v != votes.end(); ++v) {
+      if (v->second > winner->second) winner = v;
+    }
+    if (_singleStrings.count(it->first)) output.set(it->first, winner->first);
+    else output.add(it->first, winner->first);
+  }
+
+  for (map<string, vector<vector<string> > >::const_iterator it = _vectorStrings.begin();
+       it != _vectorStrings.end(); ++it) {
+    for (int i=0; i<(int)it->second.size(); ++i) output.add(it->first, it->second[i]);
+  }
+}
+
+} // namespace essentia
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_CHUNKEDPOOLAGGREGATOR_H
+#define ESSENTIA_CHUNKEDPOOLAGGREGATOR_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "pool.h"
+
+namespace essentia {
+
+/**
+ * Computes the same statistics as the PoolAggregator algorithm over a signal
+ * that is analyzed in consecutive chunks, so that only the descriptors of one
+ * chunk need to be kept in memory at any time.
+ *
+ * Frame-wise descriptors (vectors of Reals and of vectors of Reals) are
+ * accumulated frame by frame: mean, var, stdev, min, max, cov, icov, and the
+ * statistics of the derivatives (which are computed across the chunk
+ * boundaries) are exactly those of the concatenated frames. The median, skew
+ * and kurt cannot be merged and are approximated by the average of the values
+ * of each chunk, weighted by their number of frames.
+ *
+ * Descriptors computed once per chunk are merged as follows: single Reals
+ * and vectors of Reals are averaged, weighted by the duration of the chunks,
+ * and strings are chosen by a vote weighted by the duration of the chunks.
+ * Descriptors given as a vector of Reals with a single value per chunk (e.g.
+ * the bpm) are thus aggregated over the chunks like any frame-wise descriptor.
+ *
+ * The 'copy' and 'value' statistics concatenate the frames of all the chunks
+ * and therefore need a memory proportional to the duration of the signal.
+ * Array2D and stereo descriptors are not supported.
+ */
+class ChunkedPoolAggregator {
+ public:
+  ChunkedPoolAggregator(const std::vector<std::string>& defaultStats);
+
+  /**
+   * Sets the statistics to compute for the given descriptors instead of the
+   * default ones, as the 'exceptions' parameter of PoolAggregator. Exceptions
+   * are added to the ones already set, so that they can be given for the
+   * descriptors of each chunk as they appear.
+   */
+  void setExceptions(const std::map<std::string, std::vector<std::string> >& exceptions);
+
+  /**
+   * Sets the duration [s] between the frames of the frame-wise descriptors
+   * whose name starts with the given prefix, the first frame of each chunk
+   * being centered at its start. The frames of these descriptors centered in
+   * the overlap or the lookahead of a chunk are then ignored exactly, instead
+   * of in proportion to the durations.
+   */
+  void setFramePeriod(const std::string& prefix, Real period);
+
+  /**
+   * Adds the descriptors of a chunk of the signal of the given duration [s].
+   * The first overlap seconds of the chunk only overlap with the previous
+   * chunk, and the last lookahead seconds with the next one, to give context
+   * to the analysis: the corresponding frames of each frame-wise descriptor
+   * are ignored (see setFramePeriod()), and only the remaining duration is
+   * used to weight the descriptors of the chunk.
+   */
+  void add(const Pool& chunk, Real duration, Real overlap=0, Real lookahead=0);
+
+  /**
+   * Adds the statistics of all the chunks added so far to output, with the
+   * same names as PoolAggregator would.
+   */
+  void aggregate(Pool& output) const;
+
+  int chunks() const { return _chunks; }
+
+ protected:
+  // running statistics of a frame-wise descriptor. Vectors of Reals are
+  // handled as frames of dimension 1
+  struct FrameStats {
+    bool scalar;
+    bool skip;
+    int dim;
+    double n, nd, nd2;
+    std::vector<double> mean, m2, dmean, dm2, d2mean, d2m2;
+    std::vector<double> scatter; // dim x dim, only if cov or icov are needed
+    std::vector<Real> min, max;
+    std::vector<Real> previous, previousDerivative;
+    std::vector<double> median, skew, kurt; // weighted by the frames of each chunk
+    std::vector<std::vector<Real> > values; // for 'copy' and 'value'
+  };
+
+  std::vector<std::string> _defaultStats;
+  std::map<std::string, std::vector<std::string> > _exceptions;
+  std::map<std::string, Real> _framePeriods;
+  int _chunks;
+
+  std::map<std::string, FrameStats> _frames;
+  std::map<std::string, std::pair<double, double> > _singleReals; // weighted sum, weight
+  std::map<std::string, std::pair<std::vector<double>, double> > _singleVectors;
+  std::map<std::string, std::map<std::string, double> > _votes;
+  std::set<std::string> _singleStrings;
+  std::map<std::string, std::vector<std::vector<std::string> > > _vectorStrings;
+
+  const std::vector<std::string>& getStats(const std::string& key) const;
+  bool needs(const std::string& key, const char* stat) const;
+  void chunkFrames(const std::string& key, int size, Real duration, Real overlap,
+                   Real lookahead, int& begin, int& end) const;
+
+  FrameStats& frameStats(const std::string& key, bool scalar, int dim);
+  void addFrame(FrameStats& stats, const Real* frame, bool covariance);
+  void addColumnStats(FrameStats& stats, const std::string& key, int j,
+                      const std::vector<Real>& column);
+  void addStats(const std::string& key, const FrameStats& stats, Pool& output) const;
+};
+
+} // namespace essentia
+
+#endif // ESSENTIA_CHUNKEDPOOLAGGREGATOR_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef CUBICSPLINEUTIL_H
+#define CUBICSPLINEUTIL_H
+
+#include <algorithm>
+#include "types.h"
+#include "splineutil.h"
+
+namespace essentia {
+namespace util {
+
+/**
+ * A piecewise cubic spline through the given points, evaluated as by
+ * spline_cubic_val (the values outside of the points being extrapolated from
+ * the first and last intervals), but locating the interval of each x-value
+ * with a binary search instead of a linear scan.
+ */
+class CubicSpline {
+ protected:
+  std::vector<double> _xPoints;
+  std::vector<double> _yPoints;
+  std::vector<double> _secondDerivatives;
+
+ public:
+  CubicSpline() {}
+
+  /**
+   * The boundary flags and values are those of spline_cubic_set.
+   */
+  void init(const std::vector<double>& xPoints, const std::vector<double>& yPoints,
+            int leftBoundaryFlag, double leftBoundaryValue,
+            int rightBoundaryFlag, double rightBoundaryValue) {
+    if (xPoints.size() != yPoints.size()) {
+      throw EssentiaException("CubicSpline: xPoints and yPoints do not have the same size");
+    }
+    if (xPoints.size() < 2) {
+      throw EssentiaException("CubicSpline: there are less than 2 points, which is the minimum required for a cubic spline");
+    }
+
+    _xPoints = xPoints;
+    _yPoints = yPoints;
+
+    double* ypp = spline_cubic_set(int(_xPoints.size()), &_xPoints[0], &_yPoints[0],
+                                   leftBoundaryFlag, leftBoundaryValue,
+                                   rightBoundaryFlag, rightBoundaryValue);
+    if (!ypp) {
+      throw EssentiaException("CubicSpline: could not compute the spline, the points must be in ascending order and the boundary flags must be 0, 1 or 2");
+    }
+    _secondDerivatives.assign(ypp, ypp + _xPoints.size());
+    delete[] ypp;
+  }
+
+  inline double operator()(double x, double& dy, double& ddy) const {
+    return value(x, interval(x), dy, ddy);
+  }
+
+  /**
+   * Evaluates the spline and its derivatives at each of the given x-values.
+   * Increasing x-values are located with a single walk over the points, and
+   * the other ones with a binary search. The derivatives are not computed if
+   * dy and ddy are null.
+   */
+  void operator()(const std::vector<Real>& x, std::vector<Real>& y,
+                  std::vector<Real>* dy=0, std::vector<Real>* ddy=0) const {
+    const int last = int(_xPoints.size()) - 2;
+    y.resize(x.size());
+    if (dy) dy->resize(x.size());
+    if (ddy) ddy->resize(x.size());
+
+    int j = 0;
+    for (int i=0; i<int(x.size()); ++i) {
+      double xi = x[i];
+      if (i > 0 && x[i] >= x[i-1]) {
+        while (j < last && !(xi < _xPoints[j+1])) j += 1;
+      }
+      else {
+        j = interval(xi);
+      }
+
+      double d, dd;
+      y[i] = Real(value(xi, j, d, dd));
+      if (dy) (*dy)[i] = Real(d);
+      if (ddy) (*ddy)[i] = Real(dd);
+    }
+  }
+
+ protected:
+  // the first interval whose end is after x, or the last one
+  inline int interval(double x) const {
+    return int(std::upper_bound(_xPoints.begin() + 1, _xPoints.end() - 1, x) - _xPoints.begin()) - 1;
+  }
+
+  // same computation as spline_cubic_val, so that the results are identical
+  inline double value(double x, int j, double& dy, double& ddy) const {
+    const double* t = &_xPoints[0];
+    const double* y = &_yPoints[0];
+    const double* ypp = &_secondDerivatives[0];
+
+    double dt = x - t[j];
+    double h = t[j+1] - t[j];
+
+    double yval = y[j]
+      + dt * ( ( y[j+1] - y[j] ) / h
+             - ( ypp[j+1] / 6.0 + ypp[j] / 3.0 ) * h
+      + dt * ( 0.5 * ypp[j]
+      + dt * ( ( ypp[j+1] - ypp[j] ) / ( 6.0 * h ) ) ) );
+
+    dy = ( y[j+1] - y[j] ) / h
+      - ( ypp[j+1] / 6.0 + ypp[j] / 3.0 ) * h
+      + dt * ( ypp[j]
+      + dt * ( 0.5 * ( ypp[j+1] - ypp[j] ) / h ) );
+
+    ddy = ypp[j] + dt * ( ypp[j+1] - ypp[j] ) / h;
+
+    return yval;
+  }
+};
+
+} // namespace util
+} // namespace essentia
+
+#endif // CUBICSPLINEUTIL_H
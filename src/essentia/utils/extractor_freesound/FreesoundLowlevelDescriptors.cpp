@@ -76,20 +76,13 @@ void FreesoundLowlevelDescriptors::createNetwork(SourceBase& source, Pool& pool)
   mfcc->output("mfcc") >> PC(pool, nameSpace + "mfcc");
 
   // Spectral MelBands Central Moments Statistics, Flatness and Crest
-  Algorithm* mels_cm = factory.create("CentralMoments", "range", 40-1);
-  Algorithm* mels_ds = factory.create("DistributionShape");
-  mfcc->output("bands")             >> mels_cm->input("array");
-  mels_cm->output("centralMoments") >> mels_ds->input("centralMoments");
-  mels_ds->output("kurtosis")       >> PC(pool, nameSpace + "melbands_kurtosis");
-  mels_ds->output("spread")         >> PC(pool, nameSpace + "melbands_spread");
-  mels_ds->output("skewness")       >> PC(pool, nameSpace + "melbands_skewness");
-
-  Algorithm* mels_fl = factory.create("FlatnessDB");
-  Algorithm* mels_cr = factory.create("Crest");
-  mfcc->output("bands")      >> mels_fl->input("array");
-  mfcc->output("bands")      >> mels_cr->input("array");
-  mels_fl->output("flatnessDB")  >> PC(pool, nameSpace + "melbands_flatness_db");
-  mels_cr->output("crest")       >> PC(pool, nameSpace + "melbands_crest");
+  Algorithm* mels_st = factory.create("BandStats", "range", 40-1);
+  mfcc->output("bands") >> mels_st->input("bands");
+  mels_st->output("kurtosis")   >> PC(pool, nameSpace + "melbands_kurtosis");
+  mels_st->output("spread")     >> PC(pool, nameSpace + "melbands_spread");
+  mels_st->output("skewness")   >> PC(pool, nameSpace + "melbands_skewness");
+  mels_st->output("flatnessDB") >> PC(pool, nameSpace + "melbands_flatness_db");
+  mels_st->output("crest")      >> PC(pool, nameSpace + "melbands_crest");
 
   // taken from MusicExtractor. MelBands 128 
   Algorithm* melbands96 = factory.create("MelBands", "numberBands", 96);
@@ -106,20 +99,13 @@ void FreesoundLowlevelDescriptors::createNetwork(SourceBase& source, Pool& pool)
   gfcc->output("gfcc") >> PC(pool, nameSpace + "gfcc");
 
   // Spectral ERBBands Central Moments Statistics, Flatness and Crest
-  Algorithm* erbs_cm = factory.create("CentralMoments", "range", 18-1);
-  Algorithm* erbs_ds = factory.create("DistributionShape");
-  gfcc->output("bands")             >> erbs_cm->input("array");
-  erbs_cm->output("centralMoments") >> erbs_ds->input("centralMoments");
-  erbs_ds->output("kurtosis")       >> PC(pool, nameSpace + "erbbands_kurtosis");
-  erbs_ds->output("spread")         >> PC(pool, nameSpace + "erbbands_spread");
-  erbs_ds->output("skewness")       >> PC(pool, nameSpace + "erbbands_skewness");
-
-  Algorithm* erbs_fl = factory.create("FlatnessDB");
-  Algorithm* erbs_cr = factory.create("Crest");
-  gfcc->output("bands")      >> erbs_fl->input("array");
-  gfcc->output("bands")      >> erbs_cr->input("array");
-  erbs_fl->output("flatnessDB")  >> PC(pool, nameSpace + "erbbands_flatness_db");
-  erbs_cr->output("crest")       >> PC(pool, nameSpace + "erbbands_crest");
+  Algorithm* erbs_st = factory.create("BandStats", "range", 18-1);
+  gfcc->output("bands") >> erbs_st->input("bands");
+  erbs_st->output("kurtosis")   >> PC(pool, nameSpace + "erbbands_kurtosis");
+  erbs_st->output("spread")     >> PC(pool, nameSpace + "erbbands_spread");
+  erbs_st->output("skewness")   >> PC(pool, nameSpace + "erbbands_skewness");
+  erbs_st->output("flatnessDB") >> PC(pool, nameSpace + "erbbands_flatness_db");
+  erbs_st->output("crest")      >> PC(pool, nameSpace + "erbbands_crest");
 
  // BarkBands
   uint nBarkBands = 27;
@@ -129,81 +115,33 @@ void FreesoundLowlevelDescriptors::createNetwork(SourceBase& source, Pool& pool)
   barkBands->output("bands") >> PC(pool, nameSpace + "barkbands");
 
   // Spectral BarkBands Central Moments Statistics, Flatness and Crest
-  Algorithm* barks_cm = factory.create("CentralMoments", "range", nBarkBands-1);
-  Algorithm* barks_ds = factory.create("DistributionShape");
-  barkBands->output("bands")          >> barks_cm->input("array");
-  barks_cm->output("centralMoments")  >> barks_ds->input("centralMoments");
-  barks_ds->output("kurtosis")        >> PC(pool, nameSpace + "barkbands_kurtosis");
-  barks_ds->output("spread")          >> PC(pool, nameSpace + "barkbands_spread");
-  barks_ds->output("skewness")        >> PC(pool, nameSpace + "barkbands_skewness");
-
-  Algorithm* barks_fl = factory.create("FlatnessDB");
-  Algorithm* barks_cr = factory.create("Crest");
-  barkBands->output("bands")      >> barks_fl->input("array");
-  barkBands->output("bands")      >> barks_cr->input("array");
-  barks_fl->output("flatnessDB")  >> PC(pool, nameSpace + "barkbands_flatness_db");
-  barks_cr->output("crest")       >> PC(pool, nameSpace + "barkbands_crest");
-
-  // Spectral Decrease
-  Algorithm* square = factory.create("UnaryOperator", "type", "square");
-  Algorithm* decrease = factory.create("Decrease",
-                                       "range", sampleRate * 0.5);
-  spec->output("spectrum") >> square->input("array");
-  square->output("array") >> decrease->input("array");
-  decrease->output("decrease") >> PC(pool, nameSpace + "spectral_decrease");
-
-  // Spectral Roll Off
-  Algorithm* ro = factory.create("RollOff");
-  spec->output("spectrum") >> ro->input("spectrum");
-  ro->output("rollOff") >> PC(pool, nameSpace + "spectral_rolloff");
-
-  // Spectral Energy
-  Algorithm* energy = factory.create("Energy");
-  spec->output("spectrum") >> energy->input("array");
-  energy->output("energy") >> PC(pool, nameSpace + "spectral_energy");
-
-  // Spectral RMS
-  Algorithm* rms = factory.create("RMS");
-  spec->output("spectrum") >> rms->input("array");
-  rms->output("rms") >> PC(pool, nameSpace + "spectral_rms");
-
-  // Spectral Energy Band Ratio
-  Algorithm* ebr_low      = factory.create("EnergyBand",
-                                           "startCutoffFrequency", 20.0,
-                                           "stopCutoffFrequency", 150.0);
-  Algorithm* ebr_mid_low  = factory.create("EnergyBand",
-                                           "startCutoffFrequency", 150.0,
-                                           "stopCutoffFrequency", 800.0);
-  Algorithm* ebr_mid_hi   = factory.create("EnergyBand",
-                                           "startCutoffFrequency", 800.0,
-                                           "stopCutoffFrequency", 4000.0);
-  Algorithm* ebr_hi       = factory.create("EnergyBand",
-                                           "startCutoffFrequency", 4000.0,
-                                           "stopCutoffFrequency", 20000.0);
-  spec->output("spectrum")  >> ebr_low->input("spectrum");
-  spec->output("spectrum")  >> ebr_mid_low->input("spectrum");
-  spec->output("spectrum")  >> ebr_mid_hi->input("spectrum");
-  spec->output("spectrum")  >> ebr_hi->input("spectrum");
-  ebr_low->output("energyBand")     >> PC(pool, nameSpace + "spectral_energyband_low");
-  ebr_mid_low->output("energyBand") >> PC(pool, nameSpace + "spectral_energyband_middle_low");
-  ebr_mid_hi->output("energyBand")  >> PC(pool, nameSpace + "spectral_energyband_middle_high");
-  ebr_hi->output("energyBand")      >> PC(pool, nameSpace + "spectral_energyband_high");
-
-  // Spectral HFC
-  Algorithm* hfc = factory.create("HFC");
-  spec->output("spectrum") >> hfc->input("spectrum");
-  hfc->output("hfc") >> PC(pool, nameSpace + "hfc");
+  Algorithm* barks_st = factory.create("BandStats", "range", nBarkBands-1);
+  barkBands->output("bands") >> barks_st->input("bands");
+  barks_st->output("kurtosis")   >> PC(pool, nameSpace + "barkbands_kurtosis");
+  barks_st->output("spread")     >> PC(pool, nameSpace + "barkbands_spread");
+  barks_st->output("skewness")   >> PC(pool, nameSpace + "barkbands_skewness");
+  barks_st->output("flatnessDB") >> PC(pool, nameSpace + "barkbands_flatness_db");
+  barks_st->output("crest")      >> PC(pool, nameSpace + "barkbands_crest");
+
+  // Spectral Energy, RMS, Roll Off, Decrease, HFC, Strong Peak and Energy Band Ratio
+  Algorithm* spst = factory.create("SpectrumStats", "sampleRate", sampleRate);
+  spec->output("spectrum")              >> spst->input("spectrum");
+  spst->output("energy")                >> PC(pool, nameSpace + "spectral_energy");
+  spst->output("rms")                   >> PC(pool, nameSpace + "spectral_rms");
+  spst->output("rollOff")               >> PC(pool, nameSpace + "spectral_rolloff");
+  spst->output("decrease")              >> PC(pool, nameSpace + "spectral_decrease");
+  spst->output("hfc")                   >> PC(pool, nameSpace + "hfc");
+  spst->output("strongPeak")            >> PC(pool, nameSpace + "spectral_strongpeak");
+  spst->output("energyBandLow")         >> PC(pool, nameSpace + "spectral_energyband_low");
+  spst->output("energyBandMiddleLow")   >> PC(pool, nameSpace + "spectral_energyband_middle_low");
+  spst->output("energyBandMiddleHigh")  >> PC(pool, nameSpace + "spectral_energyband_middle_high");
+  spst->output("energyBandHigh")        >> PC(pool, nameSpace + "spectral_energyband_high");
 
   // Spectral Flux
   Algorithm* flux = factory.create("Flux");
   spec->output("spectrum") >> flux->input("spectrum");
   flux->output("flux") >> PC(pool, nameSpace + "spectral_flux");
 
-  // Spectral Strong Peak
-  Algorithm* sp = factory.create("StrongPeak");
-  spec->output("spectrum") >> sp->input("spectrum");
-  sp->output("strongPeak") >> PC(pool, nameSpace + "spectral_strongpeak");
-
   // Spectral Complexity
   Algorithm* tc = factory.create("SpectralComplexity",
                                  "magnitudeThreshold", 0.005);
@@ -223,15 +161,9 @@ void FreesoundLowlevelDescriptors::createNetwork(SourceBase& source, Pool& pool)
   fb->output("bands") >> PC(pool, nameSpace + "frequency_bands");
   */
 
-  // Spectral Crest
-  Algorithm* crest = factory.create("Crest");
-  barkBands->output("bands") >> crest->input("array");
-  crest->output("crest") >> PC(pool, nameSpace + "spectral_crest");
-
-  // Spectral Flatness DB
-  Algorithm* flatness = factory.create("FlatnessDB");
-  barkBands->output("bands") >> flatness->input("array");
-  flatness->output("flatnessDB") >> PC(pool, nameSpace + "spectral_flatness_db");
+  // Spectral Crest and Flatness DB, computed on the bark bands
+  barks_st->output("crest") >> PC(pool, nameSpace + "spectral_crest");
+  barks_st->output("flatnessDB") >> PC(pool, nameSpace + "spectral_flatness_db");
 
   // Spectral Centroid
   Algorithm* square2 = factory.create("UnaryOperator", "type", "square");
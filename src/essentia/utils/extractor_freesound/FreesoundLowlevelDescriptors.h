@@ -33,7 +33,7 @@ class FreesoundLowlevelDescriptors : public FreesoundDescriptorSet {
   FreesoundLowlevelDescriptors(Pool& options) {
     this->options = options;
   }
-  ~FreesoundLowlevelDescriptors();
+  ~FreesoundLowlevelDescriptors() {}
 
  	void createNetwork(SourceBase& source, Pool& pool);
 	void computeAverageLoudness(Pool& pool);
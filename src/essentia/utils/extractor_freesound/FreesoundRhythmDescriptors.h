@@ -35,7 +35,7 @@ using namespace essentia::streaming;
   FreesoundRhythmDescriptors(Pool& options) {
     this->options = options;
   }
-  ~FreesoundRhythmDescriptors();
+  ~FreesoundRhythmDescriptors() {}
 
  	void createNetwork(SourceBase& source, Pool& pool);
 	void createNetworkBeatsLoudness(SourceBase& source, Pool& pool);
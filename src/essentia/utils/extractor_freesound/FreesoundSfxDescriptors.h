@@ -32,7 +32,7 @@ class FreesoundSfxDescriptors : public FreesoundDescriptorSet {
   FreesoundSfxDescriptors(Pool& options) {
     this->options = options;
   }
-  ~FreesoundSfxDescriptors();
+  ~FreesoundSfxDescriptors() {}
 
  	void createNetwork(SourceBase& source, Pool& pool);
  	void createPitchNetwork(VectorInput<Real>& pitch, Pool& pool);
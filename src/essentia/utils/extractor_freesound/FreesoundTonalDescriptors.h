@@ -31,7 +31,7 @@ class FreesoundTonalDescriptors : public FreesoundDescriptorSet {
   FreesoundTonalDescriptors(Pool& options) {
     this->options = options;
   }
-  ~FreesoundTonalDescriptors();
+  ~FreesoundTonalDescriptors() {}
 
  	void createNetwork(SourceBase& source, Pool& pool);
 };
@@ -33,7 +33,7 @@ class MusicLowlevelDescriptors : public MusicDescriptorSet {
   MusicLowlevelDescriptors(Pool& options) {
     this->options = options;
   }
-  ~MusicLowlevelDescriptors();
+  ~MusicLowlevelDescriptors() {}
 
  	void createNetworkNeqLoud(SourceBase& source, Pool& pool);
   void createNetworkEqLoud(SourceBase& source, Pool& pool);
@@ -35,7 +35,7 @@ class MusicRhythmDescriptors : public MusicDescriptorSet {
   MusicRhythmDescriptors(Pool& options) {
     this->options = options;
   }
-  ~MusicRhythmDescriptors();
+  ~MusicRhythmDescriptors() {}
 
  	void createNetwork(SourceBase& source, Pool& pool);
 	void createNetworkBeatsLoudness(SourceBase& source, Pool& pool);
@@ -31,7 +31,7 @@ class MusicTonalDescriptors : public MusicDescriptorSet {
   MusicTonalDescriptors(Pool& options) {
     this->options = options;
   }
-  ~MusicTonalDescriptors();
+  ~MusicTonalDescriptors() {}
 
   void createNetworkTuningFrequency(SourceBase& source, Pool& pool);
  	void createNetwork(SourceBase& source, Pool& pool);
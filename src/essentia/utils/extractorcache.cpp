@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdint.h>
+#include "extractorcache.h"
+#include "poolbinary.h"
+#include "audiodecoder.h"
+
+#ifdef OS_WIN32
+#include <io.h> // _mktemp_s
+#else
+#include <unistd.h> // close
+#endif
+
+using namespace std;
+
+namespace essentia {
+
+// the cache file names only contain characters that are safe on any filesystem
+static string sanitize(const string& name) {
+  string result = name;
+  for (int i=0; i<(int)result.size(); ++i) {
+    if (!isalnum(result[i]) && result[i] != '.' && result[i] != '-') result[i] = '_';
+  }
+  return result;
+}
+
+// 64-bit FNV-1a hash
+static string hashString(const string& s) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (int i=0; i<(int)s.size(); ++i) {
+    hash ^= (unsigned char)s[i];
+    hash *= 1099511628211ULL;
+  }
+  ostringstream result;
+  result << hex << setw(16) << setfill('0') << hash;
+  return result.str();
+}
+
+
+ExtractorCache::ExtractorCache(const string& directory, const string& extractor,
+                               const string& version)
+    : _directory(directory), _extractor(sanitize(extractor + "-" + version)) {
+  if (!_directory.empty() && _directory[_directory.size()-1] != '/') _directory += '/';
+}
+
+
+void ExtractorCache::setAudioFile(const string& filename) {
+  // the MD5 checksum is the same as the one of AudioLoader, it is computed
+  // over the undecoded packets, so there is no need to decode them
+  AudioDecoder decoder("ExtractorCache");
+  decoder.open(filename, 0, AV_SAMPLE_FMT_FLT, true);
+  while (decoder.readPacket());
+  _md5 = decoder.md5();
+}
+
+
+void ExtractorCache::setGroupOptions(const string& group, const Pool& options,
+                                     const vector<string>& names) {
+  // options are serialized by name, the hash only depends on their values
+  ostringstream key;
+  key << setprecision(9);
+  for (int i=0; i<(int)names.size(); ++i) {
+    key << names[i] << '=';
+    if (options.contains<Real>(names[i])) {
+      key << options.value<Real>(names[i]);
+    }
+    else if (options.contains<string>(names[i])) {
+      key << options.value<string>(names[i]);
+    }
+    else if (options.contains<vector<string> >(names[i])) {
+      const vector<string>& values = options.value<vector<string> >(names[i]);
+      for (int j=0; j<(int)values.size(); ++j) key << values[j] << ',';
+    }
+    key << '\n';
+  }
+  _groupHashes[group] = hashString(key.str());
+}
+
+
+string ExtractorCache::filename(const string& group) const {
+  if (_md5.empty()) {
+    throw EssentiaException("ExtractorCache: the audio file has not been set");
+  }
+  map<string, string>::const_iterator hash = _groupHashes.find(group);
+  if (hash == _groupHashes.end()) {
+    throw EssentiaException("ExtractorCache: the options of group '", group, "' have not been set");
+  }
+  return _directory + _md5 + "." + _extractor + "." + sanitize(group) + "-" + hash->second + ".pool";
+}
+
+
+bool ExtractorCache::load(const string& group, Pool& pool) const {
+  ifstream in(filename(group).c_str(), ios::binary);
+  if (!in.is_open()) return false;
+
+  // read into a temporary pool, so that a damaged entry leaves pool untouched
+  // and is simply recomputed
+  Pool cached;
+  try {
+    readPoolBinary(in, cached);
+  }
+  catch (std::exception& e) {
+    // EssentiaException for a damaged entry, but also e.g. bad_alloc
+    E_WARNING("ExtractorCache: ignoring cache entry " << filename(group) << ": " << e.what());
+    return false;
+  }
+  pool.merge(cached);
+  return true;
+}
+
+
+void ExtractorCache::store(const string& group, const Pool& pool) const {
+  // write to a temporary file first, so that concurrent readers never see a
+  // partially written entry
+  string name = filename(group);
+  vector<char> tmpName(name.begin(), name.end());
+  const char suffix[] = ".XXXXXX";
+  tmpName.insert(tmpName.end(), suffix, suffix + sizeof(suffix));
+
+#ifdef OS_WIN32
+  // there is no mkstemp on Windows, the file is created when writing it
+  if (_mktemp_s(&tmpName[0], tmpName.size()) != 0) {
+    E_WARNING("ExtractorCache: could not create a cache entry in " << _directory);
+    return;
+  }
+#else
+  int fd = mkstemp(&tmpName[0]);
+  if (fd < 0) {
+    E_WARNING("ExtractorCache: could not create a cache entry in " << _directory);
+    return;
+  }
+  close(fd);
+#endif
+
+  try {
+    ofstream out(&tmpName[0], ios::binary);
+    writePoolBinary(out, pool);
+  }
+  catch (EssentiaException& e) {
+    E_WARNING("ExtractorCache: could not store cache entry " << name << ": " << e.what());
+    remove(&tmpName[0]);
+    return;
+  }
+
+  if (rename(&tmpName[0], name.c_str()) != 0) {
+    // on some platforms rename fails if the entry was stored concurrently by
+    // another process, which has then written the same results
+    remove(&tmpName[0]);
+  }
+}
+
+} // namespace essentia
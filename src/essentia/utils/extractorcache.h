@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_EXTRACTORCACHE_H
+#define ESSENTIA_EXTRACTORCACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "pool.h"
+
+namespace essentia {
+
+/**
+ * On-disk cache of extractor results, addressed by the content of the audio
+ * (the MD5 of its encoded stream, as computed by AudioLoader), the name and
+ * version of the extractor, and a hash of the options used.
+ *
+ * Results are stored per descriptor group (e.g. lowlevel, rhythm, tonal),
+ * each group being keyed only by the options it depends on, so that changing
+ * the options of one group does not invalidate the results of the others.
+ * The stored pools are written with writePoolBinary.
+ */
+class ExtractorCache {
+ public:
+  ExtractorCache(const std::string& directory, const std::string& extractor,
+                 const std::string& version);
+
+  /**
+   * Sets the audio file whose results are cached. This decodes the whole
+   * file to compute its MD5.
+   */
+  void setAudioFile(const std::string& filename);
+
+  /**
+   * Sets the options the results of the given group depend on, by name.
+   * Options that are not in the options pool are ignored.
+   */
+  void setGroupOptions(const std::string& group, const Pool& options,
+                       const std::vector<std::string>& names);
+
+  /**
+   * Adds the cached results of the given group to pool. Returns false if
+   * there are no results for the current audio file and group options.
+   */
+  bool load(const std::string& group, Pool& pool) const;
+
+  /**
+   * Stores the results of the given group. Failures to write to the cache
+   * directory are reported as warnings, as they do not affect the results.
+   */
+  void store(const std::string& group, const Pool& pool) const;
+
+  const std::string& audioMD5() const { return _md5; }
+
+ protected:
+  std::string _directory;
+  std::string _extractor;
+  std::string _md5;
+  std::map<std::string, std::string> _groupHashes;
+
+  std::string filename(const std::string& group) const;
+};
+
+} // namespace essentia
+
+#endif // ESSENTIA_EXTRACTORCACHE_H
@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "featurefile.h"
+#include "essentia.h"
+
+#ifdef OS_WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#define O_BINARY 0
+#endif
+
+using namespace std;
+
+namespace essentia {
+
+static const char featureFileMagic[8] = { 'E', 'S', 'S', 'F', 'E', 'A', 'T', '1' };
+
+// magic, data offset, size of Real, type, dimension, frames, sample rate and
+// hop size, the values starting right after the header, or at the next block
+// with direct I/O
+static const int headerSize = 64;
+
+// the alignment of the data written with direct I/O, which must be a multiple
+// of the block size of the disk
+static const int directIOAlignment = 4096;
+
+
+int FeatureFileHeader::valueSize() const {
+  switch (type) {
+  case IntFeature:     return sizeof(int32_t);
+  case RealFeature:    return sizeof(Real);
+  case ComplexFeature: return sizeof(complex<Real>);
+  }
+  return 0;
+}
+
+static void encodeHeader(const FeatureFileHeader& header, uint64_t dataOffset, char* out) {
+  uint64_t fields[7] = { dataOffset, sizeof(Real), uint64_t(header.type),
+                         uint64_t(header.dimension), uint64_t(header.frames), 0,
+                         uint64_t(header.hopSize) };
+  double sampleRate = header.sampleRate;
+  memcpy(&fields[5], &sampleRate, sizeof(sampleRate));
+
+  memcpy(out, featureFileMagic, sizeof(featureFileMagic));
+  memcpy(out + sizeof(featureFileMagic), fields, sizeof(fields));
+}
+
+
+FeatureFileWriter::FeatureFileWriter(const string& filename, const FeatureFileHeader& header,
+                                     bool directIO, int bufferSize) :
+    _filename(filename), _header(header), _fd(-1), _directIO(directIO), _buffered(0) {
+
+  if (bufferSize < 1) {
+    throw EssentiaException("FeatureFileWriter: bufferSize must be at least 1");
+  }
+  _header.frames = 0;
+
+  int flags = O_WRONLY | O_CREAT | O_TRUNC | O_BINARY;
+#ifdef O_DIRECT
+  if (_directIO) {
+    _fd = open(filename.c_str(), flags | O_DIRECT, 0644);
+    if (_fd < 0 && errno == EINVAL) {
+      // e.g. tmpfs, which has no disk blocks to write to
+      E_DEBUG(EAlgorithm, "FeatureFileWriter: " << filename << " does not support direct I/O");
+      _directIO = false;
+    }
+  }
+#else
+  _directIO = false;
+#endif
+  if (_fd < 0) _fd = open(filename.c_str(), flags, 0644);
+  if (_fd < 0) {
+    throw EssentiaException("FeatureFileWriter: could not open file for writing: ", filename);
+  }
+
+  // direct I/O writes whole aligned blocks from an aligned buffer
+  _bufferSize = ((bufferSize + directIOAlignment - 1) / directIOAlignment) * directIOAlignment;
+  _memory.resize(_bufferSize + directIOAlignment);
+  uintptr_t address = uintptr_t(&_memory[0]);
+  _buffer = &_memory[0] + (directIOAlignment - address % directIOAlignment) % directIOAlignment;
+
+  // the header is written first with no frames, and again with the number of
+  // frames when closing the file
+  int dataOffset = _directIO ? directIOAlignment : headerSize;
+  fill(_buffer, _buffer + dataOffset, 0);
+  encodeHeader(_header, dataOffset, _buffer);
+  _buffered = dataOffset;
+}
+
+FeatureFileWriter::~FeatureFileWriter() {
+  try {
+    close();
+  }
+  catch (EssentiaException& e) {
+    E_WARNING("FeatureFileWriter: " << e.what());
+  }
+}
+
+void FeatureFileWriter::write(const int* values, int size) {
+  append(IntFeature, values, size);
+}
+
+void FeatureFileWriter::write(const Real* values, int size) {
+  append(RealFeature, values, size);
+}
+
+void FeatureFileWriter::write(const complex<Real>* values, int size) {
+  append(ComplexFeature, values, size);
+}
+
+void FeatureFileWriter::append(FeatureFileType type, const void* values, int size) {
+  if (_fd < 0) {
+    throw EssentiaException("FeatureFileWriter: cannot write to ", _filename, ", it has been closed");
+  }
+  if (type != _header.type) {
+    throw EssentiaException("FeatureFileWriter: the values written to ", _filename,
+                            " are not of the type of the file");
+  }
+  if (_header.frames == 0 && _header.dimension == 0) {
+    if (size == 0) {
+      throw EssentiaException("FeatureFileWriter: cannot write empty frames to ", _filename);
+    }
+    _header.dimension = size;
+    // the dimension is needed to read a file that has not been closed
+    encodeHeader(_header, _directIO ? directIOAlignment : headerSize, _buffer);
+  }
+  if (size != _header.dimension) {
+    ostringstream msg;
+    msg << "FeatureFileWriter: all the frames written to " << _filename << " must have "
+        << _header.dimension << " values, got a frame with " << size << " values";
+    throw EssentiaException(msg);
+  }
+
+  const char* data = (const char*)values;
+  int remaining = _header.frameSize();
+  while (remaining > 0) {
+    int n = min(remaining, _bufferSize - _buffered);
+    memcpy(_buffer + _buffered, data, n);
+    _buffered += n;
+    data += n;
+    remaining -= n;
+    if (_buffered == _bufferSize) flush(false);
+  }
+
+  _header.frames++;
+}
+
+void FeatureFileWriter::writeBlock(const char* data, int size) {
+  while (size > 0) {
+    int n = ::write(_fd, data, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      throw EssentiaException("FeatureFileWriter: error while writing to ", _filename, ": ", strerror(errno));
+    }
+    data += n;
+    size -= n;
+  }
+}
+
+void FeatureFileWriter::flush(bool all) {
+  int size = _buffered;
+
+  if (_directIO) {
+    // only whole blocks can be written, the last one is padded with zeros,
+    // which are removed when closing the file
+    if (all) {
+      size = ((_buffered + directIOAlignment - 1) / directIOAlignment) * directIOAlignment;
+      fill(_buffer + _buffered, _buffer + size, 0);
+    }
+    else {
+      size = (_buffered / directIOAlignment) * directIOAlignment;
+    }
+  }
+
+  writeBlock(_buffer, size);
+
+  _buffered = max(0, _buffered - size);
+  if (_buffered > 0) memmove(_buffer, _buffer + size, _buffered);
+}
+
+void FeatureFileWriter::close() {
+  if (_fd < 0) return;
+
+  int dataOffset = _directIO ? directIOAlignment : headerSize;
+  bool padded = _directIO && _buffered % directIOAlignment != 0;
+
+  try {
+    flush(true);
+
+    if (_directIO) {
+      // the header is rewritten through the system cache
+      ::close(_fd);
+      _fd = open(_filename.c_str(), O_WRONLY | O_BINARY);
+      if (_fd < 0) {
+        throw EssentiaException("FeatureFileWriter: could not reopen ", _filename);
+      }
+#ifndef OS_WIN32
+      off_t fileSize = off_t(dataOffset) + off_t(_header.frames) * _header.frameSize();
+      if (padded && ftruncate(_fd, fileSize) != 0) {
+        throw EssentiaException("FeatureFileWriter: could not truncate ", _filename);
+      }
+#endif
+    }
+
+    char header[headerSize];
+    encodeHeader(_header, dataOffset, header);
+    if (lseek(_fd, 0, SEEK_SET) != 0) {
+      throw EssentiaException("FeatureFileWriter: could not write the header of ", _filename);
+    }
+    writeBlock(header, headerSize);
+  }
+  catch (EssentiaException&) {
+    if (_fd >= 0) ::close(_fd);
+    _fd = -1;
+    throw;
+  }
+
+  if (::close(_fd) != 0) {
+    _fd = -1;
+    throw EssentiaException("FeatureFileWriter: error while closing ", _filename);
+  }
+  _fd = -1;
+}
+
+
+FeatureFileReader::FeatureFileReader(const string& filename) :
+    _filename(filename), _data(0), _size(0) {
+
+  int fd = open(filename.c_str(), O_RDONLY | O_BINARY);
+  if (fd < 0) {
+    throw EssentiaException("FeatureFileReader: could not open file: ", filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw EssentiaException("FeatureFileReader: could not get the size of ", filename);
+  }
+  _size = st.st_size;
+
+#ifndef OS_WIN32
+  if (_size > 0) {
+    void* data = mmap(0, _size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) _data = (const char*)data;
+  }
+#endif
+
+  if (!_data && _size > 0) {
+    _contents.resize(_size);
+    size_t done = 0;
+    while (done < _size) {
+      int n = ::read(fd, &_contents[done], min(_size - done, size_t(1) << 30));
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        ::close(fd);
+        throw EssentiaException("FeatureFileReader: error while reading ", filename);
+      }
+      done += n;
+    }
+    _data = &_contents[0];
+  }
+  ::close(fd);
+
+  try {
+    if (_size < size_t(headerSize) ||
+        !equal(featureFileMagic, featureFileMagic + sizeof(featureFileMagic), _data)) {
+      throw EssentiaException("FeatureFileReader: ", filename, " is not a feature file");
+    }
+
+    uint64_t fields[7];
+    memcpy(fields, _data + sizeof(featureFileMagic), sizeof(fields));
+    double sampleRate;
+    memcpy(&sampleRate, &fields[5], sizeof(sampleRate));
+
+    if (fields[1] != sizeof(Real)) {
+      throw EssentiaException("FeatureFileReader: ", filename, " was written with a different Real type");
+    }
+    if (fields[2] > ComplexFeature || fields[0] < uint64_t(headerSize) || fields[0] > _size) {
+      throw EssentiaException("FeatureFileReader: ", filename, " has an invalid header");
+    }
+
+    _dataOffset = fields[0];
+    _header.type = FeatureFileType(fields[2]);
+    _header.dimension = int(fields[3]);
+    _header.sampleRate = Real(sampleRate);
+    _header.hopSize = int(fields[6]);
+
+    // a file that has not been closed has no frames in its header, and may
+    // end with an incomplete frame
+    long long complete = 0;
+    if (_header.frameSize() > 0) complete = (_size - _dataOffset) / _header.frameSize();
+    _header.frames = fields[4] > 0 ? min((long long)fields[4], complete) : complete;
+  }
+  catch (EssentiaException&) {
+#ifndef OS_WIN32
+    if (_contents.empty() && _data) munmap((void*)_data, _size);
+#endif
+    throw;
+  }
+}
+
+FeatureFileReader::~FeatureFileReader() {
+#ifndef OS_WIN32
+  if (_contents.empty() && _data) munmap((void*)_data, _size);
+#endif
+}
+
+const char* FeatureFileReader::frame(FeatureFileType type, long long frame) const {
+  if (type != _header.type) {
+    throw EssentiaException("FeatureFileReader: the values of ", _filename,
+                            " are not of the requested type");
+  }
+  if (frame < 0 || frame >= _header.frames) {
+    ostringstream msg;
+    msg << "FeatureFileReader: frame " << frame << " is out of range, "
+        << _filename << " has " << _header.frames << " frames";
+    throw EssentiaException(msg);
+  }
+  return _data + _dataOffset + frame * _header.frameSize();
+}
+
+const int* FeatureFileReader::intFrame(long long i) const {
+  return (const int*)frame(IntFeature, i);
+}
+
+const Real* FeatureFileReader::realFrame(long long i) const {
+  return (const Real*)frame(RealFeature, i);
+}
+
+const complex<Real>* FeatureFileReader::complexFrame(long long i) const {
+  return (const complex<Real>*)frame(ComplexFeature, i);
+}
+
+void FeatureFileReader::read(long long i, vector<Real>& values) const {
+  const Real* data = realFrame(i);
+  values.assign(data, data + _header.dimension);
+}
+
+void FeatureFileReader::read(long long i, vector<complex<Real> >& values) const {
+  const complex<Real>* data = complexFrame(i);
+  values.assign(data, data + _header.dimension);
+}
+
+} // namespace essentia
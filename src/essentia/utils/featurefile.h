@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_FEATUREFILE_H
+#define ESSENTIA_FEATUREFILE_H
+
+#include <complex>
+#include <string>
+#include <vector>
+#include "types.h"
+
+namespace essentia {
+
+/**
+ * The type of the values stored in a feature file.
+ */
+enum FeatureFileType {
+  IntFeature, RealFeature, ComplexFeature
+};
+
+/**
+ * The self-describing header of a feature file: the type of its values, the
+ * number of values in each frame, and the sample rate and hop size the frames
+ * were computed with (0 if unknown).
+ */
+struct FeatureFileHeader {
+  FeatureFileType type;
+  int dimension;
+  long long frames;
+  Real sampleRate;
+  int hopSize;
+
+  FeatureFileHeader(FeatureFileType type=RealFeature, Real sampleRate=0, int hopSize=0)
+    : type(type), dimension(0), frames(0), sampleRate(sampleRate), hopSize(hopSize) {}
+
+  int valueSize() const;
+  int frameSize() const { return dimension * valueSize(); }
+};
+
+
+/**
+ * Writes frames of a constant number of values (e.g. the frames of a
+ * spectrogram) to a binary feature file, for caching intermediate features
+ * and reading them back with FeatureFileReader.
+ *
+ * The frames are accumulated in a large buffer and written to the file in a
+ * few big writes. With directIO, the file is written with O_DIRECT when the
+ * system supports it, in blocks aligned to the disk blocks and bypassing the
+ * system cache, which is faster for files much bigger than the memory and
+ * avoids evicting everything else from the cache.
+ *
+ * Values are written in the native byte order and with the native size of
+ * Real, as for writePoolBinary. The number of frames is written in the header
+ * when closing the file, a file that was not closed can still be read up to
+ * its last complete frame.
+ */
+class FeatureFileWriter {
+ public:
+  FeatureFileWriter(const std::string& filename, const FeatureFileHeader& header,
+                    bool directIO=false, int bufferSize=1<<20);
+  ~FeatureFileWriter();
+
+  /**
+   * Appends a frame. The first frame sets the dimension of the file, if it
+   * was not given in the header, and all the frames must have this size.
+   */
+  void write(const int* values, int size);
+  void write(const Real* values, int size);
+  void write(const std::complex<Real>* values, int size);
+
+  void write(const std::vector<Real>& frame) {
+    write(frame.empty() ? (const Real*)0 : &frame[0], frame.size());
+  }
+  void write(const std::vector<std::complex<Real> >& frame) {
+    write(frame.empty() ? (const std::complex<Real>*)0 : &frame[0], frame.size());
+  }
+
+  /**
+   * Writes the buffered frames and the header, and closes the file. Called
+   * by the destructor if needed.
+   */
+  void close();
+
+  const FeatureFileHeader& header() const { return _header; }
+
+ protected:
+  std::string _filename;
+  FeatureFileHeader _header;
+  int _fd;
+  bool _directIO;
+
+  std::vector<char> _memory;
+  char* _buffer; // aligned inside _memory
+  int _bufferSize;
+  int _buffered;
+
+  void append(FeatureFileType type, const void* values, int size);
+  void flush(bool all);
+  void writeBlock(const char* data, int size);
+};
+
+
+/**
+ * Reads a feature file written by FeatureFileWriter. The file is memory
+ * mapped, so opening it is immediate whatever its size and frames are only
+ * read from the disk when they are accessed.
+ */
+class FeatureFileReader {
+ public:
+  FeatureFileReader(const std::string& filename);
+  ~FeatureFileReader();
+
+  const FeatureFileHeader& header() const { return _header; }
+  long long frames() const { return _header.frames; }
+  int dimension() const { return _header.dimension; }
+
+  /**
+   * Direct access to the values of a frame, which stay valid as long as the
+   * reader. The type must match the type of the file.
+   */
+  const int* intFrame(long long frame) const;
+  const Real* realFrame(long long frame) const;
+  const std::complex<Real>* complexFrame(long long frame) const;
+
+  void read(long long frame, std::vector<Real>& values) const;
+  void read(long long frame, std::vector<std::complex<Real> >& values) const;
+
+ protected:
+  std::string _filename;
+  FeatureFileHeader _header;
+  const char* _data; // the whole file
+  size_t _size;
+  size_t _dataOffset;
+  std::vector<char> _contents; // when the file cannot be mapped
+
+  const char* frame(FeatureFileType type, long long frame) const;
+};
+
+} // namespace essentia
+
+#endif // ESSENTIA_FEATUREFILE_H
@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "frameencoding.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+
+using namespace std;
+
+namespace essentia {
+
+static const string metadataPrefix = "frameEncoding.";
+
+
+void FrameEncoding::validate(bool needRange) const {
+  if (decimation < 1) {
+    throw EssentiaException("FrameEncoding: decimation must be at least 1, it is ", decimation);
+  }
+  if (quantization != "none" && quantization != "int8" &&
+      quantization != "int16" && quantization != "float16") {
+    throw EssentiaException("FrameEncoding: unknown quantization '", quantization,
+                            "', it should be one of none, int8, int16 or float16");
+  }
+  if (delta && quantization == "none") {
+    throw EssentiaException("FrameEncoding: delta encoding needs a quantization");
+  }
+  if (needRange && (quantization == "int8" || quantization == "int16") &&
+      !(maxValue > minValue)) {
+    throw EssentiaException("FrameEncoding: the ", quantization,
+                            " quantization needs a range with maxValue > minValue");
+  }
+}
+
+
+Real realToHalf(Real value) {
+  float f = value;
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+
+  uint32_t sign = (bits >> 16) & 0x8000;
+  int exponent = int((bits >> 23) & 0xff);
+  uint32_t mantissa = bits & 0x7fffff;
+
+  if (exponent == 0xff) { // inf or nan
+    return Real(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+  }
+
+  exponent += 15 - 127;
+  if (exponent >= 31) return Real(sign | 0x7c00); // overflow to inf
+
+  uint32_t half, remainder, halfway;
+  if (exponent <= 0) { // subnormal half, or zero
+    if (exponent < -10) return Real(sign);
+    mantissa |= 0x800000;
+    int shift = 14 - exponent;
+    half = mantissa >> shift;
+    remainder = mantissa & ((1u << shift) - 1);
+    halfway = 1u << (shift - 1);
+  }
+  else {
+    half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+    remainder = mantissa & 0x1fff;
+    halfway = 0x1000;
+  }
+
+  // round to nearest even, a carry into the exponent is the correct result
+  if (remainder > halfway || (remainder == halfway && (half & 1))) ++half;
+
+  return Real(sign | half);
+}
+
+
+Real halfToReal(Real code) {
+  uint32_t half = uint32_t(code) & 0xffff;
+  int exponent = (half >> 10) & 0x1f;
+  uint32_t mantissa = half & 0x3ff;
+
+  Real value;
+  if (exponent == 0)       value = ldexp(Real(mantissa), -24);
+  else if (exponent == 31) value = mantissa ? numeric_limits<Real>::quiet_NaN()
+                                            : numeric_limits<Real>::infinity();
+  else                     value = ldexp(Real(mantissa | 0x400), exponent - 25);
+
+  return (half & 0x8000) ? -value : value;
+}
+
+
+FrameEncoder::FrameEncoder(const FrameEncoding& encoding) : _encoding(encoding) {
+  _encoding.validate(true);
+
+  _scale = 1;
+  _offset = 0;
+  _maxCode = 0;
+  if (_encoding.quantization == "int8" || _encoding.quantization == "int16") {
+    _maxCode = _encoding.quantization == "int8" ? 127 : 32767;
+    _offset = (_encoding.maxValue + _encoding.minValue) / 2;
+    _scale = (_encoding.maxValue - _encoding.minValue) / (2 * _maxCode);
+    // a descriptor with a constant value only needs code 0
+    if (_scale <= 0) _scale = 1;
+  }
+
+  reset();
+}
+
+void FrameEncoder::reset() {
+  _frame = 0;
+  _previous.clear();
+}
+
+Real FrameEncoder::quantize(Real value) const {
+  if (_encoding.quantization == "none") return value;
+  if (_encoding.quantization == "float16") return realToHalf(value);
+
+  Real code = round((value - _offset) / _scale);
+  return max(-_maxCode, min(_maxCode, code));
+}
+
+bool FrameEncoder::encode(const vector<Real>& frame, vector<Real>& encoded) {
+  if ((_frame++) % _encoding.decimation != 0) return false;
+
+  encoded.resize(frame.size());
+  for (int i=0; i<(int)frame.size(); ++i) encoded[i] = quantize(frame[i]);
+
+  if (_encoding.delta) {
+    bool first = _previous.empty();
+    if (!first && _previous.size() != encoded.size()) {
+      throw EssentiaException("FrameEncoder: delta encoding needs frames of constant size, got ",
+                              encoded.size(), " values after ", _previous.size());
+    }
+    for (int i=0; i<(int)encoded.size(); ++i) {
+      Real code = encoded[i];
+      if (!first) encoded[i] -= _previous[i];
+      if (first) _previous.push_back(code);
+      else _previous[i] = code;
+    }
+  }
+
+  return true;
+}
+
+bool FrameEncoder::encode(Real value, Real& encoded) {
+  vector<Real> frame(1, value), result;
+  if (!encode(frame, result)) return false;
+  encoded = result[0];
+  return true;
+}
+
+void FrameEncoder::setMetadata(Pool& pool, const string& descriptorName) const {
+  string prefix = metadataPrefix + descriptorName + ".";
+  pool.set(prefix + "decimation", Real(_encoding.decimation));
+  pool.set(prefix + "quantization", _encoding.quantization);
+  pool.set(prefix + "delta", Real(_encoding.delta ? 1 : 0));
+  if (_maxCode > 0) {
+    pool.set(prefix + "scale", _scale);
+    pool.set(prefix + "offset", _offset);
+  }
+}
+
+
+void encodeFrames(Pool& pool, const string& descriptorName, const FrameEncoding& encoding) {
+  encoding.validate(false);
+
+  const PoolOf(Real)& reals = pool.getRealPool();
+  const PoolOf(vector<Real>)& vectors = pool.getVectorRealPool();
+
+  PoolOf(Real)::const_iterator realIt = reals.find(descriptorName);
+  PoolOf(vector<Real>)::const_iterator vectorIt = vectors.find(descriptorName);
+
+  if (realIt == reals.end() && vectorIt == vectors.end()) {
+    throw EssentiaException("encodeFrames: ", descriptorName,
+                            " is not a frame-wise descriptor of Reals or vectors of Reals");
+  }
+
+  FrameEncoding enc = encoding;
+  if ((enc.quantization == "int8" || enc.quantization == "int16") &&
+      !(enc.maxValue > enc.minValue)) {
+    Real minValue = numeric_limits<Real>::max();
+    Real maxValue = -numeric_limits<Real>::max();
+    if (realIt != reals.end()) {
+      const vector<Real>& values = realIt->second;
+      for (int i=0; i<(int)values.size(); ++i) {
+        minValue = min(minValue, values[i]);
+        maxValue = max(maxValue, values[i]);
+      }
+    }
+    else {
+      const vector<vector<Real> >& frames = vectorIt->second;
+      for (int i=0; i<(int)frames.size(); ++i) {
+        for (int j=0; j<(int)frames[i].size(); ++j) {
+          minValue = min(minValue, frames[i][j]);
+          maxValue = max(maxValue, frames[i][j]);
+        }
+      }
+    }
+    if (minValue > maxValue) minValue = maxValue = 0; // no values
+    enc.minValue = minValue;
+    enc.maxValue = maxValue;
+  }
+
+  FrameEncoder encoder(enc);
+
+  if (realIt != reals.end()) {
+    vector<Real> values = realIt->second;
+    vector<Real> encoded;
+    encoded.reserve(values.size() / enc.decimation + 1);
+    Real code;
+    for (int i=0; i<(int)values.size(); ++i) {
+      if (encoder.encode(values[i], code)) encoded.push_back(code);
+    }
+    pool.remove(descriptorName);
+    pool.append(descriptorName, encoded);
+  }
+  else {
+    vector<vector<Real> > frames = vectorIt->second;
+    vector<vector<Real> > encoded;
+    encoded.reserve(frames.size() / enc.decimation + 1);
+    vector<Real> codes;
+    for (int i=0; i<(int)frames.size(); ++i) {
+      if (encoder.encode(frames[i], codes)) encoded.push_back(codes);
+    }
+    pool.remove(descriptorName);
+    pool.append(descriptorName, encoded);
+  }
+
+  encoder.setMetadata(pool, descriptorName);
+}
+
+
+static void decodeFrame(vector<Real>& frame, vector<Real>& previous,
+                        const string& quantization, bool delta,
+                        Real scale, Real offset) {
+  if (delta) {
+    if (previous.empty()) previous = frame;
+    else {
+      for (int i=0; i<(int)frame.size(); ++i) previous[i] += frame[i];
+    }
+    frame = previous;
+  }
+  for (int i=0; i<(int)frame.size(); ++i) {
+    if (quantization == "float16") frame[i] = halfToReal(frame[i]);
+    else if (quantization != "none") frame[i] = frame[i] * scale + offset;
+  }
+}
+
+void decodeFrames(Pool& pool, const string& descriptorName) {
+  string prefix = metadataPrefix + descriptorName;
+  if (!pool.contains<string>(prefix + ".quantization")) {
+    throw EssentiaException("decodeFrames: no encoding metadata for ", descriptorName);
+  }
+
+  string quantization = pool.value<string>(prefix + ".quantization");
+  bool delta = pool.value<Real>(prefix + ".delta") != 0;
+  Real scale = 1, offset = 0;
+  if (pool.contains<Real>(prefix + ".scale")) {
+    scale = pool.value<Real>(prefix + ".scale");
+    offset = pool.value<Real>(prefix + ".offset");
+  }
+
+  const PoolOf(Real)& reals = pool.getRealPool();
+  const PoolOf(vector<Real>)& vectors = pool.getVectorRealPool();
+  vector<Real> previous;
+
+  if (reals.find(descriptorName) != reals.end()) {
+    vector<Real> values = reals.find(descriptorName)->second;
+    vector<Real> frame(1);
+    for (int i=0; i<(int)values.size(); ++i) {
+      frame[0] = values[i];
+      decodeFrame(frame, previous, quantization, delta, scale, offset);
+      values[i] = frame[0];
+    }
+    pool.remove(descriptorName);
+    pool.append(descriptorName, values);
+  }
+  else if (vectors.find(descriptorName) != vectors.end()) {
+    vector<vector<Real> > frames = vectors.find(descriptorName)->second;
+    for (int i=0; i<(int)frames.size(); ++i) {
+      decodeFrame(frames[i], previous, quantization, delta, scale, offset);
+    }
+    pool.remove(descriptorName);
+    pool.append(descriptorName, frames);
+  }
+  // else: no frame has been stored, only the metadata needs to be removed
+
+  // only the metadata keys are removed, the pool may have other descriptors
+  // in the same namespace
+  const char* metadataFields[] = { "decimation", "quantization", "delta", "scale", "offset" };
+  for (int i=0; i<(int)ARRAY_SIZE(metadataFields); ++i) {
+    pool.remove(prefix + "." + metadataFields[i]);
+  }
+}
+
+} // namespace essentia
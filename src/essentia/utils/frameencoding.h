@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_FRAMEENCODING_H
+#define ESSENTIA_FRAMEENCODING_H
+
+#include <string>
+#include <vector>
+#include "pool.h"
+
+namespace essentia {
+
+/**
+ * Describes how the frames of a frame-wise descriptor are stored:
+ *  - decimation: only one frame out of every 'decimation' frames is kept
+ *    (the first one, then every decimation-th frame).
+ *  - quantization: "none" keeps the values as they are, "int8" and "int16"
+ *    map the range [minValue, maxValue] linearly to the integers in
+ *    [-127, 127] and [-32767, 32767] (values outside of the range are
+ *    clipped), and "float16" stores the bit pattern of the half-precision
+ *    float closest to each value.
+ *  - delta: the quantized codes of each frame are replaced by their
+ *    difference with the codes of the previous stored frame. As the codes
+ *    are integers, this is lossless and only needs a quantization.
+ *
+ * The quantized codes are stored as Reals in the Pool, so that they can be
+ * written by YamlOutput like any other descriptor: they take less space on
+ * disk, and decimation reduces the memory used by the Pool.
+ */
+struct FrameEncoding {
+  int decimation;
+  std::string quantization;
+  Real minValue;
+  Real maxValue;
+  bool delta;
+
+  FrameEncoding() : decimation(1), quantization("none"),
+                    minValue(0), maxValue(0), delta(false) {}
+
+  bool isIdentity() const {
+    return decimation == 1 && quantization == "none" && !delta;
+  }
+
+  /**
+   * Throws an EssentiaException if the encoding is not valid. If needRange is
+   * true, the int8 and int16 quantizations also need a range to be given.
+   */
+  void validate(bool needRange) const;
+};
+
+/**
+ * Encodes the successive frames of a descriptor with the given encoding.
+ * The encoder keeps the state needed for decimation and delta encoding, so
+ * that frames can be given one at a time, as they are computed.
+ */
+class FrameEncoder {
+ public:
+  FrameEncoder(const FrameEncoding& encoding);
+
+  const FrameEncoding& encoding() const { return _encoding; }
+
+  /**
+   * Returns false if the frame is dropped by decimation, otherwise returns
+   * true and sets encoded to the codes of the frame.
+   */
+  bool encode(const std::vector<Real>& frame, std::vector<Real>& encoded);
+  bool encode(Real value, Real& encoded);
+
+  /**
+   * Sets the metadata needed to decode the frames of the given descriptor
+   * in pool, under "frameEncoding.<descriptorName>".
+   */
+  void setMetadata(Pool& pool, const std::string& descriptorName) const;
+
+  void reset();
+
+ protected:
+  FrameEncoding _encoding;
+  Real _scale, _offset, _maxCode;
+  long long _frame;
+  std::vector<Real> _previous;
+
+  Real quantize(Real value) const;
+};
+
+/**
+ * Encodes in place the frames of the given descriptor of pool, which must be
+ * a vector of Reals or a vector of vectors of Reals, and sets its metadata.
+ * If no range is given for an int8 or int16 quantization, the range of the
+ * values of the descriptor is used.
+ */
+void encodeFrames(Pool& pool, const std::string& descriptorName,
+                  const FrameEncoding& encoding);
+
+/**
+ * Decodes in place the frames of a descriptor encoded by encodeFrames or by
+ * a PoolStorage with an encoding, using (and removing) its metadata. Decimated
+ * frames are not restored.
+ */
+void decodeFrames(Pool& pool, const std::string& descriptorName);
+
+Real halfToReal(Real code);
+Real realToHalf(Real value);
+
+} // namespace essentia
+
+#endif // ESSENTIA_FRAMEENCODING_H
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <stdint.h>
+#include "poolbinary.h"
+
+using namespace std;
+
+namespace essentia {
+
+static const char poolBinaryMagic[8] = { 'E', 'S', 'S', 'P', 'O', 'O', 'L', '1' };
+
+// the values of each sub-pool are stored as a list of (name, value(s)) pairs,
+// with the sub-pools always written in the same order
+enum PoolBinaryType {
+  SINGLE_REAL, SINGLE_STRING, SINGLE_VECTOR_REAL, SINGLE_VECTOR_STRING,
+  REAL, STRING, VECTOR_REAL, VECTOR_STRING, STEREO_SAMPLE, ARRAY2D_REAL,
+  NUMBER_OF_TYPES
+};
+
+
+static void writeSize(ostream& out, size_t size) {
+  uint64_t s = size;
+  out.write((const char*)&s, sizeof(s));
+}
+
+static void write(ostream& out, const Real& value) {
+  out.write((const char*)&value, sizeof(Real));
+}
+
+static void write(ostream& out, const string& value) {
+  writeSize(out, value.size());
+  out.write(value.data(), value.size());
+}
+
+static void write(ostream& out, const StereoSample& value) {
+  write(out, value.left());
+  write(out, value.right());
+}
+
+static void write(ostream& out, const vector<Real>& value) {
+  writeSize(out, value.size());
+  if (!value.empty()) out.write((const char*)&value[0], value.size()*sizeof(Real));
+}
+
+static void write(ostream& out, const TNT::Array2D<Real>& value) {
+  writeSize(out, value.dim1());
+  writeSize(out, value.dim2());
+  if (value.dim1() > 0 && value.dim2() > 0) {
+    // Array2D rows are stored contiguously
+    out.write((const char*)value[0], value.dim1()*value.dim2()*sizeof(Real));
+  }
+}
+
+template <typename T>
+static void write(ostream& out, const vector<T>& value) {
+  writeSize(out, value.size());
+  for (int i=0; i<(int)value.size(); ++i) write(out, value[i]);
+}
+
+template <typename T>
+static void writeSubPool(ostream& out, const map<string, T>& subPool) {
+  writeSize(out, subPool.size());
+  for (typename map<string, T>::const_iterator it = subPool.begin(); it != subPool.end(); ++it) {
+    write(out, it->first);
+    write(out, it->second);
+  }
+}
+
+
+void writePoolBinary(ostream& out, const Pool& pool) {
+  out.write(poolBinaryMagic, sizeof(poolBinaryMagic));
+  writeSize(out, sizeof(Real));
+  writeSize(out, NUMBER_OF_TYPES);
+
+  writeSubPool(out, pool.getSingleRealPool());
+  writeSubPool(out, pool.getSingleStringPool());
+  writeSubPool(out, pool.getSingleVectorRealPool());
+  writeSubPool(out, pool.getSingleVectorStringPool());
+  writeSubPool(out, pool.getRealPool());
+  writeSubPool(out, pool.getStringPool());
+  writeSubPool(out, pool.getVectorRealPool());
+  writeSubPool(out, pool.getVectorStringPool());
+  writeSubPool(out, pool.getStereoSamplePool());
+  writeSubPool(out, pool.getArray2DRealPool());
+
+  if (!out) {
+    throw EssentiaException("writePoolBinary: error while writing the pool");
+  }
+}
+
+
+// the stream being read, with the position of its end, so that sizes read
+// from a damaged stream can be checked before allocating anything
+struct PoolBinaryInput {
+  istream& in;
+  streamoff end;
+
+  PoolBinaryInput(istream& stream) : in(stream) {
+    streampos pos = in.tellg();
+    in.seekg(0, ios::end);
+    end = in.tellg();
+    in.seekg(pos);
+    if (pos < 0 || end < 0) {
+      throw EssentiaException("readPoolBinary: the stream is not seekable");
+    }
+  }
+
+  uint64_t available() const { return uint64_t(end - streamoff(in.tellg())); }
+};
+
+static void check(PoolBinaryInput& input) {
+  if (!input.in) {
+    throw EssentiaException("readPoolBinary: unexpected end of stream, the binary pool is truncated");
+  }
+}
+
+// reads the number of elements that follow, each of them taking at least
+// elementSize bytes in the stream
+static size_t readSize(PoolBinaryInput& input, size_t elementSize) {
+  uint64_t s;
+  input.in.read((char*)&s, sizeof(s));
+  check(input);
+  if (s > input.available() / elementSize) {
+    throw EssentiaException("readPoolBinary: invalid size ", s, ", the binary pool is damaged or truncated");
+  }
+  return s;
+}
+
+static void read(PoolBinaryInput& input, Real& value) {
+  input.in.read((char*)&value, sizeof(Real));
+  check(input);
+}
+
+static void read(PoolBinaryInput& input, string& value) {
+  value.resize(readSize(input, 1));
+  if (!value.empty()) input.in.read(&value[0], value.size());
+  check(input);
+}
+
+static void read(PoolBinaryInput& input, StereoSample& value) {
+  read(input, value.left());
+  read(input, value.right());
+}
+
+static void read(PoolBinaryInput& input, vector<Real>& value) {
+  value.resize(readSize(input, sizeof(Real)));
+  if (!value.empty()) input.in.read((char*)&value[0], value.size()*sizeof(Real));
+  check(input);
+}
+
+static void read(PoolBinaryInput& input, TNT::Array2D<Real>& value) {
+  size_t dim1 = readSize(input, 1);
+  size_t dim2 = readSize(input, 1);
+  if (dim1 > 0 && dim2 > input.available() / sizeof(Real) / dim1) {
+    throw EssentiaException("readPoolBinary: invalid matrix size, the binary pool is damaged or truncated");
+  }
+  value = TNT::Array2D<Real>(int(dim1), int(dim2));
+  if (dim1 > 0 && dim2 > 0) input.in.read((char*)value[0], dim1*dim2*sizeof(Real));
+  check(input);
+}
+
+// every value takes at least sizeof(Real) bytes (a Real, or the uint64_t
+// size of a string, vector or matrix)
+template <typename T>
+static void read(PoolBinaryInput& input, vector<T>& value) {
+  value.resize(readSize(input, sizeof(Real)));
+  for (int i=0; i<(int)value.size(); ++i) read(input, value[i]);
+}
+
+// every entry takes at least the size of its name and its value
+template <typename T>
+static void readSingleSubPool(PoolBinaryInput& input, Pool& pool) {
+  size_t size = readSize(input, sizeof(uint64_t) + sizeof(Real));
+  string name;
+  T value;
+  for (size_t i=0; i<size; ++i) {
+    read(input, name);
+    read(input, value);
+    pool.set(name, value);
+  }
+}
+
+template <typename T>
+static void readSubPool(PoolBinaryInput& input, Pool& pool) {
+  size_t size = readSize(input, 2*sizeof(uint64_t));
+  string name;
+  vector<T> values;
+  for (size_t i=0; i<size; ++i) {
+    read(input, name);
+    read(input, values);
+    // descriptors always have values, and Pool::merge does not accept an
+    // empty list of matrices
+    if (!values.empty()) pool.merge(name, values);
+  }
+}
+
+
+void readPoolBinary(istream& in, Pool& pool) {
+  char magic[sizeof(poolBinaryMagic)];
+  in.read(magic, sizeof(magic));
+  if (!in || !equal(magic, magic + sizeof(magic), poolBinaryMagic)) {
+    throw EssentiaException("readPoolBinary: the stream does not contain a binary pool");
+  }
+
+  PoolBinaryInput input(in);
+  if (readSize(input, 1) != sizeof(Real)) {
+    throw EssentiaException("readPoolBinary: the binary pool was written with a different Real type");
+  }
+  if (readSize(input, 1) != NUMBER_OF_TYPES) {
+    throw EssentiaException("readPoolBinary: unsupported binary pool version");
+  }
+
+  readSingleSubPool<Real>(input, pool);
+  readSingleSubPool<string>(input, pool);
+  readSingleSubPool<vector<Real> >(input, pool);
+  readSingleSubPool<vector<string> >(input, pool);
+  readSubPool<Real>(input, pool);
+  readSubPool<string>(input, pool);
+  readSubPool<vector<Real> >(input, pool);
+  readSubPool<vector<string> >(input, pool);
+  readSubPool<StereoSample>(input, pool);
+  readSubPool<TNT::Array2D<Real> >(input, pool);
+}
+
+} // namespace essentia
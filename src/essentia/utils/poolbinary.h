@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_POOLBINARY_H
+#define ESSENTIA_POOLBINARY_H
+
+#include <iostream>
+#include "pool.h"
+
+namespace essentia {
+
+/**
+ * Writes all the descriptors of a Pool to a stream in a compact binary form.
+ * Values are written in the native byte order and with the native size of
+ * Real, so the result is meant to be read back by the same build, e.g. for
+ * caching analysis results, not as an interchange format.
+ */
+void writePoolBinary(std::ostream& out, const Pool& pool);
+
+/**
+ * Reads descriptors written by writePoolBinary and adds them to the given
+ * pool. An exception is thrown if the stream is not a valid binary pool, if
+ * it was written with a different Real type, or if it is damaged or
+ * truncated. The stream must be seekable, as the sizes read are checked
+ * against the number of bytes left in it.
+ */
+void readPoolBinary(std::istream& in, Pool& pool);
+
+} // namespace essentia
+
+#endif // ESSENTIA_POOLBINARY_H
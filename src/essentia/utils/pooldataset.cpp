@@ -0,0 +1,654 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#ifndef _WIN32
+#include <unistd.h> // truncate
+#endif
+#include "pooldataset.h"
+
+using namespace std;
+
+namespace essentia {
+
+// file layout, all sizes being uint64:
+//   magic, sizeof(Real), number of columns, (name, type, dimension) per column
+//   then for each chunk:
+//     chunk magic, number of rows, size of each column (the ids being first)
+//     the values of the ids, then of each column, for all the rows of the chunk
+static const char datasetMagic[8] = { 'E', 'S', 'S', 'D', 'S', 'E', 'T', '1' };
+static const char chunkMagic[8] = { 'E', 'S', 'S', 'C', 'H', 'U', 'N', 'K' };
+
+
+static void appendSize(string& out, size_t size) {
+  uint64_t s = size;
+  out.append((const char*)&s, sizeof(s));
+}
+
+static void appendReals(string& out, const Real* values, size_t size) {
+  if (size) out.append((const char*)values, size*sizeof(Real));
+}
+
+static void appendString(string& out, const string& value) {
+  appendSize(out, value.size());
+  out.append(value);
+}
+
+template <typename T>
+static const T* find(const map<string, T>& subPool, const string& name) {
+  typename map<string, T>::const_iterator it = subPool.find(name);
+  return it == subPool.end() ? 0 : &it->second;
+}
+
+
+// reads the values of a column block with bounds checking
+class BlockParser {
+ public:
+  BlockParser(const string& block) : _block(block), _pos(0) {}
+
+  // reads the number of elements that follow, each of them taking
+  // elementSize bytes in the block (if not 0)
+  size_t readSize(size_t elementSize=0) {
+    uint64_t s;
+    readBytes((char*)&s, sizeof(s));
+    if (elementSize) check(s, elementSize);
+    return s;
+  }
+
+  void readReals(Real* values, size_t size) {
+    check(size, sizeof(Real));
+    readBytes((char*)values, size*sizeof(Real));
+  }
+
+  // the size is checked before resizing values, as it may be corrupted too
+  void readReals(vector<Real>& values, size_t size) {
+    check(size, sizeof(Real));
+    values.resize(size);
+    if (size) readBytes((char*)&values[0], size*sizeof(Real));
+  }
+
+  string readString() {
+    size_t size = readSize(1);
+    string value = _block.substr(_pos, size);
+    _pos += size;
+    return value;
+  }
+
+ protected:
+  const string& _block;
+  size_t _pos;
+
+  void check(uint64_t size, size_t elementSize=1) {
+    if (size > (_block.size() - _pos) / elementSize) {
+      throw EssentiaException("PoolDatasetReader: corrupted column block");
+    }
+  }
+
+  void readBytes(char* out, size_t size) {
+    check(size);
+    if (size) memcpy(out, &_block[_pos], size);
+    _pos += size;
+  }
+};
+
+
+PoolDatasetWriter::PoolDatasetWriter(const string& filename, int chunkSize, int chunkBytes) :
+    _filename(filename), _chunkSize(chunkSize), _chunkBytes(chunkBytes), _autoFlush(true),
+    _hasSchema(false), _rows(0), _bytes(0) {
+
+  if (_chunkSize < 1) {
+    throw EssentiaException("PoolDatasetWriter: chunkSize must be at least 1");
+  }
+  if (_chunkBytes < 1) {
+    throw EssentiaException("PoolDatasetWriter: chunkBytes must be at least 1");
+  }
+
+  ifstream existing(filename.c_str(), ios::binary | ios::ate);
+  bool append = existing.is_open() && existing.tellg() > 0;
+  streamoff fileSize = append ? streamoff(existing.tellg()) : 0;
+  existing.close();
+
+  if (append) {
+    PoolDatasetReader reader(filename);
+    _columns = reader.columns();
+    for (int i=0; i<(int)_columns.size(); ++i) _names.insert(_columns[i].name);
+    _hasSchema = true;
+
+    if (reader.validSize() < fileSize) {
+#ifdef _WIN32
+      throw EssentiaException("PoolDatasetWriter: ", filename, " ends with an incomplete chunk, "
+                              "which cannot be removed on this platform");
+#else
+      if (truncate(filename.c_str(), reader.validSize()) != 0) {
+        throw EssentiaException("PoolDatasetWriter: could not remove the incomplete chunk at the end of ", filename);
+      }
+#endif
+    }
+    _file.open(filename.c_str(), ios::binary | ios::app);
+  }
+  else {
+    _file.open(filename.c_str(), ios::binary | ios::trunc);
+  }
+
+  if (!_file.is_open()) {
+    throw EssentiaException("PoolDatasetWriter: could not open ", filename, " for writing");
+  }
+
+  _chunk.resize(_columns.size() + 1);
+}
+
+PoolDatasetWriter::~PoolDatasetWriter() {
+  try {
+    close();
+  }
+  catch (EssentiaException& e) {
+    E_WARNING("PoolDatasetWriter: " << e.what());
+  }
+}
+
+template <typename T>
+static void addColumns(const map<string, T>& subPool, PoolDatasetColumnType type,
+                       vector<PoolDatasetColumn>& columns) {
+  for (typename map<string, T>::const_iterator it = subPool.begin(); it != subPool.end(); ++it) {
+    PoolDatasetColumn column;
+    column.name = it->first;
+    column.type = type;
+    column.dimension = 1;
+    columns.push_back(column);
+  }
+}
+
+static bool columnNameLess(const PoolDatasetColumn& a, const PoolDatasetColumn& b) {
+  return a.name < b.name;
+}
+
+void PoolDatasetWriter::setColumns(const Pool& pool) {
+  _columns.clear();
+  addColumns(pool.getSingleRealPool(), RealColumn, _columns);
+  addColumns(pool.getSingleVectorRealPool(), VectorColumn, _columns);
+  addColumns(pool.getRealPool(), RealListColumn, _columns);
+  addColumns(pool.getVectorRealPool(), VectorListColumn, _columns);
+  addColumns(pool.getSingleStringPool(), StringColumn, _columns);
+  addColumns(pool.getSingleVectorStringPool(), StringListColumn, _columns);
+  addColumns(pool.getStringPool(), StringListColumn, _columns);
+  sort(_columns.begin(), _columns.end(), columnNameLess);
+
+  // the size of the vectors of Reals is fixed by the first pool
+  for (int i=0; i<(int)_columns.size(); ++i) {
+    PoolDatasetColumn& column = _columns[i];
+    if (column.type == VectorColumn) {
+      column.dimension = find(pool.getSingleVectorRealPool(), column.name)->size();
+    }
+    else if (column.type == VectorListColumn) {
+      const vector<vector<Real> >& frames = *find(pool.getVectorRealPool(), column.name);
+      column.dimension = frames.empty() ? 0 : frames[0].size();
+    }
+    _names.insert(column.name);
+  }
+
+  _chunk.clear();
+  _chunk.resize(_columns.size() + 1);
+  _hasSchema = true;
+}
+
+void PoolDatasetWriter::writeHeader() {
+  string header(datasetMagic, sizeof(datasetMagic));
+  appendSize(header, sizeof(Real));
+  appendSize(header, _columns.size());
+  for (int i=0; i<(int)_columns.size(); ++i) {
+    appendString(header, _columns[i].name);
+    appendSize(header, _columns[i].type);
+    appendSize(header, _columns[i].dimension);
+  }
+  _file.write(header.data(), header.size());
+  _file.flush();
+  if (!_file) {
+    throw EssentiaException("PoolDatasetWriter: error while writing to ", _filename);
+  }
+}
+
+void PoolDatasetWriter::add(const string& id, const Pool& pool) {
+  {
+    ForcedMutexLocker lock(_mutex);
+    if (!_file.is_open()) {
+      throw EssentiaException("PoolDatasetWriter: cannot add to ", _filename, ", it has been closed");
+    }
+    if (!_hasSchema) {
+      setColumns(pool);
+      writeHeader();
+    }
+  }
+
+  // the values of the row are serialized without holding the lock, the
+  // columns do not change once they have been set
+  vector<string> row(_columns.size());
+  const Real nan = numeric_limits<Real>::quiet_NaN();
+
+  for (int i=0; i<(int)_columns.size(); ++i) {
+    const PoolDatasetColumn& column = _columns[i];
+    string& out = row[i];
+
+    switch (column.type) {
+    case RealColumn: {
+      const Real* value = find(pool.getSingleRealPool(), column.name);
+      appendReals(out, value ? value : &nan, 1);
+      break;
+    }
+    case VectorColumn: {
+      const vector<Real>* value = find(pool.getSingleVectorRealPool(), column.name);
+      if (!value) {
+        vector<Real> missing(column.dimension, nan);
+        appendReals(out, missing.empty() ? 0 : &missing[0], missing.size());
+      }
+      else if ((int)value->size() != column.dimension) {
+        throw EssentiaException("PoolDatasetWriter: the size of ", column.name,
+                                " is different from its size in the dataset, ", column.dimension);
+      }
+      else {
+        appendReals(out, value->empty() ? 0 : &(*value)[0], value->size());
+      }
+      break;
+    }
+    case RealListColumn: {
+      const vector<Real>* value = find(pool.getRealPool(), column.name);
+      appendSize(out, value ? value->size() : 0);
+      if (value && !value->empty()) appendReals(out, &(*value)[0], value->size());
+      break;
+    }
+    case VectorListColumn: {
+      const vector<vector<Real> >* value = find(pool.getVectorRealPool(), column.name);
+      appendSize(out, value ? value->size() : 0);
+      if (!value) break;
+      for (int j=0; j<(int)value->size(); ++j) {
+        const vector<Real>& frame = (*value)[j];
+        if ((int)frame.size() != column.dimension) {
+          throw EssentiaException("PoolDatasetWriter: the size of the frames of ", column.name,
+                                  " is different from their size in the dataset, ", column.dimension);
+        }
+        if (!frame.empty()) appendReals(out, &frame[0], frame.size());
+      }
+      break;
+    }
+    case StringColumn: {
+      const string* value = find(pool.getSingleStringPool(), column.name);
+      appendString(out, value ? *value : string());
+      break;
+    }
+    case StringListColumn: {
+      const vector<string>* value = find(pool.getStringPool(), column.name);
+      if (!value) value = find(pool.getSingleVectorStringPool(), column.name);
+      appendSize(out, value ? value->size() : 0);
+      if (!value) break;
+      for (int j=0; j<(int)value->size(); ++j) appendString(out, (*value)[j]);
+      break;
+    }
+    }
+  }
+
+  vector<string> ignored;
+  vector<string> names = pool.descriptorNames();
+  for (int i=0; i<(int)names.size(); ++i) {
+    if (_names.find(names[i]) == _names.end()) ignored.push_back(names[i]);
+  }
+
+  ForcedMutexLocker lock(_mutex);
+  for (int i=0; i<(int)ignored.size(); ++i) {
+    if (_ignored.insert(ignored[i]).second) {
+      E_WARNING("PoolDatasetWriter: " << ignored[i] << " is not a column of " << _filename
+                << " (or its type is not supported), it is ignored");
+    }
+  }
+
+  appendString(_chunk[0], id);
+  _bytes += id.size() + sizeof(uint64_t);
+  for (int i=0; i<(int)row.size(); ++i) {
+    _chunk[i+1] += row[i];
+    _bytes += row[i].size();
+  }
+  _rows++;
+  if (_autoFlush && (_rows >= _chunkSize || _bytes >= size_t(_chunkBytes))) writeChunk();
+}
+
+void PoolDatasetWriter::setAutoFlush(bool autoFlush) {
+  ForcedMutexLocker lock(_mutex);
+  _autoFlush = autoFlush;
+}
+
+bool PoolDatasetWriter::chunkFull() {
+  ForcedMutexLocker lock(_mutex);
+  return _rows >= _chunkSize || _bytes >= size_t(_chunkBytes);
+}
+
+void PoolDatasetWriter::flush() {
+  ForcedMutexLocker lock(_mutex);
+  if (!_file.is_open()) return;
+  writeChunk();
+}
+
+void PoolDatasetWriter::writeChunk() {
+  if (_rows == 0) return;
+
+  string header(chunkMagic, sizeof(chunkMagic));
+  appendSize(header, _rows);
+  for (int i=0; i<(int)_chunk.size(); ++i) appendSize(header, _chunk[i].size());
+
+  _file.write(header.data(), header.size());
+  for (int i=0; i<(int)_chunk.size(); ++i) {
+    _file.write(_chunk[i].data(), _chunk[i].size());
+    _chunk[i].clear();
+  }
+  _file.flush();
+  _rows = 0;
+  _bytes = 0;
+
+  if (!_file) {
+    throw EssentiaException("PoolDatasetWriter: error while writing to ", _filename);
+  }
+}
+
+void PoolDatasetWriter::close() {
+  ForcedMutexLocker lock(_mutex);
+  if (!_file.is_open()) return;
+  writeChunk();
+  _file.close();
+}
+
+
+static void check(istream& in, const string& filename) {
+  if (!in) {
+    throw EssentiaException("PoolDatasetReader: unexpected end of file, the header of ",
+                            filename, " is truncated");
+  }
+}
+
+static size_t readSize(istream& in, const string& filename) {
+  uint64_t s;
+  in.read((char*)&s, sizeof(s));
+  check(in, filename);
+  return s;
+}
+
+// reads the number of elements that follow, each of them taking at least
+// elementSize bytes before the end of the file
+static size_t readSize(istream& in, const string& filename, streamoff fileSize, size_t elementSize) {
+  uint64_t s = readSize(in, filename);
+  if (s > uint64_t(fileSize - in.tellg()) / elementSize) {
+    throw EssentiaException("PoolDatasetReader: invalid size ", s, ", the header of ",
+                            filename + " is corrupted");
+  }
+  return s;
+}
+
+PoolDatasetReader::PoolDatasetReader(const string& filename) :
+    _filename(filename), _size(0), _validSize(0) {
+
+  _file.open(filename.c_str(), ios::binary);
+  if (!_file.is_open()) {
+    throw EssentiaException("PoolDatasetReader: could not open ", filename);
+  }
+
+  _file.seekg(0, ios::end);
+  streamoff fileSize = _file.tellg();
+  _file.seekg(0, ios::beg);
+  if (fileSize == 0) return; // no row was ever added
+
+  char magic[sizeof(datasetMagic)];
+  _file.read(magic, sizeof(magic));
+  if (!_file || memcmp(magic, datasetMagic, sizeof(magic)) != 0) {
+    throw EssentiaException("PoolDatasetReader: ", filename, " is not a dataset");
+  }
+  if (readSize(_file, filename) != sizeof(Real)) {
+    throw EssentiaException("PoolDatasetReader: ", filename,
+                            " was written with a different Real type");
+  }
+
+  // a column takes at least the sizes of its name, type and dimension. Its
+  // dimension is only checked when reading the values, as the header may be
+  // written before any chunk
+  _columns.resize(readSize(_file, filename, fileSize, 3*sizeof(uint64_t)));
+  for (int i=0; i<(int)_columns.size(); ++i) {
+    PoolDatasetColumn& column = _columns[i];
+    column.name.resize(readSize(_file, filename, fileSize, 1));
+    if (!column.name.empty()) _file.read(&column.name[0], column.name.size());
+    column.type = (PoolDatasetColumnType)readSize(_file, filename);
+    uint64_t dimension = readSize(_file, filename);
+    column.dimension = dimension;
+    if (column.type > StringListColumn || dimension > uint64_t(numeric_limits<int>::max())) {
+      throw EssentiaException("PoolDatasetReader: ", filename, " is corrupted");
+    }
+  }
+
+  // index the chunks, the last one may be incomplete if the writing process
+  // has been interrupted
+  _validSize = _file.tellg();
+  int nBlocks = _columns.size() + 1;
+  streamoff chunkHeaderSize = sizeof(chunkMagic) + (nBlocks + 1)*sizeof(uint64_t);
+
+  while (_validSize + chunkHeaderSize <= fileSize) {
+    _file.seekg(_validSize);
+    _file.read(magic, sizeof(magic));
+    if (!_file || memcmp(magic, chunkMagic, sizeof(magic)) != 0) break;
+
+    // sizes going past the end of the file are those of an incomplete
+    // chunk, each row taking at least the size of its id
+    streamoff offset = _validSize + chunkHeaderSize;
+    uint64_t rows = readSize(_file, filename);
+    if (rows > uint64_t(fileSize - offset) / sizeof(uint64_t)) break;
+
+    Chunk chunk;
+    chunk.rows = rows;
+    for (int i=0; i<nBlocks; ++i) {
+      uint64_t size = readSize(_file, filename);
+      if (size > uint64_t(fileSize - offset)) break;
+      chunk.offsets.push_back(offset);
+      chunk.sizes.push_back(size);
+      offset += size;
+    }
+    if ((int)chunk.sizes.size() < nBlocks) break;
+
+    _chunks.push_back(chunk);
+    _size += chunk.rows;
+    _validSize = offset;
+  }
+
+  if (_validSize < fileSize) {
+    E_WARNING("PoolDatasetReader: " << filename << " ends with an incomplete chunk, which is ignored");
+  }
+  _file.clear();
+}
+
+const PoolDatasetColumn& PoolDatasetReader::column(const string& name) const {
+  return _columns[columnIndex(name)];
+}
+
+int PoolDatasetReader::columnIndex(const string& name) const {
+  for (int i=0; i<(int)_columns.size(); ++i) {
+    if (_columns[i].name == name) return i;
+  }
+  throw EssentiaException("PoolDatasetReader: ", _filename, " has no column named ", name);
+}
+
+void PoolDatasetReader::readBlock(const Chunk& chunk, int index, string& block) {
+  block.resize(chunk.sizes[index]);
+  _file.clear();
+  _file.seekg(chunk.offsets[index]);
+  if (!block.empty()) _file.read(&block[0], block.size());
+  if (!_file) {
+    throw EssentiaException("PoolDatasetReader: error while reading ", _filename);
+  }
+}
+
+static void checkType(const PoolDatasetColumn& column, bool valid, const char* type) {
+  if (!valid) {
+    throw EssentiaException("PoolDatasetReader: column ", column.name,
+                            " cannot be read as ", type);
+  }
+}
+
+// reads the values of a row of a list column, the vectors of the row being
+// concatenated
+static void readList(BlockParser& parser, const PoolDatasetColumn& column, vector<Real>& values) {
+  size_t dimension = column.type == VectorListColumn ? column.dimension : 1;
+  size_t size = parser.readSize(dimension*sizeof(Real));
+  parser.readReals(values, size*dimension);
+}
+
+vector<string> PoolDatasetReader::ids() {
+  vector<string> values;
+  values.reserve(_size);
+  string block;
+  for (int c=0; c<(int)_chunks.size(); ++c) {
+    readBlock(_chunks[c], 0, block);
+    BlockParser parser(block);
+    for (int i=0; i<_chunks[c].rows; ++i) values.push_back(parser.readString());
+  }
+  return values;
+}
+
+void PoolDatasetReader::read(const string& name, vector<Real>& values) {
+  int index = columnIndex(name);
+  checkType(_columns[index], _columns[index].type == RealColumn, "Real");
+
+  values.resize(_size);
+  int row = 0;
+  string block;
+  for (int c=0; c<(int)_chunks.size(); ++c) {
+    readBlock(_chunks[c], index+1, block);
+    BlockParser parser(block);
+    parser.readReals(&values[row], _chunks[c].rows);
+    row += _chunks[c].rows;
+  }
+}
+
+void PoolDatasetReader::read(const string& name, vector<vector<Real> >& values) {
+  int index = columnIndex(name);
+  const PoolDatasetColumn& column = _columns[index];
+  checkType(column, column.type == VectorColumn || column.type == RealListColumn ||
+                    column.type == VectorListColumn, "vector<Real>");
+
+  values.resize(_size);
+  int row = 0;
+  string block;
+  for (int c=0; c<(int)_chunks.size(); ++c) {
+    readBlock(_chunks[c], index+1, block);
+    BlockParser parser(block);
+    for (int i=0; i<_chunks[c].rows; ++i, ++row) {
+      if (column.type == VectorColumn) parser.readReals(values[row], column.dimension);
+      else readList(parser, column, values[row]);
+    }
+  }
+}
+
+void PoolDatasetReader::read(const string& name, vector<string>& values) {
+  int index = columnIndex(name);
+  checkType(_columns[index], _columns[index].type == StringColumn, "string");
+
+  values.clear();
+  values.reserve(_size);
+  string block;
+  for (int c=0; c<(int)_chunks.size(); ++c) {
+    readBlock(_chunks[c], index+1, block);
+    BlockParser parser(block);
+    for (int i=0; i<_chunks[c].rows; ++i) values.push_back(parser.readString());
+  }
+}
+
+void PoolDatasetReader::read(const string& name, vector<vector<string> >& values) {
+  int index = columnIndex(name);
+  checkType(_columns[index], _columns[index].type == StringListColumn, "vector<string>");
+
+  values.resize(_size);
+  int row = 0;
+  string block;
+  for (int c=0; c<(int)_chunks.size(); ++c) {
+    readBlock(_chunks[c], index+1, block);
+    BlockParser parser(block);
+    for (int i=0; i<_chunks[c].rows; ++i, ++row) {
+      values[row].resize(parser.readSize(sizeof(uint64_t)));
+      for (int j=0; j<(int)values[row].size(); ++j) values[row][j] = parser.readString();
+    }
+  }
+}
+
+void PoolDatasetReader::readRow(int row, Pool& pool) {
+  if (row < 0 || row >= _size) {
+    throw EssentiaException("PoolDatasetReader: row ", row, " is out of range, the number of rows is ", _size);
+  }
+
+  int c = 0;
+  while (row >= _chunks[c].rows) row -= _chunks[c++].rows;
+  const Chunk& chunk = _chunks[c];
+
+  string block;
+  vector<Real> values;
+  for (int index=0; index<(int)_columns.size(); ++index) {
+    const PoolDatasetColumn& column = _columns[index];
+    readBlock(chunk, index+1, block);
+    BlockParser parser(block);
+
+    // skip the values of the previous rows of the chunk
+    for (int i=0; i<=row; ++i) {
+      switch (column.type) {
+      case RealColumn:
+      case VectorColumn:
+        parser.readReals(values, column.dimension);
+        if (i == row && !values.empty() && !isnan(values[0])) {
+          if (column.type == RealColumn) pool.set(column.name, values[0]);
+          else                           pool.set(column.name, values);
+        }
+        break;
+
+      case RealListColumn:
+        readList(parser, column, values);
+        if (i == row && !values.empty()) pool.append(column.name, values);
+        break;
+
+      case VectorListColumn:
+        readList(parser, column, values);
+        if (i == row) {
+          for (int j=0; j<(int)values.size(); j+=column.dimension) {
+            pool.add(column.name, vector<Real>(values.begin()+j, values.begin()+j+column.dimension));
+          }
+        }
+        break;
+
+      case StringColumn: {
+        string value = parser.readString();
+        if (i == row) pool.set(column.name, value);
+        break;
+      }
+
+      case StringListColumn: {
+        int n = parser.readSize(sizeof(uint64_t));
+        for (int j=0; j<n; ++j) {
+          string value = parser.readString();
+          if (i == row) pool.add(column.name, value);
+        }
+        break;
+      }
+      }
+    }
+  }
+}
+
+} // namespace essentia
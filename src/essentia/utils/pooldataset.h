@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_POOLDATASET_H
+#define ESSENTIA_POOLDATASET_H
+
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+#include "pool.h"
+#include "threading.h"
+
+namespace essentia {
+
+/**
+ * The columns of a dataset, one per descriptor of the first Pool written to
+ * it, plus the id of each row:
+ *  - RealColumn: a single Real (Pool::set)
+ *  - VectorColumn: a single vector of Reals of constant size (Pool::set)
+ *  - RealListColumn: a variable number of Reals (Pool::add), e.g. frame
+ *    values or beat positions
+ *  - VectorListColumn: a variable number of vectors of Reals of constant size
+ *    (Pool::add), e.g. frame values
+ *  - StringColumn: a single string (Pool::set)
+ *  - StringListColumn: a variable number of strings (Pool::add, or a single
+ *    vector of strings)
+ * Other descriptors (Array2D, stereo samples, vectors of vectors of strings)
+ * are not stored.
+ */
+enum PoolDatasetColumnType {
+  RealColumn, VectorColumn, RealListColumn, VectorListColumn,
+  StringColumn, StringListColumn
+};
+
+struct PoolDatasetColumn {
+  std::string name;
+  PoolDatasetColumnType type;
+  int dimension; // the size of each vector of Reals, 1 for Reals
+};
+
+
+/**
+ * Appends Pools, e.g. the results of an extractor for many files, as the rows
+ * of a columnar dataset file. The rows are grouped in chunks, and the values
+ * of each column are stored contiguously inside a chunk, so that a single
+ * column can be read back without parsing the other ones (see
+ * PoolDatasetReader).
+ *
+ * The columns are those of the first Pool added to the dataset. Descriptors
+ * missing from later Pools are stored as NaN, empty strings or empty lists,
+ * and descriptors that are not in the dataset are ignored with a warning.
+ *
+ * The rows are buffered in memory until the current chunk has chunkSize rows
+ * or chunkBytes bytes, and the chunk is then written to the file.
+ *
+ * Pools can be added from several threads at the same time. Values are
+ * written in the native byte order and with the native size of Real, as for
+ * writePoolBinary. Opening an existing dataset appends to it, after dropping
+ * a chunk that was not completely written (e.g. if the writing process was
+ * interrupted).
+ */
+class PoolDatasetWriter {
+ public:
+  PoolDatasetWriter(const std::string& filename, int chunkSize=1024,
+                    int chunkBytes=64*1024*1024);
+  ~PoolDatasetWriter();
+
+  /**
+   * Adds the descriptors of pool as a new row with the given id (e.g. the
+   * filename of the track).
+   */
+  void add(const std::string& id, const Pool& pool);
+
+  /**
+   * If autoFlush is false, add() never writes the current chunk, even if it
+   * is full, and flush() must be called instead, e.g. for writing the
+   * chunks of two datasets with related rows at the same time.
+   */
+  void setAutoFlush(bool autoFlush);
+
+  /**
+   * Returns true if the current chunk has chunkSize rows or chunkBytes
+   * bytes.
+   */
+  bool chunkFull();
+
+  /**
+   * Writes the rows not written yet as a new chunk.
+   */
+  void flush();
+
+  /**
+   * Writes the rows not written yet and closes the file. Called by the
+   * destructor if needed.
+   */
+  void close();
+
+  const std::vector<PoolDatasetColumn>& columns() const { return _columns; }
+
+ protected:
+  std::string _filename;
+  std::ofstream _file;
+  int _chunkSize;
+  int _chunkBytes;
+  bool _autoFlush;
+  bool _hasSchema;
+  std::vector<PoolDatasetColumn> _columns;
+  std::set<std::string> _names;
+  std::set<std::string> _ignored;
+
+  ForcedMutex _mutex; // protects everything below
+  int _rows; // rows in the current chunk
+  std::vector<std::string> _chunk; // the values of the current chunk, per column
+  size_t _bytes; // size of the values of the current chunk
+
+  void setColumns(const Pool& pool);
+  void writeHeader();
+  void writeChunk();
+};
+
+
+/**
+ * Reads the columns of a dataset written by PoolDatasetWriter. Only the
+ * header of each chunk is read when opening the dataset; reading a column
+ * then reads its values in each chunk, skipping the other columns.
+ */
+class PoolDatasetReader {
+ public:
+  PoolDatasetReader(const std::string& filename);
+
+  int size() const { return _size; }
+  const std::vector<PoolDatasetColumn>& columns() const { return _columns; }
+  const PoolDatasetColumn& column(const std::string& name) const;
+
+  std::vector<std::string> ids();
+
+  /**
+   * Reads all the rows of a column. The type of values must match the type
+   * of the column: Real for RealColumn, vector<Real> for VectorColumn and
+   * the list columns (the vectors of a row of a VectorListColumn are
+   * concatenated), string for StringColumn and vector<string> for
+   * StringListColumn.
+   */
+  void read(const std::string& name, std::vector<Real>& values);
+  void read(const std::string& name, std::vector<std::vector<Real> >& values);
+  void read(const std::string& name, std::vector<std::string>& values);
+  void read(const std::string& name, std::vector<std::vector<std::string> >& values);
+
+  /**
+   * Adds all the descriptors of a row to pool, as they were in the Pool
+   * written to the dataset. Descriptors that were missing from that Pool
+   * (NaN values and empty lists) are not added.
+   */
+  void readRow(int row, Pool& pool);
+
+  /**
+   * The size of the part of the file made of complete chunks.
+   */
+  std::streamoff validSize() const { return _validSize; }
+
+ protected:
+  struct Chunk {
+    int rows;
+    std::vector<std::streamoff> offsets; // of each column, the ids being first
+    std::vector<std::streamoff> sizes;
+  };
+
+  std::string _filename;
+  std::ifstream _file;
+  std::vector<PoolDatasetColumn> _columns;
+  std::vector<Chunk> _chunks;
+  int _size;
+  std::streamoff _validSize;
+
+  int columnIndex(const std::string& name) const;
+  void readBlock(const Chunk& chunk, int index, std::string& block);
+};
+
+} // namespace essentia
+
+#endif // ESSENTIA_POOLDATASET_H
@@ -0,0 +1,527 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
+#include "pooljson.h"
+
+using namespace std;
+
+namespace essentia {
+
+namespace {
+
+// the values of a descriptor, as they are added to the pool once the whole
+// document has been parsed
+struct JsonDescriptor {
+  enum Type {
+    SINGLE_REAL, SINGLE_STRING, EMPTY_LIST, REALS, STRINGS,
+    REAL_VECTORS, STRING_VECTORS, MATRICES, STEREO_SAMPLES
+  };
+
+  std::string name;
+  Type type;
+  Real real;
+  std::string str;
+  std::vector<Real> reals;
+  std::vector<std::string> strings;
+  std::vector<std::vector<Real> > realVectors;
+  std::vector<std::vector<std::string> > stringVectors;
+  std::vector<TNT::Array2D<Real> > matrices;
+  std::vector<StereoSample> stereoSamples;
+};
+
+enum ScalarType { UNKNOWN_SCALAR, REAL_SCALAR, STRING_SCALAR };
+
+// the powers of ten that are exactly represented as doubles
+const double exactPowersOfTen[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Parses a number with at most 15 significant digits and a small exponent,
+// which covers the numbers written by YamlOutput: both the digits and the
+// power of ten are then exact doubles, and a single multiplication or
+// division gives the correctly rounded result, the same as strtod. Returns
+// false for anything else, which is left to strtod.
+bool parseSimpleNumber(const char* p, const char* end, double& value) {
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+  uint64_t digits = 0;
+  int significant = 0;
+  int exponent = 0;
+  bool anyDigit = false;
+
+  for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+    anyDigit = true;
+    if (digits == 0 && *p == '0') continue;
+    if (++significant > 15) return false;
+    digits = digits*10 + (*p - '0');
+  }
+  if (p < end && *p == '.') {
+    for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+      anyDigit = true;
+      --exponent;
+      if (digits == 0 && *p == '0') continue;
+      if (++significant > 15) return false;
+      digits = digits*10 + (*p - '0');
+    }
+  }
+  if (!anyDigit) return false;
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool negativeExponent = false;
+    if (p < end && (*p == '-' || *p == '+')) negativeExponent = (*p++ == '-');
+    if (p == end) return false;
+    int e = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+      if (e > 1000) return false;
+      e = e*10 + (*p - '0');
+    }
+    exponent += negativeExponent ? -e : e;
+  }
+  if (p != end) return false;
+
+  if (digits == 0) exponent = 0;
+  if (exponent < -22 || exponent > 22) return false;
+
+  value = double(digits);
+  if (exponent < 0) value /= exactPowersOfTen[-exponent];
+  else              value *= exactPowersOfTen[exponent];
+  if (negative) value = -value;
+  return true;
+}
+
+
+class PoolJsonParser {
+ public:
+  PoolJsonParser(const char* json, size_t size) : _begin(json), _p(json), _end(json + size) {}
+
+  void parse(vector<JsonDescriptor>& descriptors);
+
+ protected:
+  const char* _begin;
+  const char* _p;
+  const char* _end;
+  vector<JsonDescriptor>* _descriptors;
+  string _token;
+
+  void error(const string& msg) const {
+    ostringstream e;
+    e << "readPoolJson: " << msg << " at offset " << (_p - _begin);
+    throw JsonParseException(e.str());
+  }
+
+  void skipSpaces() {
+    while (_p < _end && (*_p == ' ' || *_p == '\n' || *_p == '\r' || *_p == '\t')) ++_p;
+  }
+
+  // the next character that is not a space
+  char peek() {
+    skipSpaces();
+    if (_p == _end) error("unexpected end of document");
+    return *_p;
+  }
+
+  void expect(char c) {
+    if (peek() != c) error(string("expected '") + c + "'");
+    ++_p;
+  }
+
+  // after an element of a list or object, returns false at its end
+  bool next(char close) {
+    char c = peek();
+    ++_p;
+    if (c == ',') return true;
+    if (c != close) error(string("expected ',' or '") + close + "'");
+    return false;
+  }
+
+  JsonDescriptor& addDescriptor(const string& name, JsonDescriptor::Type type) {
+    _descriptors->push_back(JsonDescriptor());
+    _descriptors->back().name = name;
+    _descriptors->back().type = type;
+    return _descriptors->back();
+  }
+
+  void parseString(string& str);
+  void parseKey(string& key);
+  ScalarType parseScalar(Real& value, string& str);
+  void parseObject(const string& prefix);
+  void parseValue(const string& name);
+  void parseList(const string& name);
+  void parseScalars(vector<Real>& reals, vector<string>& strings, ScalarType& type);
+  void parseLists(const string& name);
+  void parseMatrix(TNT::Array2D<Real>& matrix);
+  StereoSample parseStereoSample();
+};
+
+
+void appendUtf8(string& str, uint32_t c) {
+  if (c < 0x80) {
+    str += char(c);
+  }
+  else if (c < 0x800) {
+    str += char(0xc0 | (c >> 6));
+    str += char(0x80 | (c & 0x3f));
+  }
+  else if (c < 0x10000) {
+    str += char(0xe0 | (c >> 12));
+    str += char(0x80 | ((c >> 6) & 0x3f));
+    str += char(0x80 | (c & 0x3f));
+  }
+  else {
+    str += char(0xf0 | (c >> 18));
+    str += char(0x80 | ((c >> 12) & 0x3f));
+    str += char(0x80 | ((c >> 6) & 0x3f));
+    str += char(0x80 | (c & 0x3f));
+  }
+}
+
+void PoolJsonParser::parseString(string& str) {
+  expect('"');
+  str.clear();
+
+  while (true) {
+    const char* start = _p;
+    while (_p < _end && *_p != '"' && *_p != '\\') ++_p;
+    str.append(start, _p);
+    if (_p == _end) error("unterminated string");
+    if (*_p++ == '"') return;
+
+    if (_p == _end) error("unterminated string");
+    char c = *_p++;
+    switch (c) {
+      case '"':  str += '"'; break;
+      case '\\': str += '\\'; break;
+      case '/':  str += '/'; break;
+      case 'b':  str += '\b'; break;
+      case 'f':  str += '\f'; break;
+      case 'n':  str += '\n'; break;
+      case 'r':  str += '\r'; break;
+      case 't':  str += '\t'; break;
+      case 'u': {
+        uint32_t code = 0;
+        for (int i=0; i<4; ++i) {
+          if (_p == _end || !isxdigit((unsigned char)*_p)) error("invalid \\u escape sequence");
+          char h = *_p++;
+          code = code*16 + (h <= '9' ? h - '0' : (h | 0x20) - 'a' + 10);
+        }
+        // a surrogate pair encodes a character outside the basic plane
+        if (code >= 0xd800 && code < 0xdc00 && _end - _p >= 6 && _p[0] == '\\' && _p[1] == 'u') {
+          uint32_t low = strtoul(string(_p + 2, _p + 6).c_str(), 0, 16);
+          if (low >= 0xdc00 && low < 0xe000) {
+            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            _p += 6;
+          }
+        }
+        appendUtf8(str, code);
+        break;
+      }
+      default:
+        error(string("invalid escape sequence \\") + c);
+    }
+  }
+}
+
+// keys are strings, but the keys of stereo samples are written by YamlOutput
+// without quotes
+void PoolJsonParser::parseKey(string& key) {
+  if (peek() == '"') {
+    parseString(key);
+  }
+  else {
+    const char* start = _p;
+    while (_p < _end && (isalnum((unsigned char)*_p) || *_p == '_')) ++_p;
+    if (_p == start) error("expected a key");
+    key.assign(start, _p);
+  }
+  expect(':');
+}
+
+// quoted values are strings, other values are numbers if the whole of them
+// can be read as one, and strings otherwise
+ScalarType PoolJsonParser::parseScalar(Real& value, string& str) {
+  if (peek() == '"') {
+    parseString(str);
+    return STRING_SCALAR;
+  }
+
+  const char* start = _p;
+  while (_p < _end && *_p != ',' && *_p != '}' && *_p != ']' &&
+         *_p != ' ' && *_p != '\n' && *_p != '\r' && *_p != '\t') ++_p;
+  if (_p == start) error("expected a value");
+
+  double number;
+  if (parseSimpleNumber(start, _p, number)) {
+    value = float(number);
+    return REAL_SCALAR;
+  }
+
+  _token.assign(start, _p);
+  if (_token == "true" || _token == "false") {
+    value = _token == "true" ? 1 : 0;
+    return REAL_SCALAR;
+  }
+
+  char* tokenEnd;
+  number = strtod(_token.c_str(), &tokenEnd);
+  if (tokenEnd == _token.c_str() + _token.size()) {
+    value = float(number);
+    return REAL_SCALAR;
+  }
+
+  str = _token;
+  return STRING_SCALAR;
+}
+
+void PoolJsonParser::parse(vector<JsonDescriptor>& descriptors) {
+  _descriptors = &descriptors;
+  parseObject("");
+  skipSpaces();
+  if (_p != _end) error("extra data after the root object");
+}
+
+void PoolJsonParser::parseObject(const string& prefix) {
+  expect('{');
+  if (peek() == '}') error("empty objects are not supported");
+
+  string key;
+  do {
+    parseKey(key);
+    parseValue(prefix.empty() ? key : prefix + "." + key);
+  } while (next('}'));
+}
+
+void PoolJsonParser::parseValue(const string& name) {
+  char c = peek();
+  if (c == '{') {
+    parseObject(name);
+  }
+  else if (c == '[') {
+    parseList(name);
+  }
+  else {
+    JsonDescriptor& d = addDescriptor(name, JsonDescriptor::SINGLE_REAL);
+    if (parseScalar(d.real, d.str) == STRING_SCALAR) d.type = JsonDescriptor::SINGLE_STRING;
+  }
+}
+
+// the type of the values is given by the first one, and all the other ones
+// must be of the same type
+void PoolJsonParser::parseScalars(vector<Real>& reals, vector<string>& strings, ScalarType& type) {
+  expect('[');
+  if (peek() == ']') {
+    ++_p;
+    return;
+  }
+
+  Real value;
+  string str;
+  do {
+    char c = peek();
+    if (c == '[' || c == '{') {
+      throw JsonParseException("YamlInput: mixed sequence types are not supported");
+    }
+    ScalarType t = parseScalar(value, str);
+    if (type == UNKNOWN_SCALAR) type = t;
+    if (t != type) {
+      throw JsonParseException("YamlInput: mixed sequence types are not supported");
+    }
+    if (t == REAL_SCALAR) reals.push_back(value);
+    else strings.push_back(str);
+  } while (next(']'));
+}
+
+void PoolJsonParser::parseList(const string& name) {
+  const char* start = _p;
+  expect('[');
+  char first = peek();
+  _p = start;
+
+  if (first == ']') {
+    addDescriptor(name, JsonDescriptor::EMPTY_LIST);
+    expect('[');
+    expect(']');
+  }
+  else if (first == '[') {
+    parseLists(name);
+  }
+  else if (first == '{') {
+    JsonDescriptor& d = addDescriptor(name, JsonDescriptor::STEREO_SAMPLES);
+    expect('[');
+    do {
+      if (peek() != '{') throw JsonParseException("YamlInput: mixed sequence types are not supported");
+      d.stereoSamples.push_back(parseStereoSample());
+    } while (next(']'));
+  }
+  else {
+    JsonDescriptor& d = addDescriptor(name, JsonDescriptor::REALS);
+    ScalarType type = UNKNOWN_SCALAR;
+    parseScalars(d.reals, d.strings, type);
+    if (type == STRING_SCALAR) d.type = JsonDescriptor::STRINGS;
+  }
+}
+
+// a list of vectors of Reals or strings, or of matrices. The type of the
+// vectors is given by the first non-empty one, empty vectors before it being
+// vectors of Reals if they are all empty
+void PoolJsonParser::parseLists(const string& name) {
+  JsonDescriptor& d = addDescriptor(name, JsonDescriptor::REAL_VECTORS);
+  ScalarType type = UNKNOWN_SCALAR;
+  int leadingEmpty = 0;
+  bool matrices = false;
+
+  expect('[');
+  do {
+    if (peek() != '[') throw JsonParseException("YamlInput: mixed sequence types are not supported");
+
+    const char* start = _p;
+    expect('[');
+    char first = peek();
+    _p = start;
+
+    if (first == '[' || matrices) {
+      if (type != UNKNOWN_SCALAR || (!matrices && leadingEmpty > 0)) {
+        throw JsonParseException("YamlInput: mixed sub-sequence types are not supported");
+      }
+      matrices = true;
+      d.type = JsonDescriptor::MATRICES;
+      d.matrices.push_back(TNT::Array2D<Real>());
+      parseMatrix(d.matrices.back());
+      continue;
+    }
+
+    if (type == UNKNOWN_SCALAR && first == ']') {
+      expect('[');
+      expect(']');
+      leadingEmpty++;
+      continue;
+    }
+
+    ScalarType previous = type;
+    d.realVectors.push_back(vector<Real>());
+    d.stringVectors.push_back(vector<string>());
+    parseScalars(d.realVectors.back(), d.stringVectors.back(), type);
+    if (previous != UNKNOWN_SCALAR && type != previous) {
+      throw JsonParseException("YamlInput: mixed sub-sequence types are not supported");
+    }
+  } while (next(']'));
+
+  if (matrices) return;
+
+  if (type == STRING_SCALAR) {
+    d.type = JsonDescriptor::STRING_VECTORS;
+    d.stringVectors.insert(d.stringVectors.begin(), leadingEmpty, vector<string>());
+    d.realVectors.clear();
+  }
+  else {
+    d.realVectors.insert(d.realVectors.begin(), leadingEmpty, vector<Real>());
+    d.stringVectors.clear();
+  }
+}
+
+void PoolJsonParser::parseMatrix(TNT::Array2D<Real>& matrix) {
+  vector<Real> values;
+  vector<string> strings;
+  int rows = 0, columns = 0;
+
+  expect('[');
+  if (peek() == ']') {
+    throw JsonParseException("YamlInput: sequences of matrices that have at least one dimension equal to 0 are not permitted");
+  }
+  do {
+    if (peek() != '[') throw JsonParseException("YamlInput: mixed sub-sequence types are not supported");
+    ScalarType type = REAL_SCALAR;
+    int size = values.size();
+    parseScalars(values, strings, type);
+    if (!strings.empty()) {
+      throw JsonParseException("YamlInput: sequences of matrices can only consist of Reals");
+    }
+    int rowSize = values.size() - size;
+    if (rows == 0) {
+      if (rowSize == 0) {
+        throw JsonParseException("YamlInput: sequences of matrices that have at least one dimension equal to 0 are not permitted");
+      }
+      columns = rowSize;
+    }
+    else if (rowSize != columns) {
+      throw JsonParseException("YamlInput: in sequences of matrices, each matrix must be rectangular");
+    }
+    rows++;
+  } while (next(']'));
+
+  matrix = TNT::Array2D<Real>(rows, columns);
+  for (int i=0; i<rows; ++i) {
+    for (int j=0; j<columns; ++j) matrix[i][j] = values[i*columns + j];
+  }
+}
+
+StereoSample PoolJsonParser::parseStereoSample() {
+  StereoSample sample;
+  bool hasLeft = false, hasRight = false;
+  string key, str;
+  Real value;
+
+  expect('{');
+  do {
+    parseKey(key);
+    if (parseScalar(value, str) != REAL_SCALAR || (key != "left" && key != "right")) {
+      throw JsonParseException("YamlInput: invalid StereoSample format--mapping node should only contain the keys 'left' and 'right', with Real values");
+    }
+    if (key == "left") { sample.left() = value; hasLeft = true; }
+    else               { sample.right() = value; hasRight = true; }
+  } while (next('}'));
+
+  if (!hasLeft || !hasRight) {
+    throw JsonParseException("YamlInput: invalid StereoSample format--mapping node should contain the keys 'left' and 'right'");
+  }
+  return sample;
+}
+
+} // namespace
+
+
+void readPoolJson(const char* json, size_t size, Pool& pool) {
+  vector<JsonDescriptor> descriptors;
+  PoolJsonParser(json, size).parse(descriptors);
+
+  for (int i=0; i<(int)descriptors.size(); ++i) {
+    const JsonDescriptor& d = descriptors[i];
+    switch (d.type) {
+      case JsonDescriptor::SINGLE_REAL:    pool.set(d.name, d.real); break;
+      case JsonDescriptor::SINGLE_STRING:  pool.set(d.name, d.str); break;
+      case JsonDescriptor::EMPTY_LIST:     pool.set(d.name, vector<Real>()); break;
+      case JsonDescriptor::REALS:          pool.append(d.name, d.reals); break;
+      case JsonDescriptor::STRINGS:        pool.append(d.name, d.strings); break;
+      case JsonDescriptor::REAL_VECTORS:   pool.append(d.name, d.realVectors); break;
+      case JsonDescriptor::STRING_VECTORS: pool.append(d.name, d.stringVectors); break;
+      case JsonDescriptor::STEREO_SAMPLES: pool.append(d.name, d.stereoSamples); break;
+      case JsonDescriptor::MATRICES:
+        for (int j=0; j<(int)d.matrices.size(); ++j) pool.add(d.name, d.matrices[j]);
+        break;
+    }
+  }
+}
+
+} // namespace essentia
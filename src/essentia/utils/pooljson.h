@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_POOLJSON_H
+#define ESSENTIA_POOLJSON_H
+
+#include <string>
+#include "pool.h"
+
+namespace essentia {
+
+/**
+ * Thrown by readPoolJson when the document is not valid JSON, or does not
+ * describe a Pool. The pool is left unchanged.
+ */
+class JsonParseException : public EssentiaException {
+ public:
+  JsonParseException(const std::string& msg) : EssentiaException(msg) {}
+};
+
+/**
+ * Adds the descriptors of a JSON document, as written by YamlOutput with
+ * format=json, to the given pool. The document is parsed in a single pass,
+ * without building a syntax tree, numbers being parsed directly into the
+ * vectors that are added to the pool. The pool is only modified once the
+ * whole document has been parsed.
+ *
+ * Values are typed as by YamlInput: quoted strings are strings, other values
+ * are Reals if they are numbers (true and false being 1 and 0), and strings
+ * otherwise. Lists of values are added with Pool::add, lists of lists of
+ * Reals or strings as vectors, lists of lists of lists of Reals as matrices,
+ * and lists of {"left": x, "right": y} objects as stereo samples.
+ */
+void readPoolJson(const char* json, size_t size, Pool& pool);
+
+inline void readPoolJson(const std::string& json, Pool& pool) {
+  readPoolJson(json.data(), json.size(), pool);
+}
+
+} // namespace essentia
+
+#endif // ESSENTIA_POOLJSON_H
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "randomgenerator.h"
+#include "atomic.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+using namespace std;
+
+namespace essentia {
+
+// the constants of Philox4x32
+static const uint32_t philoxM0 = 0xD2511F53;
+static const uint32_t philoxM1 = 0xCD9E8D57;
+static const uint32_t philoxW0 = 0x9E3779B9;
+static const uint32_t philoxW1 = 0xBB67AE85;
+
+// the number of blocks computed together, as the lanes of vector registers
+static const int lanes = 16;
+
+
+void RandomGenerator::seed(uint64_t seed, uint64_t stream) {
+  _key[0] = uint32_t(seed);
+  _key[1] = uint32_t(seed >> 32);
+  _stream = stream;
+  _counter = 0;
+  _used = 4;
+}
+
+// SplitMix64, to spread the bits of the values mixed into a seed
+static uint64_t mix(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+uint64_t RandomGenerator::randomSeed() {
+  static Atomic calls;
+  ++calls;
+  int local;
+  uint64_t seed = mix(uint64_t(time(NULL)));
+  seed = mix(seed ^ uint64_t(clock()));
+  seed = mix(seed ^ uint64_t(int(calls)));
+  return mix(seed ^ uint64_t(size_t(&local)));
+}
+
+void RandomGenerator::generate(uint32_t* values, int blocks) {
+  uint32_t c0[lanes], c1[lanes], c2[lanes], c3[lanes];
+
+  for (int start=0; start<blocks; start+=lanes) {
+    int n = min(lanes, blocks - start);
+
+    for (int l=0; l<lanes; ++l) {
+      uint64_t counter = _counter + start + l;
+      c0[l] = uint32_t(counter);
+      c1[l] = uint32_t(counter >> 32);
+      c2[l] = uint32_t(_stream);
+      c3[l] = uint32_t(_stream >> 32);
+    }
+
+    // the blocks of the lanes are independent of each other, so that the
+    // loop over the lanes is vectorized
+    uint32_t k0 = _key[0], k1 = _key[1];
+    for (int round=0; round<10; ++round) {
+      for (int l=0; l<lanes; ++l) {
+        uint64_t p0 = uint64_t(philoxM0) * c0[l];
+        uint64_t p1 = uint64_t(philoxM1) * c2[l];
+        c0[l] = uint32_t(p1 >> 32) ^ c1[l] ^ k0;
+        c2[l] = uint32_t(p0 >> 32) ^ c3[l] ^ k1;
+        c1[l] = uint32_t(p1);
+        c3[l] = uint32_t(p0);
+      }
+      k0 += philoxW0;
+      k1 += philoxW1;
+    }
+
+    for (int l=0; l<n; ++l) {
+      uint32_t* v = values + 4*(start + l);
+      v[0] = c0[l];
+      v[1] = c1[l];
+      v[2] = c2[l];
+      v[3] = c3[l];
+    }
+  }
+
+  _counter += blocks;
+}
+
+void RandomGenerator::integers(uint32_t* values, int size) {
+  // the rest of the current block
+  while (size > 0 && _used < 4) {
+    *values++ = _buffer[_used++];
+    --size;
+  }
+
+  int blocks = size / 4;
+  generate(values, blocks);
+  values += 4*blocks;
+  size -= 4*blocks;
+
+  if (size > 0) {
+    generate(_buffer, 1);
+    _used = 0;
+    while (size > 0) {
+      *values++ = _buffer[_used++];
+      --size;
+    }
+  }
+}
+
+void RandomGenerator::uniform(Real* values, int size, Real low, Real high) {
+  const int chunkSize = 256;
+  uint32_t chunk[chunkSize] = { 0 };
+  Real converted[chunkSize];
+  const Real scale = (high - low) / 16777216.f; // 2^24
+
+  for (int start=0; start<size; start+=chunkSize) {
+    int n = min(chunkSize, size - start);
+    integers(chunk, n);
+    // the 24 high bits, which are exactly represented by a float. The whole
+    // chunk is converted, as loops of constant size are vectorized
+    for (int i=0; i<chunkSize; ++i) converted[i] = low + Real(int32_t(chunk[i] >> 8)) * scale;
+    copy(converted, converted + n, values + start);
+  }
+}
+
+void RandomGenerator::gaussian(Real* values, int size, Real mean, Real stddev) {
+  const int chunkSize = 256;
+  uint32_t chunk[chunkSize];
+  const float toUnit = 1.f / 16777216.f;
+  const float twoPi = 2 * M_PI;
+
+  // each pair of values is computed from a pair of integers
+  for (int start=0; start<size; start+=chunkSize) {
+    int n = min(chunkSize, size - start);
+    int pairs = (n + 1) / 2;
+    integers(chunk, 2*pairs);
+
+    for (int p=0; p<pairs; ++p) {
+      float u1 = float((chunk[2*p] >> 8) + 1) * toUnit; // in (0, 1], for the log
+      float u2 = float(chunk[2*p + 1] >> 8) * toUnit;
+      float r = stddev * sqrt(-2.f * log(u1));
+      values[start + 2*p] = mean + r * cos(twoPi * u2);
+      if (2*p + 1 < n) values[start + 2*p + 1] = mean + r * sin(twoPi * u2);
+    }
+  }
+}
+
+} // namespace essentia
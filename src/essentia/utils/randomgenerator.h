@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_RANDOMGENERATOR_H
+#define ESSENTIA_RANDOMGENERATOR_H
+
+#include <stdint.h>
+#include "types.h"
+
+namespace essentia {
+
+/**
+ * A counter-based random number generator (Philox4x32-10), which generates
+ * blocks of random values at once. The n-th value of a sequence only depends
+ * on the seed, the stream and n, so that:
+ *  - a sequence is the same whatever the sizes of the blocks it is drawn in
+ *  - independent sequences are obtained from the same seed by giving each of
+ *    them its own stream (e.g. the index of a file processed in parallel with
+ *    others), which makes parallel runs reproducible
+ *  - the values of a block are computed independently of each other, and the
+ *    computation is vectorized by the compiler
+ *
+ * References:
+ *   [1] J. K. Salmon, M. A. Moraes, R. O. Dror, and D. E. Shaw, "Parallel
+ *   random numbers: as easy as 1, 2, 3," in Proceedings of the International
+ *   Conference for High Performance Computing, Networking, Storage and
+ *   Analysis (SC'11), 2011.
+ */
+class RandomGenerator {
+ public:
+  RandomGenerator(uint64_t seed=0, uint64_t stream=0) { this->seed(seed, stream); }
+
+  /**
+   * Restarts the sequence of the given seed and stream.
+   */
+  void seed(uint64_t seed, uint64_t stream=0);
+
+  /**
+   * Returns a seed that is different for each call, e.g. for instances that
+   * should not generate the same values as other ones.
+   */
+  static uint64_t randomSeed();
+
+  /**
+   * Fills values with uniformly distributed 32-bit integers.
+   */
+  void integers(uint32_t* values, int size);
+
+  /**
+   * Fills values with numbers uniformly distributed in [low, high).
+   */
+  void uniform(Real* values, int size, Real low=0, Real high=1);
+
+  /**
+   * Fills values with normally distributed numbers, using the Box-Muller
+   * transform. Each pair of values is computed from two integers of the
+   * sequence, as is the last value if size is odd.
+   */
+  void gaussian(Real* values, int size, Real mean=0, Real stddev=1);
+
+  void uniform(std::vector<Real>& values, Real low=0, Real high=1) {
+    if (!values.empty()) uniform(&values[0], values.size(), low, high);
+  }
+
+  void gaussian(std::vector<Real>& values, Real mean=0, Real stddev=1) {
+    if (!values.empty()) gaussian(&values[0], values.size(), mean, stddev);
+  }
+
+ protected:
+  uint32_t _key[2];
+  uint64_t _stream;
+  uint64_t _counter;    // the next block of 4 values to generate
+  uint32_t _buffer[4];  // the block being used
+  int _used;            // the values of _buffer already used
+
+  void generate(uint32_t* values, int blocks);
+};
+
+} // namespace essentia
+
+#endif // ESSENTIA_RANDOMGENERATOR_H
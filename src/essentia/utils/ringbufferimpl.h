@@ -116,6 +116,9 @@ class RingBufferImpl {
 
   Real* _buffer;
 
+  // whether no more data will be added to the buffer
+  bool _endOfStream;
+
   Condition condition;
 
   // whether to wait for space (to add data to the buffer)
@@ -131,6 +134,7 @@ class RingBufferImpl {
   , _readIndex(0)
   , _available(0)
   , _space(_bufferSize)
+  , _endOfStream(false)
   , _waitingCondition(c)
   {
     _buffer = new Real[_bufferSize];
@@ -146,6 +150,7 @@ class RingBufferImpl {
     _readIndex = 0;
     _available = 0;
     _space = _bufferSize;
+    _endOfStream = false;
     delete[] _buffer;
     _buffer = new Real[_bufferSize];
   }
@@ -158,7 +163,7 @@ class RingBufferImpl {
 
     condition.lock();
 
-    while (_available == 0)
+    while (_available == 0 && !_endOfStream)
     {
       condition.wait();
     }
@@ -166,6 +171,16 @@ class RingBufferImpl {
     condition.unlock();
   }
 
+  void endOfStream()
+  {
+    // wakes up the thread waiting for data, if any, for it to see that there
+    // will be no more
+    condition.lock();
+    _endOfStream = true;
+    condition.signal();
+    condition.unlock();
+  }
+
   void waitSpace(void)
   {
     // this function should only be called if the waiting condition
@@ -1,4 +1,13 @@
 #include "extractor_utils.h"
+#include <essentia/utils/frameencoding.h>
+#include <algorithm>
+#include <fstream>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h> // _mkdir
+#else
+#include <dirent.h>
+#endif
 
 using namespace std;
 using namespace essentia;
@@ -60,3 +69,145 @@ void outputToFile(Pool& pool, const string& outputFilename, Pool& options) {
   output->compute();
   delete output;
 }
+
+
+static Real frameEncodingOption(Pool& options, const string& name,
+                                 const string& field, Real defaultValue) {
+  string key = "frameEncoding." + name + "." + field;
+  if (options.contains<Real>(key)) return options.value<Real>(key);
+  key = "frameEncoding." + field;
+  if (options.contains<Real>(key)) return options.value<Real>(key);
+  return defaultValue;
+}
+
+
+void applyFrameEncoding(Pool& frames, Pool& options) {
+  // the default encoding ("frameEncoding.<field>") is applied to the
+  // descriptors of the given namespaces, and can be overridden for any
+  // descriptor with "frameEncoding.<descriptor name>.<field>"
+  string prefix = "frameEncoding";
+  if (options.descriptorNames(prefix).empty()) return;
+
+  vector<string> namespaces(1, "lowlevel");
+  if (options.contains<vector<string> >(prefix + ".namespaces")) {
+    namespaces = options.value<vector<string> >(prefix + ".namespaces");
+  }
+  else if (options.contains<string>(prefix + ".namespaces")) {
+    namespaces = vector<string>(1, options.value<string>(prefix + ".namespaces"));
+  }
+
+  vector<string> names;
+  const PoolOf(Real)& reals = frames.getRealPool();
+  for (PoolOf(Real)::const_iterator it = reals.begin(); it != reals.end(); ++it) {
+    names.push_back(it->first);
+  }
+  const PoolOf(vector<Real>)& vectors = frames.getVectorRealPool();
+  for (PoolOf(vector<Real>)::const_iterator it = vectors.begin(); it != vectors.end(); ++it) {
+    names.push_back(it->first);
+  }
+
+  for (int i=0; i<(int)names.size(); ++i) {
+    const string& name = names[i];
+    bool inNamespace = false;
+    for (int j=0; j<(int)namespaces.size(); ++j) {
+      if (name.compare(0, namespaces[j].size()+1, namespaces[j] + ".") == 0) inNamespace = true;
+    }
+    string descriptorPrefix = prefix + "." + name;
+    bool specific = !options.descriptorNames(descriptorPrefix).empty();
+    if (!inNamespace && !specific) continue;
+
+    FrameEncoding encoding;
+    encoding.decimation = (int)frameEncodingOption(options, name, "decimation", 1);
+    encoding.delta = frameEncodingOption(options, name, "delta", 0) != 0;
+    encoding.minValue = frameEncodingOption(options, name, "minValue", 0);
+    encoding.maxValue = frameEncodingOption(options, name, "maxValue", 0);
+    if (options.contains<string>(descriptorPrefix + ".quantization")) {
+      encoding.quantization = options.value<string>(descriptorPrefix + ".quantization");
+    }
+    else if (options.contains<string>(prefix + ".quantization")) {
+      encoding.quantization = options.value<string>(prefix + ".quantization");
+    }
+
+    if (encoding.isIdentity()) continue;
+    encodeFrames(frames, name, encoding);
+  }
+}
+
+
+bool fileExists(const string& filename) {
+  ifstream file(filename.c_str());
+  return file.good();
+}
+
+
+bool isDirectory(const string& path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR);
+}
+
+
+void createParentDirectories(const string& filename) {
+  // create each directory of the path in turn, existing ones are skipped
+  size_t pos = filename.find_first_of("/\\", 1);
+  while (pos != string::npos) {
+    string directory = filename.substr(0, pos);
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0777);
+#endif
+    pos = filename.find_first_of("/\\", pos+1);
+  }
+}
+
+
+static bool isAudioFile(const string& filename) {
+  const char* audioExtensions[] = { "mp3", "flac", "ogg", "oga", "opus", "wav", "aif",
+                                    "aiff", "m4a", "mp4", "aac", "wma", "ape", "wv", "mpc" };
+  size_t dot = filename.rfind('.');
+  if (dot == string::npos) return false;
+  string extension = toLower(filename.substr(dot+1));
+  for (int i=0; i<(int)ARRAY_SIZE(audioExtensions); ++i) {
+    if (extension == audioExtensions[i]) return true;
+  }
+  return false;
+}
+
+
+static void listAudioFiles(const string& directory, const string& prefix, vector<string>& files) {
+#ifdef _WIN32
+  throw EssentiaException("Scanning directories for audio files is not supported on Windows, use a list of files instead");
+#else
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) {
+    throw EssentiaException("Could not open directory ", directory);
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    string name = entry->d_name;
+    if (name == "." || name == "..") continue;
+
+    string path = directory + "/" + name;
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) continue;
+
+    if (S_ISDIR(info.st_mode)) {
+      listAudioFiles(path, prefix + name + "/", files);
+    }
+    else if (isAudioFile(name)) {
+      files.push_back(prefix + name);
+    }
+  }
+  closedir(dir);
+#endif
+}
+
+
+vector<string> listAudioFiles(const string& directory) {
+  // returns the paths relative to the given directory, sorted so that the
+  // files are always processed in the same order
+  vector<string> files;
+  listAudioFiles(directory, "", files);
+  sort(files.begin(), files.end());
+  return files;
+}
@@ -8,4 +8,9 @@ void setExtractorDefaultOptions(Pool &options);
 void setExtractorOptions(const std::string& filename, Pool& options);
 void mergeValues(Pool& pool, Pool& options);
 void outputToFile(Pool& pool, const string& outputFilename, Pool& options);
+void applyFrameEncoding(Pool& frames, Pool& options);
 
+bool fileExists(const string& filename);
+bool isDirectory(const string& path);
+void createParentDirectories(const string& filename);
+vector<string> listAudioFiles(const string& directory);
@@ -75,6 +75,7 @@ int essentia_main(string audioFilename, string outputFilename, string profileFil
 
     outputToFile(results, outputFilename, options);    
     if (options.value<Real>("outputFrames")) {
+      applyFrameEncoding(resultsFrames, options);
       outputToFile(resultsFrames, outputFilename+"_frames", options);
     }
     delete extractor;
@@ -25,7 +25,15 @@
 #include <essentia/algorithm.h>
 #include <essentia/algorithmfactory.h> 
 #include <essentia/utils/extractor_music/extractor_version.h>
+#include <essentia/threading.h>
+#include <essentia/utils/pooldataset.h>
 #include "music_extractor/extractor_utils.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <thread>
 
 #include "credit_libav.h"
 
@@ -37,6 +45,15 @@ using namespace essentia::standard;
 void usage(char *progname) {
     cout << "Error: wrong number of arguments" << endl;
     cout << "Usage: " << progname << " input_audiofile output_textfile [profile]" << endl;
+    cout << "       " << progname << " --batch input_directory|input_filelist output_directory [profile] [--jobs N]" << endl;
+    cout << endl << "In batch mode, all the audio files found in input_directory, or listed in" << endl
+         << "input_filelist (one per line, optionally followed by a tab and the output" << endl
+         << "filename), are analyzed by N concurrent workers (all CPU cores by default)." << endl
+         << "Results are written to output_directory with the same relative paths, and" << endl
+         << "files that already have results are skipped, so that an interrupted batch" << endl
+         << "can be resumed by running the same command again. With the 'dataset'" << endl
+         << "output format (set in the profile), the results of all the files are" << endl
+         << "appended to output_directory/results.dataset instead." << endl;
     cout << endl << "Music extractor version '" << MUSIC_EXTRACTOR_VERSION << "'" << endl 
          << "built with Essentia version " << essentia::version_git_sha << endl;
     creditLibAV();
@@ -73,6 +90,7 @@ int essentia_main(string audioFilename, string outputFilename, string profileFil
 
     outputToFile(results, outputFilename, options);    
     if (options.value<Real>("outputFrames")) {
+      applyFrameEncoding(resultsFrames, options);
       outputToFile(resultsFrames, outputFilename+"_frames", options);
     }
     delete extractor;
@@ -85,6 +103,311 @@ int essentia_main(string audioFilename, string outputFilename, string profileFil
   return 0;
 }
 
+// writes the results to a temporary file first and then renames it, so that
+// an interrupted analysis never leaves incomplete results behind
+void outputToFileAtomic(Pool& pool, const string& outputFilename, Pool& options) {
+  string tmpFilename = outputFilename + ".tmp";
+  outputToFile(pool, tmpFilename, options);
+  remove(outputFilename.c_str()); // rename does not overwrite on Windows
+  if (rename(tmpFilename.c_str(), outputFilename.c_str()) != 0) {
+    throw EssentiaException("Could not rename ", tmpFilename, " to ", outputFilename);
+  }
+}
+
+
+struct BatchJob {
+  string audioFilename;
+  string outputFilename;
+};
+
+
+vector<BatchJob> batchJobs(const string& input, const string& outputDirectory, Pool& options) {
+  vector<BatchJob> jobs;
+  string extension = "." + options.value<string>("outputFormat");
+
+  if (isDirectory(input)) {
+    vector<string> files = listAudioFiles(input);
+    for (int i=0; i<(int)files.size(); ++i) {
+      BatchJob job;
+      job.audioFilename = input + "/" + files[i];
+      job.outputFilename = outputDirectory + "/" + files[i] + extension;
+      jobs.push_back(job);
+    }
+    return jobs;
+  }
+
+  ifstream list(input.c_str());
+  if (!list.is_open()) {
+    throw EssentiaException("Could not open ", input, " as a directory or as a list of files");
+  }
+  string line;
+  while (getline(list, line)) {
+    if (!line.empty() && line[line.size()-1] == '\r') line.erase(line.size()-1);
+    if (line.empty() || line[0] == '#') continue;
+
+    BatchJob job;
+    size_t tab = line.find('\t');
+    if (tab != string::npos) {
+      job.audioFilename = line.substr(0, tab);
+      job.outputFilename = line.substr(tab+1);
+    }
+    else {
+      // mirror the path of the audio file inside the output directory
+      string path = line;
+      while (!path.empty() && (path[0] == '/' || path[0] == '\\' || path[0] == '.')) {
+        path.erase(0, 1);
+      }
+      job.audioFilename = line;
+      job.outputFilename = outputDirectory + "/" + path + extension;
+    }
+    jobs.push_back(job);
+  }
+  return jobs;
+}
+
+
+struct BatchState {
+  vector<BatchJob> jobs;
+  atomic<int> next;
+
+  ForcedMutex mutex; // protects everything below
+  int processed;
+  int skipped;
+  int failed;
+  double audioDuration;
+  vector<string> errors;
+
+  // with the "dataset" output format, the results of all the files are
+  // appended to a single dataset, and the files already in it are skipped
+  PoolDatasetWriter* dataset;
+  PoolDatasetWriter* framesDataset;
+  set<string> done;
+  set<string> framesDone;
+
+  // the rows of a file are added to both datasets at once, and their chunks
+  // are written at the same time, so that the files are in both or in neither
+  ForcedMutex datasetMutex;
+};
+
+
+double elapsedSeconds(const chrono::steady_clock::time_point& start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+void batchFailure(BatchState* state, int i, const BatchJob& job, const string& error) {
+  ForcedMutexLocker lock(state->mutex);
+  state->failed++;
+  state->errors.push_back(job.audioFilename + ": " + error);
+  cerr << "[" << i+1 << "/" << state->jobs.size() << "] " << job.audioFilename
+       << " FAILED: " << error << endl;
+}
+
+
+void batchWorker(BatchState* state, Algorithm* extractor, Pool options) {
+  int nJobs = state->jobs.size();
+
+  for (int i = state->next++; i < nJobs; i = state->next++) {
+    const BatchJob& job = state->jobs[i];
+
+    // a file in only one of the datasets (if a batch was interrupted while
+    // writing them) is analyzed again, and only added to the other one
+    bool inDataset = state->dataset && state->done.count(job.audioFilename) > 0;
+    bool inFramesDataset = state->framesDataset && state->framesDone.count(job.audioFilename) > 0;
+
+    bool exists = state->dataset ? inDataset && (!state->framesDataset || inFramesDataset)
+                                 : fileExists(job.outputFilename);
+    if (exists) {
+      ForcedMutexLocker lock(state->mutex);
+      state->skipped++;
+      continue;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    try {
+      Pool results;
+      Pool resultsFrames;
+
+      extractor->input("filename").set(job.audioFilename);
+      extractor->output("results").set(results);
+      extractor->output("resultsFrames").set(resultsFrames);
+      extractor->compute();
+
+      mergeValues(results, options);
+
+      Real duration = results.value<Real>("metadata.audio_properties.length");
+
+      if (state->dataset) {
+        if (state->framesDataset) {
+          applyFrameEncoding(resultsFrames, options);
+
+          // the results are written first, as for the files
+          ForcedMutexLocker lock(state->datasetMutex);
+          if (!inDataset) state->dataset->add(job.audioFilename, results);
+          if (!inFramesDataset) state->framesDataset->add(job.audioFilename, resultsFrames);
+          if (state->dataset->chunkFull() || state->framesDataset->chunkFull()) {
+            state->dataset->flush();
+            state->framesDataset->flush();
+          }
+        }
+        else {
+          state->dataset->add(job.audioFilename, results);
+        }
+
+        ForcedMutexLocker lock(state->mutex);
+        state->processed++;
+        state->audioDuration += duration;
+        cerr << "[" << i+1 << "/" << nJobs << "] " << job.audioFilename
+             << " (" << elapsedSeconds(start) << "s)" << endl;
+        continue;
+      }
+
+      // writing is cheap compared to the analysis, it is serialized so that
+      // the messages of outputToFile are not interleaved with other workers
+      ForcedMutexLocker lock(state->mutex);
+      createParentDirectories(job.outputFilename);
+      // the results file is written last, as its presence marks the file as done
+      if (options.value<Real>("outputFrames")) {
+        applyFrameEncoding(resultsFrames, options);
+        outputToFileAtomic(resultsFrames, job.outputFilename+"_frames", options);
+      }
+      outputToFileAtomic(results, job.outputFilename, options);
+
+      state->processed++;
+      state->audioDuration += duration;
+      cerr << "[" << i+1 << "/" << nJobs << "] " << job.audioFilename
+           << " (" << elapsedSeconds(start) << "s)" << endl;
+    }
+    catch (EssentiaException& e) {
+      batchFailure(state, i, job, e.what());
+    }
+    catch (std::exception& e) {
+      // any other error (e.g. out of memory) only fails this file, instead of
+      // terminating the whole batch from the worker thread
+      batchFailure(state, i, job, e.what());
+    }
+  }
+}
+
+
+int essentia_batch_main(string input, string outputDirectory, string profileFilename, int nWorkers) {
+  // Returns: 1 on essentia error, 2 if some files could not be analyzed
+
+  try {
+    essentia::init();
+
+    // log messages from concurrent workers would be interleaved, only the
+    // per-file progress is reported
+    essentia::infoLevelActive = false;
+
+    Pool options;
+    setExtractorDefaultOptions(options);
+    setExtractorOptions(profileFilename, options);
+
+    BatchState state;
+    state.jobs = batchJobs(input, outputDirectory, options);
+    state.next = 0;
+    state.processed = state.skipped = state.failed = 0;
+    state.audioDuration = 0;
+    state.dataset = state.framesDataset = 0;
+
+    if (options.value<string>("outputFormat") == "dataset") {
+      string filename = outputDirectory + "/results.dataset";
+      string framesFilename = outputDirectory + "/results_frames.dataset";
+      bool outputFrames = options.value<Real>("outputFrames") != 0;
+      createParentDirectories(filename);
+
+      // the files done are those in both datasets, the ones in only one of
+      // them (if a batch was interrupted while writing) are analyzed again
+      if (fileExists(filename)) {
+        vector<string> ids = PoolDatasetReader(filename).ids();
+        state.done.insert(ids.begin(), ids.end());
+      }
+      if (outputFrames && fileExists(framesFilename)) {
+        vector<string> ids = PoolDatasetReader(framesFilename).ids();
+        state.framesDone.insert(ids.begin(), ids.end());
+      }
+
+      state.dataset = new PoolDatasetWriter(filename);
+      if (outputFrames) {
+        state.framesDataset = new PoolDatasetWriter(framesFilename);
+        state.dataset->setAutoFlush(false);
+        state.framesDataset->setAutoFlush(false);
+      }
+    }
+
+    if (nWorkers <= 0) nWorkers = max(1, (int)thread::hardware_concurrency());
+    nWorkers = max(1, min(nWorkers, (int)state.jobs.size()));
+
+    cerr << "Analyzing " << state.jobs.size() << " files with " << nWorkers << " workers" << endl;
+
+    // each worker owns an extractor, configured (profile parsing, SVM models
+    // loading) only once for all the files it analyzes
+    vector<Algorithm*> extractors;
+    for (int i=0; i<nWorkers; ++i) {
+      extractors.push_back(AlgorithmFactory::create("MusicExtractor",
+                                                    "profile", profileFilename));
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    vector<thread> workers;
+    for (int i=0; i<nWorkers; ++i) {
+      workers.push_back(thread(batchWorker, &state, extractors[i], options));
+    }
+    for (int i=0; i<nWorkers; ++i) {
+      workers[i].join();
+      delete extractors[i];
+    }
+    if (state.dataset) {
+      state.dataset->close();
+      if (state.framesDataset) state.framesDataset->close();
+      delete state.dataset;
+      delete state.framesDataset;
+    }
+
+    double elapsed = elapsedSeconds(start);
+    cerr << endl
+         << "Analyzed " << state.processed << " files, skipped " << state.skipped
+         << " files with existing results, " << state.failed << " files failed" << endl
+         << "Total time: " << elapsed << "s, "
+         << state.processed / elapsed << " files/s, "
+         << state.audioDuration / elapsed << "x realtime" << endl;
+
+    if (state.failed) {
+      cerr << endl << "Failed files:" << endl;
+      for (int i=0; i<(int)state.errors.size(); ++i) cerr << "  " << state.errors[i] << endl;
+    }
+
+    essentia::shutdown();
+    return state.failed ? 2 : 0;
+  }
+  catch (EssentiaException& e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+}
+
+
+// parses the arguments following --batch
+int batch_main(int argc, char* argv[]) {
+  vector<string> args;
+  int nWorkers = 0;
+  for (int i=2; i<argc; ++i) {
+    string arg = argv[i];
+    if ((arg == "--jobs" || arg == "-j") && i+1 < argc) {
+      nWorkers = atoi(argv[++i]);
+    }
+    else {
+      args.push_back(arg);
+    }
+  }
+
+  if (args.size() < 2 || args.size() > 3) usage(argv[0]);
+
+  return essentia_batch_main(args[0], args[1], args.size() == 3 ? args[2] : "", nWorkers);
+}
+
 #ifdef _WIN32
 int main(int win32_argc, char **win32_argv)
 {
@@ -111,6 +434,10 @@ int main(int win32_argc, char **win32_argv)
 
   LocalFree(argv);
 
+  if (argc > 1 && string(utf8_argv[1]) == "--batch") {
+    return batch_main(argc, utf8_argv);
+  }
+
   string audioFilename, outputFilename, profileFilename;
 
   switch (argc) {
@@ -133,6 +460,10 @@ int main(int win32_argc, char **win32_argv)
 #else
 int main(int argc, char* argv[]) {
 
+  if (argc > 1 && string(argv[1]) == "--batch") {
+    return batch_main(argc, argv);
+  }
+
   string audioFilename, outputFilename, profileFilename;
 
   switch (argc) {
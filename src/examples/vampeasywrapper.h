@@ -21,7 +21,9 @@
 #define ESSENTIA_VAMPEASYWRAPPER_H
 
 #include "vampwrapper.h"
+#include "vampstreamingwrapper.h"
 #include <essentia/algorithmfactory.h>
+#include <essentia/streaming/algorithms/poolstorage.h>
 
 
 #define WRAP_ALGO(algoname, unit, ndim, outputType)                      \
@@ -169,4 +171,59 @@ public:
     return returnFeature(value);                                         \
   }                                                                      \
 }
+
+// for the streaming algorithms computing single values from the whole signal
+// (e.g. AccumulatorAlgorithms), the values of all their outputs being given
+// as one feature at the end of the stream
+#define WRAP_STREAMING_ALGO(algoname, unit, ndim)                        \
+class S##algoname : public VampStreamingWrapper  {                       \
+public:                                                                  \
+                                                                         \
+  S##algoname(float sr) :                                                \
+    VampStreamingWrapper(essentia::standard::AlgorithmFactory::create(#algoname), sr) {} \
+                                                                         \
+  std::string getIdentifier() const  { return "essentia_" + info().name; }\
+  std::string getName() const        { return info().name; }             \
+                                                                         \
+  OutputList getOutputDescriptors() const {                              \
+    OutputList list = genericDescriptor(unit, ndim);                     \
+    list[0].sampleType = OutputDescriptor::VariableSampleRate;           \
+    return list;                                                         \
+  }                                                                      \
+                                                                         \
+protected:                                                               \
+  std::vector<std::string> _outputNames;                                 \
+                                                                         \
+  void connectNetwork(essentia::streaming::SourceBase& signal) {         \
+    essentia::streaming::Algorithm* algo =                               \
+      essentia::streaming::AlgorithmFactory::create(#algoname);          \
+    const essentia::ParameterMap& params = algo->defaultParameters();    \
+    if (params.find("sampleRate") != params.end()) {                     \
+      try { algo->configure("sampleRate", _sampleRate); }                \
+      catch (...) { delete algo; throw; }                                \
+    }                                                                    \
+                                                                         \
+    signal >> algo->input("signal");                                     \
+    _outputNames = algo->outputNames();                                  \
+    for (int i=0; i<(int)_outputNames.size(); i++) {                     \
+      essentia::streaming::connectSingleValue(algo->output(i), _pool, _outputNames[i]); \
+    }                                                                    \
+  }                                                                      \
+                                                                         \
+  FeatureSet finalFeatures() {                                           \
+    std::vector<float> values;                                           \
+    for (int i=0; i<(int)_outputNames.size(); i++) {                     \
+      if (!_pool.contains<essentia::Real>(_outputNames[i])) return FeatureSet(); \
+      values.push_back(_pool.value<essentia::Real>(_outputNames[i]));    \
+    }                                                                    \
+                                                                         \
+    Feature feature = makeFeature(values);                               \
+    feature.hasTimestamp = true;                                         \
+    feature.timestamp = Vamp::RealTime::zeroTime;                        \
+    FeatureSet result;                                                   \
+    result[0].push_back(feature);                                        \
+    return result;                                                       \
+  }                                                                      \
+}
+
 #endif // ESSENTIA_VAMPEASYWRAPPER_H
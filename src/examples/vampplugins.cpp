@@ -60,6 +60,10 @@ static Vamp::PluginAdapter<B##algoname> b##algoname;
 WRAP_MEL_ALGO(algoname, unit, ndim, dtype);          \
 static Vamp::PluginAdapter<M##algoname> m##algoname;
 
+#define WRAP_STREAMING_PLUGIN(algoname, unit, ndim) \
+WRAP_STREAMING_ALGO(algoname, unit, ndim);          \
+static Vamp::PluginAdapter<S##algoname> s##algoname;
+
 // Spectral
 WRAP_PLUGIN(BarkBands, "", _algo->parameter("numberBands").toInt(), vector<float>);
 WRAP_PLUGIN(Flux, "", 1, float);
@@ -118,6 +122,10 @@ WRAP_TEMPORAL_PLUGIN(Larm, "", 1, float);
 WRAP_TEMPORAL_PLUGIN(LoudnessVickers, "", 1, float);
 WRAP_TEMPORAL_PLUGIN(ZeroCrossingRate, "", 1, float);
 
+// Whole signal, computed incrementally by a streaming network
+WRAP_STREAMING_PLUGIN(Leq, "dB", 1);
+WRAP_STREAMING_PLUGIN(LoudnessMeters, "dB", 4);
+
 
 static Vamp::PluginAdapter<Pitch> aPitch;
 static Vamp::PluginAdapter<DistributionShape> aDistributionShape;
@@ -180,6 +188,8 @@ const VampPluginDescriptor *vampGetPluginDescriptor(unsigned int version,
   case 39: return aERBBands.getDescriptor();
   case 40: return aGFCC.getDescriptor();
   case 41: return tZeroCrossingRate.getDescriptor();
+  case 42: return sLeq.getDescriptor();
+  case 43: return sLoudnessMeters.getDescriptor();
 
   default:
     return 0;
@@ -602,18 +602,38 @@ public:
 
 };
 
-class RhythmTransform : public VampWrapper  {
+// The rhythm transform is computed as the blocks arrive: each frame of the
+// transform only needs frameSize frames of the derivative of the mel bands,
+// so only those are kept instead of the mel bands of the whole signal. The
+// frames are the same as the ones of the RhythmTransform algorithm given all
+// the mel bands at once.
+class RhythmTransform : public VampStreamingWrapper  {
+  standard::Algorithm* _rhythmWindowing;
+  standard::Algorithm* _rhythmSpectrum;
+  int _rtFrameSize, _rtHopSize;
+
+  vector<vector<Real> > _bands;        // the mel bands computed since the last block
+  vector<Real> _previousBands;
+  deque<vector<Real> > _derivatives;   // the derivatives of the bands, from frame _derivativesStart
+  long _derivativesStart;
+  long _nextFrame;                     // the first band frame of the next rhythm frame
+
 public:
 
   RhythmTransform(float sr) :
-    VampWrapper(standard::AlgorithmFactory::create("MelBands", "numberBands", 40), sr) {
-      // as rhythmtransform uses the mel bands to be initialized, we don't want
-      // this plugin to take MelBands as the name
-      AlgorithmInfo<standard::Algorithm> info = standard::AlgorithmFactory::getInfo("RhythmTransform");
-      setName(info.name);
-      setDescription(info.description);
+    VampStreamingWrapper(standard::AlgorithmFactory::create("RhythmTransform"), sr),
+    _rtFrameSize(256), _rtHopSize(32) {
+      // same as the RhythmTransform algorithm
+      _rhythmWindowing = standard::AlgorithmFactory::create("Windowing", "type", "blackmanharris62");
+      _rhythmSpectrum = standard::AlgorithmFactory::create("Spectrum");
+      clearFrames();
     }
 
+  ~RhythmTransform() {
+    delete _rhythmWindowing;
+    delete _rhythmSpectrum;
+  }
+
   OutputList getOutputDescriptors() const {
     OutputList list;
 
@@ -636,35 +656,121 @@ public:
     return ParameterList();
   }
 
-  FeatureSet process(const float *const *inputBuffers, Vamp::RealTime ts) {
+  bool initialise(size_t channels, size_t stepSize, size_t blockSize) {
+    clearFrames();
+    return VampStreamingWrapper::initialise(channels, stepSize, blockSize);
+  }
 
-    computeSpectrum(inputBuffers);
+  void reset() {
+    VampStreamingWrapper::reset();
+    clearFrames();
+  }
 
-    vector<Real> melBands;
-    _algo->input("spectrum").set(_spectrum);
-    _algo->output("bands").set(melBands);
-    _algo->compute();
+protected:
 
-    // TODO: name under pool should be unique or otherwise the next time this algo is run
-    // will pick the wrong data
-    _pool.add("melbands", melBands);
+  void connectNetwork(streaming::SourceBase& signal) {
+    streaming::AlgorithmFactory& factory = streaming::AlgorithmFactory::instance();
 
-    return FeatureSet();
+    // the frames and the magnitude spectrum the host would give in the
+    // frequency domain. Each algorithm is connected as soon as it is created,
+    // so that it is deleted by initialise() if a later one cannot be created
+    streaming::Algorithm* frameCutter = factory.create("FrameCutter",
+                                                       "frameSize", _blockSize,
+                                                       "hopSize", _stepSize,
+                                                       "startFromZero", true);
+    signal >> frameCutter->input("signal");
+
+    streaming::Algorithm* windowing = factory.create("Windowing",
+                                                     "type", "hann",
+                                                     "normalized", false,
+                                                     "zeroPhase", false);
+    frameCutter->output("frame") >> windowing->input("frame");
+
+    streaming::Algorithm* spectrum = factory.create("Spectrum");
+    windowing->output("frame") >> spectrum->input("frame");
+
+    streaming::Algorithm* melBands = factory.create("MelBands",
+                                                    "numberBands", 40,
+                                                    "inputSize", _blockSize/2 + 1,
+                                                    "sampleRate", _sampleRate);
+    spectrum->output("spectrum") >> melBands->input("spectrum");
+    melBands->output("bands") >> _bands;
   }
 
-  FeatureSet getRemainingFeatures() {
-    standard::Algorithm * rhythmTransform = standard::AlgorithmFactory::create("RhythmTransform");
+  FeatureSet blockFeatures(Vamp::RealTime) {
+    addBands();
+    return rhythmFrames(false);
+  }
 
-    vector<vector<Real> > rhythm;
-    FeatureSet result;
+  FeatureSet finalFeatures() {
+    addBands();
+    return rhythmFrames(true);
+  }
+
+  void clearFrames() {
+    _bands.clear();
+    _previousBands.clear();
+    _derivatives.clear();
+    _derivativesStart = 0;
+    _nextFrame = 0;
+  }
+
+  void addBands() {
+    for (int i=0; i<(int)_bands.size(); i++) {
+      const vector<Real>& bands = _bands[i];
+      vector<Real> derivative(bands.size(), 0.0);
+      if (!_previousBands.empty()) {
+        for (int b=0; b<(int)bands.size(); b++) derivative[b] = bands[b] - _previousBands[b];
+      }
+      _derivatives.push_back(derivative);
+      _previousBands = bands;
+    }
+    _bands.clear();
+    dropDerivatives();
+  }
+
+  // the derivatives before the next rhythm frame are not needed anymore
+  void dropDerivatives() {
+    while (!_derivatives.empty() && _derivativesStart < _nextFrame) {
+      _derivatives.pop_front();
+      _derivativesStart++;
+    }
+  }
 
-    rhythmTransform->input("melBands").set(_pool.value<vector<vector<Real> > >("melbands"));
-    rhythmTransform->output("rhythm").set(rhythm);
-    rhythmTransform->compute();
-    _pool.remove("melbands");
+  // returns the rhythm frames that can be computed, the last ones being
+  // zero-padded at the end of the stream
+  FeatureSet rhythmFrames(bool endOfStream) {
+    FeatureSet result;
+    long nFrames = _derivativesStart + (long)_derivatives.size();
+
+    while (endOfStream ? _nextFrame < nFrames : _nextFrame + _rtFrameSize <= nFrames) {
+      int nBands = _derivatives.front().size();
+      vector<Real> bandSpectrum(_rtFrameSize/2 + 1, 0.0);
+      vector<Real> rhythmFrame(_rtFrameSize);
+      vector<Real> windowedFrame, rhythmSpectrum;
+
+      for (int band=0; band<nBands; band++) {
+        for (int j=0; j<_rtFrameSize; j++) {
+          long frame = _nextFrame + j;
+          rhythmFrame[j] = frame < nFrames ? _derivatives[frame - _derivativesStart][band] : 0.0;
+        }
+
+        _rhythmWindowing->input("frame").set(rhythmFrame);
+        _rhythmWindowing->output("frame").set(windowedFrame);
+        _rhythmSpectrum->input("frame").set(windowedFrame);
+        _rhythmSpectrum->output("spectrum").set(rhythmSpectrum);
+        _rhythmWindowing->compute();
+        _rhythmSpectrum->compute();
+
+        // sum the periodograms across bands
+        for (int bin=0; bin<(int)rhythmSpectrum.size(); bin++) {
+          bandSpectrum[bin] += rhythmSpectrum[bin]*rhythmSpectrum[bin];
+        }
+      }
 
-    for (int i=0; i<(int)rhythm.size(); i++) {
-      result[0].push_back(makeFeature(rhythm[i]));
+      result[0].push_back(makeFeature(bandSpectrum));
+      _nextFrame += _rtHopSize;
+      dropDerivatives();
     }
 
     return result;
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "vampstreamingwrapper.h"
+#include <algorithm>
+using namespace std;
+using namespace essentia;
+
+
+VampStreamingWrapper::VampStreamingWrapper(standard::Algorithm* algo, float inputSampleRate)
+  : VampWrapper(algo, inputSampleRate), _input(0), _network(0) {}
+
+VampStreamingWrapper::~VampStreamingWrapper() {
+  // the network owns the input and the algorithms connected to it
+  delete _network;
+}
+
+bool VampStreamingWrapper::initialise(size_t channels, size_t stepSize, size_t blockSize) {
+  if (!VampWrapper::initialise(channels, stepSize, blockSize)) return false;
+
+  delete _network;
+  _network = 0;
+  _pool.clear();
+
+  // RingBufferInput is not in the factory. Its buffer only needs to hold the
+  // samples of one block, as they are all consumed by process()
+  _input = new streaming::RingBufferInput();
+  _input->declareParameters();
+  static_cast<streaming::Algorithm*>(_input)->configure("bufferSize", max(8192, _stepSize));
+
+  try {
+    connectNetwork(_input->output("signal"));
+    _network = new scheduler::Network(_input);
+    _network->runPrepare();
+  }
+  catch (const std::exception& e) {
+    cerr << "ERROR: could not initialise " << getIdentifier() << ": " << e.what() << endl;
+
+    // the algorithms connected to the input are owned by the network, or by
+    // nobody if it could not be created
+    if (_network) delete _network;
+    else {
+      vector<streaming::Algorithm*> algos = scheduler::Network::innerVisibleAlgorithms(_input);
+      for (int i=0; i<(int)algos.size(); i++) delete algos[i];
+    }
+    _network = 0;
+    _input = 0;
+    return false;
+  }
+
+  return true;
+}
+
+void VampStreamingWrapper::reset() {
+  VampWrapper::reset();
+  if (!_network) return;
+
+  _network->reset();
+  _pool.clear();
+  _network->runPrepare();
+}
+
+VampStreamingWrapper::FeatureSet
+VampStreamingWrapper::process(const float *const *inputBuffers, Vamp::RealTime timestamp) {
+  _input->add(inputBuffers[0], min(_stepSize, _blockSize));
+
+  // the generator outputs a limited number of samples at each step
+  while (_input->available() > 0) _network->runStep();
+
+  return blockFeatures(timestamp);
+}
+
+VampStreamingWrapper::FeatureSet VampStreamingWrapper::getRemainingFeatures() {
+  _input->endOfStream();
+  while (_network->runStep());
+
+  return finalFeatures();
+}
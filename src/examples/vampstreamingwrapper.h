@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_VAMPSTREAMINGWRAPPER_H
+#define ESSENTIA_VAMPSTREAMINGWRAPPER_H
+
+#include "vampwrapper.h"
+#include <essentia/streaming/algorithms/ringbufferinput.h>
+#include <essentia/scheduler/network.h>
+
+/**
+ * Base class of the plugins computed by a network of streaming algorithms.
+ * The network is built once, when the plugin is initialised, and each block
+ * given to process() is added to the RingBufferInput at its root, after
+ * which the network runs until it has consumed it. The algorithms therefore
+ * keep their state from one block to the next, and the algorithms working on
+ * the whole signal compute their results as the blocks arrive instead of
+ * after all of them have been stored. The end of the stream is signalled in
+ * getRemainingFeatures(), for the algorithms to produce their final results.
+ *
+ * The signal is given to the network as the stepSize samples of each block
+ * that are not in the next one.
+ */
+class VampStreamingWrapper : public VampWrapper {
+
+protected:
+  essentia::streaming::RingBufferInput* _input;
+  essentia::scheduler::Network* _network;
+
+  /**
+   * Connects the algorithms computing the features to the signal, their
+   * results being stored in _pool. The algorithms are deleted with the
+   * network, or by initialise() if connecting them fails, in which case
+   * only those already connected to the signal can be deleted.
+   */
+  virtual void connectNetwork(essentia::streaming::SourceBase& signal) = 0;
+
+  /**
+   * Returns the features of the block given to process(), once the network
+   * has consumed it. None by default.
+   */
+  virtual FeatureSet blockFeatures(Vamp::RealTime timestamp) {
+    return FeatureSet();
+  }
+
+  /**
+   * Returns the features available at the end of the stream.
+   */
+  virtual FeatureSet finalFeatures() = 0;
+
+public:
+  VampStreamingWrapper(essentia::standard::Algorithm* algo, float inputSampleRate);
+  ~VampStreamingWrapper();
+
+  bool initialise(size_t channels, size_t stepSize, size_t blockSize);
+
+  void reset();
+
+  InputDomain getInputDomain() const { return TimeDomain; }
+
+  FeatureSet process(const float *const *inputBuffers, Vamp::RealTime timestamp);
+
+  FeatureSet getRemainingFeatures();
+};
+
+#endif // ESSENTIA_VAMPSTREAMINGWRAPPER_H
@@ -336,6 +336,35 @@ TEST(Connectors, MultiConnectDisconnect) {
 
 }
 
+TEST(Connectors, DisconnectKeepsOtherReaders) {
+  Source<int> source("source");
+  Sink<int> sink1("sink1"), sink2("sink2"), sink3("sink3");
+  source.setBufferInfo(BufferInfo(16, 4)); // the readers acquire several tokens
+
+  source >> sink1;
+  source >> sink2;
+  source >> sink3;
+  for (int i=1; i<=5; i++) source.push(i);
+
+  // the first two readers have acquired different windows of the buffer
+  EXPECT_EQ(1, sink1.pop());
+  ASSERT_TRUE(sink1.acquire(3));
+  ASSERT_TRUE(sink2.acquire(2));
+
+  disconnect(source, sink1);
+
+  // the windows of the other readers still point to the same tokens, which
+  // have not been overwritten
+  ASSERT_EQ(0, sink2.id());
+  ASSERT_EQ(2, (int)sink2.tokens().size());
+  EXPECT_EQ(1, sink2.tokens()[0]);
+  EXPECT_EQ(2, sink2.tokens()[1]);
+  sink2.release(2);
+  for (int i=3; i<=5; i++) EXPECT_EQ(i, sink2.pop());
+  for (int i=1; i<=5; i++) EXPECT_EQ(i, sink3.pop());
+}
+
+
 TEST(Connectors, ForwardSourceProxy) {
   Source<int> source1("source1");
   SourceProxy<int> sourcep1("sourcep1"), sourcep2("sourcep2");
@@ -22,6 +22,7 @@
 #include "network.h"
 #include "vectorinput.h"
 #include "fileoutput.h"
+#include "featurefile.h"
 using namespace std;
 using namespace essentia;
 using namespace essentia::streaming;
@@ -371,7 +372,7 @@ TEST(FileOutput, DifferentSizes) {
 TEST(FileOutput, InvalidParam) {
   string filename =  "build/test/invalidParam.txt";
   streaming::Algorithm* file = new FileOutput<vector<complex<Real> > >();
-  string expected = "Parameter mode=\"unknown\" is not within specified range: {text,binary}";
+  string expected = "Parameter mode=\"unknown\" is not within specified range: {text,binary,frames}";
   ASSERT_THROW(file->configure("filename", filename, "mode", "unknown"),
                EssentiaException /*, e.what(), expected */);
 
@@ -382,3 +383,105 @@ TEST(FileOutput, InvalidParam) {
 
   delete file;
 }
+
+
+TEST(FileOutput, Frames) {
+  string filename = "build/test/fileoutput.frames";
+  vector<vector<Real> > inputData(1000, vector<Real>(513));
+  for (int f=0; f<(int)inputData.size(); ++f) {
+    for (int j=0; j<(int)inputData[f].size(); ++j) inputData[f][j] = f + j*0.001;
+  }
+
+  streaming::Algorithm* gen = new VectorInput<vector<Real> >(&inputData);
+  streaming::Algorithm* file = new FileOutput<vector<Real> >();
+  file->configure("filename", filename, "mode", "frames",
+                  "sampleRate", 44100., "hopSize", 256);
+
+  connect(gen->output("data"), file->input("data"));
+
+  scheduler::Network(gen).run();
+
+  {
+    FeatureFileReader reader(filename);
+    EXPECT_EQ(RealFeature, reader.header().type);
+    EXPECT_EQ(513, reader.dimension());
+    EXPECT_EQ(1000, reader.frames());
+    EXPECT_EQ(44100, reader.header().sampleRate);
+    EXPECT_EQ(256, reader.header().hopSize);
+
+    vector<Real> frame;
+    for (int f=0; f<(int)inputData.size(); ++f) {
+      reader.read(f, frame);
+      EXPECT_VEC_EQ(inputData[f], frame);
+    }
+    ASSERT_THROW(reader.read(1000, frame), EssentiaException);
+    ASSERT_THROW(reader.intFrame(0), EssentiaException);
+  }
+
+  if (remove(filename.c_str())) throw EssentiaException("TestFileOutput: Error deleting ", filename);
+}
+
+
+TEST(FileOutput, FramesInvalidType) {
+  streaming::Algorithm* file = new FileOutput<string>();
+  ASSERT_THROW(file->configure("filename", "build/test/fileoutput.frames", "mode", "frames"),
+               EssentiaException);
+  delete file;
+}
+
+
+TEST(FeatureFile, DirectIO) {
+  string filename = "build/test/featurefile.frames";
+  int frameSize = 1000; // not a multiple of the block size
+
+  for (int direct=0; direct<2; ++direct) {
+    {
+      FeatureFileWriter writer(filename, FeatureFileHeader(ComplexFeature, 16000, 160),
+                               direct != 0, 8192);
+      vector<complex<Real> > frame(frameSize);
+      for (int f=0; f<37; ++f) {
+        for (int j=0; j<frameSize; ++j) frame[j] = complex<Real>(f, j);
+        writer.write(frame);
+      }
+      ASSERT_THROW(writer.write(vector<complex<Real> >(3)), EssentiaException);
+      ASSERT_THROW(writer.write(vector<Real>(frameSize)), EssentiaException);
+    }
+
+    FeatureFileReader reader(filename);
+    EXPECT_EQ(ComplexFeature, reader.header().type);
+    EXPECT_EQ(frameSize, reader.dimension());
+    EXPECT_EQ(37, reader.frames());
+    EXPECT_EQ(16000, reader.header().sampleRate);
+    for (int f=0; f<37; ++f) {
+      const complex<Real>* frame = reader.complexFrame(f);
+      EXPECT_EQ(complex<Real>(f, 0), frame[0]);
+      EXPECT_EQ(complex<Real>(f, frameSize-1), frame[frameSize-1]);
+    }
+  }
+
+  if (remove(filename.c_str())) throw EssentiaException("TestFeatureFile: Error deleting ", filename);
+}
+
+
+TEST(FeatureFile, NotClosed) {
+  // a file whose writer did not close it can be read up to its last
+  // complete frame
+  string filename = "build/test/featurefile.frames";
+  {
+    FeatureFileWriter writer(filename, FeatureFileHeader(IntFeature), false, 4096);
+    int frame[] = { 1, 2, 3 };
+    for (int f=0; f<1000; ++f) writer.write(frame, 3);
+
+    FeatureFileReader reader(filename);
+    EXPECT_EQ(3, reader.dimension());
+    EXPECT_TRUE(reader.frames() > 0);
+    EXPECT_TRUE(reader.frames() < 1000);
+    EXPECT_EQ(3, reader.intFrame(reader.frames()-1)[2]);
+  }
+
+  FeatureFileReader reader(filename);
+  EXPECT_EQ(1000, reader.frames());
+  EXPECT_EQ(3, reader.intFrame(999)[2]);
+
+  if (remove(filename.c_str())) throw EssentiaException("TestFeatureFile: Error deleting ", filename);
+}
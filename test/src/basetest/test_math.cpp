@@ -19,6 +19,9 @@
 
 #include "essentia_gtest.h"
 #include "essentiamath.h"
+#include "bpfutil.h"
+#include "cubicsplineutil.h"
+#include "randomgenerator.h"
 using namespace std;
 using namespace essentia;
 
@@ -40,3 +43,123 @@ TEST(Math, NextPowerOfTwo) {
   EXPECT_EQ(2*n, nextPowerTwo(n+1));
 
 }
+
+
+// query points with duplicates and the end points, first sorted and then
+// shuffled
+vector<Real> interpolationQueries(Real first, Real last, int size) {
+  vector<Real> x;
+  for (int i=0; i<size; ++i) x.push_back(first + (last - first) * Real(i % (size - 3)) / (size - 4));
+  x.push_back(first);
+  x.push_back(last);
+  sort(x.begin(), x.end());
+  return x;
+}
+
+TEST(Math, BPFBatch) {
+  vector<Real> xPoints, yPoints;
+  for (int i=0; i<50; ++i) {
+    xPoints.push_back(Real(i*i) / 7);
+    yPoints.push_back(sin(Real(i)));
+  }
+  util::BPF bpf(xPoints, yPoints);
+
+  vector<Real> x = interpolationQueries(xPoints[0], xPoints.back(), 1000);
+  for (int k=0; k<2; ++k) {
+    vector<Real> y;
+    bpf(x, y);
+    ASSERT_EQ(y.size(), x.size());
+    for (int j=0; j<(int)x.size(); ++j) EXPECT_EQ(y[j], bpf(x[j])) << x[j];
+    random_shuffle(x.begin(), x.end());
+  }
+
+  vector<Real> y, outside(1, xPoints.back() + 1);
+  ASSERT_THROW(bpf(outside, y), EssentiaException);
+}
+
+TEST(Math, CubicSplineBatch) {
+  vector<double> xPoints, yPoints;
+  for (int i=0; i<50; ++i) {
+    xPoints.push_back(i*i / 7.);
+    yPoints.push_back(cos(double(i)));
+  }
+  util::CubicSpline spline;
+  spline.init(xPoints, yPoints, 1, 0.5, 2, -1);
+  double* ypp = spline_cubic_set(xPoints.size(), &xPoints[0], &yPoints[0], 1, 0.5, 2, -1);
+
+  // also extrapolated outside of the points
+  vector<Real> x = interpolationQueries(xPoints[0] - 10, xPoints.back() + 10, 1000);
+  for (int k=0; k<2; ++k) {
+    vector<Real> y, dy, ddy;
+    spline(x, y, &dy, &ddy);
+    ASSERT_EQ(y.size(), x.size());
+    for (int j=0; j<(int)x.size(); ++j) {
+      double expectedDy, expectedDdy;
+      double expected = spline_cubic_val(xPoints.size(), &xPoints[0], x[j], &yPoints[0], ypp,
+                                         &expectedDy, &expectedDdy);
+      EXPECT_EQ(y[j], Real(expected)) << x[j];
+      EXPECT_EQ(dy[j], Real(expectedDy)) << x[j];
+      EXPECT_EQ(ddy[j], Real(expectedDdy)) << x[j];
+    }
+    random_shuffle(x.begin(), x.end());
+  }
+  delete[] ypp;
+
+  ASSERT_THROW(spline.init(xPoints, yPoints, 3, 0, 0, 0), EssentiaException);
+}
+
+TEST(Math, RandomGeneratorPhilox) {
+  // known answer of Philox4x32-10 from the Random123 library, for a null
+  // counter and key
+  uint32_t values[4];
+  RandomGenerator(0).integers(values, 4);
+  EXPECT_EQ(values[0], 0x6627e8d5u);
+  EXPECT_EQ(values[1], 0xe169c58du);
+  EXPECT_EQ(values[2], 0xbc57ac4cu);
+  EXPECT_EQ(values[3], 0x9b00dbd8u);
+}
+
+TEST(Math, RandomGeneratorBlocks) {
+  RandomGenerator random(1234, 5);
+  vector<Real> all(1000);
+  random.uniform(all, -1, 1);
+
+  // the same values, drawn in blocks of various sizes
+  random.seed(1234, 5);
+  vector<Real> blocks;
+  for (int size=1; (int)blocks.size()<1000; ++size) {
+    vector<Real> block(min(size, 1000 - (int)blocks.size()));
+    random.uniform(block, -1, 1);
+    blocks.insert(blocks.end(), block.begin(), block.end());
+  }
+  EXPECT_VEC_EQ(blocks, all);
+
+  Real mean = 0;
+  for (int j=0; j<(int)all.size(); ++j) {
+    EXPECT_TRUE(all[j] >= -1 && all[j] < 1);
+    mean += all[j];
+  }
+  EXPECT_NEAR(mean / all.size(), 0, 0.1);
+
+  // other streams and seeds give other values
+  vector<Real> other(1000);
+  RandomGenerator(1234, 6).uniform(other, -1, 1);
+  EXPECT_NE(other[0], all[0]);
+  RandomGenerator(1235, 5).uniform(other, -1, 1);
+  EXPECT_NE(other[0], all[0]);
+  EXPECT_NE(RandomGenerator::randomSeed(), RandomGenerator::randomSeed());
+}
+
+TEST(Math, RandomGeneratorGaussian) {
+  vector<Real> values(100001);
+  RandomGenerator(7).gaussian(values, 3, 2);
+
+  double mean = 0, variance = 0;
+  for (int j=0; j<(int)values.size(); ++j) mean += values[j];
+  mean /= values.size();
+  for (int j=0; j<(int)values.size(); ++j) variance += (values[j] - mean) * (values[j] - mean);
+  variance /= values.size();
+
+  EXPECT_NEAR(mean, 3, 0.05);
+  EXPECT_NEAR(variance, 4, 0.1);
+}
@@ -21,6 +21,8 @@
 #include "network.h"
 #include "networkparser.h"
 #include "graphutils.h"
+#include "vectorinput.h"
+#include "ringbufferinput.h"
 using namespace std;
 using namespace essentia;
 using namespace essentia::streaming;
@@ -1024,3 +1026,284 @@ or the very smartass way:
 
 
  */
+
+
+TEST(Network, MemoryUsage) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  vector<Real> signal(44100, 0.5);
+  VectorInput<Real, 1024>* gen = new VectorInput<Real, 1024>(&signal);
+  Algorithm* fc = factory.create("FrameCutter",
+                                 "frameSize", 1024,
+                                 "hopSize", 512);
+  Pool pool;
+
+  gen->output("data")  >> fc->input("signal");
+  fc->output("frame")  >> PC(pool, "frames");
+
+  Network network(gen);
+  network.run();
+
+  size_t nFrames = pool.value<vector<vector<Real> > >("frames").size();
+  size_t framesSize = nFrames * 1024 * sizeof(Real);
+
+  MemoryMap usage = network.memoryUsage();
+  EXPECT_GE(usage["PoolStorage[frames]"].algorithm, framesSize);
+  EXPECT_EQ(usage["PoolStorage[frames]"].buffers, (size_t)0);
+  EXPECT_GT(usage["VectorInput"].buffers, (size_t)0);
+  EXPECT_GT(usage["FrameCutter"].buffers, (size_t)0);
+  EXPECT_GT(network.totalMemoryUsage(), framesSize);
+
+  EXPECT_GE(pool.memoryUsagePerType()["vector<Real>"], framesSize);
+  EXPECT_EQ(pool.memoryUsagePerType()["Real"], (size_t)0);
+  EXPECT_GT(pool.memoryUsage(), framesSize);
+
+  // the memory accounted to the pool storage starts again after a reset
+  network.reset();
+  EXPECT_EQ(network.memoryUsage()["PoolStorage[frames]"].algorithm, (size_t)0);
+}
+
+
+TEST(Network, MemoryBudget) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  vector<Real> signal(10*44100, 0.5);
+  VectorInput<Real, 1024>* gen = new VectorInput<Real, 1024>(&signal);
+  Algorithm* fc = factory.create("FrameCutter",
+                                 "frameSize", 1024,
+                                 "hopSize", 512);
+  Pool pool;
+
+  gen->output("data")  >> fc->input("signal");
+  fc->output("frame")  >> PC(pool, "frames");
+
+  // storing all the frames takes about 3.5 MB, the budget is exceeded during
+  // the processing and the network stops before reaching the end of the signal
+  Network network(gen);
+  network.setMemoryBudget(2*1024*1024);
+  ASSERT_THROW(network.run(), EssentiaException);
+
+  size_t nFrames = pool.value<vector<vector<Real> > >("frames").size();
+  EXPECT_LT(nFrames, signal.size() / 512);
+
+  // a large enough budget lets the network run to the end
+  network.reset();
+  pool.clear();
+  network.setMemoryBudget(64*1024*1024);
+  network.run();
+  EXPECT_GT(pool.value<vector<vector<Real> > >("frames").size(), nFrames);
+}
+
+
+// the memory of composites is accounted through their inner algorithms, the
+// one of accumulators and wrappers by the algorithms themselves
+TEST(Network, MemoryUsageAccumulators) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  // a novelty curve with a peak every 100 frames
+  vector<Real> novelty(200000, 0);
+  for (int i=50; i<(int)novelty.size(); i+=100) novelty[i] = 1;
+  VectorInput<Real, 1024>* gen = new VectorInput<Real, 1024>(&novelty);
+  Algorithm* accumulator = factory.create("RealAccumulator");
+  Algorithm* peaks = factory.create("SuperFluxPeaks", "frameRate", 100.);
+  Pool pool;
+
+  gen->output("data")          >> accumulator->input("data");
+  gen->output("data")          >> peaks->input("novelty");
+  accumulator->output("array") >> PC(pool, "array");
+  peaks->output("peaks")       >> PC(pool, "peaks");
+
+  Network network(gen);
+  network.runPrepare();
+  while (gen->output("data").totalProduced() < (int)novelty.size() / 2) {
+    network.runStep();
+  }
+
+  MemoryMap usage = network.memoryUsage();
+  size_t produced = gen->output("data").totalProduced();
+  EXPECT_GE(usage["VectorOutput"].algorithm, produced / 2 * sizeof(Real));
+  EXPECT_GE(usage["SuperFluxPeaks"].algorithm, produced / 200 * sizeof(Real));
+
+  // as for the pool storages, it starts again after a reset
+  network.reset();
+  EXPECT_EQ(network.memoryUsage()["VectorOutput"].algorithm, (size_t)0);
+}
+
+
+static void runUnaryOperatorChain(const vector<Real>& signal, Pool& pool, bool fusion) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  VectorInput<Real, 1024>* gen = new VectorInput<Real, 1024>(&signal);
+  Algorithm* fc = factory.create("FrameCutter",
+                                 "frameSize", 1024,
+                                 "hopSize", 512);
+  Algorithm* norm  = factory.create("UnaryOperator", "scale", 1.0/1024);
+  Algorithm* scale = factory.create("UnaryOperator", "scale", 1000.0);
+  Algorithm* shift = factory.create("UnaryOperator", "shift", 1.0);
+  Algorithm* abs   = factory.create("UnaryOperator", "type", "abs", "scale", 2.0);
+  Algorithm* log   = factory.create("UnaryOperator", "type", "log");
+  Algorithm* square = factory.create("UnaryOperatorStream", "type", "square");
+  Algorithm* db     = factory.create("UnaryOperatorStream", "type", "lin2db",
+                                     "scale", 0.5, "shift", 3.0);
+
+  gen->output("data")     >> fc->input("signal");
+  fc->output("frame")     >> norm->input("array");
+  norm->output("array")   >> scale->input("array");
+  scale->output("array")  >> shift->input("array");
+  shift->output("array")  >> abs->input("array");
+  abs->output("array")    >> log->input("array");
+  log->output("array")    >> PC(pool, "frames");
+  // a fork stops the chain
+  shift->output("array")  >> PC(pool, "shifted");
+
+  gen->output("data")     >> square->input("array");
+  square->output("array") >> db->input("array");
+  db->output("array")     >> PC(pool, "db");
+
+  Network::setElementwiseFusion(fusion);
+  Network network(gen);
+  network.runPrepare();
+  Network::setElementwiseFusion(false);
+
+  int nUnary = 0, nElementwise = 0;
+  for (int i=0; i<(int)network.linearExecutionOrder().size(); i++) {
+    string name = network.linearExecutionOrder()[i]->name();
+    if (name == "UnaryOperator" || name == "UnaryOperatorStream") nUnary++;
+    if (name == "Elementwise" || name == "ElementwiseStream") nElementwise++;
+  }
+  EXPECT_EQ(fusion ? 0 : 7, nUnary);
+  EXPECT_EQ(fusion ? 3 : 0, nElementwise);
+
+  while (network.runStep());
+}
+
+TEST(Network, ElementwiseFusion) {
+  vector<Real> signal(44100);
+  for (int i=0; i<(int)signal.size(); i++) signal[i] = sin(0.01*i) + 0.1*cos(0.37*i);
+
+  Pool fused, expected;
+  runUnaryOperatorChain(signal, fused, true);
+  runUnaryOperatorChain(signal, expected, false);
+
+  const char* names[] = { "frames", "shifted" };
+  for (int n=0; n<2; n++) {
+    const vector<vector<Real> >& frames = fused.value<vector<vector<Real> > >(names[n]);
+    const vector<vector<Real> >& frames0 = expected.value<vector<vector<Real> > >(names[n]);
+    ASSERT_EQ(frames0.size(), frames.size());
+    for (int f=0; f<(int)frames.size(); f++) EXPECT_VEC_EQ(frames0[f], frames[f]);
+  }
+
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("db"), fused.value<vector<Real> >("db"));
+}
+
+
+TEST(Network, TraceBuffer) {
+  TraceBuffer buffer(3);
+  EXPECT_EQ(0, buffer.size());
+
+  TraceEvent event;
+  for (int i=0; i<5; i++) {
+    event.name = i;
+    buffer.add(event);
+  }
+
+  // the 2 oldest events have been overwritten
+  ASSERT_EQ(3, buffer.size());
+  EXPECT_EQ(2, buffer.dropped());
+  for (int i=0; i<3; i++) EXPECT_EQ(i+2, buffer[i].name);
+
+  buffer.clear();
+  EXPECT_EQ(0, buffer.size());
+  EXPECT_EQ(0, buffer.dropped());
+}
+
+TEST(Network, Tracing) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  vector<Real> signal(44100, 0.5);
+  VectorInput<Real, 1024>* gen = new VectorInput<Real, 1024>(&signal);
+  Algorithm* fc = factory.create("FrameCutter",
+                                 "frameSize", 1024,
+                                 "hopSize", 512);
+  Pool pool;
+
+  gen->output("data")  >> fc->input("signal");
+  fc->output("frame")  >> PC(pool, "frames");
+
+  Network::setTracing(true);
+  Network network(gen);
+  network.run();
+  Network::setTracing(false);
+
+  ostringstream trace;
+  Network::writeTrace(trace);
+  string json = trace.str();
+
+  // the calls to process() and the fill levels of the buffers
+  EXPECT_NE(string::npos, json.find("{\"name\": \"FrameCutter\", "));
+  EXPECT_NE(string::npos, json.find("\"ph\": \"X\""));
+  EXPECT_NE(string::npos, json.find("{\"name\": \"FrameCutter::frame\", "));
+  EXPECT_NE(string::npos, json.find("\"ph\": \"C\""));
+  EXPECT_NE(string::npos, json.find("\"droppedEvents\": 0}"));
+
+  // networks run while tracing is disabled are not recorded
+  network.reset();
+  network.run();
+  ostringstream trace2;
+  Network::writeTrace(trace2);
+  EXPECT_EQ(json, trace2.str());
+
+  // only the last events are kept
+  Network::setTracing(true, 10);
+  network.reset();
+  network.run();
+  Network::setTracing(false);
+  ostringstream trace3;
+  Network::writeTrace(trace3);
+  EXPECT_EQ(string::npos, trace3.str().find("\"droppedEvents\": 0}"));
+
+  Network::resetTrace();
+}
+
+
+// a RingBufferInput fed from the thread running the network, one block at a
+// time, as by a plugin host
+TEST(Network, RingBufferInputBlocks) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  vector<Real> signal(10000);
+  for (int i=0; i<(int)signal.size(); i++) signal[i] = sin(0.01*i);
+
+  // RingBufferInput is not in the factory
+  RingBufferInput* input = new RingBufferInput();
+  input->declareParameters();
+  static_cast<Algorithm*>(input)->configure("bufferSize", 4096);
+  Algorithm* fc = factory.create("FrameCutter",
+                                 "frameSize", 1024,
+                                 "hopSize", 1024,
+                                 "startFromZero", true);
+  Pool pool;
+
+  input->output("signal") >> PC(pool, "signal");
+  input->output("signal") >> fc->input("signal");
+  fc->output("frame")     >> PC(pool, "frames");
+
+  Network network(input);
+  network.runPrepare();
+
+  const int blockSize = 1500;
+  for (int start=0; start<(int)signal.size(); start+=blockSize) {
+    input->add(&signal[start], min(blockSize, (int)signal.size() - start));
+    while (input->available() > 0) network.runStep();
+  }
+
+  // the last frame is only output at the end of the stream
+  EXPECT_EQ(9, (int)pool.value<vector<vector<Real> > >("frames").size());
+
+  input->endOfStream();
+  while (network.runStep())
+    {}
+
+  EXPECT_VEC_EQ(signal, pool.value<vector<Real> >("signal"));
+  EXPECT_EQ(10, (int)pool.value<vector<vector<Real> > >("frames").size());
+}
@@ -18,7 +18,22 @@
  */
 
 #include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <sstream>
 #include "essentia_gtest.h"
+#include "poolbinary.h"
+#include "chunkedpoolaggregator.h"
+#include "algorithmfactory.h"
+#include "frameencoding.h"
+#include "network.h"
+#include "vectorinput.h"
+#include "poolstorage.h"
+#include "pooldataset.h"
+#include "pooljson.h"
+#include <cstdio>
+#include <fstream>
+#include <thread>
 using namespace std;
 using essentia::Real;
 using essentia::EssentiaException;
@@ -264,3 +279,684 @@ TEST(Pool, IntegrityCheck) {
   p.add("foo.bar", (Real)1.23456789);
   ASSERT_THROW(p.add("foo.bar", "mixed up the types!"), EssentiaException);
 }
+
+TEST(Pool, BinaryRoundTrip) {
+  essentia::Pool p;
+  p.set("single.real", (Real)0.1);
+  p.set("single.string", "foo");
+  p.set("single.vector_real", vector<Real>(3, (Real)2.5));
+  p.set("single.vector_string", vector<string>(2, "bar"));
+  p.add("multi.real", (Real)1.0);
+  p.add("multi.real", (Real)-1.0);
+  p.add("multi.string", "foo");
+  p.add("multi.vector_real", vector<Real>(5, (Real)0.3));
+  p.add("multi.vector_real", vector<Real>());
+  p.add("multi.vector_string", vector<string>(1, ""));
+  p.add("multi.stereo", essentia::StereoSample());
+  TNT::Array2D<Real> matrix(2, 3, (Real)4.2);
+  matrix[1][2] = 7;
+  p.add("multi.matrix", matrix);
+
+  ostringstream out;
+  essentia::writePoolBinary(out, p);
+  istringstream in(out.str());
+  essentia::Pool q;
+  essentia::readPoolBinary(in, q);
+
+  vector<string> names = p.descriptorNames();
+  vector<string> readNames = q.descriptorNames();
+  EXPECT_VEC_EQ(readNames, names);
+  EXPECT_EQ(q.value<Real>("single.real"), (Real)0.1);
+  EXPECT_EQ(q.value<string>("single.string"), "foo");
+  EXPECT_VEC_EQ(q.value<vector<Real> >("single.vector_real"), vector<Real>(3, (Real)2.5));
+  EXPECT_VEC_EQ(q.value<vector<string> >("single.vector_string"), vector<string>(2, "bar"));
+  EXPECT_VEC_EQ(q.value<vector<Real> >("multi.real"), p.value<vector<Real> >("multi.real"));
+  EXPECT_MATRIX_EQ(q.value<vector<vector<Real> > >("multi.vector_real"), p.value<vector<vector<Real> > >("multi.vector_real"));
+  EXPECT_MATRIX_EQ(q.value<vector<vector<string> > >("multi.vector_string"), p.value<vector<vector<string> > >("multi.vector_string"));
+  EXPECT_EQ(q.value<vector<essentia::StereoSample> >("multi.stereo").size(), (size_t)1);
+
+  const TNT::Array2D<Real>& readMatrix = q.value<vector<TNT::Array2D<Real> > >("multi.matrix")[0];
+  EXPECT_EQ(readMatrix.dim1(), 2);
+  EXPECT_EQ(readMatrix.dim2(), 3);
+  EXPECT_EQ(readMatrix[0][0], (Real)4.2);
+  EXPECT_EQ(readMatrix[1][2], (Real)7);
+}
+
+TEST(Pool, BinaryInvalid) {
+  essentia::Pool p;
+  p.add("foo.bar", vector<Real>(100, (Real)1.0));
+  ostringstream out;
+  essentia::writePoolBinary(out, p);
+
+  essentia::Pool q;
+  istringstream notAPool("foo.bar: 1.0");
+  ASSERT_THROW(essentia::readPoolBinary(notAPool, q), EssentiaException);
+  istringstream truncated(out.str().substr(0, out.str().size() / 2));
+  ASSERT_THROW(essentia::readPoolBinary(truncated, q), EssentiaException);
+}
+
+// Damaged sizes must be detected before allocating anything, and reported as
+// EssentiaException
+TEST(Pool, BinaryDamagedSizes) {
+  essentia::Pool p;
+  p.set("foo.name", "foo");
+  p.add("foo.bar", vector<Real>(100, (Real)1.0));
+  p.add("foo.matrix", TNT::Array2D<Real>(3, 4, (Real)2.0));
+  ostringstream out;
+  essentia::writePoolBinary(out, p);
+  const string binary = out.str();
+
+  const uint64_t sizes[] = { 0xffffffffffffffffULL, 1ULL << 40, 1ULL << 30 };
+  for (int s=0; s<(int)ARRAY_SIZE(sizes); ++s) {
+    for (int i=0; i+8<=(int)binary.size(); ++i) {
+      string damaged = binary;
+      memcpy(&damaged[i], &sizes[s], sizeof(uint64_t));
+      istringstream in(damaged);
+      essentia::Pool q;
+      try {
+        essentia::readPoolBinary(in, q);
+      }
+      catch (EssentiaException&) {}
+    }
+  }
+
+  // garbage after a valid header
+  string garbage = binary.substr(0, 24) + string(1000, '\xab');
+  istringstream in(garbage);
+  essentia::Pool q;
+  ASSERT_THROW(essentia::readPoolBinary(in, q), EssentiaException);
+}
+
+// Statistics merged over chunks should be those of the concatenated frames,
+// except for the median, skew and kurt
+TEST(Pool, ChunkedAggregation) {
+  const char* statsArray[] = { "mean", "var", "stdev", "min", "max",
+                               "dmean", "dvar", "dmean2", "dvar2", "cov", "icov" };
+  vector<string> stats = essentia::arrayToVector<string>(statsArray);
+
+  essentia::Pool all;
+  essentia::ChunkedPoolAggregator chunked(stats);
+  for (int c=0; c<4; ++c) {
+    essentia::Pool chunk;
+    for (int i=0; i<25; ++i) {
+      int n = c*25 + i;
+      Real x = sin(0.1*n) + 0.01*n;
+      vector<Real> v(3);
+      v[0] = cos(0.3*n);
+      v[1] = sin(0.7*n) * v[0];
+      v[2] = (n % 7) - 0.2*n;
+      chunk.add("frames.scalar", x);
+      chunk.add("frames.vector", v);
+      all.add("frames.scalar", x);
+      all.add("frames.vector", v);
+    }
+    chunked.add(chunk, 10);
+  }
+  EXPECT_EQ(chunked.chunks(), 4);
+
+  essentia::standard::Algorithm* aggregator =
+    essentia::standard::AlgorithmFactory::create("PoolAggregator", "defaultStats", stats);
+  essentia::Pool expected, result;
+  aggregator->input("input").set(all);
+  aggregator->output("output").set(expected);
+  aggregator->compute();
+  delete aggregator;
+  chunked.aggregate(result);
+
+  vector<string> names = expected.descriptorNames();
+  vector<string> resultNames = result.descriptorNames();
+  sort(names.begin(), names.end());
+  sort(resultNames.begin(), resultNames.end());
+  EXPECT_VEC_EQ(resultNames, names);
+  for (int i=0; i<(int)names.size(); ++i) {
+    if (expected.contains<Real>(names[i])) {
+      EXPECT_NEAR(result.value<Real>(names[i]), expected.value<Real>(names[i]), 1e-4) << names[i];
+      continue;
+    }
+    vector<vector<Real> > e, r;
+    if (expected.contains<vector<Real> >(names[i])) {
+      e.push_back(expected.value<vector<Real> >(names[i]));
+      r.push_back(result.value<vector<Real> >(names[i]));
+    }
+    else {
+      e = expected.value<vector<vector<Real> > >(names[i]);
+      r = result.value<vector<vector<Real> > >(names[i]);
+    }
+    ASSERT_EQ(r.size(), e.size()) << names[i];
+    for (int j=0; j<(int)e.size(); ++j) {
+      ASSERT_EQ(r[j].size(), e[j].size()) << names[i];
+      for (int k=0; k<(int)e[j].size(); ++k) {
+        EXPECT_NEAR(r[j][k], e[j][k], 1e-3 * max((Real)1, std::abs(e[j][k]))) << names[i];
+      }
+    }
+  }
+}
+
+TEST(Pool, ChunkedAggregationPerChunkValues) {
+  vector<string> stats(1, "mean");
+  essentia::ChunkedPoolAggregator chunked(stats);
+
+  // the first 5 seconds of the second chunk only give context, so that the
+  // first half of its frames and half of its duration are ignored
+  essentia::Pool first, second;
+  first.set("single.real", 1.0);
+  first.set("single.vector", vector<Real>(2, 2.0));
+  first.set("single.key", "A");
+  first.append("frames.real", vector<Real>(10, 0.0));
+  second.set("single.real", 4.0);
+  second.set("single.vector", vector<Real>(2, 5.0));
+  second.set("single.key", "B");
+  second.append("frames.real", vector<Real>(5, 100.0));
+  second.append("frames.real", vector<Real>(5, 3.0));
+
+  chunked.add(first, 10);
+  chunked.add(second, 10, 5);
+
+  essentia::Pool result;
+  chunked.aggregate(result);
+  EXPECT_NEAR(result.value<Real>("single.real"), 2.0, 1e-6);
+  EXPECT_VEC_EQ(result.value<vector<Real> >("single.vector"), vector<Real>(2, 3.0));
+  EXPECT_EQ(result.value<string>("single.key"), "A");
+  EXPECT_NEAR(result.value<Real>("frames.real.mean"), 1.0, 1e-6);
+}
+
+
+TEST(Pool, ChunkedAggregationFramePeriod) {
+  vector<string> stats;
+  stats.push_back("min");
+  stats.push_back("max");
+  essentia::ChunkedPoolAggregator chunked(stats);
+  chunked.setFramePeriod("framed.", 1.0);
+
+  // a chunk of 12 seconds, of which the first 3 and the last 2 only give
+  // context. Frames are centered every second, and include the ones centered
+  // after the end of the chunk
+  essentia::Pool chunk;
+  for (int i=0; i<14; ++i) {
+    chunk.add("framed.real", Real(i));
+    if (i < 12) chunk.add("other.real", Real(i));
+  }
+  chunk.set("single.real", 1.0);
+  chunked.add(chunk, 12, 3, 2);
+
+  // the frames centered in [3, 10) are kept exactly, and the ones of the
+  // descriptors without a frame period in proportion to the durations
+  essentia::Pool result;
+  chunked.aggregate(result);
+  EXPECT_EQ(result.value<Real>("framed.real.min"), 3);
+  EXPECT_EQ(result.value<Real>("framed.real.max"), 9);
+  EXPECT_EQ(result.value<Real>("other.real.min"), 3);
+  EXPECT_EQ(result.value<Real>("other.real.max"), 9);
+
+  ASSERT_THROW(chunked.setFramePeriod("framed.", 0), essentia::EssentiaException);
+}
+
+
+TEST(Pool, FrameEncodingHalf) {
+  Real values[] = { 0, 1, -2, 0.5, 65504, 1e-7f, 0.1f };
+  Real codes[] = { 0, 0x3c00, 0xc000, 0x3800, 0x7bff, 2, 0x2e66 };
+  for (int i=0; i<(int)ARRAY_SIZE(values); ++i) {
+    EXPECT_EQ(essentia::realToHalf(values[i]), codes[i]);
+  }
+  EXPECT_NEAR(essentia::halfToReal(0x2e66), 0.1, 1e-4);
+  EXPECT_EQ(essentia::halfToReal(0xc000), -2);
+}
+
+
+TEST(Pool, FrameEncodingRoundTrip) {
+  essentia::Pool p;
+  for (int i=0; i<10; ++i) {
+    vector<Real> frame(3);
+    frame[0] = i;
+    frame[1] = -0.5 * i;
+    frame[2] = 0.25;
+    p.add("frames.vector", frame);
+    p.add("frames.real", Real(i) / 9);
+  }
+
+  essentia::FrameEncoding encoding;
+  encoding.decimation = 3;
+  encoding.quantization = "int16";
+  encoding.delta = true;
+  essentia::encodeFrames(p, "frames.vector", encoding);
+
+  encoding.decimation = 1;
+  encoding.quantization = "int8";
+  encoding.delta = false;
+  encoding.minValue = 0;
+  encoding.maxValue = 1;
+  essentia::encodeFrames(p, "frames.real", encoding);
+
+  // frames 0, 3, 6 and 9 are kept, as integer codes
+  const vector<vector<Real> >& codes = p.value<vector<vector<Real> > >("frames.vector");
+  ASSERT_EQ(codes.size(), size_t(4));
+  for (int i=0; i<(int)codes.size(); ++i) {
+    for (int j=0; j<(int)codes[i].size(); ++j) {
+      EXPECT_EQ(codes[i][j], round(codes[i][j]));
+    }
+  }
+  EXPECT_EQ(p.value<string>("frameEncoding.frames.vector.quantization"), "int16");
+  EXPECT_EQ(p.value<Real>("frameEncoding.frames.real.scale"), Real(1) / 254);
+
+  essentia::decodeFrames(p, "frames.vector");
+  essentia::decodeFrames(p, "frames.real");
+
+  const vector<vector<Real> >& frames = p.value<vector<vector<Real> > >("frames.vector");
+  ASSERT_EQ(frames.size(), size_t(4));
+  for (int i=0; i<4; ++i) {
+    EXPECT_NEAR(frames[i][0], 3*i, 1e-3);
+    EXPECT_NEAR(frames[i][1], -1.5*i, 1e-3);
+    EXPECT_NEAR(frames[i][2], 0.25, 1e-3);
+  }
+  const vector<Real>& reals = p.value<vector<Real> >("frames.real");
+  ASSERT_EQ(reals.size(), size_t(10));
+  for (int i=0; i<10; ++i) EXPECT_NEAR(reals[i], Real(i) / 9, 0.5 / 254);
+
+  EXPECT_FALSE(p.contains<string>("frameEncoding.frames.vector.quantization"));
+}
+
+// Decoding a descriptor must only remove its own metadata
+TEST(Pool, FrameEncodingOtherDescriptors) {
+  essentia::Pool p;
+  for (int i=0; i<4; ++i) p.add("frames.real", Real(i));
+  p.set("frameEncoding.frames.real.comment", "kept");
+  p.set("frameEncoding.frames.realtime.quantization", "kept");
+
+  essentia::FrameEncoding encoding;
+  encoding.quantization = "float16";
+  essentia::encodeFrames(p, "frames.real", encoding);
+  essentia::decodeFrames(p, "frames.real");
+
+  EXPECT_FALSE(p.contains<string>("frameEncoding.frames.real.quantization"));
+  EXPECT_FALSE(p.contains<Real>("frameEncoding.frames.real.delta"));
+  EXPECT_EQ(p.value<string>("frameEncoding.frames.real.comment"), "kept");
+  EXPECT_EQ(p.value<string>("frameEncoding.frames.realtime.quantization"), "kept");
+  const vector<Real>& frames = p.value<vector<Real> >("frames.real");
+  ASSERT_EQ(frames.size(), size_t(4));
+  for (int i=0; i<4; ++i) EXPECT_EQ(frames[i], Real(i));
+}
+
+
+TEST(Pool, FrameEncodingPoolStorage) {
+  vector<vector<Real> > input(20, vector<Real>(2));
+  for (int i=0; i<(int)input.size(); ++i) {
+    input[i][0] = i;
+    input[i][1] = sin(Real(i));
+  }
+
+  essentia::FrameEncoding encoding;
+  encoding.decimation = 2;
+  encoding.quantization = "float16";
+  encoding.delta = true;
+
+  essentia::Pool p;
+  essentia::streaming::VectorInput<vector<Real> >* gen =
+    new essentia::streaming::VectorInput<vector<Real> >(&input);
+  gen->output("data") >> PC(p, "frames", encoding);
+  essentia::scheduler::Network(gen).run();
+
+  ASSERT_EQ(p.value<vector<vector<Real> > >("frames").size(), size_t(10));
+  essentia::decodeFrames(p, "frames");
+
+  const vector<vector<Real> >& frames = p.value<vector<vector<Real> > >("frames");
+  ASSERT_EQ(frames.size(), size_t(10));
+  for (int i=0; i<10; ++i) {
+    EXPECT_EQ(frames[i][0], 2*i);
+    EXPECT_NEAR(frames[i][1], sin(Real(2*i)), 1e-3);
+  }
+}
+
+
+static string datasetId(int i) {
+  ostringstream id;
+  id << i;
+  return id.str();
+}
+
+static essentia::Pool datasetRow(int i) {
+  essentia::Pool p;
+  p.set("single.real", Real(i));
+  p.set("single.string", "track" + datasetId(i));
+  p.set("single.vector_real", vector<Real>(3, Real(i)));
+  for (int j=0; j<=i; ++j) {
+    p.add("multi.real", Real(j));
+    p.add("multi.vector_real", vector<Real>(2, Real(j)));
+  }
+  p.add("multi.string", "tag");
+  return p;
+}
+
+TEST(Pool, DatasetRoundTrip) {
+  string filename = "build/test/pool.dataset";
+  remove(filename.c_str());
+  {
+    essentia::PoolDatasetWriter writer(filename, 4);
+    for (int i=0; i<10; ++i) {
+      essentia::Pool p = datasetRow(i);
+      if (i == 5) p.remove("single.real");
+      writer.add("file" + datasetId(i), p);
+    }
+  }
+
+  essentia::PoolDatasetReader reader(filename);
+  ASSERT_EQ(reader.size(), 10);
+  EXPECT_EQ(reader.columns().size(), (size_t)6);
+  EXPECT_EQ(reader.column("multi.vector_real").type, essentia::VectorListColumn);
+  EXPECT_EQ(reader.column("multi.vector_real").dimension, 2);
+
+  vector<string> ids = reader.ids();
+  vector<Real> reals;
+  vector<vector<Real> > lists;
+  vector<string> strings;
+  reader.read("single.real", reals);
+  reader.read("multi.vector_real", lists);
+  reader.read("single.string", strings);
+  for (int i=0; i<10; ++i) {
+    EXPECT_EQ(ids[i], "file" + datasetId(i));
+    if (i == 5) EXPECT_TRUE(reals[i] != reals[i]); // missing values are NaN
+    else        EXPECT_EQ(reals[i], Real(i));
+    EXPECT_EQ(lists[i].size(), (size_t)(2*(i+1)));
+    EXPECT_EQ(strings[i], "track" + datasetId(i));
+  }
+  ASSERT_THROW(reader.read("single.string", reals), EssentiaException);
+  ASSERT_THROW(reader.read("missing", reals), EssentiaException);
+
+  essentia::Pool row;
+  reader.readRow(6, row);
+  essentia::Pool expected = datasetRow(6);
+  EXPECT_VEC_EQ(row.descriptorNames(), expected.descriptorNames());
+  EXPECT_VEC_EQ(row.value<vector<Real> >("multi.real"), expected.value<vector<Real> >("multi.real"));
+  EXPECT_MATRIX_EQ(row.value<vector<vector<Real> > >("multi.vector_real"),
+                   expected.value<vector<vector<Real> > >("multi.vector_real"));
+  EXPECT_EQ(row.value<string>("single.string"), "track6");
+
+  remove(filename.c_str());
+}
+
+TEST(Pool, DatasetAppend) {
+  string filename = "build/test/pool_append.dataset";
+  remove(filename.c_str());
+  {
+    essentia::PoolDatasetWriter writer(filename, 2);
+    for (int i=0; i<4; ++i) writer.add("first", datasetRow(i));
+  }
+  // simulate an interrupted write, the incomplete chunk is dropped
+  {
+    ofstream file(filename.c_str(), ios::binary | ios::app);
+    file << "ESSCHUNK garbage";
+  }
+  {
+    essentia::PoolDatasetWriter writer(filename, 2);
+    essentia::Pool p = datasetRow(1);
+    p.set("other.real", Real(1)); // not a column, ignored
+    writer.add("second", p);
+    essentia::Pool wrongSize;
+    wrongSize.set("single.vector_real", vector<Real>(2, 0));
+    ASSERT_THROW(writer.add("third", wrongSize), EssentiaException);
+  }
+
+  essentia::PoolDatasetReader reader(filename);
+  EXPECT_EQ(reader.size(), 5);
+  EXPECT_EQ(reader.ids()[4], "second");
+  EXPECT_EQ(reader.validSize(), streamoff(ifstream(filename.c_str(), ios::binary | ios::ate).tellg()));
+
+  remove(filename.c_str());
+}
+
+static streamoff fileSize(const string& filename) {
+  return streamoff(ifstream(filename.c_str(), ios::binary | ios::ate).tellg());
+}
+
+TEST(Pool, DatasetChunkBytes) {
+  string filename = "build/test/pool_chunkbytes.dataset";
+  remove(filename.c_str());
+  {
+    // each row is larger than chunkBytes, and is written as soon as it is added
+    essentia::PoolDatasetWriter writer(filename, 1024, 64);
+    writer.add("first", datasetRow(3));
+    streamoff size = fileSize(filename);
+    writer.add("second", datasetRow(3));
+    EXPECT_GT(fileSize(filename), size);
+  }
+  EXPECT_EQ(essentia::PoolDatasetReader(filename).size(), 2);
+
+  remove(filename.c_str());
+}
+
+TEST(Pool, DatasetManualFlush) {
+  string filename = "build/test/pool_flush.dataset";
+  remove(filename.c_str());
+  {
+    essentia::PoolDatasetWriter writer(filename, 2);
+    writer.setAutoFlush(false);
+    writer.add("first", datasetRow(1));
+    EXPECT_FALSE(writer.chunkFull());
+    writer.add("second", datasetRow(2));
+    writer.add("third", datasetRow(3));
+    EXPECT_TRUE(writer.chunkFull());
+    EXPECT_EQ(essentia::PoolDatasetReader(filename).size(), 0);
+
+    writer.flush();
+    EXPECT_FALSE(writer.chunkFull());
+    EXPECT_EQ(essentia::PoolDatasetReader(filename).size(), 3);
+    writer.add("fourth", datasetRow(4));
+  }
+  EXPECT_EQ(essentia::PoolDatasetReader(filename).size(), 4);
+
+  remove(filename.c_str());
+}
+
+static void readDataset(const string& filename) {
+  essentia::PoolDatasetReader reader(filename);
+  reader.ids();
+  vector<Real> reals;
+  vector<vector<Real> > lists;
+  vector<string> strings;
+  vector<vector<string> > stringLists;
+  for (int i=0; i<(int)reader.columns().size(); ++i) {
+    const essentia::PoolDatasetColumn& column = reader.columns()[i];
+    switch (column.type) {
+    case essentia::RealColumn:       reader.read(column.name, reals); break;
+    case essentia::StringColumn:     reader.read(column.name, strings); break;
+    case essentia::StringListColumn: reader.read(column.name, stringLists); break;
+    default:                         reader.read(column.name, lists); break;
+    }
+  }
+  for (int i=0; i<reader.size(); ++i) {
+    essentia::Pool row;
+    reader.readRow(i, row);
+  }
+}
+
+// Damaged sizes in the header or in the chunks must be detected before
+// allocating anything, and reported as EssentiaException
+TEST(Pool, DatasetDamagedSizes) {
+  string filename = "build/test/pool_damaged.dataset";
+  remove(filename.c_str());
+  {
+    essentia::PoolDatasetWriter writer(filename, 2);
+    for (int i=0; i<3; ++i) writer.add("file" + datasetId(i), datasetRow(i));
+  }
+  ifstream file(filename.c_str(), ios::binary);
+  const string dataset((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+  file.close();
+  readDataset(filename);
+
+  // most damaged chunks are reported as incomplete
+  bool warnings = essentia::warningLevelActive;
+  essentia::warningLevelActive = false;
+
+  const uint64_t sizes[] = { 0xffffffffffffffffULL, 1ULL << 40, 1ULL << 30 };
+  for (int s=0; s<(int)ARRAY_SIZE(sizes); ++s) {
+    for (int i=0; i+8<=(int)dataset.size(); ++i) {
+      string damaged = dataset;
+      memcpy(&damaged[i], &sizes[s], sizeof(uint64_t));
+      ofstream(filename.c_str(), ios::binary) << damaged;
+      try {
+        readDataset(filename);
+      }
+      catch (EssentiaException&) {}
+    }
+  }
+
+  essentia::warningLevelActive = warnings;
+  remove(filename.c_str());
+}
+
+static void addDatasetRows(essentia::PoolDatasetWriter* writer, int first, int n) {
+  for (int i=first; i<first+n; ++i) writer->add(datasetId(i), datasetRow(i % 7));
+}
+
+TEST(Pool, DatasetConcurrentWriters) {
+  string filename = "build/test/pool_concurrent.dataset";
+  remove(filename.c_str());
+  {
+    essentia::PoolDatasetWriter writer(filename, 16);
+    vector<thread> workers;
+    for (int i=0; i<4; ++i) workers.push_back(thread(addDatasetRows, &writer, 100*i, 50));
+    for (int i=0; i<4; ++i) workers[i].join();
+  }
+
+  essentia::PoolDatasetReader reader(filename);
+  ASSERT_EQ(reader.size(), 200);
+  vector<string> ids = reader.ids();
+  vector<Real> reals;
+  reader.read("single.real", reals);
+  for (int i=0; i<200; ++i) {
+    EXPECT_EQ(reals[i], Real(atoi(ids[i].c_str()) % 7));
+  }
+
+  remove(filename.c_str());
+}
+
+
+essentia::Pool jsonPool() {
+  essentia::Pool p;
+  p.set("single.real", 3.25);
+  p.set("single.string", "some \"quoted\" text\twith a tab and \xc3\xa9");
+  p.set("single.vector_real", vector<Real>(3, 1e-7));
+  for (int i=0; i<20; ++i) {
+    p.add("multi.real", Real(i) * 0.1f - 0.5f);
+    p.add("multi.real_large", Real(i) * 12345.678f + 1e20f);
+    p.add("multi.string", "value " + datasetId(i));
+    p.add("multi.vector_real", vector<Real>(i % 4, Real(i) / 3));
+    p.add("multi.vector_string", vector<string>(2, "s" + datasetId(i)));
+    essentia::StereoSample sample;
+    sample.left() = Real(i);
+    sample.right() = -Real(i) / 7;
+    p.add("multi.stereo", sample);
+
+    TNT::Array2D<Real> matrix(2, 3);
+    for (int r=0; r<2; ++r) {
+      for (int c=0; c<3; ++c) matrix[r][c] = Real(i * 6 + r * 3 + c) / 11;
+    }
+    p.add("multi.matrix", matrix);
+  }
+  return p;
+}
+
+string writePoolString(const essentia::Pool& pool, const string& filename, const string& format) {
+  essentia::standard::Algorithm* output =
+    essentia::standard::AlgorithmFactory::create("YamlOutput", "filename", filename, "format", format);
+  output->input("pool").set(pool);
+  output->compute();
+  delete output;
+
+  ifstream file(filename.c_str());
+  stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+// the direct JSON reader gives the same pool as the YAML parser
+TEST(Pool, JsonReaderMatchesYaml) {
+  essentia::Pool p = jsonPool();
+  string json = writePoolString(p, "build/test/pool_json.json", "json");
+  writePoolString(p, "build/test/pool_json.yaml", "yaml");
+
+  essentia::Pool fromJson, fromYaml;
+  essentia::readPoolJson(json, fromJson);
+
+  essentia::standard::Algorithm* input =
+    essentia::standard::AlgorithmFactory::create("YamlInput", "filename", "build/test/pool_json.yaml",
+                                                 "format", "yaml");
+  input->output("pool").set(fromYaml);
+  input->compute();
+  delete input;
+
+  EXPECT_TRUE(fromJson.contains<string>("metadata.version.essentia")); // added by YamlOutput
+  EXPECT_EQ(writePoolString(fromJson, "build/test/pool_json2.json", "json"),
+            writePoolString(fromYaml, "build/test/pool_json2.json", "json"));
+  EXPECT_EQ(fromJson.value<string>("single.string"), p.value<string>("single.string"));
+  EXPECT_VEC_EQ(fromJson.value<vector<Real> >("multi.real"), p.value<vector<Real> >("multi.real"));
+  EXPECT_EQ(fromJson.value<vector<TNT::Array2D<Real> > >("multi.matrix").size(), (size_t)20);
+
+  // YamlInput reads JSON files with the direct reader
+  essentia::Pool fromInput;
+  input = essentia::standard::AlgorithmFactory::create("YamlInput", "filename", "build/test/pool_json.json",
+                                                       "format", "json");
+  input->output("pool").set(fromInput);
+  input->compute();
+  delete input;
+  EXPECT_EQ(writePoolString(fromInput, "build/test/pool_json2.json", "json"), json);
+
+  remove("build/test/pool_json.json");
+  remove("build/test/pool_json.yaml");
+  remove("build/test/pool_json2.json");
+}
+
+TEST(Pool, JsonReaderValues) {
+  essentia::Pool p;
+  essentia::readPoolJson("{\"a\": {\"b\": true, \"c\": -1.5e3, \"d\": inf, \"e\": some_word},"
+                         " \"s\": \"\\u00e9\\ud83c\\udfb5\\/\\n\","
+                         " \"empty\": [[], [\"x\"]], \"reals\": [1, 2.5, 1e-40, 123456789012345678],"
+                         " \"stereo\": [{left: 1, right: 2}]}", p);
+
+  EXPECT_EQ(p.value<Real>("a.b"), 1);
+  EXPECT_EQ(p.value<Real>("a.c"), -1500);
+  EXPECT_TRUE(isinf(p.value<Real>("a.d")));
+  EXPECT_EQ(p.value<string>("a.e"), "some_word");
+  EXPECT_EQ(p.value<string>("s"), "\xc3\xa9\xf0\x9f\x8e\xb5/\n");
+
+  vector<vector<string> > strings = p.value<vector<vector<string> > >("empty");
+  ASSERT_EQ(strings.size(), (size_t)2);
+  EXPECT_TRUE(strings[0].empty());
+  EXPECT_EQ(strings[1][0], "x");
+
+  vector<Real> reals = p.value<vector<Real> >("reals");
+  ASSERT_EQ(reals.size(), (size_t)4);
+  EXPECT_EQ(reals[1], 2.5);
+  EXPECT_EQ(reals[2], float(strtod("1e-40", 0)));
+  EXPECT_EQ(reals[3], float(strtod("123456789012345678", 0)));
+  EXPECT_EQ(p.value<vector<essentia::StereoSample> >("stereo")[0].right(), 2);
+
+  // numbers are rounded as by strtod
+  srand(1);
+  for (int k=0; k<10000; ++k) {
+    ostringstream number;
+    number.precision(1 + rand() % 17);
+    number << (Real(rand()) / RAND_MAX - 0.5f) * pow(10.f, rand() % 40 - 20);
+    essentia::Pool n;
+    essentia::readPoolJson("{\"x\": " + number.str() + "}", n);
+    ASSERT_EQ(n.value<Real>("x"), float(strtod(number.str().c_str(), 0))) << number.str();
+  }
+}
+
+TEST(Pool, JsonReaderErrors) {
+  const char* invalid[] = {
+    "", "[1, 2]", "{}", "{\"a\": 1", "{\"a\": 1,}", "{\"a\": 1} x", "{\"a\": \"unterminated}",
+    "{\"a\": [1, \"b\"]}", "{\"a\": [[1], [\"b\"]]}", "{\"a\": [[[1, 2], [3]]]}",
+    "{\"a\": [{left: 1}]}", "{\"a\": \"\\q\"}"
+  };
+
+  for (int k=0; k<(int)ARRAY_SIZE(invalid); ++k) {
+    essentia::Pool p;
+    p.set("existing", 1.0);
+    ASSERT_THROW(essentia::readPoolJson(invalid[k], p), essentia::JsonParseException) << invalid[k];
+
+    // the pool is only modified once the whole document has been parsed
+    string afterValid = string("{\"b\": 2, ") + (invalid[k][0] == '{' ? invalid[k] + 1 : "}");
+    ASSERT_THROW(essentia::readPoolJson(afterValid, p), essentia::JsonParseException) << afterValid;
+    EXPECT_EQ(p.descriptorNames().size(), (size_t)1);
+  }
+}
@@ -0,0 +1,604 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+/*
+ * Microbenchmark of every algorithm registered in the standard factory.
+ *
+ * For each algorithm and each frame size, representative inputs are generated
+ * from a synthetic harmonic signal (or from an audio file given with --audio),
+ * and the time, the number of heap allocations and the throughput of one
+ * call to compute() are measured. The results are written as a JSON report
+ * that can be compared between builds with compare_benchmarks.py.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "algorithmfactory.h"
+#include "essentiamath.h"
+#include "stringutil.h"
+#include "pool.h"
+#include "tnt/tnt.h"
+#include "benchmark_utils.h"
+
+using namespace std;
+using namespace essentia;
+using namespace essentia::standard;
+using namespace essentia::benchmark;
+
+
+// categories that are not benchmarked unless --all is given: they need files
+// on disk or are whole extraction pipelines (see extractors_benchmark)
+const char* skippedCategories[] = { "Input/output", "Extractors" };
+
+
+/**
+ * Representative data for a given frame size, from which all the inputs are
+ * taken.
+ */
+struct Signals {
+  int frameSize;
+  vector<Real> frame;
+  vector<Real> spectrum;
+  vector<complex<Real> > fft;
+  vector<Real> frequencies;
+  vector<Real> magnitudes;
+  vector<Real> bands;
+  vector<Real> hpcp;
+  vector<Real> times;
+  vector<Real> bpms;
+  vector<vector<Real> > spectrogram;
+  vector<StereoSample> stereo;
+};
+
+
+// deterministic harmonic signal with a bit of noise, to be used when no audio
+// file is given
+vector<Real> syntheticSignal(int size, Real sampleRate) {
+  vector<Real> signal(size);
+  unsigned int seed = 1;
+  for (int i=0; i<size; ++i) {
+    Real t = i / sampleRate;
+    Real value = 0;
+    Real f0 = 220 * (1 + 0.01*sin(2*M_PI*0.5*t)); // light vibrato
+    for (int h=1; h<=10; ++h) {
+      value += 0.3 / h * sin(2*M_PI*h*f0*t);
+    }
+    seed = seed * 1103515245 + 12345;
+    value += 0.01 * ((seed >> 16) % 2001 - 1000) / 1000.;
+    signal[i] = value;
+  }
+  return signal;
+}
+
+
+Signals computeSignals(const vector<Real>& audio, int frameSize, Real sampleRate) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+  Signals s;
+  s.frameSize = frameSize;
+
+  // take the frame from the middle of the audio, looping if it is too short
+  s.frame.resize(frameSize);
+  int start = audio.size() > (size_t)frameSize ? (audio.size() - frameSize) / 2 : 0;
+  for (int i=0; i<frameSize; ++i) s.frame[i] = audio[(start + i) % audio.size()];
+
+  vector<Real> windowed;
+  Algorithm* window = factory.create("Windowing", "type", "hann");
+  window->input("frame").set(s.frame);
+  window->output("frame").set(windowed);
+  window->compute();
+
+  Algorithm* spectrum = factory.create("Spectrum", "size", frameSize);
+  spectrum->input("frame").set(windowed);
+  spectrum->output("spectrum").set(s.spectrum);
+  spectrum->compute();
+
+  Algorithm* fft = factory.create("FFT", "size", frameSize);
+  fft->input("frame").set(windowed);
+  fft->output("fft").set(s.fft);
+  fft->compute();
+
+  Algorithm* peaks = factory.create("SpectralPeaks", "sampleRate", sampleRate,
+                                    "orderBy", "frequency", "minFrequency", 20.);
+  peaks->input("spectrum").set(s.spectrum);
+  peaks->output("frequencies").set(s.frequencies);
+  peaks->output("magnitudes").set(s.magnitudes);
+  peaks->compute();
+
+  Algorithm* bands = factory.create("MelBands", "inputSize", frameSize/2+1,
+                                    "sampleRate", sampleRate);
+  bands->input("spectrum").set(s.spectrum);
+  bands->output("bands").set(s.bands);
+  bands->compute();
+
+  Algorithm* hpcp = factory.create("HPCP", "sampleRate", sampleRate);
+  hpcp->input("frequencies").set(s.frequencies);
+  hpcp->input("magnitudes").set(s.magnitudes);
+  hpcp->output("hpcp").set(s.hpcp);
+  hpcp->compute();
+
+  delete window;
+  delete spectrum;
+  delete fft;
+  delete peaks;
+  delete bands;
+  delete hpcp;
+
+  for (int i=0; i<32; ++i) s.times.push_back(0.5 * i + 0.1);
+  for (int i=0; i<8; ++i) s.bpms.push_back(60 + 20 * i);
+  s.spectrogram.assign(64, s.spectrum);
+  s.stereo.resize(frameSize);
+  for (int i=0; i<frameSize; ++i) {
+    s.stereo[i].left() = s.frame[i];
+    s.stereo[i].right() = s.frame[frameSize-1-i];
+  }
+
+  return s;
+}
+
+
+/**
+ * Type-erased storage for one input or output of an algorithm.
+ */
+class Slot {
+ public:
+  virtual ~Slot() {}
+  virtual void bindInput(InputBase& input) = 0;
+  virtual void bindOutput(OutputBase& output) = 0;
+};
+
+template <typename T>
+class TypedSlot : public Slot {
+ public:
+  T value;
+  void bindInput(InputBase& input) { input.set(value); }
+  void bindOutput(OutputBase& output) { output.set(value); }
+};
+
+template <typename T>
+bool tryCreate(const std::type_info& type, Slot*& slot) {
+  if (!sameType(type, typeid(T))) return false;
+  slot = new TypedSlot<T>();
+  return true;
+}
+
+Slot* createSlot(const std::type_info& type) {
+  Slot* slot = 0;
+  tryCreate<Real>(type, slot) ||
+  tryCreate<int>(type, slot) ||
+  tryCreate<string>(type, slot) ||
+  tryCreate<StereoSample>(type, slot) ||
+  tryCreate<vector<Real> >(type, slot) ||
+  tryCreate<vector<int> >(type, slot) ||
+  tryCreate<vector<size_t> >(type, slot) ||
+  tryCreate<vector<string> >(type, slot) ||
+  tryCreate<vector<complex<Real> > >(type, slot) ||
+  tryCreate<vector<StereoSample> >(type, slot) ||
+  tryCreate<vector<vector<Real> > >(type, slot) ||
+  tryCreate<vector<vector<complex<Real> > > >(type, slot) ||
+  tryCreate<vector<TNT::Array2D<Real> > >(type, slot) ||
+  tryCreate<TNT::Array2D<Real> >(type, slot) ||
+  tryCreate<Pool>(type, slot);
+  return slot;
+}
+
+template <typename T>
+T* as(Slot* slot) {
+  TypedSlot<T>* typed = dynamic_cast<TypedSlot<T>*>(slot);
+  return typed ? &typed->value : 0;
+}
+
+bool contains(const string& name, const char* pattern) {
+  return toLower(name).find(pattern) != string::npos;
+}
+
+
+/**
+ * Fills an input with data that makes sense for its name, e.g. an input
+ * called "spectrum" gets a magnitude spectrum, and "frequencies" gets the
+ * frequencies of spectral peaks. Returns false if the type is not supported.
+ */
+bool fillInput(Slot* slot, const string& name, const Signals& s) {
+  if (Real* value = as<Real>(slot)) {
+    if (contains(name, "samplerate")) *value = 44100;
+    else if (contains(name, "pitch") || contains(name, "freq")) *value = 220;
+    else if (contains(name, "bpm")) *value = 120;
+    else *value = 0.5;
+    return true;
+  }
+  if (int* value = as<int>(slot)) {
+    *value = 1;
+    return true;
+  }
+  if (string* value = as<string>(slot)) {
+    *value = "C";
+    return true;
+  }
+  if (StereoSample* value = as<StereoSample>(slot)) {
+    value->left() = 0.5;
+    value->right() = 0.5;
+    return true;
+  }
+  if (vector<Real>* value = as<vector<Real> >(slot)) {
+    if (name == "frequencies") *value = s.frequencies;
+    else if (name == "magnitudes") *value = s.magnitudes;
+    else if (contains(name, "spectrum")) *value = s.spectrum;
+    else if (contains(name, "band")) *value = s.bands;
+    else if (contains(name, "pcp") || contains(name, "chroma")) *value = s.hpcp;
+    else if (contains(name, "bpm")) *value = s.bpms;
+    else if (contains(name, "tick") || contains(name, "onset") || contains(name, "beat")) *value = s.times;
+    else if (contains(name, "pitch")) value->assign(s.frameSize / 8, 220.);
+    else if (contains(name, "frame") || contains(name, "signal") ||
+             contains(name, "audio") || contains(name, "sample")) *value = s.frame;
+    // generic arrays get the spectrum, as many statistics expect positive values
+    else *value = s.spectrum;
+    return true;
+  }
+  if (vector<complex<Real> >* value = as<vector<complex<Real> > >(slot)) {
+    *value = s.fft;
+    return true;
+  }
+  if (vector<vector<Real> >* value = as<vector<vector<Real> > >(slot)) {
+    *value = s.spectrogram;
+    return true;
+  }
+  if (vector<StereoSample>* value = as<vector<StereoSample> >(slot)) {
+    *value = s.stereo;
+    return true;
+  }
+  if (vector<int>* value = as<vector<int> >(slot)) {
+    for (int i=0; i<10; ++i) value->push_back(i);
+    return true;
+  }
+  if (vector<size_t>* value = as<vector<size_t> >(slot)) {
+    for (int i=0; i<10; ++i) value->push_back(i);
+    return true;
+  }
+  if (vector<string>* value = as<vector<string> >(slot)) {
+    value->assign(8, "C");
+    return true;
+  }
+  if (TNT::Array2D<Real>* value = as<TNT::Array2D<Real> >(slot)) {
+    int rows = s.spectrogram.size(), cols = s.spectrum.size();
+    *value = TNT::Array2D<Real>(rows, cols);
+    for (int i=0; i<rows; ++i) {
+      for (int j=0; j<cols; ++j) (*value)[i][j] = s.spectrogram[i][j];
+    }
+    return true;
+  }
+  return false;
+}
+
+
+/**
+ * Configures the parameters describing the frame or spectrum size, if the
+ * algorithm has any.
+ */
+ParameterMap sizeParameters(Algorithm* algo, int frameSize) {
+  ParameterMap params;
+  const ParameterMap& defaults = algo->defaultParameters();
+  for (ParameterMap::const_iterator it = defaults.begin(); it != defaults.end(); ++it) {
+    const string& name = it->first;
+    int value;
+    if (name == "frameSize" || name == "size" || name == "fftSize") value = frameSize;
+    else if (name == "inputSize" || name == "spectrumSize") value = frameSize/2 + 1;
+    else continue;
+
+    if (it->second.type() == Parameter::INT) params.add(name, value);
+    else if (it->second.type() == Parameter::REAL) params.add(name, (Real)value);
+  }
+  return params;
+}
+
+
+struct Result {
+  string algorithm;
+  int frameSize;
+  long long iterations;
+  double nsPerCall;
+  double allocsPerCall;
+  double bytesPerCall;
+  double samplesPerSecond;
+  string error; // non empty if the algorithm could not be benchmarked
+};
+
+
+class AlgorithmBenchmark {
+ public:
+  AlgorithmBenchmark(const string& name) : _name(name), _algo(0) {}
+
+  ~AlgorithmBenchmark() {
+    delete _algo;
+    for (size_t i=0; i<_slots.size(); ++i) delete _slots[i];
+  }
+
+  // creates and configures the algorithm and binds all its inputs and
+  // outputs, throws an exception if anything fails
+  void setup(const Signals& signals) {
+    AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+    _algo = factory.create(_name);
+    ParameterMap params = sizeParameters(_algo, signals.frameSize);
+    try {
+      _algo->configure(params);
+    }
+    catch (EssentiaException&) {
+      // the size parameters have another meaning for this algorithm, use
+      // the default configuration instead
+      delete _algo;
+      _algo = factory.create(_name);
+    }
+
+    for (Algorithm::InputMap::const_iterator it = _algo->inputs().begin(); it != _algo->inputs().end(); ++it) {
+      Slot* slot = createSlot(it->second->typeInfo());
+      if (!slot || !fillInput(slot, it->first, signals)) {
+        delete slot;
+        throw EssentiaException("unsupported input type: ", nameOfType(*it->second));
+      }
+      _slots.push_back(slot);
+      slot->bindInput(*it->second);
+    }
+
+    for (Algorithm::OutputMap::const_iterator it = _algo->outputs().begin(); it != _algo->outputs().end(); ++it) {
+      Slot* slot = createSlot(it->second->typeInfo());
+      if (!slot) {
+        throw EssentiaException("unsupported output type: ", nameOfType(*it->second));
+      }
+      _slots.push_back(slot);
+      slot->bindOutput(*it->second);
+    }
+  }
+
+  void compute() { _algo->compute(); }
+
+ protected:
+  string _name;
+  Algorithm* _algo;
+  vector<Slot*> _slots;
+};
+
+
+Result runBenchmark(const string& name, const Signals& signals, double minTime) {
+  Result result;
+  result.algorithm = name;
+  result.frameSize = signals.frameSize;
+  result.iterations = 0;
+  result.nsPerCall = result.allocsPerCall = result.bytesPerCall = result.samplesPerSecond = 0;
+
+  try {
+    AlgorithmBenchmark bench(name);
+    bench.setup(signals);
+
+    // warm-up call, so that the buffers reused between calls are allocated
+    double start = now();
+    bench.compute();
+    double first = now() - start;
+
+    long long iterations = first > 0 ? (long long)(minTime / first) : 1000000;
+    iterations = max(1LL, min(iterations, 1000000LL));
+
+    AllocationStats allocsBefore = allocationStats();
+    start = now();
+    for (long long i=0; i<iterations; ++i) bench.compute();
+    double elapsed = now() - start;
+    AllocationStats allocsAfter = allocationStats();
+
+    result.iterations = iterations;
+    result.nsPerCall = elapsed * 1e9 / iterations;
+    result.allocsPerCall = double(allocsAfter.count - allocsBefore.count) / iterations;
+    result.bytesPerCall = double(allocsAfter.bytes - allocsBefore.bytes) / iterations;
+    result.samplesPerSecond = elapsed > 0 ? signals.frameSize * iterations / elapsed : 0;
+  }
+  catch (exception& e) {
+    // keep only the first line, some messages list all the available algorithms
+    result.error = e.what();
+    result.error = result.error.substr(0, result.error.find('\n'));
+    if (result.error.empty()) result.error = "unknown error";
+  }
+
+  return result;
+}
+
+
+/**
+ * Runs the benchmark in a child process, so that an algorithm that crashes,
+ * hangs or exhausts memory on the generated inputs is reported as skipped
+ * instead of stopping the whole suite.
+ */
+Result runBenchmarkIsolated(const string& name, const Signals& signals, double minTime,
+                            int timeout, long long memoryLimit) {
+  string output, error;
+  bool completed = runIsolated([&]() {
+    Result r = runBenchmark(name, signals, minTime);
+    ostringstream out;
+    out.precision(17);
+    out << r.iterations << ' ' << r.nsPerCall << ' ' << r.allocsPerCall << ' '
+        << r.bytesPerCall << ' ' << r.samplesPerSecond << ' ' << r.error;
+    return out.str();
+  }, timeout, memoryLimit, output, error);
+
+  Result result;
+  result.algorithm = name;
+  result.frameSize = signals.frameSize;
+  result.iterations = 0;
+  result.nsPerCall = result.allocsPerCall = result.bytesPerCall = result.samplesPerSecond = 0;
+
+  if (!completed) {
+    result.error = error;
+    return result;
+  }
+
+  istringstream in(output);
+  in >> result.iterations >> result.nsPerCall >> result.allocsPerCall
+     >> result.bytesPerCall >> result.samplesPerSecond;
+  in.get(); // separator
+  getline(in, result.error);
+  return result;
+}
+
+
+void writeReport(ostream& out, const vector<Result>& results, const vector<int>& frameSizes,
+                 const string& audioSource) {
+  out << "{\n";
+  out << "  \"benchmark\": \"algorithms\",\n";
+  out << "  \"key\": [\"algorithm\", \"frame_size\"],\n";
+  out << "  \"metric\": \"ns_per_call\",\n";
+  out << "  \"essentia_version\": " << jsonString(version) << ",\n";
+  out << "  \"git_sha\": " << jsonString(version_git_sha) << ",\n";
+  out << "  \"input\": " << jsonString(audioSource) << ",\n";
+  out << "  \"frame_sizes\": [";
+  for (size_t i=0; i<frameSizes.size(); ++i) out << (i ? ", " : "") << frameSizes[i];
+  out << "],\n";
+  out << "  \"results\": [\n";
+
+  // one result per line, in a fixed order, so that reports can be diffed
+  for (size_t i=0; i<results.size(); ++i) {
+    const Result& r = results[i];
+    out << "    {\"algorithm\": " << jsonString(r.algorithm)
+        << ", \"frame_size\": " << r.frameSize;
+    if (r.error.empty()) {
+      out << ", \"iterations\": " << r.iterations
+          << ", \"ns_per_call\": " << r.nsPerCall
+          << ", \"allocs_per_call\": " << r.allocsPerCall
+          << ", \"bytes_per_call\": " << r.bytesPerCall
+          << ", \"samples_per_second\": " << r.samplesPerSecond;
+    }
+    else {
+      out << ", \"error\": " << jsonString(r.error);
+    }
+    out << "}" << (i+1 < results.size() ? "," : "") << "\n";
+  }
+
+  out << "  ]\n";
+  out << "}\n";
+}
+
+
+void usage(const char* program) {
+  cout << "Usage: " << program << " [options]\n"
+       << "\n"
+       << "Options:\n"
+       << "  --output FILE       write the JSON report to FILE (default: stdout)\n"
+       << "  --filter NAME       only benchmark algorithms whose name contains NAME\n"
+       << "  --sizes N1,N2,...   frame sizes to benchmark (default: 512,2048,8192)\n"
+       << "  --min-time SECONDS  minimum measuring time per benchmark (default: 0.05)\n"
+       << "  --audio FILE        take the input frames from FILE instead of a synthetic\n"
+       << "                      signal (needs MonoLoader)\n"
+       << "  --all               also benchmark the Input/output and Extractors categories\n"
+       << "  --timeout SECONDS   time after which a benchmark is aborted (default: 30)\n"
+       << "  --memory-limit MB   address space allowed to a benchmark (default: 4096)\n"
+       << "  --no-isolation      run all benchmarks in this process (useful for debugging)\n";
+}
+
+
+int main(int argc, char* argv[]) {
+  string outputFilename, filter, audioFilename;
+  vector<int> frameSizes = parseIntList("512,2048,8192");
+  double minTime = 0.05;
+  bool all = false;
+  bool isolation = true;
+  int timeout = 30;
+  long long memoryLimit = 4096;
+
+  for (int i=1; i<argc; ++i) {
+    string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if (arg == "--output" && hasValue) outputFilename = argv[++i];
+    else if (arg == "--filter" && hasValue) filter = argv[++i];
+    else if (arg == "--sizes" && hasValue) frameSizes = parseIntList(argv[++i]);
+    else if (arg == "--min-time" && hasValue) minTime = atof(argv[++i]);
+    else if (arg == "--audio" && hasValue) audioFilename = argv[++i];
+    else if (arg == "--all") all = true;
+    else if (arg == "--timeout" && hasValue) timeout = atoi(argv[++i]);
+    else if (arg == "--memory-limit" && hasValue) memoryLimit = atoll(argv[++i]);
+    else if (arg == "--no-isolation") isolation = false;
+    else {
+      usage(argv[0]);
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  essentia::init();
+  setDebugLevel(ENone);
+  warningLevelActive = false;
+
+  Real sampleRate = 44100;
+  vector<Real> audio;
+  string audioSource = "synthetic";
+
+  if (!audioFilename.empty()) {
+    Algorithm* loader = AlgorithmFactory::create("MonoLoader",
+                                                 "filename", audioFilename,
+                                                 "sampleRate", sampleRate);
+    loader->output("audio").set(audio);
+    loader->compute();
+    delete loader;
+    audioSource = audioFilename;
+  }
+  if (audio.empty()) {
+    audio = syntheticSignal(int(sampleRate) * 2, sampleRate);
+  }
+
+  vector<string> names = AlgorithmFactory::keys();
+  sort(names.begin(), names.end());
+
+  vector<Result> results;
+  for (size_t f=0; f<frameSizes.size(); ++f) {
+    Signals signals = computeSignals(audio, frameSizes[f], sampleRate);
+
+    for (size_t i=0; i<names.size(); ++i) {
+      const string& name = names[i];
+      if (!filter.empty() && name.find(filter) == string::npos) continue;
+
+      if (!all) {
+        const string& category = AlgorithmFactory::getInfo(name).category;
+        bool skip = false;
+        for (size_t c=0; c<ARRAY_SIZE(skippedCategories); ++c) {
+          if (category == skippedCategories[c]) skip = true;
+        }
+        if (skip) continue;
+      }
+
+      cerr << name << " (" << frameSizes[f] << ")... " << flush;
+      Result result = isolation ? runBenchmarkIsolated(name, signals, minTime, timeout, memoryLimit << 20)
+                                : runBenchmark(name, signals, minTime);
+      if (result.error.empty()) cerr << result.nsPerCall << " ns/call" << endl;
+      else cerr << "skipped: " << result.error << endl;
+      results.push_back(result);
+    }
+  }
+
+  if (outputFilename.empty()) {
+    writeReport(cout, results, frameSizes, audioSource);
+  }
+  else {
+    ofstream out(outputFilename.c_str());
+    writeReport(out, results, frameSizes, audioSource);
+  }
+
+  essentia::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "benchmark_utils.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define HAVE_FORK
+#endif
+
+using namespace std;
+
+// Replacing the global allocation functions makes every allocation of the
+// process go through these counters, including the ones done inside the
+// Essentia shared library.
+
+static atomic<long long> allocationCount(0);
+static atomic<long long> allocationBytes(0);
+
+void* operator new(size_t size) {
+  allocationCount.fetch_add(1, memory_order_relaxed);
+  allocationBytes.fetch_add(size, memory_order_relaxed);
+  void* ptr = malloc(size ? size : 1);
+  if (!ptr) throw bad_alloc();
+  return ptr;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+  allocationCount.fetch_add(1, memory_order_relaxed);
+  allocationBytes.fetch_add(size, memory_order_relaxed);
+  return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const nothrow_t& tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, const nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const nothrow_t&) noexcept { free(ptr); }
+
+
+namespace essentia {
+namespace benchmark {
+
+AllocationStats allocationStats() {
+  AllocationStats stats;
+  stats.count = allocationCount.load(memory_order_relaxed);
+  stats.bytes = allocationBytes.load(memory_order_relaxed);
+  return stats;
+}
+
+double now() {
+  return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long long peakRSS() {
+#if defined(__linux__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return (long long)usage.ru_maxrss * 1024; // kilobytes on linux
+#elif defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return (long long)usage.ru_maxrss; // bytes on osx
+#else
+  return 0;
+#endif
+}
+
+string jsonString(const string& str) {
+  ostringstream result;
+  result << '"';
+  for (size_t i=0; i<str.size(); ++i) {
+    char c = str[i];
+    switch (c) {
+      case '"':  result << "\\\""; break;
+      case '\\': result << "\\\\"; break;
+      case '\n': result << "\\n"; break;
+      case '\t': result << "\\t"; break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          result << buf;
+        }
+        else result << c;
+    }
+  }
+  result << '"';
+  return result.str();
+}
+
+vector<int> parseIntList(const string& str) {
+  vector<int> result;
+  istringstream stream(str);
+  string item;
+  while (getline(stream, item, ',')) {
+    if (!item.empty()) result.push_back(atoi(item.c_str()));
+  }
+  return result;
+}
+
+bool runIsolated(const function<string()>& task, int timeout, long long memoryLimit,
+                 string& output, string& error) {
+#ifdef HAVE_FORK
+  int fds[2];
+  if (pipe(fds) != 0) {
+    error = "could not create pipe";
+    return false;
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    error = "could not create process";
+    return false;
+  }
+
+  if (pid == 0) {
+    close(fds[0]);
+    if (memoryLimit > 0) {
+      struct rlimit limit;
+      limit.rlim_cur = limit.rlim_max = memoryLimit;
+      setrlimit(RLIMIT_AS, &limit);
+    }
+    alarm(timeout);
+
+    string result = task();
+    size_t written = 0;
+    while (written < result.size()) {
+      ssize_t n = write(fds[1], result.data() + written, result.size() - written);
+      if (n <= 0) _exit(1);
+      written += n;
+    }
+    _exit(0);
+  }
+
+  close(fds[1]);
+  output.clear();
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) output.append(buffer, n);
+  close(fds[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  if (WIFEXITED(status) && WEXITSTATUS(status) == 0) return true;
+
+  if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) error = "timed out";
+  else if (WIFSIGNALED(status)) error = string("crashed: ") + strsignal(WTERMSIG(status));
+  else error = "benchmark process failed";
+  return false;
+#else
+  output = task();
+  return true;
+#endif
+}
+
+} // namespace benchmark
+} // namespace essentia
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_BENCHMARK_UTILS_H
+#define ESSENTIA_BENCHMARK_UTILS_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace essentia {
+namespace benchmark {
+
+/**
+ * Totals of the heap allocations done by the whole process (including the
+ * Essentia library) since it started. Benchmarks take the difference of two
+ * snapshots to get the allocations done by the code being measured.
+ */
+struct AllocationStats {
+  long long count;
+  long long bytes;
+};
+
+AllocationStats allocationStats();
+
+/**
+ * Returns a monotonic time in seconds, to be used for measuring durations.
+ */
+double now();
+
+/**
+ * Returns the peak resident set size of the process in bytes, or 0 if it
+ * cannot be determined on this platform.
+ */
+long long peakRSS();
+
+/**
+ * Returns the given string quoted and escaped so that it can be written as a
+ * JSON string.
+ */
+std::string jsonString(const std::string& str);
+
+/**
+ * Parses a comma-separated list of integers, as given on the command line
+ * (e.g.: "512,2048,8192").
+ */
+std::vector<int> parseIntList(const std::string& str);
+
+/**
+ * Runs the given task in a child process and returns in output the string
+ * returned by the task, so that a crash, a hang or an exhausted memory in the
+ * code being measured does not stop the whole benchmark. The child process is
+ * killed after timeout seconds, and its address space is limited to
+ * memoryLimit bytes (0 for no limit), so that allocating more throws
+ * std::bad_alloc. Returns false, with the reason in error, if the child did
+ * not complete. On platforms without fork(), the task runs in this process.
+ */
+bool runIsolated(const std::function<std::string()>& task, int timeout, long long memoryLimit,
+                 std::string& output, std::string& error);
+
+} // namespace benchmark
+} // namespace essentia
+
+#endif // ESSENTIA_BENCHMARK_UTILS_H
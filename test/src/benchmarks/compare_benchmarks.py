@@ -0,0 +1,104 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+"""
+Compares two benchmark reports, as written by the benchmark programs in this
+folder, and prints the ratio new/base of the main metric of each entry. Entries
+are matched using the fields listed in the 'key' of the reports.
+
+Usage: compare_benchmarks.py base.json new.json [--metric NAME] [--threshold RATIO]
+
+The exit status is 1 if any entry got slower than the threshold (by default
+1.1, i.e. 10% slower), so that the script can be used to catch regressions.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+
+def load_report(filename):
+    with open(filename) as f:
+        report = json.load(f)
+    key = report.get('key', ['algorithm', 'frame_size'])
+    results = {}
+    for r in report['results']:
+        results[tuple(r.get(k) for k in key)] = r
+    return report, key, results
+
+
+def format_key(key):
+    return ' '.join(str(k) for k in key)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two benchmark reports.')
+    parser.add_argument('base', help='the reference report')
+    parser.add_argument('new', help='the report to compare with the reference')
+    parser.add_argument('--metric', default=None,
+                        help='the field to compare (default: the metric of the reports)')
+    parser.add_argument('--threshold', type=float, default=1.1,
+                        help='ratio new/base above which an entry is reported as a regression')
+    args = parser.parse_args()
+
+    base_report, key, base = load_report(args.base)
+    new_report, new_key, new = load_report(args.new)
+    if key != new_key:
+        print('Reports of different benchmarks cannot be compared', file=sys.stderr)
+        return 2
+
+    # each report tells which of its fields is the main measure
+    metric = args.metric or base_report.get('metric', 'ns_per_call')
+
+    print('base: %s (%s)' % (base_report.get('git_sha', '?'), args.base))
+    print('new:  %s (%s)' % (new_report.get('git_sha', '?'), args.new))
+    print()
+
+    regressions = []
+    width = max([len(format_key(k)) for k in base] + [10])
+    print('%-*s %14s %14s %8s' % (width, format_key(key), 'base', 'new', 'ratio'))
+
+    for k in sorted(set(base) | set(new), key=lambda k: [str(x) for x in k]):
+        b, n = base.get(k), new.get(k)
+        if b is None or n is None:
+            print('%-*s %s' % (width, format_key(k), 'only in ' + ('new' if b is None else 'base')))
+            continue
+        if metric not in b or metric not in n:
+            print('%-*s %14s %14s' % (width, format_key(k),
+                                      b.get(metric, 'skipped'), n.get(metric, 'skipped')))
+            continue
+
+        ratio = n[metric] / b[metric] if b[metric] else float('inf')
+        flag = ''
+        if ratio > args.threshold:
+            flag = '  <-- slower'
+            regressions.append(k)
+        elif ratio < 1. / args.threshold:
+            flag = '  faster'
+        print('%-*s %14.6g %14.6g %8.3f%s' % (width, format_key(k), b[metric], n[metric], ratio, flag))
+
+    print()
+    print('%d regression(s) above %.2fx' % (len(regressions), args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
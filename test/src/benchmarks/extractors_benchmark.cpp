@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+/*
+ * End-to-end benchmark of the extractors over a fixed corpus of audio files.
+ *
+ * Each file of the corpus is lengthened by looping it up to a given duration,
+ * and each extractor is run on it in a separate process. The report gives,
+ * for each extractor and file, the realtime factor, the peak resident memory
+ * and the time spent in each stage of the extraction:
+ *  - decode: loading, downmixing and resampling the audio
+ *  - analysis: the other algorithms of the streaming networks
+ *  - aggregation: computing the statistics of the frame values, and anything
+ *    else the extractor does outside of its streaming networks
+ *  - serialization: writing the results as JSON
+ * as well as the time spent in each algorithm of the streaming networks.
+ *
+ * The report can be compared to a baseline with compare_benchmarks.py, which
+ * fails if an extractor got slower than a given threshold.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "algorithmfactory.h"
+#include "network.h"
+#include "pool.h"
+#include "poolstorage.h"
+#include "vectorinput.h"
+#include "benchmark_utils.h"
+
+using namespace std;
+using namespace essentia;
+using namespace essentia::benchmark;
+using namespace essentia::scheduler;
+
+
+// files of the test audio collection used when no files are given
+const char* defaultCorpus[] = {
+  "test/audio/recorded/musicbox.wav",
+  "test/audio/recorded/techno_loop.wav",
+  "test/audio/recorded/dubstep.wav"
+};
+
+// algorithms of the execution networks whose time counts as decoding
+const char* decodeAlgorithms[] = {
+  "AudioLoader", "MonoMixer", "Resample", "Trimmer", "Scale", "StereoDemuxer"
+};
+
+const Real sampleRate = 44100;
+
+
+struct CorpusFile {
+  string name;      // name of the original file, or "synthetic"
+  string filename;  // lengthened file, empty if it could not be written
+  vector<Real> audio;
+};
+
+
+bool isRegistered(const string& name) {
+  vector<string> keys = standard::AlgorithmFactory::keys();
+  return find(keys.begin(), keys.end(), name) != keys.end();
+}
+
+bool isDecodeAlgorithm(const string& name) {
+  for (size_t i=0; i<ARRAY_SIZE(decodeAlgorithms); ++i) {
+    if (name == decodeAlgorithms[i]) return true;
+  }
+  return false;
+}
+
+// deterministic harmonic signal with a slow melody and a beat, used when no
+// audio file is available
+vector<Real> syntheticSignal(int size) {
+  vector<Real> signal(size);
+  Real phase = 0;
+  for (int i=0; i<size; ++i) {
+    Real t = i / sampleRate;
+    Real f0 = 220 * pow(2., int(t * 2) % 12 / 12.);
+    phase += 2*M_PI * f0 / sampleRate;
+    Real value = 0;
+    for (int h=1; h<=8; ++h) value += 0.2 / h * sin(h * phase);
+    Real beat = fmod(t, 0.5);
+    value += 0.3 * exp(-beat * 40) * sin(2*M_PI*60*beat);
+    signal[i] = value;
+  }
+  return signal;
+}
+
+// loops the audio up to the given duration
+vector<Real> lengthen(const vector<Real>& audio, Real duration) {
+  vector<Real> result(int(duration * sampleRate));
+  for (size_t i=0; i<result.size(); ++i) result[i] = audio[i % audio.size()];
+  return result;
+}
+
+CorpusFile prepareFile(const string& name, Real duration, const string& workDir, int index) {
+  CorpusFile file;
+  file.name = name;
+
+  if (name == "synthetic") {
+    file.audio = syntheticSignal(int(duration * sampleRate));
+  }
+  else {
+    vector<Real> audio;
+    standard::Algorithm* loader = standard::AlgorithmFactory::create("MonoLoader",
+                                                                     "filename", name,
+                                                                     "sampleRate", sampleRate);
+    loader->output("audio").set(audio);
+    loader->compute();
+    delete loader;
+    if (audio.empty()) throw EssentiaException("empty audio file: ", name);
+    file.audio = lengthen(audio, duration);
+  }
+
+  // the extractors take a filename, write the lengthened audio to a file
+  if (isRegistered("MonoWriter")) {
+    ostringstream filename;
+    filename << workDir << "/extractors_benchmark_" << index << ".wav";
+    standard::Algorithm* writer = standard::AlgorithmFactory::create("MonoWriter",
+                                                                     "filename", filename.str(),
+                                                                     "sampleRate", sampleRate);
+    writer->input("audio").set(file.audio);
+    writer->compute();
+    delete writer;
+    file.filename = filename.str();
+  }
+
+  return file;
+}
+
+
+struct Stages {
+  double decode;
+  double analysis;
+  double aggregation;
+  double serialization;
+
+  Stages() : decode(0), analysis(0), aggregation(0), serialization(0) {}
+};
+
+// splits the time measured by the network profiler into decode and analysis
+// time, and returns the total
+double networkTime(const ProfileMap& profile, Stages& stages) {
+  double total = 0;
+  for (ProfileMap::const_iterator it = profile.begin(); it != profile.end(); ++it) {
+    if (isDecodeAlgorithm(it->first)) stages.decode += it->second.time;
+    else stages.analysis += it->second.time;
+    total += it->second.time;
+  }
+  return total;
+}
+
+double serialize(const Pool& pool, const string& workDir) {
+  if (!isRegistered("YamlOutput")) return 0;
+
+  string filename = workDir + "/extractors_benchmark_results.json";
+  double start = now();
+  standard::Algorithm* output = standard::AlgorithmFactory::create("YamlOutput",
+                                                                   "filename", filename,
+                                                                   "format", "json");
+  output->input("pool").set(pool);
+  output->compute();
+  delete output;
+  double elapsed = now() - start;
+
+  remove(filename.c_str());
+  return elapsed;
+}
+
+// runs one of the standard extractors taking a filename and returning the
+// results and frames pools (MusicExtractor, FreesoundExtractor)
+Stages runFileExtractor(const string& name, const CorpusFile& file, const string& workDir) {
+  if (file.filename.empty()) {
+    throw EssentiaException("no audio file writer available to create the input file");
+  }
+
+  Pool results, resultsFrames;
+  standard::Algorithm* extractor = standard::AlgorithmFactory::create(name);
+  extractor->input("filename").set(file.filename);
+  extractor->output("results").set(results);
+  extractor->output("resultsFrames").set(resultsFrames);
+
+  Stages stages;
+  double start = now();
+  extractor->compute();
+  double elapsed = now() - start;
+  delete extractor;
+
+  stages.aggregation = elapsed - networkTime(Network::profile(), stages);
+  stages.serialization = serialize(results, workDir);
+  return stages;
+}
+
+// runs a streaming graph in the style of the streaming extractors, computing
+// the low-level spectral descriptors of each frame into a pool which is then
+// aggregated and serialized
+Stages runLowLevelGraph(const CorpusFile& file, const string& workDir) {
+  Stages stages;
+
+  // decoding is done separately, as the graph takes the audio from memory
+  if (!file.filename.empty()) {
+    vector<Real> audio;
+    double start = now();
+    standard::Algorithm* loader = standard::AlgorithmFactory::create("MonoLoader",
+                                                                     "filename", file.filename,
+                                                                     "sampleRate", sampleRate);
+    loader->output("audio").set(audio);
+    loader->compute();
+    delete loader;
+    stages.decode = now() - start;
+  }
+
+  Pool pool;
+  streaming::VectorInput<Real, 1024>* input = new streaming::VectorInput<Real, 1024>(&file.audio);
+  streaming::Algorithm* extractor = streaming::AlgorithmFactory::create("LowLevelSpectralExtractor");
+  input->output("data") >> extractor->input("signal");
+  for (streaming::Algorithm::OutputMap::const_iterator it = extractor->outputs().begin();
+       it != extractor->outputs().end(); ++it) {
+    streaming::connect(*it->second, pool, "lowlevel." + it->first);
+  }
+
+  Network network(input);
+  network.run();
+  Stages networkStages;
+  stages.analysis = networkTime(Network::profile(), networkStages);
+
+  Pool stats;
+  double start = now();
+  standard::Algorithm* aggregator = standard::AlgorithmFactory::create("PoolAggregator");
+  aggregator->input("input").set(pool);
+  aggregator->output("output").set(stats);
+  aggregator->compute();
+  delete aggregator;
+  stages.aggregation = now() - start;
+
+  stages.serialization = serialize(stats, workDir);
+  return stages;
+}
+
+
+// returns the report entries for one run: the result line followed by one
+// line per algorithm of the streaming networks
+string runExtractor(const string& name, const CorpusFile& file, const string& workDir) {
+  Network::setProfiling(true);
+  Network::resetProfile();
+
+  ostringstream out;
+  out.precision(6);
+  out << "{\"extractor\": " << jsonString(name) << ", \"file\": " << jsonString(file.name);
+
+  try {
+    Stages stages = name == "LowLevelGraph" ? runLowLevelGraph(file, workDir)
+                                            : runFileExtractor(name, file, workDir);
+
+    double audioSeconds = file.audio.size() / sampleRate;
+    double total = stages.decode + stages.analysis + stages.aggregation + stages.serialization;
+    out << ", \"audio_seconds\": " << audioSeconds
+        << ", \"seconds\": " << total
+        << ", \"realtime_factor\": " << (total > 0 ? audioSeconds / total : 0)
+        << ", \"peak_rss\": " << peakRSS()
+        << ", \"decode_seconds\": " << stages.decode
+        << ", \"analysis_seconds\": " << stages.analysis
+        << ", \"aggregation_seconds\": " << stages.aggregation
+        << ", \"serialization_seconds\": " << stages.serialization << "}\n";
+  }
+  catch (exception& e) {
+    string error = e.what();
+    out << ", \"error\": " << jsonString(error.substr(0, error.find('\n'))) << "}\n";
+    return out.str();
+  }
+
+  ProfileMap profile = Network::profile();
+  for (ProfileMap::const_iterator it = profile.begin(); it != profile.end(); ++it) {
+    out << "{\"extractor\": " << jsonString(name)
+        << ", \"file\": " << jsonString(file.name)
+        << ", \"algorithm\": " << jsonString(it->first)
+        << ", \"calls\": " << it->second.nProcess
+        << ", \"no_output\": " << it->second.nNoOutput
+        << ", \"seconds\": " << it->second.time << "}\n";
+  }
+
+  return out.str();
+}
+
+
+void writeEntries(ostream& out, const vector<string>& entries) {
+  for (size_t i=0; i<entries.size(); ++i) {
+    out << "    " << entries[i] << (i+1 < entries.size() ? "," : "") << "\n";
+  }
+}
+
+void writeReport(ostream& out, const vector<string>& results, const vector<string>& algorithms,
+                 Real duration) {
+  out << "{\n";
+  out << "  \"benchmark\": \"extractors\",\n";
+  out << "  \"key\": [\"extractor\", \"file\"],\n";
+  out << "  \"metric\": \"seconds\",\n";
+  out << "  \"essentia_version\": " << jsonString(version) << ",\n";
+  out << "  \"git_sha\": " << jsonString(version_git_sha) << ",\n";
+  out << "  \"duration\": " << duration << ",\n";
+  out << "  \"results\": [\n";
+  writeEntries(out, results);
+  out << "  ],\n";
+  out << "  \"algorithms\": [\n";
+  writeEntries(out, algorithms);
+  out << "  ]\n";
+  out << "}\n";
+}
+
+
+void usage(const char* program) {
+  cout << "Usage: " << program << " [options] [audiofile...]\n"
+       << "\n"
+       << "Runs the extractors on the given audio files, or on a few files of the test\n"
+       << "audio collection if none are given, or on a synthetic signal if neither are\n"
+       << "available.\n"
+       << "\n"
+       << "Options:\n"
+       << "  --output FILE       write the JSON report to FILE (default: stdout)\n"
+       << "  --extractors LIST   comma-separated extractors to run (default:\n"
+       << "                      MusicExtractor,FreesoundExtractor,LowLevelGraph)\n"
+       << "  --duration SECONDS  duration to which each file is lengthened (default: 60)\n"
+       << "  --work-dir DIR      directory for the temporary files (default: /tmp)\n"
+       << "  --timeout SECONDS   time after which an extraction is aborted (default: 600)\n";
+}
+
+vector<string> split(const string& str) {
+  vector<string> result;
+  istringstream stream(str);
+  string item;
+  while (getline(stream, item, ',')) {
+    if (!item.empty()) result.push_back(item);
+  }
+  return result;
+}
+
+
+int main(int argc, char* argv[]) {
+  string outputFilename, workDir = "/tmp";
+  vector<string> extractors = split("MusicExtractor,FreesoundExtractor,LowLevelGraph");
+  vector<string> corpus;
+  Real duration = 60;
+  int timeout = 600;
+
+  for (int i=1; i<argc; ++i) {
+    string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if (arg == "--output" && hasValue) outputFilename = argv[++i];
+    else if (arg == "--extractors" && hasValue) extractors = split(argv[++i]);
+    else if (arg == "--duration" && hasValue) duration = atof(argv[++i]);
+    else if (arg == "--work-dir" && hasValue) workDir = argv[++i];
+    else if (arg == "--timeout" && hasValue) timeout = atoi(argv[++i]);
+    else if (arg.size() > 2 && arg.substr(0, 2) == "--") {
+      usage(argv[0]);
+      return arg == "--help" ? 0 : 1;
+    }
+    else corpus.push_back(arg);
+  }
+
+  essentia::init();
+  setDebugLevel(ENone);
+  warningLevelActive = false;
+
+  if (corpus.empty() && isRegistered("MonoLoader")) {
+    for (size_t i=0; i<ARRAY_SIZE(defaultCorpus); ++i) {
+      if (ifstream(defaultCorpus[i]).good()) corpus.push_back(defaultCorpus[i]);
+    }
+  }
+  if (corpus.empty()) corpus.push_back("synthetic");
+
+  vector<string> results, algorithms;
+  for (size_t f=0; f<corpus.size(); ++f) {
+    CorpusFile file = prepareFile(corpus[f], duration, workDir, f);
+
+    for (size_t e=0; e<extractors.size(); ++e) {
+      const string& name = extractors[e];
+      if (name != "LowLevelGraph" && !isRegistered(name)) {
+        cerr << name << " is not available in this build, skipping" << endl;
+        continue;
+      }
+
+      cerr << name << " on " << file.name << "... " << flush;
+      string output, error;
+      if (!runIsolated([&]() { return runExtractor(name, file, workDir); },
+                       timeout, 0, output, error)) {
+        output = "{\"extractor\": " + jsonString(name) + ", \"file\": " + jsonString(file.name) +
+                 ", \"error\": " + jsonString(error) + "}\n";
+      }
+
+      istringstream lines(output);
+      string line;
+      getline(lines, line);
+      cerr << line << endl;
+      results.push_back(line);
+      while (getline(lines, line)) algorithms.push_back(line);
+    }
+
+    if (!file.filename.empty()) remove(file.filename.c_str());
+  }
+
+  if (outputFilename.empty()) {
+    writeReport(cout, results, algorithms, duration);
+  }
+  else {
+    ofstream out(outputFilename.c_str());
+    writeReport(out, results, algorithms, duration);
+  }
+
+  essentia::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+/*
+ * Benchmark of reading Pools from the files written by YamlOutput.
+ *
+ * A synthetic Pool with the frame values of a few descriptors is written as
+ * JSON and as YAML, for a few numbers of frames, and read back:
+ *  - json: YamlInput with format=json, which parses the file directly into
+ *    the Pool (readPoolJson)
+ *  - yaml: YamlInput with format=yaml, which builds a YAML syntax tree with
+ *    libyaml and converts it to a Pool, as JSON files not supported by the
+ *    direct reader are
+ * The report gives the time taken by each of them, and can be compared to a
+ * baseline with compare_benchmarks.py.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "algorithmfactory.h"
+#include "essentia.h"
+#include "pool.h"
+#include "benchmark_utils.h"
+
+using namespace std;
+using namespace essentia;
+using namespace essentia::benchmark;
+
+
+// a Pool like the frames pool of an extractor: a few frame-wise Reals and
+// vectors of Reals, and some metadata
+Pool syntheticPool(int frames) {
+  Pool pool;
+  pool.set("metadata.version.essentia", string(version));
+  pool.set("metadata.audio_properties.sample_rate", 44100.f);
+  pool.set("metadata.audio_properties.analysis.downmix", string("mix"));
+
+  srand(0);
+  for (int i=0; i<frames; ++i) {
+    pool.add("lowlevel.loudness", Real(rand()) / RAND_MAX);
+    pool.add("lowlevel.spectral_centroid", 10000.f * rand() / RAND_MAX);
+    pool.add("rhythm.onset_rate", Real(i % 7));
+
+    vector<Real> mfcc(13), bands(40);
+    for (int j=0; j<(int)mfcc.size(); ++j) mfcc[j] = 100.f * rand() / RAND_MAX - 50;
+    for (int j=0; j<(int)bands.size(); ++j) bands[j] = Real(rand()) / RAND_MAX * 1e-3f;
+    pool.add("lowlevel.mfcc", mfcc);
+    pool.add("lowlevel.melbands", bands);
+  }
+  return pool;
+}
+
+void writePool(const Pool& pool, const string& filename, const string& format) {
+  standard::Algorithm* output = standard::AlgorithmFactory::create("YamlOutput",
+                                                                   "filename", filename,
+                                                                   "format", format);
+  output->input("pool").set(pool);
+  output->compute();
+  delete output;
+}
+
+// returns the best time of a few runs, as reading a small file is too fast to
+// be measured reliably once
+double readPool(const string& filename, const string& format, int runs) {
+  standard::Algorithm* input = standard::AlgorithmFactory::create("YamlInput",
+                                                                  "filename", filename,
+                                                                  "format", format);
+  double best = 0;
+  for (int i=0; i<runs; ++i) {
+    Pool pool;
+    input->output("pool").set(pool);
+    double start = now();
+    input->compute();
+    double elapsed = now() - start;
+    if (i == 0 || elapsed < best) best = elapsed;
+  }
+  delete input;
+  return best;
+}
+
+long long fileSize(const string& filename) {
+  ifstream file(filename.c_str(), ios::binary | ios::ate);
+  return file ? (long long)file.tellg() : 0;
+}
+
+
+void writeReport(ostream& out, const vector<string>& results) {
+  out << "{\n";
+  out << "  \"benchmark\": \"pool\",\n";
+  out << "  \"key\": [\"reader\", \"frames\"],\n";
+  out << "  \"metric\": \"seconds\",\n";
+  out << "  \"essentia_version\": " << jsonString(version) << ",\n";
+  out << "  \"git_sha\": " << jsonString(version_git_sha) << ",\n";
+  out << "  \"results\": [\n";
+  for (size_t i=0; i<results.size(); ++i) {
+    out << "    " << results[i] << (i+1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n";
+  out << "}\n";
+}
+
+
+void usage(const char* program) {
+  cout << "Usage: " << program << " [options]\n"
+       << "\n"
+       << "Writes synthetic Pools as JSON and YAML with YamlOutput, and measures the\n"
+       << "time taken by YamlInput to read them back.\n"
+       << "\n"
+       << "Options:\n"
+       << "  --output FILE     write the JSON report to FILE (default: stdout)\n"
+       << "  --frames LIST     comma-separated numbers of frames of the Pools\n"
+       << "                    (default: 1000,10000,50000)\n"
+       << "  --runs N          number of runs of each reader, the best one being\n"
+       << "                    reported (default: 3)\n"
+       << "  --work-dir DIR    directory for the temporary files (default: /tmp)\n";
+}
+
+
+int main(int argc, char* argv[]) {
+  string outputFilename, workDir = "/tmp";
+  vector<int> frameCounts = parseIntList("1000,10000,50000");
+  int runs = 3;
+
+  for (int i=1; i<argc; ++i) {
+    string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if (arg == "--output" && hasValue) outputFilename = argv[++i];
+    else if (arg == "--frames" && hasValue) frameCounts = parseIntList(argv[++i]);
+    else if (arg == "--runs" && hasValue) runs = max(1, atoi(argv[++i]));
+    else if (arg == "--work-dir" && hasValue) workDir = argv[++i];
+    else {
+      usage(argv[0]);
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  essentia::init();
+  setDebugLevel(ENone);
+  warningLevelActive = false;
+
+  vector<string> results;
+  for (size_t f=0; f<frameCounts.size(); ++f) {
+    int frames = frameCounts[f];
+    Pool pool = syntheticPool(frames);
+
+    const char* formats[] = { "json", "yaml" };
+    for (int i=0; i<2; ++i) {
+      string format = formats[i];
+      string filename = workDir + "/pool_benchmark." + format;
+      writePool(pool, filename, format);
+
+      cerr << format << " with " << frames << " frames... " << flush;
+      double seconds = readPool(filename, format, runs);
+      long long bytes = fileSize(filename);
+      cerr << seconds << "s" << endl;
+
+      ostringstream result;
+      result << "{\"reader\": " << jsonString(format)
+             << ", \"frames\": " << frames
+             << ", \"bytes\": " << bytes
+             << ", \"seconds\": " << seconds
+             << ", \"megabytes_per_second\": " << (seconds > 0 ? bytes / seconds / 1e6 : 0) << "}";
+      results.push_back(result.str());
+
+      remove(filename.c_str());
+    }
+  }
+
+  if (outputFilename.empty()) {
+    writeReport(cout, results);
+  }
+  else {
+    ofstream out(outputFilename.c_str());
+    writeReport(out, results);
+  }
+
+  essentia::shutdown();
+
+  return 0;
+}
@@ -87,6 +87,17 @@ class TestIIR(TestCase):
         filt = IIR(numerator = a, denominator = b)
         self.assertAlmostEqualVector(filt(signal), expected, 1e-6)
 
+    def testNarrowLowPassPrecision(self):
+        # 4th-order Butterworth low-pass with a very low cutoff: its poles are
+        # so close to the unit circle that rounding the filter state to single
+        # precision makes the output drift away from the steady state
+        b = array([5.84514243e-08, 2.33805697e-07, 3.50708546e-07, 2.33805697e-07, 5.84514243e-08])
+        a = array([1., -3.91790950, 5.75707946, -3.76034550, 0.92117647])
+        dcGain = numpy.sum(b.astype(numpy.float64)) / numpy.sum(a.astype(numpy.float64))
+
+        output = IIR(numerator = b, denominator = a)(ones(20000))
+        self.assertAlmostEqual(output[-1], dcGain, 1e-4)
+
 
 
 
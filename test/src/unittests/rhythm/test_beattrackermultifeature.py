@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+
+
+class TestBeatTrackerMultiFeature(TestCase):
+
+    def signal(self):
+        # 10 seconds of tone bursts every 0.5s over a low sine
+        sampleRate = 44100.
+        t = numpy.arange(10 * 44100) / sampleRate
+        phase = numpy.fmod(t, 0.5)
+        signal = 0.1 * numpy.sin(2 * numpy.pi * 220 * t)
+        signal += numpy.where(phase < 0.1, 0.8 * numpy.exp(-60 * phase) * numpy.sin(2 * numpy.pi * 1000 * phase), 0)
+        return numpy.array(signal, dtype=numpy.float32)
+
+    def testRegression(self):
+        # the reference values were computed by the algorithm before it
+        # shared one STFT between the infogain and beat emphasis functions
+        expectedTicks = [0.487619042, 0.975238085, 1.48607707, 1.99691606,
+                         2.49614501, 2.9953742, 3.49460316, 3.99383211,
+                         4.49306107, 4.99229002, 5.47990942, 5.99074841,
+                         6.47836733, 6.98920631, 7.47682524, 7.98766422,
+                         8.47528362, 8.98612213, 9.49696159]
+        expectedConfidence = 3.79530764
+
+        ticks, confidence = BeatTrackerMultiFeature()(self.signal())
+        self.assertAlmostEqualVector(ticks, expectedTicks, 1e-5)
+        self.assertAlmostEqual(confidence, expectedConfidence, 1e-4)
+
+    def testComputeTwice(self):
+        signal = self.signal()
+        algo = BeatTrackerMultiFeature()
+        ticks, confidence = algo(signal)
+        ticks2, confidence2 = algo(signal)
+        self.assertEqualVector(ticks2, ticks)
+        self.assertEqual(confidence2, confidence)
+
+    def testEmpty(self):
+        ticks, confidence = BeatTrackerMultiFeature()([])
+        self.assertEqualVector(ticks, [])
+        self.assertEqual(confidence, 0)
+
+
+suite = allTests(TestBeatTrackerMultiFeature)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
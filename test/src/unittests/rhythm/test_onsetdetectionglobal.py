@@ -0,0 +1,59 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+
+
+class TestOnsetDetectionGlobal(TestCase):
+
+    def signal(self):
+        # 10 seconds of tone bursts every 0.5s over a low sine
+        sampleRate = 44100.
+        t = numpy.arange(10 * 44100) / sampleRate
+        phase = numpy.fmod(t, 0.5)
+        signal = 0.1 * numpy.sin(2 * numpy.pi * 220 * t)
+        signal += numpy.where(phase < 0.1, 0.8 * numpy.exp(-60 * phase) * numpy.sin(2 * numpy.pi * 1000 * phase), 0)
+        return numpy.array(signal, dtype=numpy.float32)
+
+    def testRegression(self):
+        # the reference values were computed by the algorithm before the two
+        # detection functions shared the same frames and FFT
+        signal = self.signal()
+        for method in ['infogain', 'beat_emphasis']:
+            expected = readVector(join(filedir(), 'onsetdetectionglobal', method + '.txt'))
+            found = OnsetDetectionGlobal(method=method)(signal)
+            self.assertAlmostEqualVector(found, expected, 1e-4)
+
+    def testComputeTwice(self):
+        signal = self.signal()
+        for method in ['infogain', 'beat_emphasis']:
+            algo = OnsetDetectionGlobal(method=method)
+            self.assertEqualVector(algo(signal), algo(signal))
+
+    def testEmpty(self):
+        for method in ['infogain', 'beat_emphasis']:
+            self.assertEqualVector(OnsetDetectionGlobal(method=method)([]), [])
+
+
+suite = allTests(TestOnsetDetectionGlobal)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
@@ -47,6 +47,32 @@ class TestSuperFluxExtractor(TestCase):
         #       in an ideal case, but what about practice?
         self.assertAlmostEqualVectorAbs(result, expected, 256./44100)
 
+    def testComputeTwice(self):
+        signal = zeros(44100*2)
+        signal[22050] = 1.
+        signal[44100] = 1.
+
+        algo = SuperFluxExtractor()
+        self.assertEqualVector(algo(signal), algo(signal))
+
+    def testStreaming(self):
+        # the streaming extractor outputs the vector of onsets at the end of
+        # the stream, the onsets being the same as the ones of the standard mode
+        from essentia.streaming import SuperFluxExtractor as sSuperFluxExtractor
+        signal = zeros(44100*2)
+        signal[22050] = 1.
+        signal[44100] = 1.
+
+        gen = VectorInput(signal)
+        extractor = sSuperFluxExtractor()
+        p = Pool()
+
+        gen.data >> extractor.signal
+        extractor.onsets >> (p, 'onsets')
+        run(gen)
+
+        self.assertEqualVector(p['onsets'], SuperFluxExtractor()(signal))
+
 
 suite = allTests(TestSuperFluxExtractor)
 
@@ -0,0 +1,75 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+from essentia.streaming import SuperFluxNovelty as sSuperFluxNovelty
+
+
+class TestSuperFluxNovelty(TestCase):
+
+    def bands(self):
+        numpy.random.seed(0)
+        return numpy.random.rand(50, 20).astype(numpy.float32)
+
+    def testRegression(self):
+        # the difference of each frame with the maximum filtered bands of the
+        # frameWidth-th previous one
+        bands = array([[1, 2, 3, 4], [0, 0, 0, 0], [5, 1, 4, 6]])
+        # maximum filter of the first frame over 3 bins: [1, 2, 3, 4]
+        self.assertAlmostEqual(SuperFluxNovelty(binWidth=3, frameWidth=2)(bands), 4 + 1 + 2)
+
+    def testStdVsStreaming(self):
+        # the streaming algorithm filters each frame once and gives the same
+        # differences as the standard one given the frameWidth+1 last frames
+        bands = self.bands()
+        for frameWidth in [1, 2, 5]:
+            algo = SuperFluxNovelty(binWidth=8, frameWidth=frameWidth)
+            expected = [algo(bands[i-frameWidth:i+1]) for i in range(frameWidth, len(bands))]
+
+            gen = VectorInput(bands)
+            novelty = sSuperFluxNovelty(binWidth=8, frameWidth=frameWidth)
+            p = Pool()
+
+            gen.data >> novelty.bands
+            novelty.differences >> (p, 'novelty')
+            run(gen)
+
+            self.assertAlmostEqualVector(p['novelty'], expected, 1e-6)
+
+    def testStreamingNotEnoughFrames(self):
+        gen = VectorInput(self.bands()[:2])
+        novelty = sSuperFluxNovelty(frameWidth=2)
+        p = Pool()
+
+        gen.data >> novelty.bands
+        novelty.differences >> (p, 'novelty')
+        run(gen)
+
+        self.assertFalse('novelty' in p.descriptorNames())
+
+    def testEmpty(self):
+        self.assertComputeFails(SuperFluxNovelty(), [])
+
+
+suite = allTests(TestSuperFluxNovelty)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
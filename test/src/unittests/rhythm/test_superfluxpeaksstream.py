@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+from essentia.streaming import SuperFluxPeaksStream
+
+
+class TestSuperFluxPeaksStream(TestCase):
+
+    def novelty(self):
+        # impulses every 50 frames over a low-level noise floor
+        novelty = [0.001] * 500
+        for i in range(25, 500, 50):
+            novelty[i] = 1.
+        return novelty
+
+    def testRegression(self):
+        novelty = self.novelty()
+        expected = [i / 172. for i in range(25, 500, 50)]
+
+        gen = VectorInput(novelty)
+        peaks = SuperFluxPeaksStream(frameRate=172.)
+        p = Pool()
+
+        gen.data >> peaks.novelty
+        peaks.peaks >> (p, 'peaks')
+        run(gen)
+
+        self.assertAlmostEqualVector(p['peaks'], expected)
+
+    def testStdVsStreaming(self):
+        from essentia.standard import SuperFluxPeaks as stdSuperFluxPeaks
+        novelty = self.novelty()
+
+        gen = VectorInput(novelty)
+        peaks = SuperFluxPeaksStream()
+        p = Pool()
+
+        gen.data >> peaks.novelty
+        peaks.peaks >> (p, 'peaks')
+        run(gen)
+
+        self.assertEqualVector(p['peaks'], stdSuperFluxPeaks()(novelty))
+
+    def testChunks(self):
+        # feeding the standard algorithm with chunks of the novelty curve
+        # should give the same peaks as feeding it at once
+        from essentia.standard import SuperFluxPeaks as stdSuperFluxPeaks
+        novelty = self.novelty()
+        expected = stdSuperFluxPeaks()(novelty)
+
+        algo = stdSuperFluxPeaks()
+        result = []
+        for i in range(0, len(novelty), 7):
+            result += list(algo(novelty[i:i+7]))
+
+        self.assertEqualVector(result, expected)
+
+    def testEmpty(self):
+        gen = VectorInput([])
+        peaks = SuperFluxPeaksStream()
+        p = Pool()
+
+        gen.data >> peaks.novelty
+        peaks.peaks >> (p, 'peaks')
+        run(gen)
+
+        self.assertEqualVector(p.descriptorNames(), [])
+
+
+suite = allTests(TestSuperFluxPeaksStream)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
@@ -0,0 +1,78 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+from numpy.random import RandomState
+
+
+class TestSpectrumStats(TestCase):
+
+    def separateStats(self, spectrum, sampleRate=44100):
+        bands = [20, 150, 800, 4000, 20000]
+        return [Energy()(spectrum),
+                RMS()(spectrum),
+                RollOff(sampleRate=sampleRate)(spectrum),
+                Decrease(range=sampleRate*0.5)(spectrum**2),
+                HFC(sampleRate=sampleRate)(spectrum),
+                StrongPeak()(spectrum)] + \
+               [EnergyBand(sampleRate=sampleRate,
+                           startCutoffFrequency=bands[i],
+                           stopCutoffFrequency=bands[i+1])(spectrum) for i in range(4)]
+
+    def testEmpty(self):
+        self.assertComputeFails(SpectrumStats(), [])
+
+    def testOne(self):
+        self.assertComputeFails(SpectrumStats(), [1])
+
+    def testNegative(self):
+        self.assertComputeFails(SpectrumStats(), [-1]*50 + [1]*50)
+
+    def testInvalidParam(self):
+        self.assertConfigureFails(SpectrumStats(), {'energyBandFrequencies': [20, 150, 800]})
+        self.assertConfigureFails(SpectrumStats(), {'energyBandFrequencies': [20, 800, 150, 4000, 20000]})
+
+    def testZero(self):
+        spectrum = zeros(1025)
+        self.assertEqual(list(SpectrumStats()(spectrum)), self.separateStats(spectrum))
+
+    def testRandom(self):
+        # the fused computation must give exactly the same values as the
+        # separate algorithms it replaces in the extractors
+        rng = RandomState(0)
+        for size in [513, 1025]:
+            for i in range(20):
+                spectrum = (rng.rand(size)**4).astype('float32')
+                self.assertEqual(list(SpectrumStats()(spectrum)), self.separateStats(spectrum))
+
+    def testLowSampleRate(self):
+        # band limits above Nyquist are clipped
+        spectrum = RandomState(1).rand(513).astype('float32')
+        stats = SpectrumStats(sampleRate=22050)(spectrum)
+        high = EnergyBand(sampleRate=22050, startCutoffFrequency=4000,
+                          stopCutoffFrequency=11025)(spectrum)
+        self.assertEqual(stats[9], high)
+
+
+suite = allTests(TestSpectrumStats)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
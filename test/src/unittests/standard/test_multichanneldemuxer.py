@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+
+from essentia_test import *
+from essentia.standard import MultiChannelDemuxer
+
+class TestMultiChannelDemuxer(TestCase):
+
+    def surround(self):
+        # 6 channels, channel c holds the value c+1
+        size = 10
+        return array([[c+1]*size for c in range(6)])
+
+    def testRegression(self):
+        size = 10
+        input = array([[size-i for i in range(size)], [i for i in range(size)]])
+        left, right = MultiChannelDemuxer()(input)
+
+        self.assertEqualVector(left, [size-i for i in range(size)])
+        self.assertEqualVector(right, [i for i in range(size)])
+
+    def testChannelPair(self):
+        # rear surround pair of a 5.1 signal
+        left, right = MultiChannelDemuxer(leftChannel=4, rightChannel=5)(self.surround())
+        self.assertEqualVector(left, [5]*10)
+        self.assertEqualVector(right, [6]*10)
+
+    def testMono(self):
+        left, right = MultiChannelDemuxer()(array([[1, 2, 3]]))
+        self.assertEqualVector(left, [1, 2, 3])
+        self.assertEqualVector(right, [0, 0, 0])
+
+    def testInvalidChannel(self):
+        self.assertComputeFails(MultiChannelDemuxer(rightChannel=6), self.surround())
+
+    def testEmpty(self):
+        left, right = MultiChannelDemuxer()(array([[], []]))
+        self.assertEqualVector(left, [])
+        self.assertEqualVector(right, [])
+
+
+suite = allTests(TestMultiChannelDemuxer)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
@@ -0,0 +1,66 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+
+from essentia_test import *
+from essentia.standard import MultiChannelMixer
+
+class TestMultiChannelMixer(TestCase):
+
+    def surround(self):
+        # 6 channels, channel c holds the value c+1
+        size = 10
+        return array([[c+1]*size for c in range(6)])
+
+    def testMix(self):
+        output = MultiChannelMixer(type='mix')(self.surround())
+        self.assertEqualVector(output, [3.5]*10)
+
+    def testChannel(self):
+        for c in range(6):
+            output = MultiChannelMixer(type='channel', channel=c)(self.surround())
+            self.assertEqualVector(output, [c+1]*10)
+
+    def testMono(self):
+        input = array([[0.5, -0.5, 1.0]])
+        self.assertEqualVector(MultiChannelMixer(type='mix')(input), input[0])
+        self.assertEqualVector(MultiChannelMixer(type='channel')(input), input[0])
+
+    def testStereoSameAsMonoMixer(self):
+        left = [0.9, 0.1, -0.3]
+        right = [0.5, 0.2, 0.7]
+        output = MultiChannelMixer()(array([left, right]))
+        self.assertAlmostEqualVector(output, [0.5*(l+r) for l, r in zip(left, right)])
+
+    def testInvalidChannel(self):
+        self.assertComputeFails(MultiChannelMixer(type='channel', channel=6), self.surround())
+
+    def testEmpty(self):
+        self.assertEqualVector(MultiChannelMixer()(array([[]])), [])
+
+    def testInvalidParam(self):
+        self.assertConfigureFails(MultiChannelMixer(), {'type': 'unknown'})
+
+
+suite = allTests(TestMultiChannelMixer)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
@@ -60,6 +60,16 @@ class TestNoiseAdder(TestCase):
         for i in range(10):
             self.assertNotEqual(a[i], b[i])
 
+    def testSeed(self):
+        a=NoiseAdder(fixSeed=True, seed=1)(zeros(1000))
+        b=NoiseAdder(fixSeed=True, seed=2)(zeros(1000))
+        self.assertNotEqual(list(a), list(b))
+
+        # the noise does not depend on the size of the input signals
+        adder = NoiseAdder(fixSeed=True, seed=1)
+        c = list(adder(zeros(300))) + list(adder(zeros(700)))
+        self.assertEqualVector(a, c)
+
 
 
 suite = allTests(TestNoiseAdder)
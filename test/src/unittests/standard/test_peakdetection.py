@@ -214,6 +214,39 @@ class TestPeakDetection(TestCase):
         self.assertEqualVector(vals, [val[-1]])
 
 
+    def testMaxPeaksByAmplitude(self):
+        # only the highest peaks should be kept, sorted by descending amplitude
+        # and by ascending position in case of equality
+        inputSize = 1024
+        pos = [10, 100, 200, 300, 400, 500]
+        val = [1.0, 5.0, 3.0, 5.0, 2.0, 4.0]
+        input = [0] * inputSize
+        for i in range(len(pos)):
+            input[pos[i]] = val[i]
+
+        config = { 'range': inputSize -1,  'maxPosition': inputSize, 'minPosition': 0,  'orderBy': 'amplitude', 'maxPeaks': 3 }
+        pdetect = PeakDetection(**config)
+        (posis, vals) = pdetect(input)
+        self.assertEqualVector(posis, [100, 300, 500])
+        self.assertEqualVector(vals, [5.0, 5.0, 4.0])
+
+    def testThreshold(self):
+        # peaks below threshold are discarded, also when they are surrounded
+        # by long regions below threshold
+        inputSize = 1024
+        input = [-1.0] * inputSize
+        input[5] = 0.5
+        input[300] = 2.0
+        input[301] = 1.5
+        input[700] = 3.0
+        input[inputSize-2] = 0.8
+
+        config = { 'range': inputSize -1,  'maxPosition': inputSize, 'minPosition': 0,  'orderBy': 'position', 'interpolate': False, 'threshold': 1.0 }
+        pdetect = PeakDetection(**config)
+        (posis, vals) = pdetect(input)
+        self.assertEqualVector(posis, [300, 700])
+        self.assertEqualVector(vals, [2.0, 3.0])
+
     def testZero(self):
         inputSize = 1024
         input = [0] * inputSize
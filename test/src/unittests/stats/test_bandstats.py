@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+from numpy.random import RandomState
+
+
+class TestBandStats(TestCase):
+
+    def separateStats(self, bands, range):
+        moments = CentralMoments(range=range)(bands)
+        spread, skewness, kurtosis = DistributionShape()(moments)
+        return [spread, skewness, kurtosis, FlatnessDB()(bands), Crest()(bands)]
+
+    def testEmpty(self):
+        self.assertComputeFails(BandStats(), [])
+
+    def testOne(self):
+        self.assertComputeFails(BandStats(), [1])
+
+    def testNegative(self):
+        self.assertComputeFails(BandStats(), [1, -1, 2])
+
+    def testZero(self):
+        self.assertEqual(list(BandStats()([0]*27)), [0, 0, -3, 1, 0])
+
+    def testFlat(self):
+        bands = [.5]*40
+        self.assertEqual(list(BandStats(range=39)(bands)), self.separateStats(bands, 39))
+
+    def testRandom(self):
+        # the fused computation must give exactly the same values as the
+        # separate algorithms it replaces in the extractors
+        rng = RandomState(0)
+        for size in [18, 27, 40]:
+            for i in range(20):
+                bands = (rng.rand(size)**3).astype('float32')
+                bands[i % size] = 0
+                self.assertEqual(list(BandStats(range=size-1)(bands)),
+                                 self.separateStats(bands, size-1))
+
+
+suite = allTests(TestBandStats)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+from essentia.streaming import LoudnessMeters as sLoudnessMeters
+from numpy import sin, pi, random
+
+class TestLoudnessMeters(TestCase):
+
+    def signal(self, duration=10, sr=44100):
+        random.seed(0)
+        t = arange(int(duration*sr)) / float(sr)
+        return array(0.3*sin(2*pi*440*t)*(1 + sin(2*pi*0.5*t))
+                     + 0.05*(random.rand(len(t)) - 0.5), dtype=single)
+
+    def testEmpty(self):
+        self.assertComputeFails(LoudnessMeters(), [])
+
+    def testTooShort(self):
+        self.assertComputeFails(LoudnessMeters(), ones(100))
+
+    def testZero(self):
+        replayGain, leq, larm, vickers = LoudnessMeters()(zeros(44100))
+        self.assertAlmostEqual(replayGain, -31.492595672607422 + 90, 1e-6)
+        self.assertEqual(leq, -90)
+        self.assertEqual(larm, -100)
+        self.assertEqual(vickers, -90)
+
+    def testRegression(self):
+        # same results as the algorithms computing each of the measures
+        input = self.signal()
+        replayGain, leq, larm, vickers = LoudnessMeters()(input)
+
+        # the ReplayGain percentile is taken from a histogram of 0.01dB bins
+        self.assertAlmostEqual(replayGain, ReplayGain()(input), 1e-3)
+        self.assertAlmostEqual(leq, Leq()(input), 1e-3)
+        self.assertAlmostEqual(larm, Larm()(input), 1e-3)
+        self.assertAlmostEqual(vickers, LoudnessVickers()(input), 1e-5)
+
+    def testLarmParameters(self):
+        input = self.signal(2)
+        for power in [0, 1, 2]:
+            larm = LoudnessMeters(attackTime=5, releaseTime=500, power=power)(input)[2]
+            self.assertAlmostEqual(larm, Larm(attackTime=5, releaseTime=500, power=power)(input), 1e-3)
+
+    def testStreaming(self):
+        input = self.signal()
+
+        gen = VectorInput(input)
+        meters = sLoudnessMeters()
+        p = Pool()
+
+        gen.data >> meters.signal
+        meters.replayGain >> (p, 'replayGain')
+        meters.leq >> (p, 'leq')
+        meters.larm >> (p, 'larm')
+        meters.vickers >> (p, 'vickers')
+
+        run(gen)
+
+        replayGain, leq, larm, vickers = LoudnessMeters()(input)
+        # the blocks are not the same as in standard mode
+        self.assertAlmostEqual(p['replayGain'], replayGain, 1e-5)
+        self.assertAlmostEqual(p['leq'], leq, 1e-5)
+        self.assertAlmostEqual(p['larm'], larm, 1e-5)
+        self.assertAlmostEqual(p['vickers'], vickers, 1e-5)
+
+    def testInvalidParam(self):
+        self.assertConfigureFails(LoudnessMeters(), {'sampleRate': 22050})
+        self.assertConfigureFails(LoudnessMeters(), {'attackTime': -1})
+        self.assertConfigureFails(LoudnessMeters(), {'releaseTime': -1})
+
+
+suite = allTests(TestLoudnessMeters)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
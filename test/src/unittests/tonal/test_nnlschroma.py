@@ -69,6 +69,49 @@ class TestNNLSChroma(TestCase):
             self.assertEqual(outs[0].sum() + outs[1].sum() + numpy.sum(outs[-2:]), .0)
             size = int(size/2)
 
+    def testThreads(self):
+        # The frames split among several threads give the same chromagrams,
+        # the NNLS solver only starting again from scratch in each thread
+        numpy.random.seed(0)
+        logfreqspectrogram = numpy.random.rand(40, 256).astype(numpy.float32)
+        meanTuning = array([0.5, 0.3, 0.2])
+        localTuning = zeros(40)
+
+        outs = NNLSChroma(threads=1)(logfreqspectrogram, meanTuning, localTuning)
+        outsThreads = NNLSChroma(threads=4)(logfreqspectrogram, meanTuning, localTuning)
+
+        # the notes of the dictionary are found in noise
+        self.assertTrue(outs[1].sum() > 0)
+        for out, outThreads in zip(outs, outsThreads):
+            self.assertAlmostEqualMatrix(out, outThreads, 1e-4)
+
+    def testRegressionNNLS(self):
+        # The reference chromagrams were computed with the Lawson-Hanson
+        # solver of the NNLS Chroma VAMP plugin, which solved each frame from
+        # scratch. The input is made of chords changing every 10 frames over
+        # a low floor
+        chords = [[0, 4, 7], [5, 9, 12], [7, 11, 14], [9, 12, 16]]
+        logfreqspectrogram = zeros([40, 256])
+        for f in range(40):
+            frame = 0.05 + 0.04 * numpy.sin(0.3 * numpy.arange(256) + 0.7 * f)
+            for octave in range(1, 6):
+                for note in chords[f // 10]:
+                    centre = 3 * (12 * octave + note) + 2
+                    frame[centre] += 1. / octave
+                    frame[centre - 1] += 0.5 / octave
+                    frame[centre + 1] += 0.5 / octave
+            logfreqspectrogram[f] = frame
+        meanTuning = array([0.5, 0.3, 0.2])
+        localTuning = zeros(40)
+
+        expectedChroma = readMatrix(join(filedir(), 'nnlschroma', 'chroma.txt'))
+        expectedBassChroma = readMatrix(join(filedir(), 'nnlschroma', 'bass_chroma.txt'))
+
+        _, _, bassChroma, chroma = NNLSChroma()(array(logfreqspectrogram), meanTuning, localTuning)
+
+        self.assertAlmostEqualMatrix(chroma, expectedChroma, 1e-4)
+        self.assertAlmostEqualMatrix(bassChroma, expectedBassChroma, 1e-4)
+
     def testInvalidInput(self):
         self.assertComputeFails(NNLSChroma(), array([array([])]), zeros(3), zeros(2))
         self.assertComputeFails(NNLSChroma(), array([array([0.5])]), zeros(3), zeros(2))
@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+class TestSpectralPeakDescriptors(TestCase):
+
+    def separateDescriptors(self, freqs, mags, pitch):
+        hfreqs, hmags = HarmonicPeaks()(freqs, mags, pitch)
+        return (Dissonance()(freqs, mags),
+                Inharmonicity()(hfreqs, hmags),
+                Tristimulus()(hfreqs, hmags),
+                OddToEvenHarmonicEnergyRatio()(hfreqs, hmags))
+
+    def assertSameDescriptors(self, freqs, mags, pitch):
+        dissonance, inharmonicity, tristimulus, oddToEven = \
+            SpectralPeakDescriptors()(freqs, mags, pitch)
+        expected = self.separateDescriptors(freqs, mags, pitch)
+        self.assertEqual(dissonance, expected[0])
+        self.assertEqual(inharmonicity, expected[1])
+        self.assertEqualVector(tristimulus, expected[2])
+        self.assertEqual(oddToEven, expected[3])
+
+    def testRegression(self):
+        audio = MonoLoader(filename = join(testdata.audio_dir, 'recorded', 'musicbox.wav'),
+                           sampleRate = 44100)()
+        w = Windowing(type = 'blackmanharris62')
+        spectrum = Spectrum()
+        peaks = SpectralPeaks(orderBy = 'frequency', minFrequency = 20)
+        pitchDetection = PitchYinFFT()
+
+        for frame in FrameGenerator(audio, frameSize = 2048, hopSize = 1024):
+            spec = spectrum(w(frame))
+            freqs, mags = peaks(spec)
+            pitch, _ = pitchDetection(spec)
+            self.assertSameDescriptors(freqs, mags, pitch)
+
+    def testRandomPeaks(self):
+        from numpy.random import seed, uniform
+        seed(0)
+        for i in range(20):
+            freqs = sorted(set(uniform(20, 22050, 100).astype(numpy.float32)))
+            mags = uniform(0, 1, len(freqs))
+            self.assertSameDescriptors(freqs, mags, freqs[2])
+
+    def testHarmonics(self):
+        freqs = [100, 202, 300, 405, 500, 600]
+        mags = [1, 0.5, 0.3, 0.2, 0.1, 0.05]
+        self.assertSameDescriptors(freqs, mags, 100)
+
+    def testZeroPitch(self):
+        freqs = [100, 200, 300]
+        mags = [1, 1, 1]
+        dissonance, inharmonicity, tristimulus, oddToEven = \
+            SpectralPeakDescriptors()(freqs, mags, 0)
+        self.assertEqual(dissonance, Dissonance()(freqs, mags))
+        self.assertEqual(inharmonicity, 0)
+        self.assertEqualVector(tristimulus, [0, 0, 0])
+        self.assertEqual(oddToEven, 1)
+
+    def testEmpty(self):
+        dissonance, inharmonicity, tristimulus, oddToEven = \
+            SpectralPeakDescriptors()([], [], 100)
+        self.assertEqual(dissonance, 0)
+        self.assertEqual(inharmonicity, 0)
+        self.assertEqualVector(tristimulus, [0, 0, 0])
+        self.assertEqual(oddToEven, 1)
+
+    def testUnsortedFrequencies(self):
+        self.assertComputeFails(SpectralPeakDescriptors(), [200, 100], [1, 1], 100)
+
+    def testDifferentSize(self):
+        self.assertComputeFails(SpectralPeakDescriptors(), [100, 200], [1], 100)
+
+    def testNegativePitch(self):
+        self.assertComputeFails(SpectralPeakDescriptors(), [100, 200], [1, 1], -100)
+
+
+suite = allTests(TestSpectralPeakDescriptors)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)